@@ -0,0 +1,341 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Benchmark suite for the hot path of the driver: Serial bitstream and
+ * Manchester coding, rendering data frames in each output format and
+ * draining a data frame from the RX FIFO with VariableLengthModeProtocol.
+ * The RF module is replaced by FakeSpi, which holds a single data frame in
+ * its RX FIFO.
+ *
+ * Run it before and after changing the hot path, regressions show up as
+ * higher ns/op. The benchmarks of the single components (e.g.
+ * BitstreamBenchmark.cpp) additionally compare to reference implementations.
+ *
+ * Compile and run (from the bench directory):
+ * g++ -O2 -I../src Benchmark.cpp ../src/SerialBitstream.cpp ../src/Manchester.cpp \
+ *     ../src/LegacyOutputFormat.cpp ../src/CsvOutputFormat.cpp ../src/JsonOutputFormat.cpp \
+ *     ../src/CborOutputFormat.cpp ../src/FrameFields.cpp ../src/OutputEncoding.cpp \
+ *     ../src/VariableLengthModeProtocol.cpp ../src/Spi.cpp ../src/Log.cpp \
+ *     ../src/ReceiveLatency.cpp ../src/LatencyHistogram.cpp ../src/Metrics.cpp -lrt -lpthread -o Benchmark
+ * ./Benchmark [name prefix]
+ *
+ * With a name prefix, only the benchmarks starting with it are run, e.g.
+ * "./Benchmark format-".
+ *
+ * Prints one line per benchmark and payload size:
+ * <benchmark> <payload bytes> <ns/op> <payload bytes/s>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "AddressSpace.hpp"
+#include "Spi.hpp"
+#include "VariableLengthModeProtocol.hpp"
+#include "SerialBitstream.hpp"
+#include "Manchester.hpp"
+#include "LegacyOutputFormat.hpp"
+#include "CsvOutputFormat.hpp"
+#include "JsonOutputFormat.hpp"
+#include "CborOutputFormat.hpp"
+
+static const int ITERATIONS = 100000;
+static const int PAYLOAD_SIZES[] = { 8, 60, 184, 255 };
+
+static const char* prefix = "";
+
+static uint64_t nanos() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * VariableLengthModeProtocol waits for the RX FIFO to fill up again while
+ * draining long data frames. FakeSpi has all bytes available immediately,
+ * so waiting would only measure the sleep.
+ */
+extern "C" int usleep(useconds_t usec) {
+	return 0;
+}
+
+/**
+ * Replaces the RF module. The RX FIFO holds the same data frame again
+ * every time its first byte is read, and reports as many bytes available
+ * as the real RX FIFO could hold.
+ */
+class FakeSpi : public Spi {
+
+public:
+	FakeSpi() {
+		this->len = 0;
+		this->pos = 0;
+	}
+
+	/**
+	 * The data frame as the CC1101 receives it: Length byte, payload,
+	 * RSSI and LQI.
+	 */
+	void setFrame(const uint8_t* payload, size_t len) {
+		this->frame[0] = len;
+		memcpy(this->frame + 1, payload, len);
+		this->frame[len + 1] = 0xE4; // RSSI
+		this->frame[len + 2] = 0xAD; // LQI with CRC OK
+		this->len = len + 3;
+	}
+
+	virtual uint8_t readSingleByte(const uint8_t address, uint8_t& value) {
+		if (address == ADDR_RXTX_FIFO) {
+			this->pos = 0;
+			value = this->frame[this->pos++];
+		} else {
+			value = 0;
+		}
+
+		return STATUS_RX;
+	}
+
+	virtual uint8_t readBurst(const uint8_t address, uint8_t buffer[], const size_t nbytes) {
+		if (address == ADDR_RX_BYTES) {
+			size_t available = this->len - this->pos;
+			buffer[0] = available < VariableLengthModeProtocol::FIFO_LENGTH
+					? available : VariableLengthModeProtocol::FIFO_LENGTH;
+		} else if (address == ADDR_RXTX_FIFO) {
+			memcpy(buffer, this->frame + this->pos, nbytes);
+			this->pos += nbytes;
+		}
+
+		return STATUS_RX;
+	}
+
+	virtual uint8_t readStrobe(const uint8_t address) {
+		return STATUS_RX;
+	}
+
+	virtual uint8_t writeSingleByte(const uint8_t address, const uint8_t value) {
+		return STATUS_RX;
+	}
+
+	virtual uint8_t writeBurst(const uint8_t address, const uint8_t buffer[], const size_t nbytes) {
+		return STATUS_RX;
+	}
+
+private:
+	/** Chip status byte: CHIP_RDYn low, state RX */
+	static const uint8_t STATUS_RX = 0x10;
+
+	uint8_t frame[258];
+	size_t len;
+	size_t pos;
+};
+
+/**
+ * Returns true if the benchmark was selected on the command line.
+ */
+static bool selected(const char* name) {
+	return strncmp(name, prefix, strlen(prefix)) == 0;
+}
+
+static void report(const char* name, size_t len, uint64_t elapsed) {
+	printf("%s %d %.1f %.0f\n", name, (int) len,
+			(double) elapsed / ITERATIONS, (double) len * ITERATIONS * 1e9 / elapsed);
+	fflush(stdout);
+}
+
+static void benchmarkBitstream(const uint8_t* payload, size_t len) {
+
+	SerialBitstream bitstream;
+	uint8_t encoded[512];
+	uint8_t decoded[512];
+	size_t encodedLen;
+	size_t decodedLen;
+
+	bitstream.encode(payload, len, encoded, encodedLen);
+
+	if (selected("bitstream-encode")) {
+		uint64_t start = nanos();
+		for (int i=0 ; i<ITERATIONS ; i++) {
+			bitstream.encode(payload, len, encoded, encodedLen);
+			__asm__ __volatile__("" : : "r"(encoded) : "memory");
+		}
+		report("bitstream-encode", len, nanos() - start);
+	}
+
+	if (selected("bitstream-decode")) {
+		uint64_t start = nanos();
+		for (int i=0 ; i<ITERATIONS ; i++) {
+			bitstream.decode(encoded, encodedLen, decoded, decodedLen);
+			__asm__ __volatile__("" : : "r"(decoded) : "memory");
+		}
+		report("bitstream-decode", len, nanos() - start);
+	}
+}
+
+static void benchmarkManchester(const uint8_t* payload, size_t len) {
+
+	Manchester manchester;
+	uint8_t encoded[512];
+	uint8_t decoded[512];
+	size_t encodedLen;
+	size_t decodedLen;
+
+	manchester.encode(payload, len, encoded, encodedLen);
+
+	if (selected("manchester-encode")) {
+		uint64_t start = nanos();
+		for (int i=0 ; i<ITERATIONS ; i++) {
+			manchester.encode(payload, len, encoded, encodedLen);
+			__asm__ __volatile__("" : : "r"(encoded) : "memory");
+		}
+		report("manchester-encode", len, nanos() - start);
+	}
+
+	if (selected("manchester-decode")) {
+		uint64_t start = nanos();
+		for (int i=0 ; i<ITERATIONS ; i++) {
+			manchester.decode(encoded, encodedLen, decoded, decodedLen);
+			__asm__ __volatile__("" : : "r"(decoded) : "memory");
+		}
+		report("manchester-decode", len, nanos() - start);
+	}
+}
+
+static void benchmarkFormats(IOutputFormat* formats[], size_t nformats, const uint8_t* payload, size_t len) {
+
+	FrameRecord record;
+	memset(&record, 0, sizeof(record));
+	record.sequence = 123456;
+	record.frameType = FRAME_TYPE_RFBEE;
+	record.flags = FRAME_FLAG_ADDRESS | FRAME_FLAG_RSSI_LQI | FRAME_FLAG_CRC_OK;
+	record.srcAddress = 0x0A;
+	record.destAddress = 0x01;
+	record.rssi = 0xE4;
+	record.lqi = 0x2D;
+	record.timestamp = 1380000000123456789ULL;
+	record.len = len;
+	memcpy(record.payload, payload, len);
+
+	char line[IOutputFormat::MAX_LINE_BYTES];
+	char name[64];
+
+	for (size_t f=0 ; f<nformats ; f++) {
+		snprintf(name, sizeof(name), "format-%s", formats[f]->getName());
+		if (!selected(name)) {
+			continue;
+		}
+
+		uint64_t start = nanos();
+		for (int i=0 ; i<ITERATIONS ; i++) {
+			formats[f]->format(record, line, sizeof(line));
+			__asm__ __volatile__("" : : "r"(line) : "memory");
+		}
+		report(name, len, nanos() - start);
+	}
+}
+
+/**
+ * VariableLengthModeProtocol::receive() prints every data frame it
+ * receives, so stdout is discarded meanwhile. The cost of printing is
+ * part of the result, just as on the gateway.
+ */
+static void benchmarkReceive(const uint8_t* payload, size_t len) {
+
+	if (!selected("receive")) {
+		return;
+	}
+
+	FakeSpi spi;
+	VariableLengthModeProtocol protocol(&spi);
+	uint8_t buffer[258];
+	size_t nbytes = 0;
+
+	spi.setFrame(payload, len);
+
+	fflush(stdout);
+	int savedStdout = dup(1);
+	int devNull = open("/dev/null", O_WRONLY);
+	dup2(devNull, 1);
+
+	bool failed = false;
+	uint64_t start = nanos();
+	for (int i=0 ; i<ITERATIONS ; i++) {
+		if (protocol.receive(buffer, nbytes) < 0 || nbytes != len + 2) {
+			failed = true;
+			break;
+		}
+	}
+	uint64_t elapsed = nanos() - start;
+
+	fflush(stdout);
+	dup2(savedStdout, 1);
+	close(savedStdout);
+	close(devNull);
+
+	if (failed || memcmp(buffer, payload, len) != 0) {
+		fprintf(stderr, "Received data frame differs (length=%d)\n", (int) nbytes);
+		exit(1);
+	}
+
+	report("receive", len, elapsed);
+}
+
+int main(int argc, char** argv) {
+
+	if (argc > 1) {
+		prefix = argv[1];
+	}
+
+	LegacyOutputFormat payloadFormat(LegacyOutputFormat::STYLE_PAYLOAD);
+	LegacyOutputFormat addressFormat(LegacyOutputFormat::STYLE_ADDRESS);
+	LegacyOutputFormat binaryFormat(LegacyOutputFormat::STYLE_BINARY);
+	LegacyOutputFormat decimalFormat(LegacyOutputFormat::STYLE_DECIMAL);
+	LegacyOutputFormat hexFormat(LegacyOutputFormat::STYLE_HEX);
+	LegacyOutputFormat rawFormat(LegacyOutputFormat::STYLE_RAW);
+	LegacyOutputFormat radiatorFormat(LegacyOutputFormat::STYLE_RADIATOR);
+	CsvOutputFormat csvFormat;
+	JsonOutputFormat jsonFormat;
+	CborOutputFormat cborFormat;
+
+	IOutputFormat* formats[] = {
+		&payloadFormat, &addressFormat, &binaryFormat, &decimalFormat, &hexFormat,
+		&rawFormat, &radiatorFormat, &csvFormat, &jsonFormat, &cborFormat
+	};
+
+	uint8_t payload[255];
+	for (size_t i=0 ; i<sizeof(payload) ; i++) {
+		payload[i] = rand();
+	}
+
+	for (size_t s=0 ; s<sizeof(PAYLOAD_SIZES)/sizeof(PAYLOAD_SIZES[0]) ; s++) {
+		size_t len = PAYLOAD_SIZES[s];
+
+		benchmarkBitstream(payload, len);
+		benchmarkManchester(payload, len);
+		benchmarkFormats(formats, sizeof(formats)/sizeof(formats[0]), payload, len);
+		benchmarkReceive(payload, len);
+	}
+
+	return 0;
+}
@@ -0,0 +1,181 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Measures how fast SerialBitstream decodes and encodes, compared to the
+ * original bit by bit implementation. Both are checked to produce the
+ * same bytes first.
+ *
+ * Compile and run (from the bench directory):
+ * g++ -O2 -I../src BitstreamBenchmark.cpp ../src/SerialBitstream.cpp -o BitstreamBenchmark
+ * ./BitstreamBenchmark
+ *
+ * Prints one line per implementation and payload size:
+ * <implementation> <payload bytes> <ns/op> <bitstream bytes/s>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "SerialBitstream.hpp"
+
+static const int ITERATIONS = 200000;
+static const int PAYLOAD_SIZES[] = { 8, 60, 184, 255 };
+
+static uint64_t nanos() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * The original decoder, walking the bitstream bit by bit.
+ */
+static void referenceDecode(const uint8_t *inputBuffer, size_t inputBufferLen, uint8_t *outputBuffer, size_t& outputBufferLen) {
+
+	int j = 0;
+	for (int i=0 ; i < (int) (inputBufferLen * 8) ; i++) {
+
+		if (i % 10 == 0) {
+			// Start bit. Ignore.
+		}
+		else if ((i - 9) % 10 == 0) {
+			// Stop bit. Ignore.
+		}
+		else {
+			uint8_t mask = 1 << (7 - (i % 8));
+			if ((inputBuffer[i / 8] & mask) > 0) {
+				outputBuffer[j / 8] |= 1 << (j % 8);
+			}
+			else {
+				outputBuffer[j / 8] &= ~(1 << (j % 8));
+			}
+
+			j++;
+		}
+	}
+
+	outputBufferLen = (j / 8) + 1;
+}
+
+/**
+ * The original encoder, bit by bit.
+ */
+static void referenceEncode(const uint8_t *inputBuffer, size_t inputBufferLen, uint8_t *outputBuffer, size_t& outputBufferLen) {
+
+	int j = 0;
+	for (int i=0 ; i < (int) (inputBufferLen * 8) ; i++) {
+
+		if (j % 10 == 0) {
+			outputBuffer[j / 8] &= ~(1 << (7 - (j % 8)));
+			j++;
+		}
+
+		if ((inputBuffer[i / 8] & (1 << (i % 8))) > 0) {
+			outputBuffer[j / 8] |= 1 << (7 - (j % 8));
+		} else {
+			outputBuffer[j / 8] &= ~(1 << (7 - (j % 8)));
+		}
+
+		j++;
+
+		if ((j - 9) % 10 == 0) {
+			outputBuffer[j / 8] |= 1 << (7 - (j % 8));
+			j++;
+		}
+	}
+
+	outputBufferLen = (j / 8) + 1;
+}
+
+typedef void (*Codec)(const uint8_t*, size_t, uint8_t*, size_t&);
+
+static SerialBitstream bitstream;
+
+static void decode(const uint8_t* in, size_t len, uint8_t* out, size_t& outLen) {
+	bitstream.decode(in, len, out, outLen);
+}
+
+static void encode(const uint8_t* in, size_t len, uint8_t* out, size_t& outLen) {
+	bitstream.encode(in, len, out, outLen);
+}
+
+/**
+ * Runs the codec ITERATIONS times and prints the result.
+ */
+static void run(const char* name, Codec codec, const uint8_t* in, size_t len, int payloadBytes, size_t bitstreamBytes) {
+
+	uint8_t out[512];
+	size_t outLen;
+
+	uint64_t start = nanos();
+	for (int i=0 ; i<ITERATIONS ; i++) {
+		codec(in, len, out, outLen);
+
+		// Keep the compiler from dropping the loop
+		__asm__ __volatile__("" : : "r"(out) : "memory");
+	}
+	uint64_t elapsed = nanos() - start;
+
+	printf("%s %d %.1f %.0f\n", name, payloadBytes,
+			(double) elapsed / ITERATIONS, (double) bitstreamBytes * ITERATIONS * 1e9 / elapsed);
+}
+
+int main(int argc, char** argv) {
+
+	uint8_t payload[256];
+	uint8_t encoded[512];
+	uint8_t reference[512];
+	uint8_t decoded[512];
+	size_t encodedLen, referenceLen, decodedLen;
+
+	for (size_t s=0 ; s<sizeof(PAYLOAD_SIZES)/sizeof(PAYLOAD_SIZES[0]) ; s++) {
+		int len = PAYLOAD_SIZES[s];
+		for (int i=0 ; i<len ; i++) {
+			payload[i] = rand();
+		}
+
+		// Check both implementations against each other
+		memset(reference, 0xFF, sizeof(reference));
+		referenceEncode(payload, len, reference, referenceLen);
+		bitstream.encode(payload, len, encoded, encodedLen);
+		if (encodedLen != (size_t) (len * 10 + 7) / 8 || memcmp(encoded, reference, encodedLen) != 0) {
+			fprintf(stderr, "Encoded bitstream differs from reference for %d bytes\n", len);
+			return 1;
+		}
+
+		referenceDecode(encoded, encodedLen, reference, referenceLen);
+		int errors = bitstream.decode(encoded, encodedLen, decoded, decodedLen);
+		if (decodedLen != (size_t) len || errors != 0
+				|| memcmp(decoded, payload, len) != 0 || memcmp(reference, payload, len) != 0) {
+			fprintf(stderr, "Decoded bytes differ from reference for %d bytes\n", len);
+			return 1;
+		}
+
+		run("bitstream-decode-reference", referenceDecode, encoded, encodedLen, len, encodedLen);
+		run("bitstream-decode", decode, encoded, encodedLen, len, encodedLen);
+		run("bitstream-encode-reference", referenceEncode, payload, len, len, encodedLen);
+		run("bitstream-encode", encode, payload, len, len, encodedLen);
+	}
+
+	return 0;
+}
@@ -0,0 +1,193 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Measures how fast the CRC-16 variants and the PN9 whitening are, compared
+ * to straightforward implementations (bit by bit, byte by byte). Checks the
+ * results against each other and the CRC check values first.
+ *
+ * Compile and run (from the bench directory):
+ * g++ -O2 -I../src CrcBenchmark.cpp ../src/Crc16.cpp ../src/Pn9Whitening.cpp -o CrcBenchmark
+ * ./CrcBenchmark
+ *
+ * Prints one line per implementation and payload size:
+ * <implementation> <payload bytes> <ns/op> <bytes/s>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "Crc16.hpp"
+#include "Pn9Whitening.hpp"
+
+static const int ITERATIONS = 200000;
+static const int PAYLOAD_SIZES[] = { 8, 60, 184, 255 };
+
+static uint64_t nanos() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static uint16_t polynomial;
+
+/**
+ * CRC-16 bit by bit, as in the CC1101 documentation.
+ */
+static uint16_t referenceCrc(const uint8_t *buffer, size_t len) {
+
+	uint16_t crc = 0xFFFF;
+
+	for (size_t i=0 ; i<len ; i++) {
+		crc ^= buffer[i] << 8;
+		for (int bit=0 ; bit<8 ; bit++) {
+			crc = (crc & 0x8000) ? (crc << 1) ^ polynomial : crc << 1;
+		}
+	}
+
+	return crc;
+}
+
+/**
+ * PN9 whitening bit by bit, generating the sequence while going.
+ */
+static void referenceWhitening(uint8_t *buffer, size_t len) {
+
+	uint16_t state = 0x1FF;
+
+	for (size_t i=0 ; i<len ; i++) {
+		buffer[i] ^= state & 0xFF;
+
+		for (int bit=0 ; bit<8 ; bit++) {
+			uint16_t feedback = (state ^ (state >> 5)) & 0x01;
+			state = (state >> 1) | (feedback << 8);
+		}
+	}
+}
+
+/**
+ * Runs one of the implementations ITERATIONS times and prints the result.
+ * 0 to 2: CRC bit by bit, byte by byte, slice-by-8. 3, 4: whitening bit by
+ * bit, with the sequence calculated before.
+ */
+static void run(const char* name, int implementation, Crc16& crc, Pn9Whitening& whitening, uint8_t* payload, int len) {
+
+	uint16_t result = 0;
+
+	uint64_t start = nanos();
+	for (int i=0 ; i<ITERATIONS ; i++) {
+		switch (implementation) {
+		case 0:
+			result ^= referenceCrc(payload, len);
+			break;
+		case 1:
+			result ^= crc.updateBytewise(0xFFFF, payload, len);
+			break;
+		case 2:
+			result ^= crc.update(0xFFFF, payload, len);
+			break;
+		case 3:
+			referenceWhitening(payload, len);
+			break;
+		case 4:
+			whitening.apply(payload, len);
+			break;
+		}
+
+		// Keep the compiler from dropping the loop
+		__asm__ __volatile__("" : : "r"(payload), "r"(result) : "memory");
+	}
+	uint64_t elapsed = nanos() - start;
+
+	printf("%s %d %.1f %.0f\n", name, len,
+			(double) elapsed / ITERATIONS, (double) len * ITERATIONS * 1e9 / elapsed);
+}
+
+int main(int argc, char** argv) {
+
+	const uint8_t* check = (const uint8_t*) "123456789";
+
+	Crc16 ibm(Crc16::POLYNOMIAL_IBM, 0);
+	Crc16 ccitt(Crc16::POLYNOMIAL_CCITT, 0);
+	Pn9Whitening whitening;
+
+	// Check values of CRC-16/CMS and CRC-16/CCITT-FALSE
+	if (ibm.update(0xFFFF, check, 9) != 0xAEE7 || ccitt.update(0xFFFF, check, 9) != 0x29B1) {
+		fprintf(stderr, "Wrong CRC check value\n");
+		return 1;
+	}
+
+	// The first bytes of the sequence, see TI Design Note DN509
+	uint8_t zeros[8] = { 0 };
+	const uint8_t pn9[8] = { 0xFF, 0xE1, 0x1D, 0x9A, 0xED, 0x85, 0x33, 0x24 };
+	whitening.apply(zeros, sizeof(zeros));
+	if (memcmp(zeros, pn9, sizeof(pn9)) != 0) {
+		fprintf(stderr, "Wrong PN9 sequence\n");
+		return 1;
+	}
+
+	uint8_t payload[1024];
+	uint8_t reference[1024];
+
+	for (int i=0 ; i<1024 ; i++) {
+		payload[i] = rand();
+	}
+
+	// All implementations agree, also beyond the length of the PN9 sequence
+	for (int len=0 ; len<=1024 ; len++) {
+		polynomial = Crc16::POLYNOMIAL_IBM;
+		uint16_t referenceIbm = referenceCrc(payload, len);
+		polynomial = Crc16::POLYNOMIAL_CCITT;
+		uint16_t referenceCcitt = referenceCrc(payload, len);
+
+		if (ibm.update(0xFFFF, payload, len) != referenceIbm || ibm.updateBytewise(0xFFFF, payload, len) != referenceIbm
+				|| ccitt.update(0xFFFF, payload, len) != referenceCcitt) {
+			fprintf(stderr, "CRC differs from reference for %d bytes\n", len);
+			return 1;
+		}
+
+		memcpy(reference, payload, len);
+		referenceWhitening(reference, len);
+		whitening.apply(reference, len);
+		if (memcmp(reference, payload, len) != 0) {
+			fprintf(stderr, "Whitening differs from reference for %d bytes\n", len);
+			return 1;
+		}
+	}
+
+	for (size_t s=0 ; s<sizeof(PAYLOAD_SIZES)/sizeof(PAYLOAD_SIZES[0]) ; s++) {
+		int len = PAYLOAD_SIZES[s];
+
+		polynomial = Crc16::POLYNOMIAL_IBM;
+		run("crc-ibm-reference", 0, ibm, whitening, payload, len);
+		run("crc-ibm-bytewise", 1, ibm, whitening, payload, len);
+		run("crc-ibm", 2, ibm, whitening, payload, len);
+		polynomial = Crc16::POLYNOMIAL_CCITT;
+		run("crc-ccitt-reference", 0, ccitt, whitening, payload, len);
+		run("crc-ccitt-bytewise", 1, ccitt, whitening, payload, len);
+		run("crc-ccitt", 2, ccitt, whitening, payload, len);
+		run("pn9-reference", 3, ibm, whitening, payload, len);
+		run("pn9", 4, ibm, whitening, payload, len);
+	}
+
+	return 0;
+}
@@ -0,0 +1,114 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Measures how long it takes to render a data frame in each output format.
+ *
+ * Compile and run (from the bench directory):
+ * g++ -O2 -I../src FormatBenchmark.cpp ../src/LegacyOutputFormat.cpp ../src/CsvOutputFormat.cpp \
+ *     ../src/JsonOutputFormat.cpp ../src/CborOutputFormat.cpp ../src/FrameFields.cpp \
+ *     ../src/OutputEncoding.cpp -o FormatBenchmark
+ * ./FormatBenchmark
+ *
+ * Prints one line per format and payload size:
+ * <output format> <payload bytes> <ns/op> <output bytes/s>
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "LegacyOutputFormat.hpp"
+#include "CsvOutputFormat.hpp"
+#include "JsonOutputFormat.hpp"
+#include "CborOutputFormat.hpp"
+
+static const int ITERATIONS = 200000;
+static const int PAYLOAD_SIZES[] = { 8, 60, 184, 255 };
+
+static uint64_t nanos() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * Renders the record ITERATIONS times and prints the result.
+ */
+static void run(IOutputFormat* format, const FrameRecord& record) {
+
+	char line[IOutputFormat::MAX_LINE_BYTES];
+	size_t total = 0;
+
+	uint64_t start = nanos();
+	for (int i=0 ; i<ITERATIONS ; i++) {
+		total += format->format(record, line, sizeof(line));
+
+		// Keep the compiler from dropping the loop
+		__asm__ __volatile__("" : : "r"(line) : "memory");
+	}
+	uint64_t elapsed = nanos() - start;
+
+	printf("%s %d %.1f %.0f\n", format->getName(), record.len,
+			(double) elapsed / ITERATIONS, total * 1e9 / elapsed);
+}
+
+int main(int argc, char** argv) {
+
+	LegacyOutputFormat payloadFormat(LegacyOutputFormat::STYLE_PAYLOAD);
+	LegacyOutputFormat addressFormat(LegacyOutputFormat::STYLE_ADDRESS);
+	LegacyOutputFormat binaryFormat(LegacyOutputFormat::STYLE_BINARY);
+	LegacyOutputFormat decimalFormat(LegacyOutputFormat::STYLE_DECIMAL);
+	LegacyOutputFormat hexFormat(LegacyOutputFormat::STYLE_HEX);
+	LegacyOutputFormat rawFormat(LegacyOutputFormat::STYLE_RAW);
+	LegacyOutputFormat radiatorFormat(LegacyOutputFormat::STYLE_RADIATOR);
+	CsvOutputFormat csvFormat;
+	JsonOutputFormat jsonFormat;
+	CborOutputFormat cborFormat;
+
+	IOutputFormat* formats[] = {
+		&payloadFormat, &addressFormat, &binaryFormat, &decimalFormat, &hexFormat,
+		&rawFormat, &radiatorFormat, &csvFormat, &jsonFormat, &cborFormat
+	};
+
+	FrameRecord record;
+	memset(&record, 0, sizeof(record));
+	record.sequence = 123456;
+	record.frameType = FRAME_TYPE_RFBEE;
+	record.flags = FRAME_FLAG_ADDRESS | FRAME_FLAG_RSSI_LQI | FRAME_FLAG_CRC_OK;
+	record.srcAddress = 0x0A;
+	record.destAddress = 0x01;
+	record.rssi = 0xE4;
+	record.lqi = 0x2D;
+	record.timestamp = 1380000000123456789ULL;
+
+	for (size_t s=0 ; s<sizeof(PAYLOAD_SIZES)/sizeof(PAYLOAD_SIZES[0]) ; s++) {
+		record.len = PAYLOAD_SIZES[s];
+		for (int i=0 ; i<record.len ; i++) {
+			record.payload[i] = i * 7 + 1;
+		}
+
+		for (size_t f=0 ; f<sizeof(formats)/sizeof(formats[0]) ; f++) {
+			run(formats[f], record);
+		}
+	}
+
+	return 0;
+}
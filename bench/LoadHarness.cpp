@@ -0,0 +1,667 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Load test of the whole driver: Device, VariableLengthModeProtocol,
+ * RFBeeDataFrame and SocketServer, set up as by Main with the rfbee
+ * profile, receive data frames from a SimulatedRadio instead of the RF
+ * module. Simulated clients connect to the socket server and read the data
+ * frames in csv format, each at its own speed.
+ *
+ * The driver runs in a child process, so it runs the same code as in
+ * production, including SocketServer::run(), which never returns.
+ *
+ * Answers questions like "how many data frames per second does the driver
+ * receive before the RX FIFO overflows or the clients fall behind".
+ *
+ * Compile and run (from the bench directory):
+ * g++ -O2 -I../src LoadHarness.cpp $(ls ../src/[A-Z]*.cpp | grep -v Main.cpp) -lrt -lpthread -o LoadHarness
+ * ./LoadHarness -r 20 -s 12:253 -b 10:1000 -c 2 -k 0,2000
+ *
+ * Prints one line per result: <name> <value>
+ * Data frames are lost
+ * - drop-missed: because the radio wasn't in RX state when they were sent,
+ * - drop-overflow: because the driver didn't empty the RX FIFO fast enough,
+ * - drop-flushed: because the driver flushed the RX FIFO before reading them,
+ * - drop-daemon: after reading them from the RX FIFO, e.g. no free frame slot,
+ * - clientN-drop-tcp: because client N was too slow.
+ * The latency is the time from the last byte on air until the client read
+ * the data frame from the socket. The driver-<stage> lines tell where the
+ * time went inside the driver (see ReceiveLatency and the "HI" command).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <sys/prctl.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "DateTime.hpp"
+#include "Log.hpp"
+#include "SimulatedRadio.hpp"
+#include "SimulatedGpio.hpp"
+#include "Device.hpp"
+#include "VariableLengthModeProtocol.hpp"
+#include "RawCapture.hpp"
+#include "CapturingProtocol.hpp"
+#include "FrameStore.hpp"
+#include "QueryCommand.hpp"
+#include "LatestValueCache.hpp"
+#include "LatestValueCommand.hpp"
+#include "LinkQualityTracker.hpp"
+#include "LinkQualityCommand.hpp"
+#include "RFBeeDataFrame.hpp"
+#include "RegConfigurationProfile0_27MHz.hpp"
+#include "RadioProfile.hpp"
+#include "FramePool.hpp"
+#include "TransmitQueue.hpp"
+#include "SocketServer.hpp"
+#include "CommandDispatcher.hpp"
+#include "OutputFormatCommand.hpp"
+#include "FilterCommand.hpp"
+#include "LatencyCommand.hpp"
+#include "ReceiveLatency.hpp"
+#include "OutputFormatRegistry.hpp"
+#include "LegacyOutputFormat.hpp"
+#include "CsvOutputFormat.hpp"
+#include "JsonOutputFormat.hpp"
+#include "CborOutputFormat.hpp"
+
+static const int DEFAULT_PORT = 50100;
+static const int MAX_CLIENTS = 8;
+
+/** Time for the driver to start and the clients to connect */
+static const int STARTUP_MILLIS = 1000;
+
+/** Time for the last data frames to reach the clients */
+static const int DRAIN_MILLIS = 2000;
+
+/** Receive buffer of clients with limited speed, so they fall behind soon */
+static const int SLOW_CLIENT_RCVBUF = 4096;
+
+struct Client {
+	int fd;
+
+	/** Bytes per second read from the socket, 0 for no limit */
+	double speed;
+	uint64_t bytesRead;
+
+	char line[2048];
+	size_t lineLength;
+
+	uint64_t received;
+	uint64_t dropped;
+	uint32_t lastSequence;
+
+	/** Latency of each data frame received, ns */
+	uint64_t* latencies;
+};
+
+static void usage(const char* program) {
+	fprintf(stderr, "Usage: %s [-r rate] [-s size[:max]] [-b burst[:pause]] [-t seconds] [-B baud]\n"
+			"          [-c clients] [-k speed[,speed...]] [-p port] [-C prefix] [-S directory] [-v]\n", program);
+	fprintf(stderr, "  -r rate        Data frames per second within a burst (default 10)\n");
+	fprintf(stderr, "  -s size[:max]  Payload size, or range of sizes (default 60, %d to %d)\n",
+			(int) SimulatedRadio::MIN_PAYLOAD_BYTES, (int) SimulatedRadio::MAX_PAYLOAD_BYTES);
+	fprintf(stderr, "  -b burst[:pause] Data frames per burst and milliseconds between bursts (default 1:0)\n");
+	fprintf(stderr, "  -t seconds     Time to send data frames (default 10)\n");
+	fprintf(stderr, "  -B baud        Data rate of the radio (default 38400)\n");
+	fprintf(stderr, "  -c clients     Number of clients (default 1, up to %d)\n", MAX_CLIENTS);
+	fprintf(stderr, "  -k speed,...   Bytes per second each client reads, 0 for no limit (default 0).\n");
+	fprintf(stderr, "                 The last speed applies to the remaining clients.\n");
+	fprintf(stderr, "  -p port        TCP port of the driver (default %d)\n", DEFAULT_PORT);
+	fprintf(stderr, "  -C prefix      Capture the bytes received, as with the -C option of the driver\n");
+	fprintf(stderr, "  -S directory   Keep the data frames for queries, as with the -S option of the driver\n");
+	fprintf(stderr, "  -v             Show the output of the driver on stderr\n");
+}
+
+/**
+ * Sets up the driver like Main does, with the simulated radio, and runs it.
+ * Never returns.
+ */
+static void runDriver(SimulatedRadio* radio, int port, const char* capturePrefix, const char* storeDirectory,
+		bool verbose) {
+
+	// Exit together with the load test
+	prctl(PR_SET_PDEATHSIG, SIGTERM);
+
+	// Keep the results on stdout apart from the output of the driver
+	if (verbose) {
+		dup2(2, 1);
+	} else {
+		int devNull = open("/dev/null", O_WRONLY);
+		dup2(devNull, 1);
+		close(devNull);
+	}
+
+	signal(SIGPIPE, SIG_IGN);
+
+	Log::setLevel(LOG_LEVEL_INFO);
+	Log::start();
+
+	ReceiveLatency::dumpOnSignal(SIGUSR1);
+
+	SimulatedGpio gpio(radio);
+
+	VariableLengthModeProtocol variableLengthModeProtocol(radio);
+	Protocol* protocol = &variableLengthModeProtocol;
+
+	RawCapture* rawCapture = NULL;
+	if (capturePrefix != NULL) {
+		rawCapture = new RawCapture(capturePrefix, RawCapture::DEFAULT_SEGMENT_BYTES, 0);
+		protocol = new CapturingProtocol(protocol, rawCapture);
+	}
+
+	RFBeeDataFrame rfBeeDataFrame(protocol);
+
+	RegConfigurationProfile0_27MHz profile0_27MHz;
+	RadioProfile rfBeeProfile("rfbee", &profile0_27MHz, &rfBeeDataFrame);
+
+	// The frame store keeps slots while its background thread writes them
+	FramePool framePool(FramePool::DEFAULT_SLOT_COUNT + (storeDirectory != NULL ? FrameStore::RING_ENTRIES : 0));
+	Device device(radio, &gpio, &framePool);
+	device.reset();
+	device.addProfile(&rfBeeProfile);
+	device.selectProfile("rfbee");
+
+	TransmitQueue transmitQueue(TransmitQueue::DEFAULT_DEPTH);
+	device.setTransmitQueue(&transmitQueue);
+
+	if (rawCapture != NULL) {
+		rawCapture->start(&device);
+	}
+
+	LegacyOutputFormat payloadFormat(LegacyOutputFormat::STYLE_PAYLOAD);
+	LegacyOutputFormat addressFormat(LegacyOutputFormat::STYLE_ADDRESS);
+	LegacyOutputFormat binaryFormat(LegacyOutputFormat::STYLE_BINARY);
+	LegacyOutputFormat decimalFormat(LegacyOutputFormat::STYLE_DECIMAL);
+	LegacyOutputFormat hexFormat(LegacyOutputFormat::STYLE_HEX);
+	LegacyOutputFormat rawFormat(LegacyOutputFormat::STYLE_RAW);
+	LegacyOutputFormat radiatorFormat(LegacyOutputFormat::STYLE_RADIATOR);
+	CsvOutputFormat csvFormat;
+	JsonOutputFormat jsonFormat;
+	CborOutputFormat cborFormat;
+
+	OutputFormatRegistry formats;
+	formats.add(&payloadFormat);
+	formats.add(&addressFormat);
+	formats.add(&binaryFormat);
+	formats.add(&decimalFormat);
+	formats.add(&hexFormat);
+	formats.add(&rawFormat);
+	formats.add(&radiatorFormat);
+	formats.add(&csvFormat);
+	formats.add(&jsonFormat);
+	formats.add(&cborFormat);
+
+	CommandDispatcher dispatcher;
+	OutputFormatCommand outputFormatCommand(&formats);
+	FilterCommand filterCommand;
+	dispatcher.addCommand(&outputFormatCommand);
+	dispatcher.addCommand(&filterCommand);
+
+	LatencyCommand latencyCommand;
+	dispatcher.addCommand(&latencyCommand);
+
+	LatestValueCache latestValueCache;
+	device.addSink(&latestValueCache);
+	LatestValueCommand latestValueCommand(&latestValueCache);
+	dispatcher.addCommand(&latestValueCommand);
+
+	LinkQualityTracker linkQualityTracker;
+	device.addSink(&linkQualityTracker);
+	LinkQualityCommand linkQualityCommand(&linkQualityTracker);
+	dispatcher.addCommand(&linkQualityCommand);
+
+	if (storeDirectory != NULL) {
+		FrameStore* frameStore = new FrameStore(storeDirectory, FrameStore::DEFAULT_SYNC_MILLIS,
+				FrameStore::DEFAULT_SEGMENT_BYTES, 0);
+		frameStore->open();
+		device.addSink(frameStore);
+		dispatcher.addCommand(new QueryCommand(frameStore));
+	}
+
+	SocketServer serverSocket(&device, &dispatcher, &formats);
+	serverSocket.open(port);
+	serverSocket.run();
+
+	exit(0);
+}
+
+/**
+ * Connects to the driver, which may still be starting.
+ * Returns the socket or -1 if the driver did not start.
+ */
+static int connectClient(int port, double speed, uint64_t deadline) {
+
+	struct sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	addr.sin_port = htons(port);
+
+	while (DateTime::nanos(CLOCK_MONOTONIC) < deadline) {
+		int fd = socket(AF_INET, SOCK_STREAM, 0);
+		if (fd < 0) {
+			perror("Opening client socket");
+			exit(1);
+		}
+
+		if (speed > 0) {
+			int size = SLOW_CLIENT_RCVBUF;
+			setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+		}
+
+		if (connect(fd, (struct sockaddr*) &addr, sizeof(addr)) == 0) {
+			return fd;
+		}
+
+		close(fd);
+		usleep(10000);
+	}
+
+	return -1;
+}
+
+/**
+ * Evaluates a line read by a client. Lines other than data frames (e.g.
+ * responses to commands) are ignored.
+ */
+static void receiveLine(Client* client, const char* line, uint64_t now) {
+
+	// seq,ts,type,src,dst,rssi,lqi,crc,payload
+	if (line[0] < '0' || line[0] > '9') {
+		return;
+	}
+
+	uint32_t sequence = strtoul(line, NULL, 10);
+
+	const char* payload = line;
+	for (int i=0 ; i<8 && payload != NULL ; i++) {
+		payload = strchr(payload, ',');
+		if (payload != NULL) {
+			payload++;
+		}
+	}
+
+	if (payload == NULL || strlen(payload) < 2 * SimulatedRadio::MIN_PAYLOAD_BYTES) {
+		return;
+	}
+
+	// Payload byte 4-11: Time the last byte arrived
+	char hex[17];
+	memcpy(hex, payload + 8, 16);
+	hex[16] = '\0';
+	uint64_t airEnd = strtoull(hex, NULL, 16);
+
+	client->latencies[client->received++] = now > airEnd ? now - airEnd : 0;
+	client->dropped += sequence - client->lastSequence - 1;
+	client->lastSequence = sequence;
+}
+
+/**
+ * Reads what the speed of the client allows.
+ */
+static void readClient(Client* client, uint64_t now) {
+
+	char buf[4096];
+	size_t len = sizeof(buf);
+
+	if (client->speed > 0) {
+		double allowed = client->speed * now / 1e9 - client->bytesRead;
+		if (allowed < len) {
+			len = allowed;
+		}
+	}
+
+	ssize_t rc = read(client->fd, buf, len);
+	if (rc < 0 && (errno == EAGAIN || errno == EINTR)) {
+		return;
+	}
+
+	if (rc <= 0) {
+		fprintf(stderr, "Driver closed the connection\n");
+		exit(1);
+	}
+
+	client->bytesRead += rc;
+
+	for (ssize_t i=0 ; i<rc ; i++) {
+		if (buf[i] == '\n') {
+			client->line[client->lineLength] = '\0';
+			receiveLine(client, client->line, DateTime::nanos(CLOCK_MONOTONIC));
+			client->lineLength = 0;
+		} else if (client->lineLength < sizeof(client->line) - 1) {
+			client->line[client->lineLength++] = buf[i];
+		}
+	}
+}
+
+/**
+ * Asks the driver where the time went between the GDO2 pin and the socket
+ * ("HI" command) on a connection of its own, so the clients measured are
+ * not disturbed. Returns the response lines up to "OK HI".
+ */
+static void queryLatency(int port, char* response, size_t maxBytes) {
+
+	size_t len = 0;
+	response[0] = '\0';
+
+	int fd = connectClient(port, 0, DateTime::nanos(CLOCK_MONOTONIC) + DRAIN_MILLIS * 1000000ULL);
+	if (fd < 0) {
+		return;
+	}
+
+	const char* command = "HI\n";
+	if (write(fd, command, strlen(command)) < 0) {
+		perror("Writing command");
+		exit(1);
+	}
+
+	uint64_t deadline = DateTime::nanos(CLOCK_MONOTONIC) + DRAIN_MILLIS * 1000000ULL;
+	while (strstr(response, "OK HI\n") == NULL && DateTime::nanos(CLOCK_MONOTONIC) < deadline) {
+		struct pollfd pl[1];
+		pl[0].fd = fd;
+		pl[0].events = POLLIN;
+
+		if (poll(pl, 1, 10) <= 0) {
+			continue;
+		}
+
+		ssize_t rc = read(fd, response + len, maxBytes - len - 1);
+		if (rc <= 0) {
+			break;
+		}
+
+		len += rc;
+		response[len] = '\0';
+	}
+
+	close(fd);
+}
+
+/**
+ * Reports the latency histograms of the driver, lines
+ * "HI <stage> <count> <min> <p50> <p90> <p99> <p999> <max>" in ns.
+ */
+static void reportLatency(const char* response) {
+
+	const char* line = response;
+	while ((line = strstr(line, "HI ")) != NULL) {
+		char stage[16];
+		unsigned long long count, min, p50, p90, p99, p999, max;
+
+		if (sscanf(line, "HI %15s %llu %llu %llu %llu %llu %llu %llu",
+				stage, &count, &min, &p50, &p90, &p99, &p999, &max) == 8) {
+			printf("driver-%s-count %llu\n", stage, count);
+			printf("driver-%s-p50-us %.1f\n", stage, p50 / 1000.0);
+			printf("driver-%s-p99-us %.1f\n", stage, p99 / 1000.0);
+			printf("driver-%s-p999-us %.1f\n", stage, p999 / 1000.0);
+			printf("driver-%s-max-us %.1f\n", stage, max / 1000.0);
+		}
+
+		line += 3;
+	}
+}
+
+static int compareLatency(const void* a, const void* b) {
+	uint64_t x = *(const uint64_t*) a;
+	uint64_t y = *(const uint64_t*) b;
+	return x < y ? -1 : x > y;
+}
+
+/**
+ * Latency at the percentile of the sorted latencies, in microseconds.
+ */
+static double percentile(const uint64_t* latencies, uint64_t n, double p) {
+	if (n == 0) {
+		return 0;
+	}
+
+	uint64_t index = p * n;
+	return latencies[index < n ? index : n - 1] / 1000.0;
+}
+
+int main(int argc, char** argv) {
+
+	double rate = 10;
+	size_t minPayload = 60;
+	size_t maxPayload = 60;
+	int burst = 1;
+	int pauseMillis = 0;
+	int seconds = 10;
+	uint32_t baud = 38400;
+	int nclients = 1;
+	double speeds[MAX_CLIENTS] = { 0 };
+	int nspeeds = 1;
+	int port = DEFAULT_PORT;
+	const char* capturePrefix = NULL;
+	const char* storeDirectory = NULL;
+	bool verbose = false;
+
+	int opt;
+	while ((opt = getopt(argc, argv, "r:s:b:t:B:c:k:p:C:S:v")) != -1) {
+		switch (opt) {
+		case 'r':
+			rate = atof(optarg);
+			break;
+		case 's': {
+			minPayload = maxPayload = atoi(optarg);
+			char* colon = strchr(optarg, ':');
+			if (colon != NULL) {
+				maxPayload = atoi(colon + 1);
+			}
+			break;
+		}
+		case 'b': {
+			burst = atoi(optarg);
+			char* colon = strchr(optarg, ':');
+			pauseMillis = colon != NULL ? atoi(colon + 1) : 0;
+			break;
+		}
+		case 't':
+			seconds = atoi(optarg);
+			break;
+		case 'B':
+			baud = atoi(optarg);
+			break;
+		case 'c':
+			nclients = atoi(optarg);
+			break;
+		case 'k': {
+			nspeeds = 0;
+			for (char* p = strtok(optarg, ",") ; p != NULL && nspeeds < MAX_CLIENTS ; p = strtok(NULL, ",")) {
+				speeds[nspeeds++] = atof(p);
+			}
+			break;
+		}
+		case 'p':
+			port = atoi(optarg);
+			break;
+		case 'C':
+			capturePrefix = optarg;
+			break;
+		case 'S':
+			storeDirectory = optarg;
+			break;
+		case 'v':
+			verbose = true;
+			break;
+		default:
+			usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (rate <= 0 || minPayload < SimulatedRadio::MIN_PAYLOAD_BYTES || maxPayload < minPayload
+			|| maxPayload > SimulatedRadio::MAX_PAYLOAD_BYTES || burst < 1 || pauseMillis < 0
+			|| seconds <= 0 || baud < 1200 || nclients < 1 || nclients > MAX_CLIENTS
+			|| nspeeds == 0 || port <= 0) {
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	// Written by the driver process, read when it has finished
+	SimulatedRadioStatistics* statistics = (SimulatedRadioStatistics*) mmap(NULL, sizeof(SimulatedRadioStatistics),
+			PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if (statistics == MAP_FAILED) {
+		perror("Mapping statistics");
+		exit(1);
+	}
+
+	uint64_t start = DateTime::nanos(CLOCK_MONOTONIC) + STARTUP_MILLIS * 1000000ULL;
+	uint64_t end = start + seconds * 1000000000ULL;
+
+	SimulatedRadio radio(baud, statistics);
+	radio.setTraffic(rate, minPayload, maxPayload, burst, pauseMillis);
+	radio.start(start, end);
+
+	fflush(stdout);
+	pid_t pid = fork();
+	if (pid < 0) {
+		perror("Starting driver");
+		exit(1);
+	}
+
+	if (pid == 0) {
+		runDriver(&radio, port, capturePrefix, storeDirectory, verbose);
+	}
+
+	// Data frames are sent no faster than the rate
+	uint64_t maxFrames = (uint64_t) (seconds * rate) + 1;
+
+	Client clients[MAX_CLIENTS];
+	for (int i=0 ; i<nclients ; i++) {
+		Client* client = &clients[i];
+		memset(client, 0, sizeof(*client));
+		client->speed = speeds[i < nspeeds ? i : nspeeds - 1];
+		client->latencies = (uint64_t*) malloc(maxFrames * sizeof(uint64_t));
+
+		client->fd = connectClient(port, client->speed, start);
+		if (client->fd < 0) {
+			fprintf(stderr, "Driver did not start\n");
+			kill(pid, SIGTERM);
+			exit(1);
+		}
+
+		const char* command = "OF csv\n";
+		if (write(client->fd, command, strlen(command)) < 0) {
+			perror("Writing command");
+			exit(1);
+		}
+	}
+
+	uint64_t connected = DateTime::nanos(CLOCK_MONOTONIC);
+	uint64_t stop = end + DRAIN_MILLIS * 1000000ULL;
+
+	struct pollfd fds[MAX_CLIENTS];
+
+	uint64_t now;
+	while ((now = DateTime::nanos(CLOCK_MONOTONIC)) < stop) {
+		int nfds = 0;
+		int index[MAX_CLIENTS];
+
+		for (int i=0 ; i<nclients ; i++) {
+			Client* client = &clients[i];
+
+			// Clients that read enough for now wait for the next poll
+			if (client->speed > 0 && client->speed * (now - connected) / 1e9 < client->bytesRead + 1) {
+				continue;
+			}
+
+			fds[nfds].fd = client->fd;
+			fds[nfds].events = POLLIN;
+			index[nfds++] = i;
+		}
+
+		int rc = poll(fds, nfds, 1);
+		if (rc < 0 && errno != EINTR) {
+			perror("poll");
+			exit(1);
+		}
+
+		now = DateTime::nanos(CLOCK_MONOTONIC);
+		for (int i=0 ; i<nfds && rc > 0 ; i++) {
+			if (fds[i].revents != 0) {
+				readClient(&clients[index[i]], now - connected);
+			}
+		}
+	}
+
+	char latency[4096];
+	queryLatency(port, latency, sizeof(latency));
+
+	// Closing the connections first keeps the port of the driver out of
+	// TIME_WAIT, so the next run can start right away
+	for (int i=0 ; i<nclients ; i++) {
+		close(clients[i].fd);
+	}
+	usleep(100000);
+
+	kill(pid, SIGTERM);
+	waitpid(pid, NULL, 0);
+
+	// Data frames published after the last one a client read were dropped, too
+	uint32_t published = 0;
+	for (int i=0 ; i<nclients ; i++) {
+		if (clients[i].lastSequence > published) {
+			published = clients[i].lastSequence;
+		}
+	}
+
+	printf("injected %llu\n", (unsigned long long) statistics->injected);
+	printf("delivered %llu\n", (unsigned long long) statistics->delivered);
+	printf("published %u\n", published);
+	printf("drop-missed %llu\n", (unsigned long long) statistics->missed);
+	printf("drop-overflow %llu\n", (unsigned long long) statistics->overflows);
+	printf("drop-flushed %llu\n", (unsigned long long) statistics->flushed);
+	printf("drop-daemon %llu\n", (unsigned long long) (statistics->delivered - published));
+
+	for (int i=0 ; i<nclients ; i++) {
+		Client* client = &clients[i];
+		client->dropped += published - client->lastSequence;
+
+		qsort(client->latencies, client->received, sizeof(uint64_t), compareLatency);
+
+		printf("client%d-speed %.0f\n", i, client->speed);
+		printf("client%d-received %llu\n", i, (unsigned long long) client->received);
+		printf("client%d-drop-tcp %llu\n", i, (unsigned long long) client->dropped);
+		printf("client%d-frames/s %.1f\n", i, (double) client->received / seconds);
+		printf("client%d-latency-p50-us %.0f\n", i, percentile(client->latencies, client->received, 0.5));
+		printf("client%d-latency-p99-us %.0f\n", i, percentile(client->latencies, client->received, 0.99));
+		printf("client%d-latency-p999-us %.0f\n", i, percentile(client->latencies, client->received, 0.999));
+		printf("client%d-latency-max-us %.0f\n", i, percentile(client->latencies, client->received, 1.0));
+
+		free(client->latencies);
+	}
+
+	reportLatency(latency);
+
+	return 0;
+}
@@ -0,0 +1,229 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Measures how fast Manchester decodes and encodes, compared to the
+ * original implementation with 4 lookups of 2 bits per decoded byte.
+ * Before measuring, checks that encoding and decoding round-trips, that
+ * the result matches the original implementation and that invalid
+ * symbols are reported at the right positions.
+ *
+ * Compile and run (from the bench directory):
+ * g++ -O2 -I../src ManchesterBenchmark.cpp ../src/Manchester.cpp -o ManchesterBenchmark
+ * ./ManchesterBenchmark
+ *
+ * Prints one line per implementation and payload size:
+ * <implementation> <payload bytes> <ns/op> <encoded bytes/s>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "Manchester.hpp"
+
+static const int ITERATIONS = 200000;
+static const int PAYLOAD_SIZES[] = { 8, 60, 184, 255 };
+
+static uint64_t nanos() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Tables of the original implementation
+static const uint8_t referenceEncodeTab[16] = {
+		0xAA, 0xA9, 0xA6, 0xA5, 0x9A, 0x99, 0x96, 0x95,
+		0x6A, 0x69, 0x66, 0x65, 0x5A, 0x59, 0x56, 0x55 };
+
+static const uint8_t referenceDecodeTab[16] = {
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x03, 0x02, 0xFF,
+		0xFF, 0x01, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+
+/**
+ * The original decoder, without the error message.
+ */
+static void referenceDecode(const uint8_t *inputBuffer, size_t inputBufferLen, uint8_t *outputBuffer, size_t& outputBufferLen) {
+
+	outputBufferLen = 0;
+
+	for (size_t i=0 ; i+1<inputBufferLen ; i+=2) {
+		uint8_t data3 = referenceDecodeTab[inputBuffer[i] >> 4];
+		uint8_t data2 = referenceDecodeTab[inputBuffer[i] & 0x0F];
+		uint8_t data1 = referenceDecodeTab[inputBuffer[i+1] >> 4];
+		uint8_t data0 = referenceDecodeTab[inputBuffer[i+1] & 0x0F];
+
+		if ((data3 == 0xFF) | (data2 == 0xFF) | (data1 == 0xFF) | (data0 == 0xFF)) {
+			return;
+		}
+
+		outputBuffer[i/2] = (data3 << 6) | (data2 << 4) | (data1 << 2) | data0;
+	}
+
+	outputBufferLen = inputBufferLen >> 1;
+}
+
+/**
+ * The original encoder as it was meant to be, with the nibble table.
+ */
+static void referenceEncode(const uint8_t *inputBuffer, size_t inputBufferLen, uint8_t *outputBuffer, size_t& outputBufferLen) {
+
+	for (size_t i=0 ; i<inputBufferLen ; i++) {
+		outputBuffer[i*2]     = referenceEncodeTab[inputBuffer[i] >> 4];
+		outputBuffer[i*2 + 1] = referenceEncodeTab[inputBuffer[i] & 0x0F];
+	}
+
+	outputBufferLen = inputBufferLen << 1;
+}
+
+typedef void (*Codec)(const uint8_t*, size_t, uint8_t*, size_t&);
+
+static Manchester manchester;
+
+static void decode(const uint8_t* in, size_t len, uint8_t* out, size_t& outLen) {
+	manchester.decode(in, len, out, outLen);
+}
+
+static void decodeWithErrors(const uint8_t* in, size_t len, uint8_t* out, size_t& outLen) {
+	uint16_t errorOffsets[8];
+	manchester.decode(in, len, out, outLen, errorOffsets, 8);
+}
+
+static void encode(const uint8_t* in, size_t len, uint8_t* out, size_t& outLen) {
+	manchester.encode(in, len, out, outLen);
+}
+
+/**
+ * Runs the codec ITERATIONS times and prints the result.
+ */
+static void run(const char* name, Codec codec, const uint8_t* in, size_t len, int payloadBytes) {
+
+	uint8_t out[512];
+	size_t outLen;
+
+	uint64_t start = nanos();
+	for (int i=0 ; i<ITERATIONS ; i++) {
+		codec(in, len, out, outLen);
+
+		// Keep the compiler from dropping the loop
+		__asm__ __volatile__("" : : "r"(out) : "memory");
+	}
+	uint64_t elapsed = nanos() - start;
+
+	printf("%s %d %.1f %.0f\n", name, payloadBytes,
+			(double) elapsed / ITERATIONS, (double) payloadBytes * 2 * ITERATIONS * 1e9 / elapsed);
+}
+
+/**
+ * Round trip and comparison with the original implementation.
+ * Returns 0 if all checks pass.
+ */
+static int check(const uint8_t* payload, int len) {
+
+	uint8_t encoded[512];
+	uint8_t reference[512];
+	uint8_t decoded[512];
+	size_t encodedLen, referenceLen, decodedLen;
+
+	manchester.encode(payload, len, encoded, encodedLen);
+	referenceEncode(payload, len, reference, referenceLen);
+	if (encodedLen != referenceLen || memcmp(encoded, reference, encodedLen) != 0) {
+		fprintf(stderr, "Encoded bytes differ from reference for %d bytes\n", len);
+		return -1;
+	}
+
+	if (manchester.decode(encoded, encodedLen, decoded, decodedLen) != len
+			|| memcmp(decoded, payload, len) != 0) {
+		fprintf(stderr, "Round trip failed for %d bytes\n", len);
+		return -1;
+	}
+
+	// Decoding in place
+	memcpy(decoded, encoded, encodedLen);
+	if (manchester.decode(decoded, encodedLen, decoded, decodedLen) != len
+			|| memcmp(decoded, payload, len) != 0) {
+		fprintf(stderr, "Round trip in place failed for %d bytes\n", len);
+		return -1;
+	}
+
+	// Invalid symbols: 00 at the first symbol, 11 at the last one
+	int last = len * 8 - 1;
+	encoded[0] &= 0x3F;
+	encoded[encodedLen - 1] |= 0x03;
+
+	if (manchester.decode(encoded, encodedLen, decoded, decodedLen) != -1 || decodedLen != 0) {
+		fprintf(stderr, "Invalid symbols not detected for %d bytes\n", len);
+		return -1;
+	}
+
+	referenceDecode(encoded, encodedLen, reference, referenceLen);
+	if (referenceLen != 0) {
+		fprintf(stderr, "Reference doesn't detect invalid symbols for %d bytes\n", len);
+		return -1;
+	}
+
+	uint16_t errorOffsets[4];
+	size_t nerrors = manchester.decode(encoded, encodedLen, decoded, decodedLen, errorOffsets, 4);
+	if (nerrors != 2 || errorOffsets[0] != 0 || errorOffsets[1] != last || decodedLen != (size_t) len
+			|| (decoded[0] & 0x80) != 0 || (decoded[len - 1] & 0x01) != 0
+			|| memcmp(decoded + 1, payload + 1, len - 2) != 0) {
+		fprintf(stderr, "Wrong error offsets for %d bytes\n", len);
+		return -1;
+	}
+
+	return 0;
+}
+
+int main(int argc, char** argv) {
+
+	uint8_t payload[256];
+	uint8_t encoded[512];
+	size_t encodedLen;
+
+	// Every byte value
+	for (int i=0 ; i<256 ; i++) {
+		payload[i] = i;
+	}
+	if (check(payload, 256) < 0) {
+		return 1;
+	}
+
+	for (size_t s=0 ; s<sizeof(PAYLOAD_SIZES)/sizeof(PAYLOAD_SIZES[0]) ; s++) {
+		int len = PAYLOAD_SIZES[s];
+		for (int i=0 ; i<len ; i++) {
+			payload[i] = rand();
+		}
+
+		if (check(payload, len) < 0) {
+			return 1;
+		}
+
+		manchester.encode(payload, len, encoded, encodedLen);
+
+		run("manchester-decode-reference", referenceDecode, encoded, encodedLen, len);
+		run("manchester-decode", decode, encoded, encodedLen, len);
+		run("manchester-decode-errors", decodeWithErrors, encoded, encodedLen, len);
+		run("manchester-encode-reference", referenceEncode, payload, len, len);
+		run("manchester-encode", encode, payload, len, len);
+	}
+
+	return 0;
+}
@@ -0,0 +1,285 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Compares the fused radiator controller decoder with the separate stages
+ * it replaces: First checks that both decode the same captures to the same
+ * data frames, then measures how long each takes.
+ *
+ * Compile and run (from the bench directory):
+ * g++ -O2 -I../src RadiatorBenchmark.cpp ../src/DecoderPipeline.cpp ../src/SerialBitstream.cpp \
+ *     ../src/Manchester.cpp ../src/SyncStage.cpp ../src/EndMarkerStage.cpp \
+ *     ../src/DuplicateFilterStage.cpp ../src/SerialManchesterStage.cpp ../src/PreambleSearchStage.cpp \
+ *     ../src/Crc16.cpp ../src/Pn9Whitening.cpp ../src/Log.cpp ../src/Metrics.cpp -lpthread -o RadiatorBenchmark
+ * ./RadiatorBenchmark [captures]
+ *
+ * The captures file is optional and contains RX FIFO contents recorded from
+ * real devices, one per line, in hex. Without it, captures are generated:
+ * valid data frames, data frames with bit errors and random noise.
+ *
+ * Prints one line per pipeline and payload size:
+ * <pipeline> <payload bytes> <ns/op> <bitstream bytes/s>
+ * The align lines measure the preamble search on noise, i.e. scanning
+ * the whole RX FIFO, with 0 to 2 bits of the preamble allowed to be wrong.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "DecoderPipeline.hpp"
+#include "SerialBitstream.hpp"
+#include "Manchester.hpp"
+
+static const int ITERATIONS = 200000;
+static const int GENERATED_CAPTURES = 100000;
+
+/** Bytes read from the RX FIFO in FIFO overflow mode */
+static const size_t FIFO_LENGTH = 64;
+
+/** The largest payload that fits into the RX FIFO */
+static const int PAYLOAD_SIZES[] = { 8, 23 };
+
+static const char* SEPARATE = "bitstream,sync=335553,end=35,manchester";
+static const char* FUSED = "fused=335553:35";
+
+static uint64_t nanos() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * Builds the RX FIFO contents of a data frame as sent by a radiator controller.
+ */
+static void capture(const uint8_t* payload, size_t len, uint8_t fifo[FIFO_LENGTH]) {
+
+	static SerialBitstream bitstream;
+	static Manchester manchester;
+
+	uint8_t characters[FIFO_LENGTH];
+	size_t n = 0;
+
+	characters[n++] = 0x33;
+	characters[n++] = 0x55;
+	characters[n++] = 0x53;
+	size_t manchesterLen;
+	manchester.encode(payload, len, characters + n, manchesterLen);
+	n += manchesterLen;
+	characters[n++] = 0x35;
+
+	// Noise after the end of the data frame
+	while (n < FIFO_LENGTH * 8 / 10) {
+		characters[n++] = rand();
+	}
+
+	size_t encodedLen;
+	uint8_t encoded[FIFO_LENGTH + 8];
+	bitstream.encode(characters, n, encoded, encodedLen);
+	memcpy(fifo, encoded, FIFO_LENGTH);
+}
+
+/**
+ * Decodes the capture with both pipelines.
+ * Returns 0 if they agree, -1 if not.
+ */
+static int compare(DecoderPipeline& separate, DecoderPipeline& fused, const uint8_t* fifo, size_t len, int& passed) {
+
+	uint8_t copy[FrameRecord::MAX_PAYLOAD_BYTES + 2];
+	FrameRecord separateRecord;
+	FrameRecord fusedRecord;
+
+	memcpy(copy, fifo, len);
+	DecoderBuffer buffer = { copy, len };
+	int separateRc = separate.run(buffer, separateRecord);
+
+	memcpy(copy, fifo, len);
+	buffer.data = copy;
+	buffer.len = len;
+	int fusedRc = fused.run(buffer, fusedRecord);
+
+	if (separateRc != fusedRc || (separateRc == 0 && (separateRecord.len != fusedRecord.len
+			|| memcmp(separateRecord.payload, fusedRecord.payload, separateRecord.len) != 0))) {
+		return -1;
+	}
+
+	if (separateRc == 0) {
+		passed++;
+	}
+
+	return 0;
+}
+
+/**
+ * Compares both pipelines on all captures. The decoders report rejected data
+ * frames on stdout, so stdout is discarded meanwhile.
+ * Returns the number of captures decoded differently.
+ */
+static int verify(DecoderPipeline& separate, DecoderPipeline& fused, const char* capturesFile) {
+
+	fflush(stdout);
+	int savedStdout = dup(1);
+	int devNull = open("/dev/null", O_WRONLY);
+	dup2(devNull, 1);
+
+	int ncaptures = 0;
+	int passed = 0;
+	int differences = 0;
+	uint8_t fifo[FrameRecord::MAX_PAYLOAD_BYTES];
+
+	if (capturesFile != NULL) {
+		FILE* file = fopen(capturesFile, "r");
+		if (file == NULL) {
+			perror(capturesFile);
+			exit(1);
+		}
+
+		char line[1024];
+		while (fgets(line, sizeof(line), file) != NULL) {
+			size_t len = 0;
+			for (char* p = line ; p[0] != '\0' && p[1] != '\0' && len < sizeof(fifo) ; ) {
+				unsigned int byte;
+				if (sscanf(p, "%2x", &byte) != 1) {
+					break;
+				}
+				fifo[len++] = byte;
+				p += 2;
+				while (*p == ' ') {
+					p++;
+				}
+			}
+
+			if (len > 0) {
+				ncaptures++;
+				differences -= compare(separate, fused, fifo, len, passed);
+			}
+		}
+
+		fclose(file);
+	} else {
+		uint8_t payload[32];
+
+		for (int i=0 ; i<GENERATED_CAPTURES ; i++) {
+			size_t len = rand() % 24;
+			for (size_t j=0 ; j<len ; j++) {
+				payload[j] = rand();
+			}
+			capture(payload, len, fifo);
+
+			switch (i % 4) {
+			case 1:
+				// Bit error anywhere in the data frame
+				fifo[rand() % FIFO_LENGTH] ^= 1 << (rand() % 8);
+				break;
+			case 2:
+				// Noise
+				for (size_t j=0 ; j<FIFO_LENGTH ; j++) {
+					fifo[j] = rand();
+				}
+				break;
+			case 3:
+				// Noise with a valid preamble
+				for (size_t j=4 ; j<FIFO_LENGTH ; j++) {
+					fifo[j] = rand();
+				}
+				break;
+			}
+
+			ncaptures++;
+			differences -= compare(separate, fused, fifo, FIFO_LENGTH, passed);
+		}
+	}
+
+	fflush(stdout);
+	dup2(savedStdout, 1);
+	close(devNull);
+	close(savedStdout);
+
+	fprintf(stderr, "%d captures, %d decoded, %d differences\n", ncaptures, passed, differences);
+
+	return differences;
+}
+
+/**
+ * Runs the pipeline ITERATIONS times on the capture and prints the result.
+ */
+static void run(const char* name, DecoderPipeline& pipeline, const uint8_t* fifo, int payloadBytes) {
+
+	uint8_t copy[FIFO_LENGTH];
+	FrameRecord record;
+
+	uint64_t start = nanos();
+	for (int i=0 ; i<ITERATIONS ; i++) {
+		memcpy(copy, fifo, FIFO_LENGTH);
+		DecoderBuffer buffer = { copy, FIFO_LENGTH };
+		pipeline.run(buffer, record);
+
+		// Keep the compiler from dropping the loop
+		__asm__ __volatile__("" : : "r"(&record) : "memory");
+	}
+	uint64_t elapsed = nanos() - start;
+
+	printf("%s %d %.1f %.0f\n", name, payloadBytes,
+			(double) elapsed / ITERATIONS, (double) FIFO_LENGTH * ITERATIONS * 1e9 / elapsed);
+}
+
+int main(int argc, char** argv) {
+
+	DecoderPipeline separate;
+	DecoderPipeline fused;
+	separate.configure(SEPARATE);
+	fused.configure(FUSED);
+
+	if (verify(separate, fused, argc > 1 ? argv[1] : NULL) != 0) {
+		return 1;
+	}
+
+	for (size_t s=0 ; s<sizeof(PAYLOAD_SIZES)/sizeof(PAYLOAD_SIZES[0]) ; s++) {
+		int len = PAYLOAD_SIZES[s];
+
+		uint8_t payload[32];
+		for (int i=0 ; i<len ; i++) {
+			payload[i] = rand();
+		}
+
+		uint8_t fifo[FIFO_LENGTH];
+		capture(payload, len, fifo);
+
+		run("separate", separate, fifo, len);
+		run("fused", fused, fifo, len);
+	}
+
+	uint8_t noise[FIFO_LENGTH];
+	for (size_t i=0 ; i<FIFO_LENGTH ; i++) {
+		noise[i] = rand();
+	}
+
+	const char* align[] = { "align=335553", "align=335553:1", "align=335553:2" };
+	for (size_t i=0 ; i<sizeof(align)/sizeof(align[0]) ; i++) {
+		DecoderPipeline pipeline;
+		pipeline.configure(align[i]);
+		run(align[i], pipeline, noise, 0);
+	}
+
+	return 0;
+}
@@ -20,20 +20,31 @@
 #ifndef ABSTRACTCOMMAND_HPP_
 #define ABSTRACTCOMMAND_HPP_
 
+#include "ClientConnection.hpp"
+
 /**
  * Abstract class for all commands.
+ *
+ * Clients send commands as text lines: The 2-character command token,
+ * optionally followed by parameters separated by blanks, e.g. "OF 4".
  */
 class AbstractCommand {
 public:
+	virtual ~AbstractCommand() {};
+
 	/**
 	 * Get the 2-character command token.
 	 */
 	virtual const char* getToken() = 0;
 
 	/**
-	 * Execute the command.
+	 * Execute the command on behalf of a client.
+	 * Commands that return information write it to the client before
+	 * returning.
+	 *
+	 * Returns 0 on success, -1 if the parameters are invalid.
 	 */
-	virtual int execute(const char* parameters) = 0;
+	virtual int execute(ClientConnection* client, const char* parameters) = 0;
 };
 
 
@@ -22,6 +22,9 @@
 
 #include <stdint.h>
 
+static const uint8_t ADDR_FIFOTHR   = 0x03;
+static const uint8_t ADDR_CHANNR    = 0x0A;
+
 static const uint8_t ADDR_LQI       = 0x33;
 static const uint8_t ADDR_RSSI      = 0x34;
 static const uint8_t ADDR_TX_BYTES  = 0x3A;
@@ -31,9 +34,14 @@ static const uint8_t ADDR_RXTX_FIFO = 0x3F;
 static const uint8_t STROBE_SRES = 0x30; // Reset chip.
 static const uint8_t STROBE_SRX  = 0x34; // Enable RX.
 static const uint8_t STROBE_STX  = 0x35; // Enable TX.
+static const uint8_t STROBE_SIDLE = 0x36; // Exit RX / TX.
 static const uint8_t STROBE_SFRX = 0x3A; // Flush the RX FIFO buffer.
 static const uint8_t STROBE_SFTX = 0x3B; // Flush the TX FIFO buffer.
 static const uint8_t STROBE_SNOP = 0x3D; // No operation
 
+// State in the chip status byte returned by every SPI access
+static const uint8_t CHIP_STATE_MASK = 0x70;
+static const uint8_t CHIP_STATE_RX   = 0x10;
+
 
 #endif /* ADRESSSPACE_HPP_ */
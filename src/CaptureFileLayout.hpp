@@ -0,0 +1,102 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CAPTUREFILELAYOUT_HPP_
+#define CAPTUREFILELAYOUT_HPP_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Layout of the segment files written by RawCapture. All numbers are in
+ * the byte order of the host (little endian on the Raspberry Pi).
+ *
+ * A segment file starts with a header, followed by records. Each record
+ * holds the bytes of one Protocol::receive() call, as they were read
+ * from the RX FIFO, and starts at a multiple of CAPTURE_RECORD_ALIGNMENT.
+ *
+ * Segments are preallocated, so the end of the records is not the end of
+ * the file: "used" in the header tells. It is updated after each record,
+ * so files of a running (or killed) driver can be read as well. Segments
+ * that were completed are truncated to the used size.
+ */
+
+static const uint32_t CAPTURE_MAGIC = 0x46313143; // "C11F"
+static const uint16_t CAPTURE_VERSION = 1;
+
+static const size_t CAPTURE_RECORD_ALIGNMENT = 8;
+
+static const int CAPTURE_MAX_PROFILES = 8;
+static const size_t CAPTURE_PROFILE_NAME_BYTES = 16;
+
+/** Bytes of a receive call kept at most, without RSSI and LQI */
+static const size_t CAPTURE_MAX_DATA_BYTES = 256;
+
+struct CaptureSegmentHeader {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t headerSize;
+
+	/** Number of the segment within the recording, counting from 0 */
+	uint32_t segment;
+	uint32_t profileCount;
+
+	/** Size of the file */
+	uint64_t size;
+
+	/** End of the last complete record, counted from the start of the file */
+	uint64_t used;
+
+	/** When the recording started (CLOCK_REALTIME, ns) */
+	uint64_t started;
+
+	/** Names of the radio profiles, records refer to them by index */
+	char profiles[CAPTURE_MAX_PROFILES][CAPTURE_PROFILE_NAME_BYTES];
+} __attribute__((aligned(64)));
+
+struct CaptureRecordHeader {
+	/** Header and data, padded to CAPTURE_RECORD_ALIGNMENT. The next record follows. */
+	uint16_t recordSize;
+
+	/** Bytes of data following the header */
+	uint16_t len;
+
+	/** Index of the radio profile that was active */
+	uint8_t profile;
+
+	/** RSSI and LQI as appended by the CC1101, LQI with the CRC_OK bit */
+	uint8_t rssi;
+	uint8_t lqi;
+	uint8_t reserved;
+
+	/** Counts the receive calls captured; gaps are records dropped */
+	uint32_t sequence;
+	uint32_t reserved2;
+
+	/** Time of capture (CLOCK_REALTIME and CLOCK_MONOTONIC, ns) */
+	uint64_t timestamp;
+	uint64_t monotonic;
+};
+
+static inline size_t captureRecordSize(size_t len) {
+	size_t size = sizeof(CaptureRecordHeader) + len;
+	return (size + CAPTURE_RECORD_ALIGNMENT - 1) & ~(CAPTURE_RECORD_ALIGNMENT - 1);
+}
+
+#endif /* CAPTUREFILELAYOUT_HPP_ */
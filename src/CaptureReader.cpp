@@ -0,0 +1,125 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "CaptureReader.hpp"
+
+CaptureReader::CaptureReader() {
+	this->header = NULL;
+	this->size = 0;
+	this->offset = 0;
+	this->corrupt = false;
+}
+
+CaptureReader::~CaptureReader() {
+	if (this->header != NULL) {
+		this->close();
+	}
+}
+
+int CaptureReader::open(const char* name) {
+
+	int fd = ::open(name, O_RDONLY);
+	if (fd < 0) {
+		perror(name);
+		return -1;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) < 0 || (size_t) st.st_size < sizeof(CaptureSegmentHeader)) {
+		fprintf(stderr, "%s is not a capture segment.\n", name);
+		::close(fd);
+		return -1;
+	}
+
+	void* addr = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (addr == MAP_FAILED) {
+		perror("Mapping capture segment");
+		return -1;
+	}
+
+	const CaptureSegmentHeader* hdr = (const CaptureSegmentHeader*) addr;
+	if (__atomic_load_n(&hdr->magic, __ATOMIC_ACQUIRE) != CAPTURE_MAGIC
+			|| hdr->version != CAPTURE_VERSION
+			|| hdr->headerSize != sizeof(CaptureSegmentHeader)
+			|| hdr->profileCount > (uint32_t) CAPTURE_MAX_PROFILES) {
+		fprintf(stderr, "%s: Unsupported capture segment layout.\n", name);
+		munmap(addr, st.st_size);
+		return -1;
+	}
+
+	// Records are read once, front to back
+	madvise(addr, st.st_size, MADV_SEQUENTIAL);
+
+	this->header = hdr;
+	this->size = st.st_size;
+	this->offset = hdr->headerSize;
+	this->corrupt = false;
+
+	return 0;
+}
+
+void CaptureReader::close() {
+	munmap((void*) this->header, this->size);
+	this->header = NULL;
+	this->size = 0;
+}
+
+const char* CaptureReader::getProfileName(int index) {
+	if (index < 0 || (uint32_t) index >= this->header->profileCount) {
+		return NULL;
+	}
+
+	return this->header->profiles[index];
+}
+
+const CaptureRecordHeader* CaptureReader::next() {
+
+	// The writer updates "used" after a record is complete
+	uint64_t used = __atomic_load_n(&this->header->used, __ATOMIC_ACQUIRE);
+	if (used > this->size) {
+		used = this->size; // Grown after it was mapped
+	}
+
+	if (this->corrupt || this->offset + sizeof(CaptureRecordHeader) > used) {
+		return NULL;
+	}
+
+	const CaptureRecordHeader* record =
+			(const CaptureRecordHeader*) ((const uint8_t*) this->header + this->offset);
+
+	if (record->len > CAPTURE_MAX_DATA_BYTES
+			|| record->recordSize != captureRecordSize(record->len)
+			|| this->offset + record->recordSize > used) {
+		this->corrupt = true;
+		return NULL;
+	}
+
+	this->offset += record->recordSize;
+	return record;
+}
@@ -0,0 +1,94 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef CAPTUREREADER_HPP_
+#define CAPTUREREADER_HPP_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "CaptureFileLayout.hpp"
+
+/**
+ * Reads the records of a segment file written by RawCapture.
+ *
+ * The file is mapped read-only, so reading records does not require any
+ * system call. Segments still being written can be read as well: next()
+ * returns the records completed so far.
+ *
+ * To use it in your own application, compile CaptureReader.cpp together
+ * with your sources.
+ */
+class CaptureReader {
+
+public:
+	CaptureReader();
+	~CaptureReader();
+
+	/**
+	 * Maps a segment file. Reading starts with the first record.
+	 *
+	 * Returns 0 on success, -1 if the file does not exist or is not a
+	 * capture segment of a supported version.
+	 */
+	int open(const char* name);
+
+	void close();
+
+	const CaptureSegmentHeader* getHeader() {
+		return this->header;
+	}
+
+	/**
+	 * Returns the name of the radio profile records refer to by index,
+	 * or NULL if there is no such profile.
+	 */
+	const char* getProfileName(int index);
+
+	/**
+	 * Returns the next record, or NULL if there are no more records.
+	 * The bytes captured follow the header, see getData(). The record
+	 * stays valid until the reader is closed.
+	 */
+	const CaptureRecordHeader* next();
+
+	static const uint8_t* getData(const CaptureRecordHeader* record) {
+		return (const uint8_t*) record + sizeof(CaptureRecordHeader);
+	}
+
+	/**
+	 * Returns true if reading stopped at a record that is not valid,
+	 * instead of the end of the records.
+	 */
+	bool isCorrupt() {
+		return this->corrupt;
+	}
+
+private:
+	const CaptureSegmentHeader* header;
+	size_t size;
+
+	/** Offset of the next record from the start of the file */
+	size_t offset;
+
+	bool corrupt;
+};
+
+#endif /* CAPTUREREADER_HPP_ */
@@ -0,0 +1,40 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CapturingProtocol.hpp"
+
+CapturingProtocol::CapturingProtocol(Protocol* protocol, RawCapture* capture) {
+	this->protocol = protocol;
+	this->capture = capture;
+}
+
+int CapturingProtocol::receive(uint8_t buffer[], size_t& nbytes) {
+
+	int rc = this->protocol->receive(buffer, nbytes);
+	if (rc >= 0) {
+		this->capture->capture(buffer, nbytes);
+	}
+
+	return rc;
+}
+
+int CapturingProtocol::transmit(const uint8_t buffer[], size_t nbytes) {
+
+	return this->protocol->transmit(buffer, nbytes);
+}
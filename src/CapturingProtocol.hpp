@@ -0,0 +1,49 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CAPTURINGPROTOCOL_HPP_
+#define CAPTURINGPROTOCOL_HPP_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "Protocol.hpp"
+#include "RawCapture.hpp"
+
+/**
+ * Passes the bytes received by another protocol on to a RawCapture,
+ * before the data frame decodes them. Transmitting is left to the other
+ * protocol.
+ */
+class CapturingProtocol : public Protocol {
+
+public:
+	CapturingProtocol(Protocol* protocol, RawCapture* capture);
+
+	virtual int receive(uint8_t buffer[], size_t& nbytes);
+
+	virtual int transmit(const uint8_t buffer[], size_t nbytes);
+
+private:
+	Protocol* protocol;
+	RawCapture* capture;
+};
+
+
+#endif /* CAPTURINGPROTOCOL_HPP_ */
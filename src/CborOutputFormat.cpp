@@ -0,0 +1,132 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <assert.h>
+
+#include "FrameFields.hpp"
+
+#include "CborOutputFormat.hpp"
+
+// CBOR major types
+static const uint8_t MAJOR_UNSIGNED = 0;
+static const uint8_t MAJOR_NEGATIVE = 1;
+static const uint8_t MAJOR_BYTES = 2;
+static const uint8_t MAJOR_TEXT = 3;
+static const uint8_t MAJOR_MAP = 5;
+
+static const uint8_t CBOR_FALSE = 0xF4;
+static const uint8_t CBOR_TRUE = 0xF5;
+static const uint8_t CBOR_BREAK = 0xFF;
+
+/**
+ * Writes the fields as entries of a CBOR map. The number of fields
+ * depends on the record, so the map has indefinite length.
+ */
+class CborWriter : public IFieldVisitor {
+
+public:
+	uint8_t* p;
+
+	CborWriter(uint8_t* p) {
+		this->p = p;
+		*this->p++ = (MAJOR_MAP << 5) | 31; // Indefinite length
+	}
+
+	/**
+	 * Writes the initial byte of a data item with its argument in the
+	 * shortest form.
+	 */
+	void head(uint8_t major, uint64_t value) {
+		major <<= 5;
+
+		if (value < 24) {
+			*this->p++ = major | value;
+		} else if (value <= 0xFF) {
+			*this->p++ = major | 24;
+			*this->p++ = value;
+		} else if (value <= 0xFFFF) {
+			*this->p++ = major | 25;
+			*this->p++ = value >> 8;
+			*this->p++ = value;
+		} else if (value <= 0xFFFFFFFF) {
+			*this->p++ = major | 26;
+			for (int shift=24 ; shift>=0 ; shift-=8) {
+				*this->p++ = value >> shift;
+			}
+		} else {
+			*this->p++ = major | 27;
+			for (int shift=56 ; shift>=0 ; shift-=8) {
+				*this->p++ = value >> shift;
+			}
+		}
+	}
+
+	void text(const char* s) {
+		size_t len = strlen(s);
+		head(MAJOR_TEXT, len);
+		memcpy(this->p, s, len);
+		this->p += len;
+	}
+
+	void visitUnsigned(const char* name, uint64_t value) {
+		text(name);
+		head(MAJOR_UNSIGNED, value);
+	}
+
+	void visitSigned(const char* name, int64_t value) {
+		text(name);
+		if (value < 0) {
+			head(MAJOR_NEGATIVE, (uint64_t) -1 - (uint64_t) value);
+		} else {
+			head(MAJOR_UNSIGNED, value);
+		}
+	}
+
+	void visitBool(const char* name, bool value) {
+		text(name);
+		*this->p++ = value ? CBOR_TRUE : CBOR_FALSE;
+	}
+
+	void visitString(const char* name, const char* value) {
+		text(name);
+		text(value);
+	}
+
+	void visitBytes(const char* name, const uint8_t data[], size_t len) {
+		text(name);
+		head(MAJOR_BYTES, len);
+		memcpy(this->p, data, len);
+		this->p += len;
+	}
+
+	void visitMissing(const char* name) {
+	}
+};
+
+size_t CborOutputFormat::format(const FrameRecord& record, char line[], size_t maxBytes) {
+
+	assert(maxBytes >= MAX_LINE_BYTES);
+
+	CborWriter writer((uint8_t*) line);
+	FrameFields::visit(record, writer);
+	*writer.p++ = CBOR_BREAK;
+
+	return (char*) writer.p - line;
+}
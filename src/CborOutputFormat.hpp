@@ -0,0 +1,41 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CBOROUTPUTFORMAT_HPP_
+#define CBOROUTPUTFORMAT_HPP_
+
+#include "IOutputFormat.hpp"
+
+/**
+ * Renders records as CBOR (RFC 7049) maps, one after the other.
+ * The keys are the field names of FrameFields, the payload is a byte
+ * string. Fields not available for the data frame format are left out.
+ */
+class CborOutputFormat : public IOutputFormat {
+
+public:
+	virtual const char* getName() {
+		return "cbor";
+	}
+
+	virtual size_t format(const FrameRecord& record, char line[], size_t maxBytes);
+};
+
+
+#endif /* CBOROUTPUTFORMAT_HPP_ */
@@ -0,0 +1,39 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+
+#include "ChannelCommand.hpp"
+
+int ChannelCommand::execute(ClientConnection* client, const char* parameters) {
+
+	if (*parameters == '\0') {
+		client->respond("CH %d\n", this->device->getChannel());
+		return 0;
+	}
+
+	char* end;
+	long channel = strtol(parameters, &end, 10);
+	if (*end != '\0' || channel < 0 || channel > 255) {
+		return -1;
+	}
+
+	this->device->setChannel(channel);
+	return 0;
+}
@@ -0,0 +1,48 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CHANNELCOMMAND_HPP_
+#define CHANNELCOMMAND_HPP_
+
+#include "AbstractCommand.hpp"
+#include "Device.hpp"
+
+/**
+ * Changes the channel number of the RF module.
+ *
+ * "CH <channel>" selects the channel (0 to 255), "CH" returns the current
+ * channel. Affects all clients.
+ */
+class ChannelCommand : public AbstractCommand {
+	Device* device;
+
+public:
+	ChannelCommand(Device* device) {
+		this->device = device;
+	}
+
+	const char* getToken() {
+		return "CH";
+	}
+
+	int execute(ClientConnection* client, const char* parameters);
+};
+
+
+#endif /* CHANNELCOMMAND_HPP_ */
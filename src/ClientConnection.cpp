@@ -0,0 +1,263 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <assert.h>
+#include <sys/uio.h>
+
+#include "Log.hpp"
+
+#include "ClientConnection.hpp"
+
+ClientConnection::ClientConnection() {
+	this->fd = -1;
+	this->outputFormat = 0;
+	this->srcFilter = ANY_ADDRESS;
+	this->destFilter = ANY_ADDRESS;
+	this->dropped = 0;
+	this->lineLength = 0;
+	this->pool = NULL;
+	this->head = 0;
+	this->queued = 0;
+	this->writeOffset = 0;
+	this->failed = false;
+}
+
+void ClientConnection::open(int fd, int outputFormat, OutputBufferPool* pool) {
+	this->fd = fd;
+	this->outputFormat = outputFormat;
+	this->srcFilter = ANY_ADDRESS;
+	this->destFilter = ANY_ADDRESS;
+	this->transmitLimit.reset();
+	this->dropped = 0;
+	this->lineLength = 0;
+	this->pool = pool;
+	this->head = 0;
+	this->queued = 0;
+	this->writeOffset = 0;
+	this->failed = false;
+}
+
+void ClientConnection::close() {
+	while (this->queued > 0) {
+		this->pool->release(this->queue[this->head]);
+		this->head = (this->head + 1) % OUTPUT_QUEUE_LENGTH;
+		this->queued--;
+	}
+
+	this->query.stop();
+	this->fd = -1;
+}
+
+char* ClientConnection::readLine(const char*& data, size_t& nbytes) {
+
+	while (nbytes > 0) {
+		char c = *data++;
+		nbytes--;
+
+		if (c == '\n') {
+			// Also accept CR LF line ends
+			if (this->lineLength > 0 && this->line[this->lineLength - 1] == '\r') {
+				this->lineLength--;
+			}
+
+			this->line[this->lineLength] = '\0';
+			this->lineLength = 0;
+			return this->line;
+		}
+
+		if (this->lineLength < MAX_LINE_LENGTH - 1) {
+			this->line[this->lineLength++] = c;
+		}
+	}
+
+	return NULL;
+}
+
+bool ClientConnection::accepts(const FrameDescriptor& frame) {
+
+	if (this->srcFilter == ANY_ADDRESS && this->destFilter == ANY_ADDRESS) {
+		return true;
+	}
+
+	if ((frame.flags & FRAME_FLAG_ADDRESS) == 0) {
+		return false;
+	}
+
+	if (this->srcFilter != ANY_ADDRESS && frame.srcAddress != this->srcFilter) {
+		return false;
+	}
+
+	if (this->destFilter != ANY_ADDRESS && frame.destAddress != this->destFilter) {
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * Writes to the socket if nothing is queued before.
+ * written is the number of bytes the socket took.
+ */
+void ClientConnection::writeDirect(const char* data, size_t len, size_t& written) {
+
+	written = 0;
+	if (this->queued > 0 || this->failed) {
+		return;
+	}
+
+	ssize_t rc = write(this->fd, data, len);
+	if (rc >= 0) {
+		written = rc;
+	} else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+		this->failed = true;
+	}
+}
+
+void ClientConnection::enqueue(OutputBuffer* buffer, size_t offset) {
+	assert(this->queued < OUTPUT_QUEUE_LENGTH);
+
+	if (this->queued == 0) {
+		this->writeOffset = offset;
+	} else {
+		assert(offset == 0);
+	}
+
+	this->queue[(this->head + this->queued) % OUTPUT_QUEUE_LENGTH] = buffer;
+	this->queued++;
+}
+
+bool ClientConnection::send(OutputBuffer* buffer) {
+
+	size_t written;
+	writeDirect(buffer->data, buffer->len, written);
+	if (written == buffer->len || this->failed) {
+		return !this->failed;
+	}
+
+	// Keep the rest of a partially written data frame, otherwise the
+	// client would get garbage
+	if (written == 0 && this->queued >= OUTPUT_QUEUE_LENGTH - RESERVED_FOR_RESPONSES) {
+		this->dropped++;
+		return false;
+	}
+
+	this->pool->retain(buffer);
+	enqueue(buffer, written);
+	return true;
+}
+
+void ClientConnection::respond(const char* format, ...) {
+
+	char buf[MAX_LINE_LENGTH];
+
+	va_list args;
+	va_start(args, format);
+	int len = vsnprintf(buf, sizeof(buf), format, args);
+	va_end(args);
+
+	if (len >= (int) sizeof(buf)) {
+		len = sizeof(buf) - 1;
+	}
+
+	if (len <= 0) {
+		return;
+	}
+
+	size_t written;
+	writeDirect(buf, len, written);
+	if (written == (size_t) len || this->failed) {
+		return;
+	}
+
+	// Responses with many lines are collected in the last buffer queued,
+	// if no other client shares it
+	if (this->queued > 0) {
+		OutputBuffer* last = this->queue[(this->head + this->queued - 1) % OUTPUT_QUEUE_LENGTH];
+		if (last->refs == 1 && last->len + len <= OutputBuffer::MAX_BYTES) {
+			memcpy(last->data + last->len, buf, len);
+			last->len += len;
+			return;
+		}
+	}
+
+	OutputBuffer* buffer = this->queued < OUTPUT_QUEUE_LENGTH ? this->pool->acquire() : NULL;
+	if (buffer == NULL) {
+		// The client doesn't read its responses
+		LOG_WARN("Output queue overflow (fd=%d)\n", this->fd);
+
+		this->failed = true;
+		return;
+	}
+
+	buffer->len = len - written;
+	memcpy(buffer->data, buf + written, buffer->len);
+	enqueue(buffer, 0);
+}
+
+int ClientConnection::writeOutput() {
+
+	const int MAX_IOV = 16;
+	struct iovec iov[MAX_IOV];
+
+	while (this->queued > 0 && !this->failed) {
+		int niov = 0;
+		for (int i=0 ; i<this->queued && niov<MAX_IOV ; i++) {
+			OutputBuffer* buffer = this->queue[(this->head + i) % OUTPUT_QUEUE_LENGTH];
+			size_t offset = i == 0 ? this->writeOffset : 0;
+
+			iov[niov].iov_base = buffer->data + offset;
+			iov[niov].iov_len = buffer->len - offset;
+			niov++;
+		}
+
+		ssize_t rc = writev(this->fd, iov, niov);
+		if (rc < 0) {
+			if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+				break;
+			}
+
+			this->failed = true;
+			break;
+		}
+
+		// Release the buffers written completely
+		size_t remaining = rc;
+		while (this->queued > 0) {
+			OutputBuffer* buffer = this->queue[this->head];
+			size_t left = buffer->len - this->writeOffset;
+			if (remaining < left) {
+				this->writeOffset += remaining;
+				break;
+			}
+
+			remaining -= left;
+			this->pool->release(buffer);
+			this->head = (this->head + 1) % OUTPUT_QUEUE_LENGTH;
+			this->queued--;
+			this->writeOffset = 0;
+		}
+	}
+
+	return this->failed ? -1 : 0;
+}
@@ -0,0 +1,158 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CLIENTCONNECTION_HPP_
+#define CLIENTCONNECTION_HPP_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "FramePool.hpp"
+#include "TokenBucket.hpp"
+#include "OutputBufferPool.hpp"
+#include "FrameStoreQuery.hpp"
+
+/**
+ * State of a client connected to the socket server: The settings made
+ * by commands, the command line read so far and the output not yet
+ * written to the socket.
+ *
+ * The socket is non-blocking. Output that can't be written right away is
+ * queued and written when the socket becomes writable, so a slow client
+ * doesn't hold up the others.
+ */
+class ClientConnection {
+
+public:
+	static const int MAX_LINE_LENGTH = 256;
+
+	/** Buffers queued per client */
+	static const int OUTPUT_QUEUE_LENGTH = 32;
+
+	/**
+	 * Queue entries only used by responses to commands. Data frames are
+	 * dropped before, so a client always gets its responses.
+	 */
+	static const int RESERVED_FOR_RESPONSES = 8;
+
+	/** No filter on the address */
+	static const int ANY_ADDRESS = -1;
+
+	/** Socket file descriptor, -1 if unused */
+	int fd;
+
+	/** Format used to write data frames to the socket */
+	int outputFormat;
+
+	/** Only data frames from this source address are written, or ANY_ADDRESS */
+	int srcFilter;
+
+	/** Only data frames to this destination address are written, or ANY_ADDRESS */
+	int destFilter;
+
+	/** Limits the rate of data frames this client may transmit */
+	TokenBucket transmitLimit;
+
+	/** Data frames not written because the client was too slow */
+	uint64_t dropped;
+
+	/** Stored data frames being sent to the client, see QueryCommand */
+	FrameStoreQuery query;
+
+	ClientConnection();
+
+	/**
+	 * Starts a new connection with default settings.
+	 * Queued output is taken from the pool.
+	 */
+	void open(int fd, int outputFormat, OutputBufferPool* pool);
+
+	/**
+	 * Releases the queued output and ends the query. Doesn't close the socket.
+	 */
+	void close();
+
+	/**
+	 * Adds bytes read from the socket to the command line, up to and
+	 * including the next line end. data and nbytes are advanced by the
+	 * number of bytes consumed.
+	 * Returns the complete command line without line end, or NULL if the
+	 * line is not complete yet. Lines that are too long are truncated.
+	 */
+	char* readLine(const char*& data, size_t& nbytes);
+
+	/**
+	 * Returns true if the data frame passes the filters of this client.
+	 */
+	bool accepts(const FrameDescriptor& frame);
+
+	/**
+	 * Writes a rendered data frame to the client. The buffer may be shared
+	 * with other clients; a reference is kept while it is queued.
+	 * Returns false if the data frame was dropped because the output queue
+	 * is full, or if the connection failed (see hasFailed()).
+	 */
+	bool send(OutputBuffer* buffer);
+
+	/**
+	 * Writes a printf style formatted response to the client.
+	 */
+	void respond(const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+	/**
+	 * Writes as much of the queued output as the socket takes.
+	 * Returns 0 on success, -1 if the connection failed and must be closed.
+	 */
+	int writeOutput();
+
+	/**
+	 * Returns true if there is queued output, i.e. the socket must be
+	 * polled for POLLOUT.
+	 */
+	bool hasOutput() { return this->queued > 0; };
+
+	/**
+	 * Returns the number of buffers queued.
+	 */
+	int getQueued() { return this->queued; };
+
+	/**
+	 * Returns true if writing failed and the connection must be closed.
+	 */
+	bool hasFailed() { return this->failed; };
+
+private:
+	char line[MAX_LINE_LENGTH];
+	size_t lineLength;
+
+	OutputBufferPool* pool;
+
+	/** Output queue, the first buffer is written from writeOffset on */
+	OutputBuffer* queue[OUTPUT_QUEUE_LENGTH];
+	int head;
+	int queued;
+	size_t writeOffset;
+
+	bool failed;
+
+	void enqueue(OutputBuffer* buffer, size_t offset);
+	void writeDirect(const char* data, size_t len, size_t& written);
+};
+
+#endif /* CLIENTCONNECTION_HPP_ */
@@ -0,0 +1,107 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <assert.h>
+
+#include "Log.hpp"
+
+#include "CommandDispatcher.hpp"
+
+CommandDispatcher::CommandDispatcher() {
+	for (int i=0 ; i<LETTERS * LETTERS ; i++) {
+		this->commands[i] = NULL;
+	}
+}
+
+int CommandDispatcher::indexOf(const char* token) {
+
+	int c0 = toupper((unsigned char) token[0]) - 'A';
+	if (c0 < 0 || c0 >= LETTERS) {
+		return -1;
+	}
+
+	int c1 = toupper((unsigned char) token[1]) - 'A';
+	if (c1 < 0 || c1 >= LETTERS) {
+		return -1;
+	}
+
+	return c0 * LETTERS + c1;
+}
+
+void CommandDispatcher::addCommand(AbstractCommand* command) {
+
+	const char* token = command->getToken();
+	assert(strlen(token) == 2);
+
+	int index = indexOf(token);
+	assert(index >= 0);
+	assert(this->commands[index] == NULL);
+
+	this->commands[index] = command;
+}
+
+int CommandDispatcher::dispatch(ClientConnection* client, char* line) {
+
+	// Skip leading blanks
+	while (*line == ' ' || *line == '\t') {
+		line++;
+	}
+
+	if (*line == '\0') {
+		return 0; // Empty line
+	}
+
+	char token[3];
+	token[0] = toupper((unsigned char) line[0]);
+	token[1] = toupper((unsigned char) line[1]);
+	token[2] = '\0';
+
+	int index = line[1] != '\0' ? indexOf(token) : -1;
+	AbstractCommand* command = index >= 0 ? this->commands[index] : NULL;
+
+	// The token must be followed by a blank or the end of the line
+	if (command == NULL || (line[2] != '\0' && line[2] != ' ' && line[2] != '\t')) {
+		client->respond("ERROR %.2s\n", line);
+		return -1;
+	}
+
+	char* parameters = line + 2;
+	while (*parameters == ' ' || *parameters == '\t') {
+		parameters++;
+	}
+
+	// Strip trailing blanks
+	size_t len = strlen(parameters);
+	while (len > 0 && (parameters[len - 1] == ' ' || parameters[len - 1] == '\t')) {
+		parameters[--len] = '\0';
+	}
+
+	LOG_DEBUG("Command %s \"%s\" (fd=%d)\n", token, parameters, client->fd);
+
+	if (command->execute(client, parameters) < 0) {
+		client->respond("ERROR %s\n", token);
+		return -1;
+	}
+
+	client->respond("OK %s\n", token);
+	return 0;
+}
@@ -0,0 +1,64 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMMANDDISPATCHER_HPP_
+#define COMMANDDISPATCHER_HPP_
+
+#include "AbstractCommand.hpp"
+#include "ClientConnection.hpp"
+
+/**
+ * Parses the command lines sent by the clients and executes the command
+ * with the matching token.
+ *
+ * Tokens consist of two letters, so the command is looked up directly
+ * in a table with an entry for every possible token.
+ *
+ * The client gets "OK <token>" if the command was executed, or
+ * "ERROR <token>" if the command is unknown or the parameters are invalid.
+ */
+class CommandDispatcher {
+
+public:
+	CommandDispatcher();
+
+	/**
+	 * Registers a command. The token must consist of two letters.
+	 */
+	void addCommand(AbstractCommand* command);
+
+	/**
+	 * Executes a command line sent by a client.
+	 * Returns 0 on success, -1 on error.
+	 */
+	int dispatch(ClientConnection* client, char* line);
+
+private:
+	static const int LETTERS = 26;
+
+	AbstractCommand* commands[LETTERS * LETTERS];
+
+	/**
+	 * Returns the table index of the token, or -1 if it is not valid.
+	 */
+	static int indexOf(const char* token);
+};
+
+
+#endif /* COMMANDDISPATCHER_HPP_ */
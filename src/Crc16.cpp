@@ -0,0 +1,87 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "Crc16.hpp"
+
+Crc16::Crc16(uint16_t polynomial, size_t length) {
+	this->length = length;
+
+	for (int byte=0 ; byte<256 ; byte++) {
+		uint16_t crc = byte << 8;
+		for (int bit=0 ; bit<8 ; bit++) {
+			crc = (crc & 0x8000) ? (crc << 1) ^ polynomial : crc << 1;
+		}
+		this->table[0][byte] = crc;
+	}
+
+	for (int k=1 ; k<8 ; k++) {
+		for (int byte=0 ; byte<256 ; byte++) {
+			uint16_t crc = this->table[k - 1][byte];
+			this->table[k][byte] = (crc << 8) ^ this->table[0][crc >> 8];
+		}
+	}
+}
+
+uint16_t Crc16::update(uint16_t crc, const uint8_t *buffer, size_t len) {
+
+	while (len >= 8) {
+		crc = this->table[7][buffer[0] ^ (crc >> 8)]
+				^ this->table[6][buffer[1] ^ (crc & 0xFF)]
+				^ this->table[5][buffer[2]]
+				^ this->table[4][buffer[3]]
+				^ this->table[3][buffer[4]]
+				^ this->table[2][buffer[5]]
+				^ this->table[1][buffer[6]]
+				^ this->table[0][buffer[7]];
+
+		buffer += 8;
+		len -= 8;
+	}
+
+	return this->updateBytewise(crc, buffer, len);
+}
+
+uint16_t Crc16::updateBytewise(uint16_t crc, const uint8_t *buffer, size_t len) {
+
+	for (size_t i=0 ; i<len ; i++) {
+		crc = (crc << 8) ^ this->table[0][(crc >> 8) ^ buffer[i]];
+	}
+
+	return crc;
+}
+
+int Crc16::process(DecoderBuffer& buffer, FrameRecord& record) {
+
+	size_t len = this->length > 0 ? this->length : buffer.len - 2;
+	if (buffer.len < 2 || len + 2 > buffer.len) {
+		return -1;
+	}
+
+	// The CRC over the data and its CRC is 0
+	if (this->update(0xFFFF, buffer.data, len + 2) != 0) {
+		return -1;
+	}
+
+	buffer.len = len;
+	record.flags |= FRAME_FLAG_CRC_OK;
+
+	return 0;
+}
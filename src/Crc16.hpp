@@ -0,0 +1,87 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CRC16_HPP_
+#define CRC16_HPP_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "IDecoderStage.hpp"
+
+/**
+ * Software CRC-16, for data frames the CC1101 receives without checking
+ * the CRC itself, e.g. in FIFO overflow mode.
+ *
+ * The CRC is calculated most significant bit first, starting with 0xFFFF
+ * and without final XOR, like the CC1101 does. The data is processed 8
+ * bytes at a time with 8 tables (slice-by-8).
+ *
+ * As decoder stage "crc", checks the CRC in the 2 bytes after the data
+ * (most significant byte first), strips them off and sets FRAME_FLAG_CRC_OK.
+ * Data frames with wrong CRC are rejected. Place the stage before stages
+ * that take long, so they don't waste time on damaged data frames.
+ */
+class Crc16 : public IDecoderStage {
+
+public:
+	/** x^16 + x^15 + x^2 + 1, used by the CC1101 */
+	static const uint16_t POLYNOMIAL_IBM = 0x8005;
+
+	/** x^16 + x^12 + x^5 + 1 */
+	static const uint16_t POLYNOMIAL_CCITT = 0x1021;
+
+	/**
+	 * @param polynomial Generator polynomial, without the x^16 term.
+	 * @param length Number of bytes the CRC is calculated over, the CRC
+	 *        follows them. Bytes after the CRC are cut off. 0 if the CRC is
+	 *        in the last 2 bytes received.
+	 */
+	Crc16(uint16_t polynomial, size_t length);
+
+	virtual const char* getName() {
+		return "crc";
+	}
+
+	virtual int process(DecoderBuffer& buffer, FrameRecord& record);
+
+	/**
+	 * Calculates the CRC of a buffer of bytes.
+	 *
+	 * @param crc CRC of the preceding bytes, 0xFFFF to start.
+	 */
+	uint16_t update(uint16_t crc, const uint8_t *buffer, size_t len);
+
+	/**
+	 * Calculates the CRC a byte at a time, for comparison.
+	 */
+	uint16_t updateBytewise(uint16_t crc, const uint8_t *buffer, size_t len);
+
+private:
+	size_t length;
+
+	/**
+	 * table[0] is the CRC of each byte value. table[k] is the CRC of the
+	 * byte value followed by k zero bytes.
+	 */
+	uint16_t table[8][256];
+};
+
+
+#endif /* CRC16_HPP_ */
@@ -0,0 +1,90 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <assert.h>
+
+#include "FrameFields.hpp"
+#include "OutputEncoding.hpp"
+
+#include "CsvOutputFormat.hpp"
+
+/**
+ * Writes the field values separated by comma.
+ */
+class CsvWriter : public IFieldVisitor {
+
+public:
+	char* p;
+	bool first;
+
+	CsvWriter(char* p) {
+		this->p = p;
+		this->first = true;
+	}
+
+	void separator() {
+		if (!this->first) {
+			*this->p++ = ',';
+		}
+		this->first = false;
+	}
+
+	void visitUnsigned(const char* name, uint64_t value) {
+		separator();
+		this->p = OutputEncoding::decimal(this->p, value);
+	}
+
+	void visitSigned(const char* name, int64_t value) {
+		separator();
+		this->p = OutputEncoding::signedDecimal(this->p, value);
+	}
+
+	void visitBool(const char* name, bool value) {
+		separator();
+		*this->p++ = value ? '1' : '0';
+	}
+
+	void visitString(const char* name, const char* value) {
+		separator();
+		size_t len = strlen(value);
+		memcpy(this->p, value, len);
+		this->p += len;
+	}
+
+	void visitBytes(const char* name, const uint8_t data[], size_t len) {
+		separator();
+		this->p = OutputEncoding::hex(this->p, data, len);
+	}
+
+	void visitMissing(const char* name) {
+		separator();
+	}
+};
+
+size_t CsvOutputFormat::format(const FrameRecord& record, char line[], size_t maxBytes) {
+
+	assert(maxBytes >= MAX_LINE_BYTES);
+
+	CsvWriter writer(line);
+	FrameFields::visit(record, writer);
+	*writer.p++ = '\n';
+
+	return writer.p - line;
+}
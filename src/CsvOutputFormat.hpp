@@ -0,0 +1,44 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CSVOUTPUTFORMAT_HPP_
+#define CSVOUTPUTFORMAT_HPP_
+
+#include "IOutputFormat.hpp"
+
+/**
+ * Renders records as comma separated values, one line per record:
+ *
+ * seq,ts,type,src,dst,rssi,lqi,crc,payload
+ *
+ * Fields not available for the data frame format are empty. crc is 1 or 0,
+ * the payload is written in hex.
+ */
+class CsvOutputFormat : public IOutputFormat {
+
+public:
+	virtual const char* getName() {
+		return "csv";
+	}
+
+	virtual size_t format(const FrameRecord& record, char line[], size_t maxBytes);
+};
+
+
+#endif /* CSVOUTPUTFORMAT_HPP_ */
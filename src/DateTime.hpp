@@ -23,24 +23,21 @@
 #include <stdint.h>
 #include <stddef.h>
 #include <time.h>
-#include <sys/time.h>
 
 
 class DateTime {
 
 public:
-	static void print() {
-		char            fmt[64], buf[64];
-		struct timeval  tv;
-		struct tm       *tm;
-
-		gettimeofday(&tv, NULL);
-		if((tm = localtime(&tv.tv_sec)) != NULL)
-		{
-			strftime(fmt, sizeof fmt, "%Y-%m-%d %H:%M:%S.%%06u", tm);
-			snprintf(buf, sizeof buf, fmt, tv.tv_usec);
-			printf("%s ", buf);
-		}
+	/**
+	 * Returns the current time of the specified clock in nanoseconds.
+	 * Use CLOCK_MONOTONIC for measuring latencies and CLOCK_REALTIME for
+	 * wall clock timestamps.
+	 */
+	static uint64_t nanos(clockid_t clock) {
+		struct timespec ts;
+
+		clock_gettime(clock, &ts);
+		return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
 	};
 };
 
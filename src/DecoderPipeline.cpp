@@ -0,0 +1,284 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <assert.h>
+
+#include "DateTime.hpp"
+#include "Metrics.hpp"
+#include "SerialBitstream.hpp"
+#include "Manchester.hpp"
+#include "SyncStage.hpp"
+#include "EndMarkerStage.hpp"
+#include "DuplicateFilterStage.hpp"
+#include "SerialManchesterStage.hpp"
+#include "PreambleSearchStage.hpp"
+#include "Crc16.hpp"
+#include "Pn9Whitening.hpp"
+
+#include "DecoderPipeline.hpp"
+
+DecoderPipeline::DecoderPipeline() {
+	this->nstages = 0;
+}
+
+DecoderPipeline::~DecoderPipeline() {
+	this->clear();
+}
+
+void DecoderPipeline::clear() {
+	for (int i=0 ; i<this->nstages ; i++) {
+		delete this->stages[i];
+	}
+
+	this->nstages = 0;
+}
+
+int DecoderPipeline::configure(const char* configuration) {
+
+	IDecoderStage* configured[MAX_STAGES];
+	int nconfigured = 0;
+
+	char copy[256];
+	if (strlen(configuration) >= sizeof(copy)) {
+		fprintf(stderr, "Decoder pipeline configuration too long\n");
+		return -1;
+	}
+	strcpy(copy, configuration);
+
+	char* saveptr;
+	for (char* name = strtok_r(copy, ",", &saveptr) ; name != NULL ; name = strtok_r(NULL, ",", &saveptr)) {
+
+		char* argument = strchr(name, '=');
+		if (argument != NULL) {
+			*argument++ = '\0';
+		}
+
+		IDecoderStage* stage = nconfigured < MAX_STAGES ? createStage(name, argument) : NULL;
+		if (stage == NULL) {
+			fprintf(stderr, "Invalid decoder stage %s\n", name);
+			for (int i=0 ; i<nconfigured ; i++) {
+				delete configured[i];
+			}
+			return -1;
+		}
+
+		configured[nconfigured++] = stage;
+	}
+
+	this->clear();
+	for (int i=0 ; i<nconfigured ; i++) {
+		this->add(configured[i]);
+	}
+
+	return 0;
+}
+
+IDecoderStage* DecoderPipeline::createStage(const char* name, const char* argument) {
+
+	if (strcmp(name, "bitstream") == 0 && argument == NULL) {
+		return new SerialBitstream();
+	}
+
+	if (strcmp(name, "manchester") == 0 && argument == NULL) {
+		return new Manchester();
+	}
+
+	if (strcmp(name, "sync") == 0 && argument != NULL) {
+		uint8_t pattern[SyncStage::MAX_PATTERN_BYTES];
+		size_t len = parseBytes(argument, pattern, sizeof(pattern));
+
+		if (len == 0 || *argument != '\0') {
+			return NULL;
+		}
+
+		return new SyncStage(pattern, len);
+	}
+
+	if (strcmp(name, "end") == 0 && argument != NULL) {
+		char* end;
+		long marker = strtol(argument, &end, 16);
+		if (*argument == '\0' || *end != '\0' || marker < 0 || marker > 0xFF) {
+			return NULL;
+		}
+
+		return new EndMarkerStage(marker);
+	}
+
+	if (strcmp(name, "fused") == 0 && argument != NULL) {
+		uint8_t pattern[SyncStage::MAX_PATTERN_BYTES];
+		uint8_t marker;
+
+		size_t len = parseBytes(argument, pattern, sizeof(pattern));
+		if (len == 0 || *argument++ != ':' || parseBytes(argument, &marker, 1) != 1) {
+			return NULL;
+		}
+
+		bool verify = strcmp(argument, ":verify") == 0;
+		if (*argument != '\0' && !verify) {
+			return NULL;
+		}
+
+		return new SerialManchesterStage(pattern, len, marker, verify);
+	}
+
+	if (strcmp(name, "align") == 0 && argument != NULL) {
+		uint8_t pattern[PreambleSearchStage::MAX_PATTERN_BYTES];
+		long maxBitErrors = 0;
+
+		size_t len = parseBytes(argument, pattern, sizeof(pattern));
+		if (len == 0) {
+			return NULL;
+		}
+
+		if (*argument == ':') {
+			char* end;
+			maxBitErrors = strtol(argument + 1, &end, 10);
+			if (argument[1] == '\0' || *end != '\0' || maxBitErrors < 0 || maxBitErrors > PreambleSearchStage::maxBitErrors(len)) {
+				return NULL;
+			}
+		} else if (*argument != '\0') {
+			return NULL;
+		}
+
+		return new PreambleSearchStage(pattern, len, maxBitErrors);
+	}
+
+	if (strcmp(name, "pn9") == 0 && argument == NULL) {
+		return new Pn9Whitening();
+	}
+
+	if (strcmp(name, "crc") == 0 && argument != NULL) {
+		const char* colon = strchr(argument, ':');
+		size_t nameLength = colon != NULL ? (size_t) (colon - argument) : strlen(argument);
+
+		uint16_t polynomial;
+		if (nameLength == 3 && strncmp(argument, "ibm", 3) == 0) {
+			polynomial = Crc16::POLYNOMIAL_IBM;
+		} else if (nameLength == 5 && strncmp(argument, "ccitt", 5) == 0) {
+			polynomial = Crc16::POLYNOMIAL_CCITT;
+		} else {
+			return NULL;
+		}
+
+		long length = 0;
+		if (colon != NULL) {
+			char* end;
+			length = strtol(colon + 1, &end, 10);
+			if (colon[1] == '\0' || *end != '\0' || length <= 0 || length > FrameRecord::MAX_PAYLOAD_BYTES) {
+				return NULL;
+			}
+		}
+
+		return new Crc16(polynomial, length);
+	}
+
+	if (strcmp(name, "dedup") == 0 && argument != NULL) {
+		char* end;
+		long windowMillis = strtol(argument, &end, 10);
+		if (*argument == '\0' || *end != '\0' || windowMillis <= 0 || windowMillis > 3600000) {
+			return NULL;
+		}
+
+		return new DuplicateFilterStage(windowMillis);
+	}
+
+	return NULL;
+}
+
+size_t DecoderPipeline::parseBytes(const char*& text, uint8_t* bytes, size_t maxBytes) {
+
+	size_t len = 0;
+
+	while (len < maxBytes && isxdigit(text[0]) && isxdigit(text[1])) {
+		char hex[3] = { text[0], text[1], '\0' };
+		bytes[len++] = strtol(hex, NULL, 16);
+		text += 2;
+	}
+
+	return len;
+}
+
+void DecoderPipeline::add(IDecoderStage* stage) {
+	assert(this->nstages < MAX_STAGES);
+
+	this->stages[this->nstages] = stage;
+	memset(&this->statistics[this->nstages], 0, sizeof(StageStatistics));
+	this->nstages++;
+}
+
+int DecoderPipeline::run(DecoderBuffer& buffer, FrameRecord& record) {
+
+	for (int i=0 ; i<this->nstages ; i++) {
+		StageStatistics& statistics = this->statistics[i];
+
+		uint64_t start = DateTime::nanos(CLOCK_MONOTONIC);
+		int rc = this->stages[i]->process(buffer, record);
+		statistics.nanos += DateTime::nanos(CLOCK_MONOTONIC) - start;
+		statistics.frames++;
+
+		if (rc < 0) {
+			statistics.rejected++;
+			return -1;
+		}
+	}
+
+	if (buffer.len > (size_t) FrameRecord::MAX_PAYLOAD_BYTES) {
+		// Doesn't fit into the record; counted against the stage that made it
+		if (this->nstages > 0) {
+			this->statistics[this->nstages - 1].rejected++;
+		}
+		return -1;
+	}
+
+	if (buffer.data != record.payload) {
+		memcpy(record.payload, buffer.data, buffer.len);
+	}
+	record.len = buffer.len;
+
+	return 0;
+}
+
+size_t DecoderPipeline::formatMetrics(char* out, size_t maxBytes) {
+
+	static const char* FRAMES = "rfcc1101_decoder_frames_total";
+	static const char* REJECTED = "rfcc1101_decoder_rejected_total";
+
+	char labels[64];
+	size_t len = 0;
+
+	len += Metrics::formatHeader(out + len, maxBytes - len, FRAMES, "counter",
+			"Data frames passed to the stage of the decoder pipeline.");
+	for (int i=0 ; i<this->nstages ; i++) {
+		snprintf(labels, sizeof(labels), "stage=\"%s\",position=\"%d\"", this->stages[i]->getName(), i);
+		len += Metrics::formatSample(out + len, maxBytes - len, FRAMES, labels, this->statistics[i].frames);
+	}
+
+	len += Metrics::formatHeader(out + len, maxBytes - len, REJECTED, "counter",
+			"Data frames rejected by the stage of the decoder pipeline.");
+	for (int i=0 ; i<this->nstages ; i++) {
+		snprintf(labels, sizeof(labels), "stage=\"%s\",position=\"%d\"", this->stages[i]->getName(), i);
+		len += Metrics::formatSample(out + len, maxBytes - len, REJECTED, labels, this->statistics[i].rejected);
+	}
+
+	return len;
+}
@@ -0,0 +1,134 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DECODERPIPELINE_HPP_
+#define DECODERPIPELINE_HPP_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "IDecoderStage.hpp"
+#include "FrameRecord.hpp"
+#include "IMetricsSource.hpp"
+
+/**
+ * Time spent in a decoder stage and number of data frames it rejected.
+ */
+struct StageStatistics {
+	uint64_t frames;
+	uint64_t rejected;
+
+	/** Total time spent in the stage (CLOCK_MONOTONIC, ns) */
+	uint64_t nanos;
+};
+
+/**
+ * Chain of decoder stages that turns the bytes received into the payload
+ * of a record. The stages are configured at runtime, e.g.
+ *
+ *   "bitstream,sync=335553,end=35,manchester"
+ *
+ * Stage names are separated by comma, a stage may take an argument after '='.
+ * All stages work in place on the same buffer; only the final result is
+ * copied into the record, unless a stage put it there already.
+ *
+ * Stages:
+ *   bitstream       Remove start and stop bits, reverse the bit order
+ *   sync=<hex>      Reject data frames not starting with these bytes, strip them
+ *   end=<hex>       Cut off the data frame before the first byte with this value
+ *   manchester      Manchester decode
+ *   dedup=<ms>      Drop data frames repeated within this many milliseconds
+ *   align=<hex>[:<n>] Find the preamble at any bit offset of a serial bitstream,
+ *                   with up to n bits wrong, and shift the bitstream to it
+ *   fused=<sync hex>:<end hex>[:verify]
+ *                   bitstream, sync, end and manchester in a single pass,
+ *                   verify compares the result with the separate stages
+ *   pn9             De-whiten with the PN9 sequence
+ *   crc=ibm|ccitt[:<length>]
+ *                   Reject data frames with wrong CRC-16, which follows
+ *                   length bytes or is at the end, and strip it off
+ */
+class DecoderPipeline : public IMetricsSource {
+
+public:
+	static const int MAX_STAGES = 8;
+
+	DecoderPipeline();
+	~DecoderPipeline();
+
+	/**
+	 * Replaces the stages by the ones configured.
+	 * Returns 0 on success, -1 if the configuration is invalid. The
+	 * pipeline is unchanged then.
+	 */
+	int configure(const char* configuration);
+
+	/**
+	 * Appends a stage. The pipeline takes ownership of the stage.
+	 */
+	void add(IDecoderStage* stage);
+
+	/**
+	 * Passes the bytes through all stages and copies the result into the
+	 * payload of the record.
+	 * Returns 0 on success, -1 if a stage rejected the data frame.
+	 */
+	int run(DecoderBuffer& buffer, FrameRecord& record);
+
+	int getStageCount() {
+		return this->nstages;
+	}
+
+	IDecoderStage* getStage(int index) {
+		return this->stages[index];
+	}
+
+	const StageStatistics& getStatistics(int index) {
+		return this->statistics[index];
+	}
+
+	/**
+	 * Data frames passed to and rejected by each stage, labeled with the
+	 * name and position of the stage.
+	 */
+	virtual size_t formatMetrics(char* out, size_t maxBytes);
+
+private:
+	IDecoderStage* stages[MAX_STAGES];
+	StageStatistics statistics[MAX_STAGES];
+	int nstages;
+
+	void clear();
+
+	/**
+	 * Creates the stage with this name, NULL if the name or argument is
+	 * invalid.
+	 */
+	static IDecoderStage* createStage(const char* name, const char* argument);
+
+	/**
+	 * Parses pairs of hex digits into bytes, up to maxBytes. text is advanced
+	 * to the first character not parsed.
+	 * Returns the number of bytes parsed.
+	 */
+	static size_t parseBytes(const char*& text, uint8_t* bytes, size_t maxBytes);
+};
+
+
+#endif /* DECODERPIPELINE_HPP_ */
@@ -0,0 +1,39 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "DecoderPipelineCommand.hpp"
+
+int DecoderPipelineCommand::execute(ClientConnection* client, const char* parameters) {
+
+	if (*parameters != '\0') {
+		return -1;
+	}
+
+	for (int i=0 ; i<this->pipeline->getStageCount() ; i++) {
+		const StageStatistics& statistics = this->pipeline->getStatistics(i);
+
+		client->respond("DP %s %llu %llu %llu\n",
+				this->pipeline->getStage(i)->getName(),
+				(unsigned long long) statistics.frames,
+				(unsigned long long) statistics.rejected,
+				(unsigned long long) (statistics.frames > 0 ? statistics.nanos / statistics.frames : 0));
+	}
+
+	return 0;
+}
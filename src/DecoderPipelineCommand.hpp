@@ -0,0 +1,48 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DECODERPIPELINECOMMAND_HPP_
+#define DECODERPIPELINECOMMAND_HPP_
+
+#include "AbstractCommand.hpp"
+#include "DecoderPipeline.hpp"
+
+/**
+ * Returns the statistics of the decoder pipeline.
+ *
+ * "DP" returns one line "DP <stage> <frames> <rejected> <ns per frame>"
+ * per stage, in pipeline order.
+ */
+class DecoderPipelineCommand : public AbstractCommand {
+	DecoderPipeline* pipeline;
+
+public:
+	DecoderPipelineCommand(DecoderPipeline* pipeline) {
+		this->pipeline = pipeline;
+	}
+
+	const char* getToken() {
+		return "DP";
+	}
+
+	int execute(ClientConnection* client, const char* parameters);
+};
+
+
+#endif /* DECODERPIPELINECOMMAND_HPP_ */
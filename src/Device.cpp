@@ -20,17 +20,35 @@
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "AddressSpace.hpp"
 #include "DateTime.hpp"
+#include "Log.hpp"
+#include "Metrics.hpp"
+#include "ReceiveLatency.hpp"
 
 #include "Device.hpp"
 
 
-Device::Device(Spi* spi, Gpio* gpio, IDataFrame* dataFrame) {
+Device::Device(Spi* spi, Gpio* gpio, FramePool* framePool) {
 	this->spi = spi;
 	this->gpio = gpio;
-	this->dataFrame = dataFrame;
+	this->dataFrame = NULL;
+
+	this->nprofiles = 0;
+	this->profile = NULL;
+	this->channel = 0;
+
+	this->nsinks = 0;
+	this->sequence = 0;
+	this->transmitQueue = NULL;
+
+	this->framePool = framePool;
+	this->frame.slot = FramePool::NO_SLOT;
+	this->poolExhausted = 0;
+
+	this->flushRx = true;
 }
 
 void Device::reset() {
@@ -43,38 +61,279 @@ void Device::configureRegisters(RegConfiguration* configuration) {
 	this->spi->writeBurst(0x00, configuration->getValues(), 0x2E);
 }
 
-int Device::blockingRead(int otherFd, int timeoutMillis) {
+void Device::addProfile(RadioProfile* profile) {
+	assert(this->nprofiles < MAX_PROFILES);
+
+	this->profiles[this->nprofiles++] = profile;
+}
+
+int Device::selectProfile(const char* name) {
+	for (int i=0 ; i<this->nprofiles ; i++) {
+		if (strcmp(this->profiles[i]->name, name) == 0) {
+			this->spi->readStrobe(STROBE_SIDLE);
+			this->spi->readStrobe(STROBE_SFRX);
+			this->flushRx = true;
+
+			this->profile = this->profiles[i];
+			this->configureRegisters(this->profile->configuration);
+			this->dataFrame = this->profile->dataFrame;
+			this->channel = this->profile->configuration->getValues()[ADDR_CHANNR];
+
+			LOG_INFO("Selected profile %s (channel=%d)\n", this->profile->name, this->channel);
+			return 0;
+		}
+	}
+
+	return -1;
+}
+
+void Device::setChannel(uint8_t channel) {
+	// Registers must only be written in IDLE state.
+	this->spi->readStrobe(STROBE_SIDLE);
+	this->spi->writeSingleByte(ADDR_CHANNR, channel);
+	this->channel = channel;
+	this->flushRx = true;
+
+	LOG_INFO("Selected channel %d\n", channel);
+}
+
+void Device::addSink(IFrameSink* sink) {
+	assert(this->nsinks < MAX_SINKS);
+
+	this->sinks[this->nsinks++] = sink;
+}
+
+void Device::setTransmitQueue(TransmitQueue* transmitQueue) {
+	this->transmitQueue = transmitQueue;
+}
+
+TransmitRequest* Device::queueTransmit(const void* owner) {
+	assert(this->transmitQueue != NULL);
+
+	return this->transmitQueue->push(owner);
+}
+
+void Device::cancelTransmits(const void* owner) {
+	if (this->transmitQueue != NULL) {
+		this->transmitQueue->remove(owner);
+	}
+}
+
+int Device::transmitQueued(ITransmitListener* listener) {
+
+	if (this->transmitQueue == NULL) {
+		return 0;
+	}
+
+	int cnt = 0;
+	TransmitRequest* request;
+	while (cnt < MAX_TRANSMITS_PER_CALL && (request = this->transmitQueue->front()) != NULL) {
+		int rc = this->dataFrame->transmit(request->record);
+		if (rc < 0) {
+			Metrics::increment(Metrics::TRANSMIT_ERRORS);
+			LOG_WARN("Transmitting request %u failed (length=%d)\n", request->id, request->record.len);
+		} else {
+			Metrics::increment(Metrics::FRAMES_TRANSMITTED);
+		}
+
+		listener->transmitted(*request, rc);
+		this->transmitQueue->pop();
+		cnt++;
+	}
+
+	// RX mode is entered again by blockingRead().
+	return cnt;
+}
+
+/**
+ * Passes the data frame received last on to all sinks.
+ */
+void Device::publish() {
+	FrameRecord& record = this->framePool->get(this->frame.slot);
+	record.sequence = ++this->sequence;
+
+	this->framePool->describe(this->frame.slot, this->frame);
+
+	Metrics::increment(Metrics::FRAMES_RECEIVED);
+	Metrics::add(Metrics::BYTES_RECEIVED, record.len);
+
+	for (int i=0 ; i<this->nsinks ; i++) {
+		this->sinks[i]->publishFrame(this->framePool, this->frame);
+	}
+}
+
+/**
+ * Receives the data frame in the RX FIFO into a free slot.
+ * Returns 0 on success, -1 on error.
+ */
+int Device::receiveFrame() {
+
+	// The consumers are done with the data frame received before
+	if (this->frame.slot != FramePool::NO_SLOT) {
+		this->framePool->release(this->frame.slot);
+		this->frame.slot = FramePool::NO_SLOT;
+	}
+
+	int32_t slot = this->framePool->acquire();
+	if (slot == FramePool::NO_SLOT) {
+		this->poolExhausted++;
+		Metrics::increment(Metrics::FRAME_POOL_EXHAUSTED);
+
+		LOG_WARN("No free frame slot. Dropping data frame (dropped=%llu)\n",
+				(unsigned long long) this->poolExhausted);
+
+		this->spi->readStrobe(STROBE_SIDLE);
+		this->spi->readStrobe(STROBE_SFRX);
+		return -1;
+	}
+
+	// Set before decoding, the decoder stages may look at the receive time
+	FrameRecord& record = this->framePool->get(slot);
+	record.timestamp = DateTime::nanos(CLOCK_REALTIME);
+	record.monotonic = DateTime::nanos(CLOCK_MONOTONIC);
+
+	int rc = this->dataFrame->receive(record);
+	if (rc < 0) {
+		Metrics::increment(Metrics::RECEIVE_ERRORS);
+		this->flushRx = true;
+
+		if (rc == IDataFrame::CRC_ERROR) {
+			record.sequence = this->sequence;
+
+			for (int i=0 ; i<this->nsinks ; i++) {
+				this->sinks[i]->publishCrcError(record);
+			}
+		}
+
+		this->framePool->release(slot);
+		return -1;
+	}
+
+	ReceiveLatency::mark(LATENCY_DECODED);
+
+	this->frame.slot = slot;
+	return 0;
+}
+
+/**
+ * Returns the time to wait for incoming data, limited by the sinks that
+ * want to be flushed before.
+ */
+int Device::sinkTimeout(int timeoutMillis) {
+	for (int i=0 ; i<this->nsinks ; i++) {
+		int t = this->sinks[i]->flushTimeout();
+		if (t >= 0 && (timeoutMillis < 0 || t < timeoutMillis)) {
+			timeoutMillis = t;
+		}
+	}
 
-	assert(otherFd >= 0);
+	return timeoutMillis;
+}
+
+/**
+ * Flushes all sinks that are due.
+ */
+void Device::flushSinks() {
+	for (int i=0 ; i<this->nsinks ; i++) {
+		if (this->sinks[i]->flushTimeout() == 0) {
+			this->sinks[i]->flush();
+		}
+	}
+}
+
+/**
+ * Enters RX mode, unless the RF module is receiving already or holds a
+ * data frame that wasn't read yet. The RX FIFO is only flushed after an
+ * error or when the receiver stopped, so a data frame that started
+ * arriving while the sockets were served is not lost.
+ */
+void Device::startReceiving() {
+
+	if (!this->flushRx) {
+		// GDO2 asserted: A data frame is waiting (or the RX FIFO overflowed
+		// in FIFO overflow mode, which is how those data frames are read)
+		char pin = '0';
+		this->gpio->getPinValue(&pin, 1);
+		if (pin == '1') {
+			return;
+		}
+
+		// RXBYTES may be wrong while it changes, read until it is stable
+		uint8_t rxBytes;
+		uint8_t again;
+		uint8_t status;
+		do {
+			status = this->spi->readBurst(ADDR_RX_BYTES, &rxBytes, 1);
+			this->spi->readBurst(ADDR_RX_BYTES, &again, 1);
+		} while (rxBytes != again);
+
+		if ((status & CHIP_STATE_MASK) == CHIP_STATE_RX && (rxBytes & 0x80) == 0) {
+			return; // Receiving, maybe in the middle of a data frame
+		}
+	}
+
+	this->spi->readStrobe(STROBE_SFRX); // Flush the RX FIFO
+	this->spi->readStrobe(STROBE_SRX);  // Enable RX mode
+	this->flushRx = false;
+}
+
+int Device::blockingRead(struct pollfd otherFds[], int nOtherFds, int timeoutMillis) {
+
+	uint64_t deadline = DateTime::nanos(CLOCK_MONOTONIC) + timeoutMillis * 1000000ULL;
 
 	while(true) {
-		spi->readStrobe(STROBE_SFRX); // Flush the RX FIFO
-		spi->readStrobe(STROBE_SRX);  // Enable RX mode
+		startReceiving();
+
+		LOG_DEBUG("Waiting for incoming data ...\n");
+
+		int rc;
+		while (true) {
+			uint64_t now = DateTime::nanos(CLOCK_MONOTONIC);
+			int remaining = now < deadline ? (deadline - now + 999999) / 1000000 : 0;
+
+			rc = gpio->waitForPinValueChange(sinkTimeout(remaining), otherFds, nOtherFds);
+
+			flushSinks();
 
-		DateTime::print();
-		printf("Waiting for incoming data ...\n");
+			// Signals interrupt the wait
+			ReceiveLatency::dumpIfRequested();
+
+			// Sinks that needed to be flushed may have cut the wait short.
+			if (rc != 0 || DateTime::nanos(CLOCK_MONOTONIC) >= deadline) {
+				break;
+			}
+		}
 
-		int rc = gpio->waitForPinValueChange(timeoutMillis, otherFd);
 		if ( rc > 0) {
 			// GPIO input pin raised -> data available
+			ReceiveLatency::mark(LATENCY_EDGE);
+
 			assert(this->dataFrame != NULL);
-			if (this->dataFrame->receive() < 0) {
+			if (receiveFrame() < 0) {
 				// Some kind of error reading and decoding data.
-				// Just ignore and try to read the next incoming message.
+				// Just ignore and try to read the next incoming message,
+				// unless the sockets have to be served first.
+				for (int i=0 ; i<nOtherFds ; i++) {
+					if (otherFds[i].revents != 0) {
+						return -1;
+					}
+				}
 			} else {
+				publish();
 				return rc;
 			}
 		} else if (rc == 0) {
 			// Timeout. Nothing received.
+			if (timeoutMillis > 0) {
+				Metrics::increment(Metrics::RECEIVE_TIMEOUTS);
+			}
 
-			DateTime::print();
-			printf("Timeout.\n");
+			LOG_DEBUG("Timeout.\n");
 			return rc;
 		} else {
 			// Some event on other file descriptor (socket fd)
 
-			DateTime::print();
-			printf("Event on socket.\n");
+			LOG_DEBUG("Event on socket.\n");
 
 			return rc;
 		}
@@ -24,6 +24,11 @@
 #include "Gpio.hpp"
 #include "RegConfiguration.hpp"
 #include "IDataFrame.hpp"
+#include "IFrameSink.hpp"
+#include "FrameRecord.hpp"
+#include "RadioProfile.hpp"
+#include "TransmitQueue.hpp"
+#include "FramePool.hpp"
 
 /**
  * Represents a CC1101 based RF communication module.
@@ -32,15 +37,140 @@ class Device {
 	Spi* spi;
 	Gpio* gpio;
 
+	static const int MAX_SINKS = 8;
+	static const int MAX_PROFILES = 8;
+
+	/** Register configurations and data frame formats to choose from */
+	RadioProfile* profiles[MAX_PROFILES];
+	int nprofiles;
+	RadioProfile* profile;
+
+	/** Channel number currently configured */
+	uint8_t channel;
+
+	/** Outputs that get a copy of every data frame received */
+	IFrameSink* sinks[MAX_SINKS];
+	int nsinks;
+
+	/** Sequence number of the data frame received last */
+	uint32_t sequence;
+
+	/** Slots data frames are received into */
+	FramePool* framePool;
+
+	/** Data frame received last, holds a reference to its slot */
+	FrameDescriptor frame;
+
+	/** Data frames lost because no slot was free */
+	uint64_t poolExhausted;
+
+	/** Data frames waiting to be transmitted */
+	TransmitQueue* transmitQueue;
+
+	/** The RX FIFO holds nothing worth keeping, e.g. after an error */
+	bool flushRx;
+
+	void startReceiving();
+	int receiveFrame();
+	void publish();
+	int sinkTimeout(int timeoutMillis);
+	void flushSinks();
+
 public:
 	IDataFrame* dataFrame;
 
-	Device(Spi* spi, Gpio* gpio, IDataFrame* dataFrame);
+	Device(Spi* spi, Gpio* gpio, FramePool* framePool);
 
 	void reset();
 	void configureRegisters(RegConfiguration* configuration);
 
-	int blockingRead(int otherFD, int timeoutMillis);
+	/**
+	 * Adds a profile that can be selected with selectProfile().
+	 */
+	void addProfile(RadioProfile* profile);
+
+	/**
+	 * Configures the registers and the data frame format of the profile.
+	 * Can be called at any time while not waiting in blockingRead().
+	 * Returns 0 on success, -1 if there is no profile with this name.
+	 */
+	int selectProfile(const char* name);
+
+	int getProfileCount() { return this->nprofiles; };
+	RadioProfile* getProfile(int index) { return this->profiles[index]; };
+	RadioProfile* getCurrentProfile() { return this->profile; };
+
+	/**
+	 * Changes the channel number. The frequency synthesizer is calibrated
+	 * when RX mode is entered the next time.
+	 */
+	void setChannel(uint8_t channel);
+	uint8_t getChannel() { return this->channel; };
+
+	/**
+	 * Returns the descriptor of the data frame received last. The slot is
+	 * valid until the next call of blockingRead(); consumers that keep the
+	 * data frame longer must retain the slot in the frame pool.
+	 */
+	const FrameDescriptor& getFrame() { return this->frame; };
+
+	/**
+	 * Returns the data frame received last, independent of the data
+	 * frame format.
+	 */
+	const FrameRecord& getRecord() { return this->framePool->get(this->frame.slot); };
+
+	FramePool* getFramePool() { return this->framePool; };
+
+	/**
+	 * Adds an output that gets a copy of every data frame received.
+	 */
+	void addSink(IFrameSink* sink);
+
+	/**
+	 * Sets the queue for data frames to be transmitted.
+	 */
+	void setTransmitQueue(TransmitQueue* transmitQueue);
+	TransmitQueue* getTransmitQueue() { return this->transmitQueue; };
+
+	/**
+	 * Queues a data frame to be transmitted by transmitQueued().
+	 * Returns the request to fill in the addresses and payload, or NULL if
+	 * the queue is full.
+	 */
+	TransmitRequest* queueTransmit(const void* owner);
+
+	/**
+	 * Drops the data frames of an owner that were not transmitted yet.
+	 */
+	void cancelTransmits(const void* owner);
+
+	/** Data frames transmitted per call of transmitQueued() */
+	static const int MAX_TRANSMITS_PER_CALL = 4;
+
+	/**
+	 * Transmits up to MAX_TRANSMITS_PER_CALL queued data frames, using the
+	 * current data frame format, and reports the result of each one to the
+	 * listener. The rest waits for the next call, so a full queue doesn't
+	 * hold up receiving and the clients.
+	 * Returns the number of data frames transmitted.
+	 */
+	int transmitQueued(ITransmitListener* listener);
+
+	/**
+	 * Returns true if data frames are waiting for transmitQueued().
+	 */
+	bool hasQueuedTransmits() {
+		return this->transmitQueue != NULL && this->transmitQueue->size() > 0;
+	};
+
+	/**
+	 * Waits for incoming data and receives it using the data frame.
+	 * Returns 1 if a data frame was received, 0 on timeout and -1 if there
+	 * was an event on one of the other file descriptors. Events that came
+	 * together with the data frame are in the revents fields as well.
+	 */
+	int blockingRead(struct pollfd otherFds[], int nOtherFds, int timeoutMillis);
 };
 
 #endif /* DEVICE_HPP_ */
@@ -0,0 +1,81 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "DuplicateFilterStage.hpp"
+
+DuplicateFilterStage::DuplicateFilterStage(int windowMillis) {
+	this->window = (uint64_t) windowMillis * 1000000;
+
+	memset(this->table, 0, sizeof(this->table));
+}
+
+/**
+ * 64 bit FNV-1a hash of the source address, the length and the payload.
+ */
+uint64_t DuplicateFilterStage::hash(uint8_t srcAddress, const uint8_t* data, size_t len) {
+
+	uint64_t h = 0xCBF29CE484222325ULL;
+
+	h = (h ^ srcAddress) * 0x100000001B3ULL;
+	h = (h ^ (len & 0xFF)) * 0x100000001B3ULL;
+	h = (h ^ (len >> 8)) * 0x100000001B3ULL;
+
+	for (size_t i=0 ; i<len ; i++) {
+		h = (h ^ data[i]) * 0x100000001B3ULL;
+	}
+
+	return h;
+}
+
+int DuplicateFilterStage::process(DecoderBuffer& buffer, FrameRecord& record) {
+
+	uint64_t h = hash(record.srcAddress, buffer.data, buffer.len);
+	uint64_t now = record.monotonic;
+
+	Entry* free = NULL;
+	Entry* oldest = NULL;
+
+	for (int i=0 ; i<MAX_PROBES ; i++) {
+		Entry* entry = &this->table[(h + i) & (TABLE_SIZE - 1)];
+		bool expired = entry->seen == 0 || now - entry->seen >= this->window;
+
+		if (!expired && entry->hash == h) {
+			// Repeated copy. The window runs from the first copy, so a
+			// sender repeating the same payload is passed once per window.
+			return -1;
+		}
+
+		if (expired && free == NULL) {
+			free = entry;
+		}
+
+		if (oldest == NULL || entry->seen < oldest->seen) {
+			oldest = entry;
+		}
+	}
+
+	Entry* entry = free != NULL ? free : oldest;
+	entry->hash = h;
+	entry->seen = now;
+
+	return 0;
+}
@@ -0,0 +1,79 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DUPLICATEFILTERSTAGE_HPP_
+#define DUPLICATEFILTERSTAGE_HPP_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "IDecoderStage.hpp"
+
+/**
+ * Decoder stage that drops data frames repeated within a time window.
+ * Many devices, e.g. HR80 radiator controllers, send every message several
+ * times in quick succession; only the first copy is passed on.
+ *
+ * Source address, length and payload are hashed into a small open
+ * addressing table. Entries older than the window count as free, so the
+ * table never needs to be cleaned up. Place the stage after the stages
+ * that decode the payload.
+ *
+ * Time is taken from the receive time of the records, so a replayed
+ * capture is filtered as it was when it was received.
+ */
+class DuplicateFilterStage : public IDecoderStage {
+
+public:
+	/** Number of different data frames remembered, must be a power of 2 */
+	static const int TABLE_SIZE = 64;
+
+	/** Entries probed for a hash before the oldest one is replaced */
+	static const int MAX_PROBES = 8;
+
+	DuplicateFilterStage(int windowMillis);
+
+	virtual const char* getName() {
+		return "dedup";
+	}
+
+	/**
+	 * Returns -1 if the same data frame was passed within the window.
+	 * Dropped copies do not extend the window. They are counted as the
+	 * stage's rejected data frames (see StageStatistics and "DP").
+	 */
+	virtual int process(DecoderBuffer& buffer, FrameRecord& record);
+
+private:
+	struct Entry {
+		uint64_t hash;
+
+		/** Receive time of the copy passed on (FrameRecord::monotonic), 0 if never */
+		uint64_t seen;
+	};
+
+	uint64_t window;
+
+	Entry table[TABLE_SIZE];
+
+	static uint64_t hash(uint8_t srcAddress, const uint8_t* data, size_t len);
+};
+
+
+#endif /* DUPLICATEFILTERSTAGE_HPP_ */
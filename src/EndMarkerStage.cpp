@@ -0,0 +1,46 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "Log.hpp"
+
+#include "EndMarkerStage.hpp"
+
+EndMarkerStage::EndMarkerStage(uint8_t marker) {
+	this->marker = marker;
+}
+
+int EndMarkerStage::process(DecoderBuffer& buffer, FrameRecord& record) {
+
+	const uint8_t* end = (const uint8_t*) memchr(buffer.data, this->marker, buffer.len);
+	if (end == NULL) {
+		LOG_WARN("ERROR: Cannot find message end marker.\n");
+		return -1;
+	}
+
+	if (end == buffer.data) {
+		return -1;
+	}
+
+	buffer.len = end - buffer.data;
+
+	return 0;
+}
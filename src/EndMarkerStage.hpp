@@ -0,0 +1,51 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ENDMARKERSTAGE_HPP_
+#define ENDMARKERSTAGE_HPP_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "IDecoderStage.hpp"
+
+/**
+ * Decoder stage for data frames without length byte, that are terminated
+ * by a marker byte instead, e.g. the RF postamble 0x35 of HR80 radiator
+ * controllers. Whatever follows the marker is cut off, as well as the
+ * marker itself. Data frames without marker or with nothing before the
+ * marker are rejected.
+ */
+class EndMarkerStage : public IDecoderStage {
+
+public:
+	EndMarkerStage(uint8_t marker);
+
+	virtual const char* getName() {
+		return "end";
+	}
+
+	virtual int process(DecoderBuffer& buffer, FrameRecord& record);
+
+private:
+	uint8_t marker;
+};
+
+
+#endif /* ENDMARKERSTAGE_HPP_ */
@@ -24,6 +24,7 @@
 
 #include "AddressSpace.hpp"
 #include "DateTime.hpp"
+#include "ReceiveLatency.hpp"
 
 #include "FifoOverflowProtocol.hpp"
 
@@ -47,6 +48,7 @@ int FifoOverflowProtocol::receive(uint8_t buffer[], size_t& nbytes) {
 
 	// Read the complete RX FIFO buffer
 	this->spi->readBurst(ADDR_RXTX_FIFO, fifo, FIFO_LENGTH);
+	ReceiveLatency::mark(LATENCY_FIFO_READ);
 
 	memcpy(buffer, fifo, FIFO_LENGTH);
 	nbytes = FIFO_LENGTH;
@@ -60,6 +62,7 @@ int FifoOverflowProtocol::receive(uint8_t buffer[], size_t& nbytes) {
 	uint8_t buffer_lqi[1];
 	this->spi->readBurst(ADDR_LQI, buffer_lqi, 1);
 	buffer[nbytes++] = buffer_lqi[0];
+	ReceiveLatency::mark(LATENCY_DRAINED);
 
 	return 0;
 }
@@ -0,0 +1,89 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "FilterCommand.hpp"
+
+/**
+ * Parses a hex address or '*' for any address.
+ * Returns -2 if the address is invalid.
+ */
+static int parseAddress(const char* s) {
+
+	if (strcmp(s, "*") == 0) {
+		return ClientConnection::ANY_ADDRESS;
+	}
+
+	char* end;
+	long address = strtol(s, &end, 16);
+	if (*s == '\0' || *end != '\0' || address < 0 || address > 0xFF) {
+		return -2;
+	}
+
+	return address;
+}
+
+static void printAddress(char* buf, size_t len, int address) {
+	if (address == ClientConnection::ANY_ADDRESS) {
+		snprintf(buf, len, "*");
+	} else {
+		snprintf(buf, len, "%.2X", address);
+	}
+}
+
+int FilterCommand::execute(ClientConnection* client, const char* parameters) {
+
+	if (*parameters == '\0') {
+		char src[4], dest[4];
+		printAddress(src, sizeof(src), client->srcFilter);
+		printAddress(dest, sizeof(dest), client->destFilter);
+		client->respond("FI SRC %s DST %s\n", src, dest);
+		return 0;
+	}
+
+	if (strcasecmp(parameters, "OFF") == 0) {
+		client->srcFilter = ClientConnection::ANY_ADDRESS;
+		client->destFilter = ClientConnection::ANY_ADDRESS;
+		return 0;
+	}
+
+	if (strncasecmp(parameters, "SRC ", 4) == 0) {
+		int address = parseAddress(parameters + 4);
+		if (address < -1) {
+			return -1;
+		}
+		client->srcFilter = address;
+		return 0;
+	}
+
+	if (strncasecmp(parameters, "DST ", 4) == 0) {
+		int address = parseAddress(parameters + 4);
+		if (address < -1) {
+			return -1;
+		}
+		client->destFilter = address;
+		return 0;
+	}
+
+	return -1;
+}
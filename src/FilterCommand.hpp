@@ -0,0 +1,46 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FILTERCOMMAND_HPP_
+#define FILTERCOMMAND_HPP_
+
+#include "AbstractCommand.hpp"
+
+/**
+ * Restricts the data frames written to the client by address.
+ *
+ * "FI SRC <address>" only passes frames from this source address,
+ * "FI DST <address>" only frames to this destination address (hex).
+ * "FI SRC *" resp. "FI DST *" removes the filter, "FI OFF" removes all
+ * filters and "FI" returns the current filters.
+ *
+ * Data frame formats without addresses do not pass any address filter.
+ */
+class FilterCommand : public AbstractCommand {
+
+public:
+	const char* getToken() {
+		return "FI";
+	}
+
+	int execute(ClientConnection* client, const char* parameters);
+};
+
+
+#endif /* FILTERCOMMAND_HPP_ */
@@ -0,0 +1,65 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FrameFields.hpp"
+
+const char* FrameFields::typeName(uint8_t frameType) {
+
+	switch (frameType) {
+	case FRAME_TYPE_RFBEE:
+		return "rfbee";
+	case FRAME_TYPE_RAW:
+		return "raw";
+	case FRAME_TYPE_RADIATORCONTROLLER:
+		return "radiator";
+	default:
+		return "unknown";
+	}
+}
+
+void FrameFields::visit(const FrameRecord& record, IFieldVisitor& visitor) {
+
+	visitor.visitUnsigned("seq", record.sequence);
+	visitor.visitUnsigned("ts", record.timestamp);
+	visitor.visitString("type", typeName(record.frameType));
+
+	if ((record.flags & FRAME_FLAG_ADDRESS) != 0) {
+		visitor.visitUnsigned("src", record.srcAddress);
+		visitor.visitUnsigned("dst", record.destAddress);
+	} else {
+		visitor.visitMissing("src");
+		visitor.visitMissing("dst");
+	}
+
+	if ((record.flags & FRAME_FLAG_RSSI_LQI) != 0) {
+		visitor.visitSigned("rssi", decodeRssi(record.rssi));
+		visitor.visitUnsigned("lqi", record.lqi);
+	} else {
+		visitor.visitMissing("rssi");
+		visitor.visitMissing("lqi");
+	}
+
+	visitor.visitBool("crc", (record.flags & FRAME_FLAG_CRC_OK) != 0);
+
+	size_t len = record.len;
+	if (len > FrameRecord::MAX_PAYLOAD_BYTES) {
+		len = FrameRecord::MAX_PAYLOAD_BYTES;
+	}
+	visitor.visitBytes("payload", record.payload, len);
+}
@@ -0,0 +1,78 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FRAMEFIELDS_HPP_
+#define FRAMEFIELDS_HPP_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "FrameRecord.hpp"
+
+/**
+ * Gets the fields of a record one after the other, see FrameFields.
+ */
+class IFieldVisitor {
+
+public:
+	virtual ~IFieldVisitor() {};
+
+	virtual void visitUnsigned(const char* name, uint64_t value) = 0;
+	virtual void visitSigned(const char* name, int64_t value) = 0;
+	virtual void visitBool(const char* name, bool value) = 0;
+	virtual void visitString(const char* name, const char* value) = 0;
+	virtual void visitBytes(const char* name, const uint8_t data[], size_t len) = 0;
+
+	/**
+	 * The field is not available for this data frame format,
+	 * e.g. the addresses of raw data frames.
+	 */
+	virtual void visitMissing(const char* name) = 0;
+};
+
+/**
+ * Describes the fields of a record, so output formats don't need to know
+ * about the record layout and the flags.
+ *
+ * The fields are always visited in this order:
+ *
+ * seq:     Sequence number (unsigned)
+ * ts:      Wall clock time received, ns since the epoch (unsigned)
+ * type:    Data frame format, "rfbee", "raw" or "radiator" (string)
+ * src:     Source address (unsigned, may be missing)
+ * dst:     Destination address (unsigned, may be missing)
+ * rssi:    Received signal strength in dBm (signed, may be missing)
+ * lqi:     Link quality indicator (unsigned, may be missing)
+ * crc:     The receiver checked the CRC and it was correct (bool)
+ * payload: Payload (bytes)
+ */
+class FrameFields {
+
+public:
+	static const int FIELD_COUNT = 9;
+
+	static void visit(const FrameRecord& record, IFieldVisitor& visitor);
+
+	/**
+	 * Returns the name of the data frame format of a record.
+	 */
+	static const char* typeName(uint8_t frameType);
+};
+
+#endif /* FRAMEFIELDS_HPP_ */
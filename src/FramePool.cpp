@@ -0,0 +1,111 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <new>
+#include <assert.h>
+
+#include "FramePool.hpp"
+
+FramePool::FramePool(int nslots) {
+	assert(nslots > 0);
+
+	void* memory;
+	if (posix_memalign(&memory, 64, nslots * sizeof(Slot)) != 0) {
+		perror("Allocating frame pool");
+		exit(1);
+	}
+
+	this->slots = new (memory) Slot[nslots];
+	this->nslots = nslots;
+	this->freeList = NO_SLOT;
+
+	for (int32_t i=nslots-1 ; i>=0 ; i--) {
+		this->slots[i].refs = 0;
+		this->slots[i].next = this->freeList;
+		this->freeList = i;
+	}
+
+	this->available = nslots;
+	pthread_mutex_init(&this->mutex, NULL);
+}
+
+FramePool::~FramePool() {
+	pthread_mutex_destroy(&this->mutex);
+	free(this->slots);
+}
+
+int32_t FramePool::acquire() {
+
+	pthread_mutex_lock(&this->mutex);
+
+	int32_t slot = this->freeList;
+	if (slot != NO_SLOT) {
+		this->freeList = this->slots[slot].next;
+		__atomic_store_n(&this->available, this->available - 1, __ATOMIC_RELAXED);
+		__atomic_store_n(&this->slots[slot].refs, 1, __ATOMIC_RELAXED);
+	}
+
+	pthread_mutex_unlock(&this->mutex);
+
+	return slot;
+}
+
+void FramePool::retain(int32_t slot) {
+	assert(slot >= 0 && slot < this->nslots);
+	assert(this->slots[slot].refs > 0);
+
+	__atomic_add_fetch(&this->slots[slot].refs, 1, __ATOMIC_RELAXED);
+}
+
+bool FramePool::retainSpare(int32_t slot, int reserve) {
+	if (getAvailable() <= reserve) {
+		return false;
+	}
+
+	retain(slot);
+	return true;
+}
+
+void FramePool::release(int32_t slot) {
+	assert(slot >= 0 && slot < this->nslots);
+	assert(this->slots[slot].refs > 0);
+
+	if (__atomic_sub_fetch(&this->slots[slot].refs, 1, __ATOMIC_ACQ_REL) == 0) {
+		pthread_mutex_lock(&this->mutex);
+		this->slots[slot].next = this->freeList;
+		this->freeList = slot;
+		__atomic_store_n(&this->available, this->available + 1, __ATOMIC_RELAXED);
+		pthread_mutex_unlock(&this->mutex);
+	}
+}
+
+void FramePool::describe(int32_t slot, FrameDescriptor& descriptor) {
+
+	const FrameRecord& record = this->slots[slot].record;
+
+	descriptor.slot = slot;
+	descriptor.sequence = record.sequence;
+	descriptor.len = record.len;
+	descriptor.frameType = record.frameType;
+	descriptor.flags = record.flags;
+	descriptor.srcAddress = record.srcAddress;
+	descriptor.destAddress = record.destAddress;
+}
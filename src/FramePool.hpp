@@ -0,0 +1,118 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FRAMEPOOL_HPP_
+#define FRAMEPOOL_HPP_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+
+#include "FrameRecord.hpp"
+
+/**
+ * Refers to a data frame in a FramePool. Small enough to be passed by
+ * value; carries the fields needed to decide whether a consumer wants the
+ * data frame at all, without touching the slot.
+ */
+struct FrameDescriptor {
+	/** Slot in the pool, NO_SLOT if the descriptor is empty */
+	int32_t slot;
+
+	uint32_t sequence;
+	uint16_t len;
+	uint8_t frameType;
+	uint8_t flags;
+	uint8_t srcAddress;
+	uint8_t destAddress;
+};
+
+/**
+ * Fixed number of slots for data frames, allocated once at startup.
+ *
+ * A data frame is received into a free slot and stays there while it is
+ * decoded, filtered, formatted and written. Every consumer that keeps the
+ * data frame beyond the current call holds a reference; the slot is
+ * reused after the last one released it.
+ *
+ * Slots are cache line aligned, so neighbouring data frames don't share
+ * cache lines.
+ *
+ * Slots are acquired by the receiving thread only. References may be
+ * retained and released by any thread, e.g. by a sink that hands the
+ * data frame to its background thread.
+ */
+class FramePool {
+
+public:
+	static const int32_t NO_SLOT = -1;
+	static const int DEFAULT_SLOT_COUNT = 64;
+
+	FramePool(int nslots);
+	~FramePool();
+
+	/**
+	 * Takes a free slot, with a single reference.
+	 * Returns the slot, or NO_SLOT if all slots are in use.
+	 */
+	int32_t acquire();
+
+	void retain(int32_t slot);
+
+	/**
+	 * Adds a reference unless no more than reserve slots are free, so that
+	 * a consumer keeping many data frames can't starve receiving.
+	 * Returns true if the reference was added.
+	 */
+	bool retainSpare(int32_t slot, int reserve);
+
+	/**
+	 * Drops a reference. The slot is free again when it was the last one.
+	 */
+	void release(int32_t slot);
+
+	FrameRecord& get(int32_t slot) {
+		return this->slots[slot].record;
+	}
+
+	/**
+	 * Fills a descriptor from the record in a slot.
+	 */
+	void describe(int32_t slot, FrameDescriptor& descriptor);
+
+	int getSlotCount() { return this->nslots; };
+	int getAvailable() { return __atomic_load_n(&this->available, __ATOMIC_RELAXED); };
+
+private:
+	struct Slot {
+		FrameRecord record;
+		int refs;
+		int32_t next;
+	} __attribute__((aligned(64)));
+
+	Slot* slots;
+	int nslots;
+
+	/** First free slot, free slots are linked by next. Guarded by the mutex. */
+	int32_t freeList;
+	int available;
+	pthread_mutex_t mutex;
+};
+
+#endif /* FRAMEPOOL_HPP_ */
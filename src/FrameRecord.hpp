@@ -0,0 +1,97 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FRAMERECORD_HPP_
+#define FRAMERECORD_HPP_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/** Data frame format that decoded the record. */
+static const uint8_t FRAME_TYPE_RFBEE              = 1;
+static const uint8_t FRAME_TYPE_RAW                = 2;
+static const uint8_t FRAME_TYPE_RADIATORCONTROLLER = 3;
+
+/** Record contains valid source and destination addresses. */
+static const uint8_t FRAME_FLAG_ADDRESS = 0x01;
+/** Record contains valid RSSI and LQI values. */
+static const uint8_t FRAME_FLAG_RSSI_LQI = 0x02;
+/** The receiver checked the CRC and it was correct. */
+static const uint8_t FRAME_FLAG_CRC_OK = 0x04;
+
+/**
+ * Binary representation of a received data frame, independent of the
+ * data frame format that decoded it.
+ *
+ * Records are published to all frame sinks (shared memory, network, ...).
+ * The layout is fixed size and contains no pointers, so it may be copied
+ * into shared memory or sent over the wire as it is.
+ */
+struct FrameRecord {
+	static const int MAX_PAYLOAD_BYTES = 256;
+
+	/** Incremented for every frame received, used to detect lost records. */
+	uint32_t sequence;
+
+	/** One of the FRAME_TYPE_* constants. */
+	uint8_t frameType;
+
+	/** Combination of the FRAME_FLAG_* constants. */
+	uint8_t flags;
+
+	uint8_t srcAddress;
+	uint8_t destAddress;
+
+	/** Received Signal Strength Indicator, as reported by the CC1101. */
+	uint8_t rssi;
+
+	/** Link Quality Indicator, CRC bit stripped off. */
+	uint8_t lqi;
+
+	/** Number of valid bytes in payload. */
+	uint16_t len;
+
+	/** Wall clock time when the frame was received (CLOCK_REALTIME, ns). */
+	uint64_t timestamp;
+
+	/**
+	 * Time when the frame was received (CLOCK_MONOTONIC, ns).
+	 * Consumers on the same host can use this to measure the latency.
+	 */
+	uint64_t monotonic;
+
+	uint8_t payload[MAX_PAYLOAD_BYTES];
+};
+
+/**
+ * Converts the RSSI value added by the CC1101 receiver to dBm.
+ */
+static inline int decodeRssi(uint8_t rssiEnc) {
+	int rssi;
+
+	if (rssiEnc >= 128) {
+		rssi = (rssiEnc - 256) >> 1;
+	} else {
+		rssi = rssiEnc >> 1;
+	}
+
+	return rssi - 74;
+}
+
+#endif /* FRAMERECORD_HPP_ */
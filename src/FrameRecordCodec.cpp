@@ -0,0 +1,91 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "FrameRecordCodec.hpp"
+
+static inline void put16(uint8_t* p, uint16_t v) {
+	p[0] = v >> 8;
+	p[1] = v;
+}
+
+static inline void put32(uint8_t* p, uint32_t v) {
+	put16(p, v >> 16);
+	put16(p + 2, v);
+}
+
+static inline void put64(uint8_t* p, uint64_t v) {
+	put32(p, v >> 32);
+	put32(p + 4, v);
+}
+
+static inline uint16_t get16(const uint8_t* p) {
+	return (p[0] << 8) | p[1];
+}
+
+static inline uint32_t get32(const uint8_t* p) {
+	return ((uint32_t) get16(p) << 16) | get16(p + 2);
+}
+
+static inline uint64_t get64(const uint8_t* p) {
+	return ((uint64_t) get32(p) << 32) | get32(p + 4);
+}
+
+size_t FrameRecordCodec::encode(const FrameRecord& record, uint8_t* buffer) {
+
+	put32(buffer, record.sequence);
+	put64(buffer + 4, record.timestamp);
+	buffer[12] = record.frameType;
+	buffer[13] = record.flags;
+	buffer[14] = record.srcAddress;
+	buffer[15] = record.destAddress;
+	buffer[16] = record.rssi;
+	buffer[17] = record.lqi;
+	put16(buffer + 18, record.len);
+	memcpy(buffer + HEADER_BYTES, record.payload, record.len);
+
+	return HEADER_BYTES + record.len;
+}
+
+size_t FrameRecordCodec::decode(const uint8_t* buffer, size_t len, FrameRecord& record) {
+
+	if (len < HEADER_BYTES) {
+		return 0;
+	}
+
+	uint16_t payloadLength = get16(buffer + 18);
+	if (payloadLength > FrameRecord::MAX_PAYLOAD_BYTES || len < HEADER_BYTES + payloadLength) {
+		return 0;
+	}
+
+	record.sequence = get32(buffer);
+	record.timestamp = get64(buffer + 4);
+	record.monotonic = 0; // Not transferred, meaningless on other hosts
+	record.frameType = buffer[12];
+	record.flags = buffer[13];
+	record.srcAddress = buffer[14];
+	record.destAddress = buffer[15];
+	record.rssi = buffer[16];
+	record.lqi = buffer[17];
+	record.len = payloadLength;
+	memcpy(record.payload, buffer + HEADER_BYTES, payloadLength);
+
+	return HEADER_BYTES + payloadLength;
+}
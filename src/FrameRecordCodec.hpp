@@ -0,0 +1,74 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FRAMERECORDCODEC_HPP_
+#define FRAMERECORDCODEC_HPP_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "FrameRecord.hpp"
+
+/**
+ * Encodes/Decodes frame records into a compact, portable binary format
+ * that is used to send records over the network.
+ *
+ * All fields are in network byte order (big endian):
+ *
+ * Byte 0-3:   Sequence number
+ * Byte 4-11:  Timestamp (ns since the epoch)
+ * Byte 12:    Frame type
+ * Byte 13:    Flags
+ * Byte 14:    Source address
+ * Byte 15:    Destination address
+ * Byte 16:    RSSI
+ * Byte 17:    LQI
+ * Byte 18-19: Payload length (n)
+ * Byte 20 to Byte 20+n-1: Payload
+ */
+class FrameRecordCodec {
+
+public:
+	static const size_t HEADER_BYTES = 20;
+
+	/**
+	 * Number of bytes needed to encode the record.
+	 */
+	static size_t encodedLength(const FrameRecord& record) {
+		return HEADER_BYTES + record.len;
+	}
+
+	/**
+	 * Encodes the record into the buffer. The caller is responsible to
+	 * provide a buffer of at least encodedLength(record) bytes.
+	 *
+	 * @return Number of bytes written.
+	 */
+	static size_t encode(const FrameRecord& record, uint8_t* buffer);
+
+	/**
+	 * Decodes a record from the buffer.
+	 *
+	 * @return Number of bytes consumed, or 0 if the buffer does not
+	 *         contain a complete record.
+	 */
+	static size_t decode(const uint8_t* buffer, size_t len, FrameRecord& record);
+};
+
+#endif /* FRAMERECORDCODEC_HPP_ */
@@ -0,0 +1,681 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "DateTime.hpp"
+#include "Log.hpp"
+#include "Metrics.hpp"
+
+#include "FrameStore.hpp"
+
+/**
+ * Writes all bytes. Returns 0 on success, -1 on error.
+ */
+static int writeAll(int fd, const void* data, size_t len) {
+	const uint8_t* p = (const uint8_t*) data;
+
+	while (len > 0) {
+		ssize_t rc = ::write(fd, p, len);
+		if (rc < 0 && errno == EINTR) {
+			continue;
+		}
+		if (rc <= 0) {
+			return -1;
+		}
+		p += rc;
+		len -= rc;
+	}
+
+	return 0;
+}
+
+static int compareNumbers(const void* a, const void* b) {
+	uint32_t x = *(const uint32_t*) a;
+	uint32_t y = *(const uint32_t*) b;
+	return x < y ? -1 : x > y ? 1 : 0;
+}
+
+FrameStore::FrameStore(const char* directory, int syncMillis, size_t segmentBytes, int maxSegments) {
+	this->directory = directory;
+	this->syncMillis = syncMillis;
+	this->segmentBytes = segmentBytes;
+	this->maxSegments = maxSegments;
+
+	this->pool = NULL;
+	this->head = 0;
+	this->tail = 0;
+	this->running = false;
+
+	this->nsegments = 0;
+	pthread_mutex_init(&this->mutex, NULL);
+
+	memset(&this->current, 0, sizeof(this->current));
+	this->dataFd = -1;
+	this->indexFd = -1;
+	this->failed = false;
+
+	this->dataBuffered = 0;
+	this->indexBuffered = 0;
+	memset(&this->block, 0, sizeof(this->block));
+
+	this->lastSync = 0;
+}
+
+FrameStore::~FrameStore() {
+	if (this->running) {
+		this->close();
+	}
+
+	pthread_mutex_destroy(&this->mutex);
+}
+
+void FrameStore::formatName(uint32_t number, const char* extension, char* name, size_t maxBytes) {
+	snprintf(name, maxBytes, "%s/%08u.%s", this->directory, number, extension);
+}
+
+void FrameStore::open() {
+
+	if (mkdir(this->directory, 0755) < 0 && errno != EEXIST) {
+		perror("Creating frame store directory");
+		exit(1);
+	}
+
+	DIR* dir = opendir(this->directory);
+	if (dir == NULL) {
+		perror("Opening frame store directory");
+		exit(1);
+	}
+
+	// Numbers of the segments found, in any order
+	uint32_t* numbers = NULL;
+	int nnumbers = 0;
+	int capacity = 0;
+
+	struct dirent* dirent;
+	while ((dirent = readdir(dir)) != NULL) {
+		const char* name = dirent->d_name;
+		if (strlen(name) != 15 || strcmp(name + 8, ".frames") != 0
+				|| strspn(name, "0123456789") != 8) {
+			continue;
+		}
+
+		if (nnumbers == capacity) {
+			capacity = capacity > 0 ? capacity * 2 : 64;
+			numbers = (uint32_t*) realloc(numbers, capacity * sizeof(uint32_t));
+			if (numbers == NULL) {
+				perror("Allocating frame store segments");
+				exit(1);
+			}
+		}
+		numbers[nnumbers++] = strtoul(name, NULL, 10);
+	}
+	closedir(dir);
+
+	qsort(numbers, nnumbers, sizeof(uint32_t), compareNumbers);
+
+	// The newest segments, leaving room for the one started now
+	int first = nnumbers > MAX_SEGMENTS - 1 ? nnumbers - (MAX_SEGMENTS - 1) : 0;
+	for (int i=first ; i<nnumbers ; i++) {
+		if (recoverSegment(numbers[i], this->segments[this->nsegments]) == 0) {
+			this->nsegments++;
+		}
+	}
+
+	uint32_t next = nnumbers > 0 ? numbers[nnumbers - 1] + 1 : 0;
+	free(numbers);
+
+	if (openSegment(next) < 0) {
+		exit(1);
+	}
+
+	this->lastSync = DateTime::nanos(CLOCK_MONOTONIC);
+
+	this->running = true;
+	if (pthread_create(&this->thread, NULL, FrameStore::run, this) != 0) {
+		perror("Starting frame store thread");
+		exit(1);
+	}
+}
+
+void FrameStore::close() {
+	this->running = false;
+	pthread_join(this->thread, NULL);
+
+	drain();
+	closeSegment();
+}
+
+/**
+ * Checks a segment left by a previous run: Drops index entries that don't
+ * fit to the frames file, and indexes the records after the last entry.
+ * Returns 0 on success, -1 if the segment can't be used.
+ */
+int FrameStore::recoverSegment(uint32_t number, Segment& segment) {
+
+	char name[256];
+	formatName(number, "frames", name, sizeof(name));
+
+	int dataFd = ::open(name, O_RDWR);
+	if (dataFd < 0) {
+		LOG_WARN("Opening frame store segment %s: %s\n", name, strerror(errno));
+		return -1;
+	}
+
+	FrameStoreHeader header;
+	struct stat st;
+	if (pread(dataFd, &header, sizeof(header), 0) != (ssize_t) sizeof(header)
+			|| header.magic != FRAME_STORE_MAGIC || header.version != FRAME_STORE_VERSION
+			|| header.headerSize != sizeof(header) || header.segment != number
+			|| fstat(dataFd, &st) < 0) {
+		LOG_WARN("Skipping frame store segment %s: Unsupported layout\n", name);
+		::close(dataFd);
+		return -1;
+	}
+	uint64_t dataSize = st.st_size;
+
+	formatName(number, "index", name, sizeof(name));
+	int indexFd = ::open(name, O_RDWR | O_CREAT, 0644);
+	if (indexFd < 0 || fstat(indexFd, &st) < 0) {
+		LOG_WARN("Opening frame store index %s: %s\n", name, strerror(errno));
+		::close(dataFd);
+		if (indexFd >= 0) {
+			::close(indexFd);
+		}
+		return -1;
+	}
+
+	FrameStoreHeader indexHeader;
+	if ((size_t) st.st_size < sizeof(indexHeader)
+			|| pread(indexFd, &indexHeader, sizeof(indexHeader), 0) != (ssize_t) sizeof(indexHeader)
+			|| indexHeader.magic != FRAME_STORE_INDEX_MAGIC || indexHeader.version != FRAME_STORE_VERSION
+			|| indexHeader.headerSize != sizeof(indexHeader) || indexHeader.segment != number) {
+		// Index everything again
+		LOG_WARN("Rebuilding frame store index %s\n", name);
+		indexHeader = header;
+		indexHeader.magic = FRAME_STORE_INDEX_MAGIC;
+		if (ftruncate(indexFd, 0) < 0 || pwrite(indexFd, &indexHeader, sizeof(indexHeader), 0) != (ssize_t) sizeof(indexHeader)) {
+			LOG_WARN("Writing frame store index %s: %s\n", name, strerror(errno));
+			::close(dataFd);
+			::close(indexFd);
+			return -1;
+		}
+		st.st_size = sizeof(indexHeader);
+	}
+
+	memset(&segment, 0, sizeof(Segment));
+	segment.number = number;
+
+	// Index entries must describe consecutive blocks of the frames file
+	uint32_t entries = (st.st_size - sizeof(indexHeader)) / sizeof(FrameStoreIndexEntry);
+	uint64_t offset = sizeof(header);
+	uint32_t valid = 0;
+
+	while (valid < entries) {
+		FrameStoreIndexEntry entry;
+		if (pread(indexFd, &entry, sizeof(entry), sizeof(indexHeader) + valid * sizeof(entry)) != (ssize_t) sizeof(entry)
+				|| entry.offset != offset || entry.records == 0 || offset + entry.bytes > dataSize) {
+			break;
+		}
+
+		addToSegment(segment, entry);
+		offset += entry.bytes;
+		valid++;
+	}
+
+	if (ftruncate(indexFd, sizeof(indexHeader) + valid * sizeof(FrameStoreIndexEntry)) < 0
+			|| lseek(indexFd, 0, SEEK_END) < 0) {
+		LOG_WARN("Truncating frame store index %s: %s\n", name, strerror(errno));
+	}
+	segment.indexEntries = valid;
+
+	int rc = indexTail(dataFd, indexFd, offset, dataSize, segment);
+
+	fdatasync(dataFd);
+	fdatasync(indexFd);
+	::close(dataFd);
+	::close(indexFd);
+
+	return rc;
+}
+
+/**
+ * Indexes the records of the frames file from offset on, and cuts off a
+ * record that was not written completely.
+ */
+int FrameStore::indexTail(int dataFd, int indexFd, uint64_t offset, uint64_t size, Segment& segment) {
+
+	FrameStoreIndexEntry entry;
+	memset(&entry, 0, sizeof(entry));
+
+	size_t buffered = 0;
+	uint64_t readOffset = offset;
+	bool done = false;
+
+	while (!done) {
+		ssize_t rc = pread(dataFd, this->dataBuffer + buffered, sizeof(this->dataBuffer) - buffered, readOffset);
+		if (rc < 0) {
+			LOG_WARN("Reading frame store segment %u: %s\n", segment.number, strerror(errno));
+			return -1;
+		}
+		readOffset += rc;
+		buffered += rc;
+		done = rc == 0;
+
+		size_t pos = 0;
+		FrameRecord record;
+		size_t consumed;
+		while ((consumed = FrameRecordCodec::decode(this->dataBuffer + pos, buffered - pos, record)) > 0) {
+			if (entry.records == 0) {
+				entry.offset = offset;
+				entry.minTimestamp = record.timestamp;
+				entry.maxTimestamp = record.timestamp;
+			}
+			if (record.timestamp < entry.minTimestamp) {
+				entry.minTimestamp = record.timestamp;
+			}
+			if (record.timestamp > entry.maxTimestamp) {
+				entry.maxTimestamp = record.timestamp;
+			}
+			if ((record.flags & FRAME_FLAG_ADDRESS) != 0) {
+				frameStoreAddSource(entry.sources, record.srcAddress);
+			}
+			entry.bytes += consumed;
+			entry.records++;
+
+			pos += consumed;
+			offset += consumed;
+
+			if (entry.records == BLOCK_RECORDS) {
+				if (writeAll(indexFd, &entry, sizeof(entry)) < 0) {
+					return -1;
+				}
+				addToSegment(segment, entry);
+				segment.indexEntries++;
+				memset(&entry, 0, sizeof(entry));
+			}
+		}
+
+		memmove(this->dataBuffer, this->dataBuffer + pos, buffered - pos);
+		buffered -= pos;
+
+		// Not a record, even with a full buffer
+		if (buffered == sizeof(this->dataBuffer)) {
+			done = true;
+		}
+	}
+
+	if (entry.records > 0) {
+		if (writeAll(indexFd, &entry, sizeof(entry)) < 0) {
+			return -1;
+		}
+		addToSegment(segment, entry);
+		segment.indexEntries++;
+	}
+
+	if (offset < size) {
+		LOG_WARN("Cutting off %llu bytes of frame store segment %u\n",
+				(unsigned long long) (size - offset), segment.number);
+		if (ftruncate(dataFd, offset) < 0) {
+			return -1;
+		}
+	}
+
+	segment.dataBytes = offset;
+	return 0;
+}
+
+void FrameStore::addToSegment(Segment& segment, const FrameStoreIndexEntry& entry) {
+
+	if (segment.records == 0 || entry.minTimestamp < segment.minTimestamp) {
+		segment.minTimestamp = entry.minTimestamp;
+	}
+	if (segment.records == 0 || entry.maxTimestamp > segment.maxTimestamp) {
+		segment.maxTimestamp = entry.maxTimestamp;
+	}
+	for (int i=0 ; i<32 ; i++) {
+		segment.sources[i] |= entry.sources[i];
+	}
+
+	segment.records += entry.records;
+}
+
+/**
+ * Creates the files of a new segment.
+ * Returns 0 on success, -1 on error.
+ */
+int FrameStore::openSegment(uint32_t number) {
+
+	FrameStoreHeader header;
+	memset(&header, 0, sizeof(header));
+	header.magic = FRAME_STORE_MAGIC;
+	header.version = FRAME_STORE_VERSION;
+	header.headerSize = sizeof(header);
+	header.segment = number;
+	header.created = DateTime::nanos(CLOCK_REALTIME);
+
+	char name[256];
+	formatName(number, "frames", name, sizeof(name));
+	this->dataFd = ::open(name, O_CREAT | O_TRUNC | O_WRONLY, 0644);
+	if (this->dataFd < 0 || writeAll(this->dataFd, &header, sizeof(header)) < 0) {
+		LOG_ERROR("Creating frame store segment %s: %s\n", name, strerror(errno));
+		closeFiles();
+		return -1;
+	}
+
+	header.magic = FRAME_STORE_INDEX_MAGIC;
+
+	formatName(number, "index", name, sizeof(name));
+	this->indexFd = ::open(name, O_CREAT | O_TRUNC | O_WRONLY, 0644);
+	if (this->indexFd < 0 || writeAll(this->indexFd, &header, sizeof(header)) < 0) {
+		LOG_ERROR("Creating frame store index %s: %s\n", name, strerror(errno));
+		closeFiles();
+		return -1;
+	}
+
+	memset(&this->current, 0, sizeof(this->current));
+	this->current.number = number;
+	this->current.dataBytes = sizeof(header);
+
+	this->block.records = 0;
+
+	// Only the segment being written may be taken out of the table
+	if (this->nsegments == MAX_SEGMENTS) {
+		removeOldSegments(MAX_SEGMENTS - 1);
+	}
+
+	pthread_mutex_lock(&this->mutex);
+	this->segments[this->nsegments++] = this->current;
+	pthread_mutex_unlock(&this->mutex);
+
+	if (this->maxSegments > 0) {
+		removeOldSegments(this->maxSegments);
+	}
+
+	LOG_INFO("Storing data frames in %s/%08u.frames\n", this->directory, number);
+	return 0;
+}
+
+/**
+ * Writes what is left, syncs and closes the files of the segment.
+ */
+void FrameStore::closeSegment() {
+
+	if (this->dataFd < 0) {
+		return;
+	}
+
+	closeBlock();
+	if (!this->failed && writeOut() < 0) {
+		fail();
+	}
+	sync();
+	closeFiles();
+}
+
+void FrameStore::closeFiles() {
+	if (this->dataFd >= 0) {
+		::close(this->dataFd);
+		this->dataFd = -1;
+	}
+	if (this->indexFd >= 0) {
+		::close(this->indexFd);
+		this->indexFd = -1;
+	}
+}
+
+/**
+ * Removes the oldest segments, until keep are left.
+ */
+void FrameStore::removeOldSegments(int keep) {
+
+	while (true) {
+		pthread_mutex_lock(&this->mutex);
+		if (this->nsegments <= keep) {
+			pthread_mutex_unlock(&this->mutex);
+			return;
+		}
+
+		uint32_t number = this->segments[0].number;
+		this->nsegments--;
+		memmove(this->segments, this->segments + 1, this->nsegments * sizeof(Segment));
+		pthread_mutex_unlock(&this->mutex);
+
+		// Queries reading the segment keep their file descriptors
+		char name[256];
+		formatName(number, "frames", name, sizeof(name));
+		if (unlink(name) < 0) {
+			LOG_WARN("Removing frame store segment %s: %s\n", name, strerror(errno));
+		}
+		formatName(number, "index", name, sizeof(name));
+		unlink(name);
+	}
+}
+
+int FrameStore::findSegment(uint32_t number, Segment& segment) {
+
+	int rc = -1;
+
+	pthread_mutex_lock(&this->mutex);
+	for (int i=0 ; i<this->nsegments ; i++) {
+		if (this->segments[i].number >= number) {
+			segment = this->segments[i];
+			rc = 0;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&this->mutex);
+
+	return rc;
+}
+
+/**
+ * Puts the slot of the data frame into the ring, with a reference of its
+ * own. No system calls, no copy.
+ */
+void FrameStore::publishFrame(FramePool* pool, const FrameDescriptor& frame) {
+
+	uint64_t head = this->head;
+	if (head - __atomic_load_n(&this->tail, __ATOMIC_ACQUIRE) >= (uint64_t) RING_ENTRIES
+			|| !pool->retainSpare(frame.slot, RESERVED_SLOTS)) {
+		Metrics::increment(Metrics::STORE_DROPS);
+		return;
+	}
+
+	this->pool = pool;
+	this->ring[head % RING_ENTRIES] = frame.slot;
+
+	__atomic_store_n(&this->head, head + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Adds a record to the write buffer, starting the next segment if it
+ * doesn't fit into this one.
+ */
+void FrameStore::append(const FrameRecord& record) {
+
+	uint8_t data[FrameRecordCodec::HEADER_BYTES + FrameRecord::MAX_PAYLOAD_BYTES];
+	size_t len = FrameRecordCodec::encode(record, data);
+
+	if (!this->failed && this->current.dataBytes + len > this->segmentBytes && this->current.records > 0) {
+		uint32_t number = this->current.number;
+		closeSegment();
+		if (!this->failed && openSegment(number + 1) < 0) {
+			fail();
+		}
+	}
+
+	if (!this->failed && this->dataBuffered + len > WRITE_BUFFER_BYTES && writeOut() < 0) {
+		fail();
+	}
+
+	if (this->failed) {
+		Metrics::increment(Metrics::STORE_DROPS);
+		return;
+	}
+
+	FrameStoreIndexEntry& block = this->block;
+	if (block.records == 0) {
+		memset(&block, 0, sizeof(block));
+		block.offset = this->current.dataBytes;
+		block.minTimestamp = record.timestamp;
+		block.maxTimestamp = record.timestamp;
+	}
+
+	memcpy(this->dataBuffer + this->dataBuffered, data, len);
+	this->dataBuffered += len;
+	this->current.dataBytes += len;
+
+	if (record.timestamp < block.minTimestamp) {
+		block.minTimestamp = record.timestamp;
+	}
+	if (record.timestamp > block.maxTimestamp) {
+		block.maxTimestamp = record.timestamp;
+	}
+	if ((record.flags & FRAME_FLAG_ADDRESS) != 0) {
+		frameStoreAddSource(block.sources, record.srcAddress);
+	}
+	block.bytes += len;
+	block.records++;
+
+	// The segment's range includes the records not indexed yet
+	FrameStoreIndexEntry single = block;
+	single.minTimestamp = single.maxTimestamp = record.timestamp;
+	single.records = 1;
+	addToSegment(this->current, single);
+
+	if (block.records == BLOCK_RECORDS) {
+		closeBlock();
+	}
+}
+
+/**
+ * Adds the index entry of the block to the write buffer.
+ */
+void FrameStore::closeBlock() {
+
+	if (this->block.records == 0 || this->failed) {
+		return;
+	}
+
+	if (this->indexBuffered == INDEX_BUFFER_ENTRIES && writeOut() < 0) {
+		fail();
+		return;
+	}
+
+	this->indexBuffer[this->indexBuffered++] = this->block;
+	this->block.records = 0;
+}
+
+/**
+ * Writes the records and index entries collected, records first, and
+ * makes them visible to queries.
+ * Returns 0 on success, -1 on error.
+ */
+int FrameStore::writeOut() {
+
+	if (writeAll(this->dataFd, this->dataBuffer, this->dataBuffered) < 0
+			|| writeAll(this->indexFd, this->indexBuffer, this->indexBuffered * sizeof(FrameStoreIndexEntry)) < 0) {
+		LOG_ERROR("Writing frame store segment %u: %s\n", this->current.number, strerror(errno));
+		return -1;
+	}
+
+	this->current.indexEntries += this->indexBuffered;
+	this->dataBuffered = 0;
+	this->indexBuffered = 0;
+
+	pthread_mutex_lock(&this->mutex);
+	this->segments[this->nsegments - 1] = this->current;
+	pthread_mutex_unlock(&this->mutex);
+
+	return 0;
+}
+
+void FrameStore::sync() {
+	if (fdatasync(this->dataFd) < 0 || fdatasync(this->indexFd) < 0) {
+		LOG_WARN("Syncing frame store segment %u: %s\n", this->current.number, strerror(errno));
+	}
+
+	this->lastSync = DateTime::nanos(CLOCK_MONOTONIC);
+}
+
+/**
+ * Stops storing after an error. The records already written stay
+ * available to queries.
+ */
+void FrameStore::fail() {
+	LOG_ERROR("Frame store stopped\n");
+	this->failed = true;
+}
+
+/**
+ * Adds the records waiting to the write buffer and releases their slots.
+ * Returns true if there were any.
+ */
+bool FrameStore::drain() {
+
+	uint64_t head = __atomic_load_n(&this->head, __ATOMIC_ACQUIRE);
+	uint64_t tail = this->tail;
+	if (tail == head) {
+		return false;
+	}
+
+	while (tail < head) {
+		int32_t slot = this->ring[tail % RING_ENTRIES];
+		append(this->pool->get(slot));
+		this->pool->release(slot);
+		tail++;
+		__atomic_store_n(&this->tail, tail, __ATOMIC_RELEASE);
+	}
+
+	return true;
+}
+
+void* FrameStore::run(void* arg) {
+	FrameStore* store = (FrameStore*) arg;
+
+	while (store->running) {
+		bool drained = store->drain();
+
+		// Everything collected is written and synced at once
+		uint64_t elapsed = DateTime::nanos(CLOCK_MONOTONIC) - store->lastSync;
+		if (!store->failed && (store->dataBuffered > 0 || store->indexBuffered > 0)
+				&& elapsed >= store->syncMillis * 1000000ULL) {
+			if (store->writeOut() < 0) {
+				store->fail();
+			} else {
+				store->sync();
+			}
+		}
+
+		if (!drained) {
+			usleep(5000);
+		}
+	}
+
+	return NULL;
+}
@@ -0,0 +1,180 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef FRAMESTORE_HPP_
+#define FRAMESTORE_HPP_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+
+#include "IFrameSink.hpp"
+#include "FrameRecordCodec.hpp"
+#include "FrameStoreLayout.hpp"
+
+/**
+ * Keeps every data frame received in segment files on disk (see
+ * FrameStoreLayout.hpp), so clients can query the data frames they
+ * missed (see FrameStoreQuery).
+ *
+ * The receiving thread only puts the frame pool slot of the data frame
+ * into a ring, holding a reference; a background thread encodes the
+ * records, appends them to the current segment and releases the slots. Writes
+ * are collected and written in large chunks, and synced to the disk every
+ * syncMillis, which is kind to SD cards. Records become visible to queries
+ * when they are written. When a segment is full, the next one is started;
+ * only the newest maxSegments are kept.
+ *
+ * On start, the segments of the directory are checked: Records torn by a
+ * crash are cut off, and records missing from the index are indexed. Then
+ * a new segment is started.
+ *
+ * If the ring is full, the frame pool is running out of slots or writing
+ * failed, records are dropped instead of waiting (see
+ * Metrics::STORE_DROPS). The frame pool needs RING_ENTRIES slots more
+ * than the device does, so the ring can fill up.
+ */
+class FrameStore : public IFrameSink {
+
+public:
+	static const int RING_ENTRIES = 1024;
+
+	/** Free frame pool slots left to receiving */
+	static const int RESERVED_SLOTS = 16;
+
+	/** Records per index entry */
+	static const int BLOCK_RECORDS = 64;
+
+	/** Segments known at most; older ones are removed */
+	static const int MAX_SEGMENTS = 1024;
+
+	static const size_t DEFAULT_SEGMENT_BYTES = 64 * 1024 * 1024;
+	static const int DEFAULT_SYNC_MILLIS = 1000;
+
+	/**
+	 * What queries need to know about a segment.
+	 */
+	struct Segment {
+		uint32_t number;
+
+		/** Bytes of the frames file written, and index entries written */
+		uint64_t dataBytes;
+		uint32_t indexEntries;
+
+		/** Range of the record timestamps, sources as in FrameStoreIndexEntry */
+		uint64_t records;
+		uint64_t minTimestamp;
+		uint64_t maxTimestamp;
+		uint8_t sources[32];
+	};
+
+	/**
+	 * @param directory Where the segments are kept, created if needed.
+	 * @param syncMillis Time between syncs to the disk, 0 syncs after each write.
+	 * @param segmentBytes Size of a segment's frames file.
+	 * @param maxSegments Number of segments kept, 0 for all.
+	 */
+	FrameStore(const char* directory, int syncMillis, size_t segmentBytes, int maxSegments);
+	virtual ~FrameStore();
+
+	/**
+	 * Checks the segments of the directory, starts a new one and starts
+	 * the background thread.
+	 */
+	void open();
+
+	/**
+	 * Writes and syncs the records waiting and stops the background thread.
+	 */
+	void close();
+
+	virtual void publishFrame(FramePool* pool, const FrameDescriptor& frame);
+
+	/**
+	 * Copies the segment with the lowest number not less than number.
+	 * Returns 0 on success, -1 if there is no such segment.
+	 */
+	int findSegment(uint32_t number, Segment& segment);
+
+	/**
+	 * Path of a file of a segment, extension "frames" or "index".
+	 */
+	void formatName(uint32_t number, const char* extension, char* name, size_t maxBytes);
+
+private:
+	/** Records collected before they are written */
+	static const size_t WRITE_BUFFER_BYTES = 64 * 1024;
+	static const int INDEX_BUFFER_ENTRIES = 128;
+
+	const char* directory;
+	int syncMillis;
+	size_t segmentBytes;
+	int maxSegments;
+
+	/** Single producer, single consumer ring of retained slots */
+	FramePool* pool;
+	int32_t ring[RING_ENTRIES];
+	uint64_t head;
+	uint64_t tail;
+
+	volatile bool running;
+	pthread_t thread;
+
+	/** Segments, oldest first, the last one is being written. Guarded by the mutex. */
+	Segment segments[MAX_SEGMENTS];
+	int nsegments;
+	pthread_mutex_t mutex;
+
+	/** Written by the background thread only */
+	Segment current;
+	int dataFd;
+	int indexFd;
+	bool failed;
+
+	uint8_t dataBuffer[WRITE_BUFFER_BYTES];
+	size_t dataBuffered;
+	FrameStoreIndexEntry indexBuffer[INDEX_BUFFER_ENTRIES];
+	int indexBuffered;
+
+	/** Block not complete yet */
+	FrameStoreIndexEntry block;
+
+	uint64_t lastSync;
+
+	int recoverSegment(uint32_t number, Segment& segment);
+	int indexTail(int dataFd, int indexFd, uint64_t offset, uint64_t size, Segment& segment);
+	static void addToSegment(Segment& segment, const FrameStoreIndexEntry& entry);
+
+	int openSegment(uint32_t number);
+	void closeSegment();
+	void closeFiles();
+	void removeOldSegments(int keep);
+
+	void append(const FrameRecord& record);
+	void closeBlock();
+	int writeOut();
+	void sync();
+	void fail();
+
+	bool drain();
+	static void* run(void* arg);
+};
+
+#endif /* FRAMESTORE_HPP_ */
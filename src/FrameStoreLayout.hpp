@@ -0,0 +1,88 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef FRAMESTORELAYOUT_HPP_
+#define FRAMESTORELAYOUT_HPP_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Layout of the files written by FrameStore. Headers and index entries
+ * are in the byte order of the host (little endian on the Raspberry Pi),
+ * records are encoded by FrameRecordCodec.
+ *
+ * Each segment is a pair of files, numbered in the order they were
+ * started: "<n>.frames" and "<n>.index", n with 8 digits. Both only grow
+ * at the end.
+ *
+ * The frames file is a header followed by the records, in the order they
+ * were received.
+ *
+ * The index file is a header followed by one entry per block of records
+ * (see FrameStore::BLOCK_RECORDS): Where the block is, when its records
+ * were received and which source addresses they came from. Queries read
+ * only the blocks that may contain matching records. The records after the
+ * last block are not indexed yet; they are read in any case.
+ */
+
+static const uint32_t FRAME_STORE_MAGIC = 0x53313143; // "C11S"
+static const uint32_t FRAME_STORE_INDEX_MAGIC = 0x58313143; // "C11X"
+static const uint16_t FRAME_STORE_VERSION = 1;
+
+/** Header of both files of a segment */
+struct FrameStoreHeader {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t headerSize;
+
+	/** Number of the segment */
+	uint32_t segment;
+	uint32_t reserved;
+
+	/** When the segment was started (CLOCK_REALTIME, ns) */
+	uint64_t created;
+};
+
+struct FrameStoreIndexEntry {
+	/** Range of the record timestamps in the block (CLOCK_REALTIME, ns) */
+	uint64_t minTimestamp;
+	uint64_t maxTimestamp;
+
+	/** Position of the block in the frames file */
+	uint32_t offset;
+	uint32_t bytes;
+
+	uint32_t records;
+	uint32_t reserved;
+
+	/** Bit set for every source address in the block (records with FRAME_FLAG_ADDRESS only) */
+	uint8_t sources[32];
+};
+
+static inline void frameStoreAddSource(uint8_t sources[32], uint8_t address) {
+	sources[address >> 3] |= 1 << (address & 7);
+}
+
+static inline bool frameStoreHasSource(const uint8_t sources[32], uint8_t address) {
+	return (sources[address >> 3] & (1 << (address & 7))) != 0;
+}
+
+#endif /* FRAMESTORELAYOUT_HPP_ */
@@ -0,0 +1,258 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+
+#include "FrameRecordCodec.hpp"
+#include "FrameStore.hpp"
+#include "Log.hpp"
+
+#include "FrameStoreQuery.hpp"
+
+FrameStoreQuery::FrameStoreQuery() {
+	this->store = NULL;
+	this->dataFd = -1;
+	this->indexFd = -1;
+	this->count = 0;
+	this->reads = 0;
+}
+
+FrameStoreQuery::~FrameStoreQuery() {
+	stop();
+}
+
+void FrameStoreQuery::start(FrameStore* store, int source, uint64_t from, uint64_t to) {
+	stop();
+
+	this->store = store;
+	this->source = source;
+	this->from = from;
+	this->to = to;
+	this->count = 0;
+	this->reads = 0;
+
+	this->segmentNumber = 0;
+	this->readOffset = 0;
+	this->readEnd = 0;
+	this->bufferPos = 0;
+	this->bufferLen = 0;
+}
+
+void FrameStoreQuery::stop() {
+	closeSegment();
+	this->store = NULL;
+}
+
+bool FrameStoreQuery::mayMatch(uint64_t minTimestamp, uint64_t maxTimestamp, const uint8_t sources[32]) {
+	return maxTimestamp >= this->from && minTimestamp <= this->to
+			&& (this->source == ANY_SOURCE || frameStoreHasSource(sources, this->source));
+}
+
+bool FrameStoreQuery::matches(const FrameRecord& record) {
+	return record.timestamp >= this->from && record.timestamp <= this->to
+			&& (this->source == ANY_SOURCE
+					|| ((record.flags & FRAME_FLAG_ADDRESS) != 0 && record.srcAddress == this->source));
+}
+
+/**
+ * Counts a read of the files. Returns false if the batch has none left.
+ */
+bool FrameStoreQuery::mayRead() {
+	if (this->reads >= READS_PER_BATCH) {
+		return false;
+	}
+
+	this->reads++;
+	return true;
+}
+
+int FrameStoreQuery::next(FrameRecord& record) {
+
+	if (this->store == NULL) {
+		return 0;
+	}
+
+	while (true) {
+		size_t consumed;
+		while ((consumed = FrameRecordCodec::decode(this->buffer + this->bufferPos,
+				this->bufferLen - this->bufferPos, record)) > 0) {
+			this->bufferPos += consumed;
+			if (matches(record)) {
+				this->count++;
+				return 1;
+			}
+		}
+
+		// Keep the start of a record that was not read completely
+		memmove(this->buffer, this->buffer + this->bufferPos, this->bufferLen - this->bufferPos);
+		this->bufferLen -= this->bufferPos;
+		this->bufferPos = 0;
+
+		if (this->readOffset < this->readEnd && this->bufferLen < BUFFER_BYTES) {
+			if (!mayRead()) {
+				return BATCH_DONE;
+			}
+
+			size_t n = BUFFER_BYTES - this->bufferLen;
+			if (n > this->readEnd - this->readOffset) {
+				n = this->readEnd - this->readOffset;
+			}
+
+			ssize_t rc = pread(this->dataFd, this->buffer + this->bufferLen, n, this->readOffset);
+			if (rc <= 0) {
+				LOG_ERROR("Reading frame store segment %u: %s\n", this->segmentNumber,
+						rc < 0 ? strerror(errno) : "Truncated");
+				return -1;
+			}
+
+			this->bufferLen += rc;
+			this->readOffset += rc;
+			continue;
+		}
+
+		if (this->bufferLen > 0) {
+			LOG_WARN("Frame store segment %u: Skipping %u bytes that are not a record\n",
+					this->segmentNumber, (unsigned int) this->bufferLen);
+			this->bufferLen = 0;
+			this->readOffset = this->readEnd;
+		}
+
+		int rc = nextRange();
+		if (rc != 1) {
+			return rc;
+		}
+	}
+}
+
+/**
+ * Opens the files of the next segment that may contain matching records.
+ * Returns 1 on success, 0 if there is no such segment.
+ */
+int FrameStoreQuery::openSegment() {
+
+	FrameStore::Segment segment;
+	while (this->store->findSegment(this->segmentNumber, segment) == 0) {
+		this->segmentNumber = segment.number + 1;
+
+		if (segment.records == 0 || !mayMatch(segment.minTimestamp, segment.maxTimestamp, segment.sources)) {
+			continue;
+		}
+
+		char name[256];
+		this->store->formatName(segment.number, "frames", name, sizeof(name));
+		this->dataFd = ::open(name, O_RDONLY);
+		this->store->formatName(segment.number, "index", name, sizeof(name));
+		this->indexFd = ::open(name, O_RDONLY);
+		if (this->dataFd < 0 || this->indexFd < 0) {
+			// Removed in the meantime
+			closeSegment();
+			continue;
+		}
+
+		this->segmentNumber = segment.number;
+		this->segmentBytes = segment.dataBytes;
+		this->indexEntries = segment.indexEntries;
+		this->entriesRead = 0;
+		this->nentries = 0;
+		this->entryPos = 0;
+		this->tailOffset = sizeof(FrameStoreHeader);
+		this->tailDone = false;
+		return 1;
+	}
+
+	return 0;
+}
+
+void FrameStoreQuery::closeSegment() {
+	if (this->dataFd >= 0) {
+		::close(this->dataFd);
+		this->dataFd = -1;
+	}
+	if (this->indexFd >= 0) {
+		::close(this->indexFd);
+		this->indexFd = -1;
+	}
+}
+
+/**
+ * Selects the next block that may contain matching records, or the
+ * records not indexed yet.
+ * Returns 1 on success, 0 if there are no more, BATCH_DONE if the index
+ * must be read in the next batch and -1 on error.
+ */
+int FrameStoreQuery::nextRange() {
+
+	while (true) {
+		if (this->dataFd < 0) {
+			if (openSegment() == 0) {
+				return 0;
+			}
+		}
+
+		while (this->entryPos < this->nentries || this->entriesRead < this->indexEntries) {
+			if (this->entryPos == this->nentries) {
+				if (!mayRead()) {
+					return BATCH_DONE;
+				}
+
+				uint32_t n = this->indexEntries - this->entriesRead;
+				if (n > (uint32_t) ENTRIES_PER_READ) {
+					n = ENTRIES_PER_READ;
+				}
+
+				size_t bytes = n * sizeof(FrameStoreIndexEntry);
+				off_t offset = sizeof(FrameStoreHeader) + this->entriesRead * sizeof(FrameStoreIndexEntry);
+				if (pread(this->indexFd, this->entries, bytes, offset) != (ssize_t) bytes) {
+					LOG_ERROR("Reading frame store index %u: %s\n", this->segmentNumber, strerror(errno));
+					return -1;
+				}
+
+				this->entriesRead += n;
+				this->nentries = n;
+				this->entryPos = 0;
+			}
+
+			const FrameStoreIndexEntry& entry = this->entries[this->entryPos++];
+			this->tailOffset = entry.offset + entry.bytes;
+
+			if (mayMatch(entry.minTimestamp, entry.maxTimestamp, entry.sources)) {
+				this->readOffset = entry.offset;
+				this->readEnd = entry.offset + entry.bytes;
+				return 1;
+			}
+		}
+
+		if (!this->tailDone) {
+			this->tailDone = true;
+			if (this->tailOffset < this->segmentBytes) {
+				this->readOffset = this->tailOffset;
+				this->readEnd = this->segmentBytes;
+				return 1;
+			}
+		}
+
+		closeSegment();
+		this->segmentNumber++;
+	}
+}
@@ -0,0 +1,142 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef FRAMESTOREQUERY_HPP_
+#define FRAMESTOREQUERY_HPP_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "FrameRecord.hpp"
+#include "FrameStoreLayout.hpp"
+
+class FrameStore;
+
+/**
+ * Reads the records of a FrameStore received in a time range, optionally
+ * only those from one source address, oldest segment first.
+ *
+ * Segments and blocks whose index entries show that they contain no
+ * matching record are skipped without reading them. Records written
+ * after the query reached a segment are not returned.
+ */
+class FrameStoreQuery {
+
+public:
+	/** Records from any address */
+	static const int ANY_SOURCE = -1;
+
+	/** Returned by next() when the reads of the batch are used up */
+	static const int BATCH_DONE = 2;
+
+	/** Reads of the files per batch at most, see beginBatch() */
+	static const int READS_PER_BATCH = 4;
+
+	FrameStoreQuery();
+	~FrameStoreQuery();
+
+	/**
+	 * Starts a query, replacing the one running.
+	 *
+	 * @param from, to Time range of the records (CLOCK_REALTIME, ns), inclusive.
+	 */
+	void start(FrameStore* store, int source, uint64_t from, uint64_t to);
+
+	/**
+	 * Ends the query and closes the files.
+	 */
+	void stop();
+
+	bool isActive() {
+		return this->store != NULL;
+	}
+
+	/**
+	 * Allows the following calls of next() READS_PER_BATCH reads of the
+	 * files, so that a query that skips many records doesn't hold up the
+	 * caller.
+	 */
+	void beginBatch() {
+		this->reads = 0;
+	}
+
+	/**
+	 * Reads the next matching record.
+	 *
+	 * Returns 1 if a record was read, 0 if there are no more records,
+	 * BATCH_DONE if more records may follow after the next beginBatch()
+	 * and -1 on error.
+	 */
+	int next(FrameRecord& record);
+
+	/**
+	 * Number of records returned so far.
+	 */
+	uint64_t getCount() {
+		return this->count;
+	}
+
+private:
+	static const size_t BUFFER_BYTES = 16 * 1024;
+	static const int ENTRIES_PER_READ = 64;
+
+	FrameStore* store;
+	int source;
+	uint64_t from;
+	uint64_t to;
+	uint64_t count;
+
+	/** Reads done since beginBatch() */
+	int reads;
+
+	/** Segment being read, if dataFd >= 0 */
+	uint32_t segmentNumber;
+	uint64_t segmentBytes;
+	uint32_t indexEntries;
+	int dataFd;
+	int indexFd;
+
+	/** Index entries read, and the next one to look at */
+	FrameStoreIndexEntry entries[ENTRIES_PER_READ];
+	uint32_t entriesRead;
+	int nentries;
+	int entryPos;
+
+	/** Records after the last index entry */
+	uint64_t tailOffset;
+	bool tailDone;
+
+	/** Range of the frames file being read */
+	uint64_t readOffset;
+	uint64_t readEnd;
+
+	uint8_t buffer[BUFFER_BYTES];
+	size_t bufferPos;
+	size_t bufferLen;
+
+	bool mayMatch(uint64_t minTimestamp, uint64_t maxTimestamp, const uint8_t sources[32]);
+	bool matches(const FrameRecord& record);
+	bool mayRead();
+	int openSegment();
+	void closeSegment();
+	int nextRange();
+};
+
+#endif /* FRAMESTOREQUERY_HPP_ */
@@ -23,9 +23,10 @@
 #include <unistd.h>
 #include <string.h>
 #include <poll.h>
-#include <unistd.h>
+#include <errno.h>
+#include <assert.h>
 
-#include "DateTime.hpp"
+#include "Log.hpp"
 
 #include "Gpio.hpp"
 
@@ -42,8 +43,14 @@ Gpio::Gpio(const char* pin) {
 	this->pin = pin;
 }
 
+Gpio::Gpio() {
+	this->pin = NULL;
+}
+
 Gpio::~Gpio() {
-	this->unexportPin();
+	if (this->pin != NULL) {
+		this->unexportPin();
+	}
 }
 
 /**
@@ -181,11 +188,12 @@ void Gpio::getPinValue(void* value, size_t nbytes) {
  * condition to happen.
  * 
  * Method returns
- *  0 if nothing happened within the specified timeout.
+ *  0 if nothing happened within the specified timeout, or a signal
+ *    interrupted the wait.
  *  1 if the PIN value changed.
- * -1 if there was an event on the other file descriptor.
+ * -1 if there was an event on one of the other file descriptors.
  */
-int Gpio::waitForPinValueChange(int timeout_millis, int otherFd) {
+int Gpio::waitForPinValueChange(int timeout_millis, struct pollfd otherFds[], int nOtherFds) {
 
 	setPinEdge(Gpio::EDGE_RISING);
 
@@ -206,16 +214,39 @@ int Gpio::waitForPinValueChange(int timeout_millis, int otherFd) {
 		exit(1);
 	}
 
-	struct pollfd pl[2];
+	// The pin may already have been raised before we started polling.
+	// In this case, there will be no further edge.
+	if (c == '1') {
+		close(fd);
+		for (int i=0 ; i<nOtherFds ; i++) {
+			otherFds[i].revents = 0;
+		}
+		return 1;
+	}
+
+	const int MAX_FDS = 64;
+	assert(nOtherFds < MAX_FDS);
+
+	struct pollfd pl[MAX_FDS];
 	pl[0].fd = fd;
 	pl[0].events = POLLPRI | POLLERR;
+	pl[0].revents = 0;
 
-	pl[1].fd = otherFd;
-	pl[1].events = POLLIN | POLLERR;
+	for (int i=0 ; i<nOtherFds ; i++) {
+		pl[i+1] = otherFds[i];
+		pl[i+1].revents = 0;
+	}
 
-	DateTime::print();
-	printf("Polling (timeout=%d ms)\n", timeout_millis);
-	rc = poll(pl, 2, timeout_millis);
+	LOG_DEBUG("Polling (timeout=%d ms)\n", timeout_millis);
+	rc = poll(pl, nOtherFds + 1, timeout_millis);
+	if (rc < 0 && errno == EINTR) {
+		// Interrupted by a signal, let the caller handle it
+		close(fd);
+		for (int i=0 ; i<nOtherFds ; i++) {
+			otherFds[i].revents = 0;
+		}
+		return 0;
+	}
 	if(rc < 0) {
 		perror("poll");
 		exit(1);
@@ -223,23 +254,25 @@ int Gpio::waitForPinValueChange(int timeout_millis, int otherFd) {
 
 	close(fd);
 
-	/*
-	DateTime::print();
-	printf("rc=0x%.2X  pl[0].revents=0x%.2X  pl[1].revents=0x%.2X\n",
-			rc, pl[0].revents, pl[1].revents);
-	*/
+	bool otherEvent = false;
+	for (int i=0 ; i<nOtherFds ; i++) {
+		otherFds[i].revents = pl[i+1].revents;
+		if (pl[i+1].revents > 0) {
+			otherEvent = true;
+		}
+	}
 
 	// Will return 0 in case of timeout
 	if (rc == 0) {
 		return 0; // Timeout
 	}
 
-	if (pl[1].revents > 0) {
-		// Data ready to read from the socket or socket was closed.
-		return -1;
+	if (pl[0].revents != 0) {
+		return 1; // Data available in RX FIFO, the caller also checks the sockets
 	}
 
-	return 1; // Data available in RX FIFO
+	// Data ready to read from a socket or socket was closed.
+	return otherEvent ? -1 : 0;
 }
 
 /**
@@ -271,6 +304,10 @@ int Gpio::waitForPinValueChange(int timeout_millis, const char* edge) {
 	pl[0].events = POLLPRI | POLLERR;
 
 	rc = poll(pl, 1, timeout_millis);
+	if (rc < 0 && errno == EINTR) {
+		close(fd);
+		return 0;
+	}
 	if(rc < 0) {
 		perror("poll");
 		exit(1);
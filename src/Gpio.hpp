@@ -26,38 +26,48 @@
 #include <stdlib.h>
 #include <string.h>
 #include <fcntl.h>
+#include <poll.h>
 
 /**
  * Represents a GPIO pin,
  * using the sysfs userspace interface provided by the kernel.
  * 
  * See https://www.kernel.org/doc/Documentation/gpio.txt for details.
+ *
+ * The methods are virtual so simulations can replace the RF module's
+ * GDO pin by a subclass.
  */
 class Gpio {
 private:
 	/** Name of the GPIO pin */
 	const char* pin;
 
+protected:
+	/**
+	 * For subclasses that don't use a GPIO pin.
+	 */
+	Gpio();
+
 public:
 	Gpio(const char* pin);
-	~Gpio();
+	virtual ~Gpio();
 
 	/**
 	 * Ask the kernel to export control of this GPIO pin to userspace.
 	 */
-	void exportPin();
+	virtual void exportPin();
 	
 	/**
 	 * Reverses the effect of exporting control of this GPIO pin to userspace.
 	 */
-	void unexportPin();
+	virtual void unexportPin();
 	
 	/**
 	 * Define the direction of the GPIO pin: "in" or "out".
 	 */
 	static const char* DIRECTION_IN; // "in"
 	static const char* DIRECTION_OUT; // "out"
-	void setPinDirection(const char* direction);
+	virtual void setPinDirection(const char* direction);
 	
 	/**
 	 * Define the GPIO pin to generate interrupts on changes of its value.
@@ -67,23 +77,27 @@ public:
 	static const char* EDGE_RISING; // "rising";
 	static const char* EDGE_FALLING; // "falling";
 	static const char* EDGE_BOTH; // "both";
-	void setPinEdge(const char* edge);
+	virtual void setPinEdge(const char* edge);
 
 	/**
 	 * Get the current value of the GPIO pin.
 	 */
-	void getPinValue(void* value, size_t nbytes);
+	virtual void getPinValue(void* value, size_t nbytes);
 	
 	/**
 	 * If the GPIO pin was configured to generate interrupts (see the
 	 * description of "edge"), you can use this method to wait for the edge
 	 * condition to happen. If 0 is returned, the edge condition did not
-	 * happen within the specified timeout.
+	 * happen within the specified timeout or a signal interrupted the wait.
+	 * The other file descriptors are polled at the same time; their
+	 * revents fields are updated. Returns 1 if the pin was raised, even if
+	 * there were events on the other file descriptors too, -1 if there
+	 * were only those.
 	 */
-	int waitForPinValueChange(int timeout_millis, int otherFd);
+	virtual int waitForPinValueChange(int timeout_millis, struct pollfd otherFds[], int nOtherFds);
 
 
-	int waitForPinValueChange(int timeout_millis, const char* edge);
+	virtual int waitForPinValueChange(int timeout_millis, const char* edge);
 };
 
 
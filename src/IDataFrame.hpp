@@ -24,13 +24,17 @@
 #include <stddef.h>
 
 #include "Protocol.hpp"
+#include "FrameRecord.hpp"
 
 /**
  * Interface for all DataFrame implementation.
  *
  * A data frame provides a way to structure the data bytes received into
- * custom fields. When transmitting data bytes, the value of the data frame's
- * fields are collected and transformed into a buffer of bytes.
+ * the fields of a FrameRecord. When transmitting data bytes, the values of
+ * the record's fields are collected and transformed into a buffer of bytes.
+ *
+ * Data frames keep no state about the data received, so the record may
+ * be any slot of the FramePool.
  */
 class IDataFrame {
 
@@ -38,32 +42,45 @@ protected:
 	Protocol* protocol;
 
 public:
+	/** Returned by receive() if the receiver detected a CRC error */
+	static const int CRC_ERROR = -2;
 
 	IDataFrame(Protocol* protocol) { this->protocol = protocol; };
 	virtual ~IDataFrame() {};
 
 	/**
-	 * Receive data bytes over the air and structure them into fields.
-	 * Only call this method if there is some data in the RX FIFO.
-	 *
+	 * Receive data bytes over the air and structure them into the fields
+	 * of a record. Only call this method if there is some data in the
+	 * RX FIFO.
+	 * Sequence number and timestamps are filled in by the caller.
 	 *
 	 * Returns 0 if a valid data frame could be read from the RX FIFO
 	 * and decoded successfully.
-	 * Returns -1 on error.
+	 * Returns CRC_ERROR if the receiver detected a CRC error. The record
+	 * then holds the addresses, RSSI and LQI as received, without
+	 * FRAME_FLAG_CRC_OK; the addresses may be damaged.
+	 * Returns -1 on other errors.
 	 */
-	virtual int receive() = 0;
+	virtual int receive(FrameRecord& record) = 0;
 
 	/**
-	 * Collect the data frame's fields, transform them into a buffer of
-	 * bytes and transmit the byte buffer over the air.
+	 * Collect the fields of a record (addresses and payload), transform
+	 * them into a buffer of bytes and transmit the byte buffer over the air.
+	 *
+	 * Returns 0 on success, -1 if the record doesn't fit into the data
+	 * frame, the data frame format can't be transmitted or transmitting
+	 * failed.
+	 *
+	 * Receive-only formats, e.g. those decoded by a DecoderPipeline,
+	 * always return -1 without touching the RF module.
 	 */
-	virtual int transmit() = 0;
-
+	virtual int transmit(const FrameRecord& record) = 0;
 
 	/**
-	 * Writes the data frame to a file descriptor in a custom format.
+	 * Name of the output format used for clients that didn't select one,
+	 * see OutputFormatRegistry.
 	 */
-	virtual void writeToSocket(int fd) = 0;
+	virtual const char* getDefaultOutputFormat() = 0;
 };
 
 
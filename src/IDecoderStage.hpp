@@ -0,0 +1,64 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef IDECODERSTAGE_HPP_
+#define IDECODERSTAGE_HPP_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "FrameRecord.hpp"
+
+/**
+ * The bytes a decoder stage works on. Stages transform the bytes in place:
+ * They may shorten the buffer or skip bytes at its start by advancing data,
+ * but never write beyond data + len. A stage may also write its result to
+ * the payload of the record and point data there.
+ */
+struct DecoderBuffer {
+	uint8_t* data;
+	size_t len;
+};
+
+/**
+ * One step of a DecoderPipeline, e.g. removing the start and stop bits of
+ * a serial bitstream or checking a preamble.
+ */
+class IDecoderStage {
+
+public:
+	virtual ~IDecoderStage() {};
+
+	/**
+	 * Name used in the pipeline configuration, e.g. "manchester".
+	 */
+	virtual const char* getName() = 0;
+
+	/**
+	 * Transforms the bytes received. Stages may also fill in fields of the
+	 * record, e.g. the addresses contained in the bytes.
+	 *
+	 * Returns 0 if the bytes are passed on to the next stage, -1 if the
+	 * data frame is rejected.
+	 */
+	virtual int process(DecoderBuffer& buffer, FrameRecord& record) = 0;
+};
+
+
+#endif /* IDECODERSTAGE_HPP_ */
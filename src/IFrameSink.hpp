@@ -0,0 +1,72 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef IFRAMESINK_HPP_
+#define IFRAMESINK_HPP_
+
+#include "FrameRecord.hpp"
+#include "FramePool.hpp"
+
+/**
+ * Interface for all outputs that get a copy of every data frame received,
+ * in addition to the clients connected to the socket server.
+ */
+class IFrameSink {
+
+public:
+	virtual ~IFrameSink() {};
+
+	/**
+	 * Called once for every data frame that was received and decoded
+	 * successfully. The record is only valid during the call.
+	 */
+	virtual void publish(const FrameRecord& record) {};
+
+	/**
+	 * Called by the device for every data frame received, with the slot it
+	 * was received into. Sinks that keep the data frame beyond the call,
+	 * e.g. for a background thread, retain the slot instead of copying the
+	 * record, and release it when done. By default the record is published.
+	 */
+	virtual void publishFrame(FramePool* pool, const FrameDescriptor& frame) {
+		publish(pool->get(frame.slot));
+	}
+
+	/**
+	 * Called for every data frame the receiver detected a CRC error in,
+	 * with the addresses, RSSI and LQI as received and the timestamps.
+	 * The data frame is not passed on otherwise.
+	 */
+	virtual void publishCrcError(const FrameRecord& record) {};
+
+	/**
+	 * Sinks that collect several records before writing them out return
+	 * the number of milliseconds until flush() should be called.
+	 * Returns -1 if there is nothing pending.
+	 */
+	virtual int flushTimeout() { return -1; };
+
+	/**
+	 * Writes out the records collected so far.
+	 */
+	virtual void flush() {};
+};
+
+
+#endif /* IFRAMESINK_HPP_ */
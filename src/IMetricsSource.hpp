@@ -0,0 +1,43 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef IMETRICSSOURCE_HPP_
+#define IMETRICSSOURCE_HPP_
+
+#include <stddef.h>
+
+/**
+ * Interface for the parts of the driver that have metrics of their own
+ * to expose, in addition to the Metrics counters, e.g. queue depths.
+ */
+class IMetricsSource {
+
+public:
+	virtual ~IMetricsSource() {};
+
+	/**
+	 * Writes the metrics in the Prometheus text format (see
+	 * Metrics::formatHeader() and Metrics::formatSample()).
+	 * Returns the number of characters written, less than maxBytes.
+	 */
+	virtual size_t formatMetrics(char* out, size_t maxBytes) = 0;
+};
+
+
+#endif /* IMETRICSSOURCE_HPP_ */
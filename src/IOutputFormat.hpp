@@ -0,0 +1,55 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef IOUTPUTFORMAT_HPP_
+#define IOUTPUTFORMAT_HPP_
+
+#include <stddef.h>
+
+#include "FrameRecord.hpp"
+
+/**
+ * Interface for all output formats clients can select with the "OF"
+ * command.
+ *
+ * Output formats work on FrameRecords, so every output format can be used
+ * with every data frame format.
+ */
+class IOutputFormat {
+
+public:
+	/** Longest output of any output format, for the largest payload */
+	static const size_t MAX_LINE_BYTES = 1024;
+
+	virtual ~IOutputFormat() {};
+
+	/**
+	 * Name used to select the output format, e.g. "json".
+	 */
+	virtual const char* getName() = 0;
+
+	/**
+	 * Renders a record. The line must have room for MAX_LINE_BYTES.
+	 * Returns the number of bytes written.
+	 */
+	virtual size_t format(const FrameRecord& record, char line[], size_t maxBytes) = 0;
+};
+
+
+#endif /* IOUTPUTFORMAT_HPP_ */
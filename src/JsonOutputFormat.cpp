@@ -0,0 +1,103 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <assert.h>
+
+#include "FrameFields.hpp"
+#include "OutputEncoding.hpp"
+
+#include "JsonOutputFormat.hpp"
+
+/**
+ * Writes the fields as JSON object members. Field names and type names
+ * never need to be escaped.
+ */
+class JsonWriter : public IFieldVisitor {
+
+public:
+	char* p;
+
+	JsonWriter(char* p) {
+		this->p = p;
+		*this->p++ = '{';
+	}
+
+	void name(const char* name) {
+		if (this->p[-1] != '{') {
+			*this->p++ = ',';
+		}
+
+		*this->p++ = '"';
+		size_t len = strlen(name);
+		memcpy(this->p, name, len);
+		this->p += len;
+		*this->p++ = '"';
+		*this->p++ = ':';
+	}
+
+	void visitUnsigned(const char* name, uint64_t value) {
+		this->name(name);
+		this->p = OutputEncoding::decimal(this->p, value);
+	}
+
+	void visitSigned(const char* name, int64_t value) {
+		this->name(name);
+		this->p = OutputEncoding::signedDecimal(this->p, value);
+	}
+
+	void visitBool(const char* name, bool value) {
+		this->name(name);
+		const char* s = value ? "true" : "false";
+		size_t len = strlen(s);
+		memcpy(this->p, s, len);
+		this->p += len;
+	}
+
+	void visitString(const char* name, const char* value) {
+		this->name(name);
+		*this->p++ = '"';
+		size_t len = strlen(value);
+		memcpy(this->p, value, len);
+		this->p += len;
+		*this->p++ = '"';
+	}
+
+	void visitBytes(const char* name, const uint8_t data[], size_t len) {
+		this->name(name);
+		*this->p++ = '"';
+		this->p = OutputEncoding::hex(this->p, data, len);
+		*this->p++ = '"';
+	}
+
+	void visitMissing(const char* name) {
+	}
+};
+
+size_t JsonOutputFormat::format(const FrameRecord& record, char line[], size_t maxBytes) {
+
+	assert(maxBytes >= MAX_LINE_BYTES);
+
+	JsonWriter writer(line);
+	FrameFields::visit(record, writer);
+	*writer.p++ = '}';
+	*writer.p++ = '\n';
+
+	return writer.p - line;
+}
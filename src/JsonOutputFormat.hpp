@@ -0,0 +1,45 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef JSONOUTPUTFORMAT_HPP_
+#define JSONOUTPUTFORMAT_HPP_
+
+#include "IOutputFormat.hpp"
+
+/**
+ * Renders records as JSON Lines: One JSON object per line, e.g.
+ *
+ * {"seq":17,"ts":1380000000000000000,"type":"rfbee","src":10,"dst":1,
+ *  "rssi":-88,"lqi":45,"crc":true,"payload":"48656C6C6F"}
+ *
+ * Fields not available for the data frame format are left out.
+ * The payload is written in hex.
+ */
+class JsonOutputFormat : public IOutputFormat {
+
+public:
+	virtual const char* getName() {
+		return "json";
+	}
+
+	virtual size_t format(const FrameRecord& record, char line[], size_t maxBytes);
+};
+
+
+#endif /* JSONOUTPUTFORMAT_HPP_ */
@@ -0,0 +1,52 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <strings.h>
+
+#include "ReceiveLatency.hpp"
+
+#include "LatencyCommand.hpp"
+
+int LatencyCommand::execute(ClientConnection* client, const char* parameters) {
+
+	if (strcasecmp(parameters, "RESET") == 0) {
+		ReceiveLatency::reset();
+		return 0;
+	}
+
+	if (*parameters != '\0') {
+		return -1;
+	}
+
+	for (int i=0 ; i<ReceiveLatency::STAGES ; i++) {
+		LatencyHistogram& histogram = ReceiveLatency::getHistogram(i);
+
+		client->respond("HI %s %llu %llu %llu %llu %llu %llu %llu\n",
+				ReceiveLatency::getStageName(i),
+				(unsigned long long) histogram.getCount(),
+				(unsigned long long) histogram.getMin(),
+				(unsigned long long) histogram.getPercentile(50.0),
+				(unsigned long long) histogram.getPercentile(90.0),
+				(unsigned long long) histogram.getPercentile(99.0),
+				(unsigned long long) histogram.getPercentile(99.9),
+				(unsigned long long) histogram.getMax());
+	}
+
+	return 0;
+}
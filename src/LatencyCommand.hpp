@@ -0,0 +1,43 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LATENCYCOMMAND_HPP_
+#define LATENCYCOMMAND_HPP_
+
+#include "AbstractCommand.hpp"
+
+/**
+ * Returns the latency histograms of the receive path (see ReceiveLatency).
+ *
+ * "HI" returns one line per stage,
+ * "HI <stage> <count> <min> <p50> <p90> <p99> <p999> <max>", in ns.
+ * "HI RESET" clears the histograms.
+ */
+class LatencyCommand : public AbstractCommand {
+
+public:
+	const char* getToken() {
+		return "HI";
+	}
+
+	int execute(ClientConnection* client, const char* parameters);
+};
+
+
+#endif /* LATENCYCOMMAND_HPP_ */
@@ -0,0 +1,96 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "LatencyHistogram.hpp"
+
+LatencyHistogram::LatencyHistogram() {
+	this->reset();
+}
+
+void LatencyHistogram::reset() {
+	memset(this->counts, 0, sizeof(this->counts));
+	this->count = 0;
+	this->min = 0;
+	this->max = 0;
+}
+
+/**
+ * Values below 2 * SUB_BUCKETS have a bucket each. Above, the value is
+ * shifted right until it has SUB_BUCKET_BITS + 1 bits left; the shift
+ * selects the power of two, the remaining bits the bucket within.
+ */
+int LatencyHistogram::bucketOf(uint64_t nanos) {
+	if (nanos > MAX_NANOS) {
+		nanos = MAX_NANOS;
+	}
+
+	if (nanos < 2 * SUB_BUCKETS) {
+		return nanos;
+	}
+
+	int shift = 63 - __builtin_clzll(nanos) - SUB_BUCKET_BITS;
+	return shift * SUB_BUCKETS + (nanos >> shift);
+}
+
+uint64_t LatencyHistogram::highestOf(int bucket) {
+	if (bucket < 2 * SUB_BUCKETS) {
+		return bucket;
+	}
+
+	int shift = bucket / SUB_BUCKETS - 1;
+	uint64_t sub = bucket - shift * SUB_BUCKETS;
+	return ((sub + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t nanos) {
+	this->counts[bucketOf(nanos)]++;
+
+	if (this->count == 0 || nanos < this->min) {
+		this->min = nanos;
+	}
+	if (nanos > this->max) {
+		this->max = nanos;
+	}
+
+	this->count++;
+}
+
+uint64_t LatencyHistogram::getPercentile(double percent) {
+	if (this->count == 0) {
+		return 0;
+	}
+
+	uint64_t rank = (uint64_t) (percent / 100.0 * this->count + 0.5);
+	if (rank < 1) {
+		rank = 1;
+	}
+
+	uint64_t seen = 0;
+	for (int i=0 ; i<BUCKETS ; i++) {
+		seen += this->counts[i];
+		if (seen >= rank) {
+			uint64_t highest = highestOf(i);
+			return highest < this->max ? highest : this->max;
+		}
+	}
+
+	return this->max;
+}
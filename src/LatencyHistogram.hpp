@@ -0,0 +1,73 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LATENCYHISTOGRAM_HPP_
+#define LATENCYHISTOGRAM_HPP_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Histogram of latencies in nanoseconds with a fixed amount of memory,
+ * in the style of an HDR histogram: Each power of two is split into
+ * SUB_BUCKETS linear buckets, so every value is counted with a relative
+ * error of less than 1/SUB_BUCKETS (about 3%), from 1 ns up to MAX_NANOS.
+ * Larger values are counted in the last bucket.
+ *
+ * Recording a value is a few shifts and an increment, without allocation.
+ */
+class LatencyHistogram {
+
+public:
+	static const int SUB_BUCKET_BITS = 5;
+	static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+
+	/** About 68 seconds */
+	static const uint64_t MAX_NANOS = (1ULL << 36) - 1;
+
+	static const int BUCKETS = 1024;
+
+	LatencyHistogram();
+
+	void record(uint64_t nanos);
+
+	void reset();
+
+	uint64_t getCount() { return this->count; };
+	uint64_t getMin() { return this->count > 0 ? this->min : 0; };
+	uint64_t getMax() { return this->max; };
+
+	/**
+	 * Returns the value below or at which the given percentage of the
+	 * values lie, e.g. 99.9. Returns the upper end of the bucket, but not
+	 * more than the largest value recorded.
+	 */
+	uint64_t getPercentile(double percent);
+
+private:
+	uint64_t counts[BUCKETS];
+	uint64_t count;
+	uint64_t min;
+	uint64_t max;
+
+	static int bucketOf(uint64_t nanos);
+	static uint64_t highestOf(int bucket);
+};
+
+#endif /* LATENCYHISTOGRAM_HPP_ */
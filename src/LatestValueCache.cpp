@@ -0,0 +1,45 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <string.h>
+
+#include "LatestValueCache.hpp"
+
+LatestValueCache::LatestValueCache() {
+	memset(this->entries, 0, sizeof(this->entries));
+}
+
+void LatestValueCache::publish(const FrameRecord& record) {
+
+	bool assigned;
+	int slot = this->senders.lookup(record, assigned);
+	if (slot == SenderTable::NO_SLOT) {
+		return;
+	}
+
+	Entry& entry = this->entries[slot];
+	if (assigned) {
+		entry.count = 0;
+	}
+	entry.count++;
+
+	// Only the valid part of the payload
+	memcpy(&entry.record, &record, offsetof(FrameRecord, payload) + record.len);
+}
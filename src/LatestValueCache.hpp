@@ -0,0 +1,68 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LATESTVALUECACHE_HPP_
+#define LATESTVALUECACHE_HPP_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "IFrameSink.hpp"
+#include "SenderTable.hpp"
+
+/**
+ * Keeps the last data frame received from every sender, so clients that
+ * only need the latest readings don't have to follow the stream.
+ * Senders are told apart by the SenderTable; data frames without a sender,
+ * e.g. raw ones, are not kept.
+ *
+ * Called by the receive loop, like the commands reading it, so there is
+ * no locking.
+ */
+class LatestValueCache : public IFrameSink {
+
+public:
+	struct Entry {
+		/** Data frames received from this sender */
+		uint64_t count;
+
+		/** The last one, with time, RSSI and LQI */
+		FrameRecord record;
+	};
+
+	LatestValueCache();
+
+	virtual void publish(const FrameRecord& record);
+
+	SenderTable& getSenders() { return this->senders; };
+
+	/**
+	 * Returns the entry of a slot of the sender table, or NULL if the slot is unused.
+	 */
+	const Entry* getEntry(int slot) {
+		return this->senders.isUsed(slot) ? &this->entries[slot] : NULL;
+	};
+
+private:
+	SenderTable senders;
+	Entry entries[SenderTable::SLOTS];
+};
+
+#endif /* LATESTVALUECACHE_HPP_ */
@@ -0,0 +1,65 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "OutputEncoding.hpp"
+
+#include "LatestValueCommand.hpp"
+
+void LatestValueCommand::respond(ClientConnection* client, int slot) {
+
+	const LatestValueCache::Entry* entry = this->cache->getEntry(slot);
+	const FrameRecord& record = entry->record;
+
+	char name[SenderTable::NAME_LENGTH];
+	this->cache->getSenders().formatName(slot, name);
+
+	size_t len = record.len < MAX_PAYLOAD_BYTES ? record.len : MAX_PAYLOAD_BYTES;
+	char payload[2 * MAX_PAYLOAD_BYTES + 1];
+	*OutputEncoding::hex(payload, record.payload, len) = '\0';
+
+	client->respond("LV %s %llu %llu %d %u %s\n",
+			name,
+			(unsigned long long) entry->count,
+			(unsigned long long) record.timestamp,
+			decodeRssi(record.rssi),
+			record.lqi,
+			payload);
+}
+
+int LatestValueCommand::execute(ClientConnection* client, const char* parameters) {
+
+	if (*parameters == '\0') {
+		for (int slot=0 ; slot<SenderTable::SLOTS ; slot++) {
+			if (this->cache->getEntry(slot) != NULL) {
+				respond(client, slot);
+			}
+		}
+
+		return 0;
+	}
+
+	int slot = this->cache->getSenders().findName(parameters);
+	if (slot == SenderTable::NO_SLOT) {
+		return -1;
+	}
+
+	respond(client, slot);
+	return 0;
+}
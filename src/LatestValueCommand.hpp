@@ -0,0 +1,58 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LATESTVALUECOMMAND_HPP_
+#define LATESTVALUECOMMAND_HPP_
+
+#include "AbstractCommand.hpp"
+#include "LatestValueCache.hpp"
+
+/**
+ * Returns the last data frame received from a sender (see LatestValueCache).
+ *
+ * "LV" returns all senders, "LV <address>" the one with this source
+ * address (2 hex digits) or radiator device address (6 hex digits).
+ * One line per sender,
+ * "LV <address> <count> <ts> <rssi> <lqi> <payload>", with ts in ns
+ * since the epoch, RSSI in dBm and the payload in hex.
+ */
+class LatestValueCommand : public AbstractCommand {
+	LatestValueCache* cache;
+
+public:
+	/** Bytes of the payload returned, so the line fits into a response */
+	static const size_t MAX_PAYLOAD_BYTES = 96;
+
+	LatestValueCommand(LatestValueCache* cache) {
+		this->cache = cache;
+	}
+
+	const char* getToken() {
+		return "LV";
+	}
+
+	int execute(ClientConnection* client, const char* parameters);
+
+private:
+	void respond(ClientConnection* client, int slot);
+};
+
+
+#endif /* LATESTVALUECOMMAND_HPP_ */
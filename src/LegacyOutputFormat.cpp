@@ -0,0 +1,104 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <assert.h>
+
+#include "OutputEncoding.hpp"
+
+#include "LegacyOutputFormat.hpp"
+
+static const char* NAMES[] = { "payload", "address", "binary", "decimal", "hex", "raw", "radiator" };
+
+LegacyOutputFormat::LegacyOutputFormat(int style) {
+	assert(style >= STYLE_PAYLOAD && style <= STYLE_RADIATOR);
+
+	this->style = style;
+}
+
+const char* LegacyOutputFormat::getName() {
+	return NAMES[this->style];
+}
+
+size_t LegacyOutputFormat::format(const FrameRecord& record, char line[], size_t maxBytes) {
+
+	assert(maxBytes >= MAX_LINE_BYTES);
+
+	size_t len = record.len;
+	if (len > FrameRecord::MAX_PAYLOAD_BYTES) {
+		len = FrameRecord::MAX_PAYLOAD_BYTES;
+	}
+
+	char* p = line;
+
+	switch(this->style) {
+
+	case STYLE_PAYLOAD :
+		memcpy(p, record.payload, len); p += len;
+		break;
+
+	case STYLE_ADDRESS :
+		*p++ = record.srcAddress;
+		*p++ = record.destAddress;
+		memcpy(p, record.payload, len); p += len;
+		break;
+
+	case STYLE_BINARY :
+		*p++ = len;
+		*p++ = record.srcAddress;
+		*p++ = record.destAddress;
+		memcpy(p, record.payload, len); p += len;
+		*p++ = record.rssi;
+		*p++ = record.lqi;
+		break;
+
+	case STYLE_DECIMAL :
+		p = OutputEncoding::decimal(p, len); *p++ = ',';
+		p = OutputEncoding::decimal(p, record.srcAddress); *p++ = ',';
+		p = OutputEncoding::decimal(p, record.destAddress); *p++ = ',';
+		memcpy(p, record.payload, len); p += len;
+		*p++ = ',';
+		p = OutputEncoding::decimal(p, record.rssi); *p++ = ',';
+		p = OutputEncoding::decimal(p, record.lqi); *p++ = '\n';
+		break;
+
+	case STYLE_HEX :
+		p = OutputEncoding::hex(p, len); *p++ = ' ';
+		p = OutputEncoding::hex(p, record.srcAddress); *p++ = ' ';
+		p = OutputEncoding::hex(p, record.destAddress); *p++ = ' ';
+		p = OutputEncoding::hex(p, record.payload, len); *p++ = ' ';
+		p = OutputEncoding::hex(p, record.rssi); *p++ = ' ';
+		p = OutputEncoding::hex(p, record.lqi); *p++ = '\n';
+		break;
+
+	case STYLE_RAW :
+		p = OutputEncoding::hex(p, record.payload, len);
+		*p++ = '\n';
+		break;
+
+	case STYLE_RADIATOR :
+		p = OutputEncoding::hex(p, record.payload, len);
+		*p++ = '-';
+		p = OutputEncoding::hex(p, record.rssi);
+		*p++ = '\n';
+		break;
+	}
+
+	return p - line;
+}
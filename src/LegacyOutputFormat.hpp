@@ -0,0 +1,59 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LEGACYOUTPUTFORMAT_HPP_
+#define LEGACYOUTPUTFORMAT_HPP_
+
+#include "IOutputFormat.hpp"
+
+/**
+ * The output formats clients got before output formats could be selected
+ * by name. The first five are registered first, so clients may still
+ * select them by number.
+ *
+ * 0 "payload":  Payload only
+ * 1 "address":  Source, destination, payload
+ * 2 "binary":   Payload length, source, destination, payload, RSSI, LQI
+ * 3 "decimal":  As 2, numbers in decimal, separated by comma, NL
+ * 4 "hex":      As 2, in hex, separated by blank, NL
+ * "raw":        Payload in hex, NL
+ * "radiator":   Payload in hex, '-', RSSI in hex, NL
+ */
+class LegacyOutputFormat : public IOutputFormat {
+
+public:
+	static const int STYLE_PAYLOAD = 0;
+	static const int STYLE_ADDRESS = 1;
+	static const int STYLE_BINARY = 2;
+	static const int STYLE_DECIMAL = 3;
+	static const int STYLE_HEX = 4;
+	static const int STYLE_RAW = 5;
+	static const int STYLE_RADIATOR = 6;
+
+	LegacyOutputFormat(int style);
+
+	virtual const char* getName();
+	virtual size_t format(const FrameRecord& record, char line[], size_t maxBytes);
+
+private:
+	int style;
+};
+
+
+#endif /* LEGACYOUTPUTFORMAT_HPP_ */
@@ -0,0 +1,76 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdio.h>
+#include <strings.h>
+
+#include "LinkQualityCommand.hpp"
+
+void LinkQualityCommand::respond(ClientConnection* client, int slot) {
+
+	const LinkStatistics* link = this->tracker->getStatistics(slot);
+
+	char name[SenderTable::NAME_LENGTH];
+	this->tracker->getSenders().formatName(slot, name);
+
+	char lqi[LinkStatistics::LQI_BUCKETS * 11];
+	size_t len = 0;
+	for (int i=0 ; i<LinkStatistics::LQI_BUCKETS ; i++) {
+		len += snprintf(lqi + len, sizeof(lqi) - len, i == 0 ? "%u" : ",%u", link->lqi[i]);
+	}
+
+	client->respond("LQ %s %llu %llu %llu %.1f %d %d %.3f %.3f %s\n",
+			name,
+			(unsigned long long) link->frames,
+			(unsigned long long) link->crcErrors,
+			(unsigned long long) link->lost,
+			link->rssiAverage / 256.0,
+			link->rssiMin,
+			link->rssiMax,
+			link->period / 1e6,
+			link->jitter / 1e6,
+			lqi);
+}
+
+int LinkQualityCommand::execute(ClientConnection* client, const char* parameters) {
+
+	if (strcasecmp(parameters, "RESET") == 0) {
+		this->tracker->reset();
+		return 0;
+	}
+
+	if (*parameters == '\0') {
+		for (int slot=0 ; slot<SenderTable::SLOTS ; slot++) {
+			if (this->tracker->getStatistics(slot) != NULL) {
+				respond(client, slot);
+			}
+		}
+
+		return 0;
+	}
+
+	int slot = this->tracker->getSenders().findName(parameters);
+	if (slot == SenderTable::NO_SLOT) {
+		return -1;
+	}
+
+	respond(client, slot);
+	return 0;
+}
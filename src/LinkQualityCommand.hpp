@@ -0,0 +1,58 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LINKQUALITYCOMMAND_HPP_
+#define LINKQUALITYCOMMAND_HPP_
+
+#include "AbstractCommand.hpp"
+#include "LinkQualityTracker.hpp"
+
+/**
+ * Returns the statistics of the radio link to the senders (see LinkQualityTracker).
+ *
+ * "LQ" returns all senders, "LQ <address>" the one with this source
+ * address (2 hex digits) or radiator device address (6 hex digits).
+ * One line per sender,
+ * "LQ <address> <frames> <crc errors> <lost> <rssi> <min> <max> <period> <jitter> <lqi>",
+ * with the RSSI average, minimum and maximum in dBm, transmit interval
+ * and jitter in ms and the number of data frames per LQI range 0-15,
+ * 16-31, ... 112-127, separated by comma.
+ * "LQ RESET" clears the statistics.
+ */
+class LinkQualityCommand : public AbstractCommand {
+	LinkQualityTracker* tracker;
+
+public:
+	LinkQualityCommand(LinkQualityTracker* tracker) {
+		this->tracker = tracker;
+	}
+
+	const char* getToken() {
+		return "LQ";
+	}
+
+	int execute(ClientConnection* client, const char* parameters);
+
+private:
+	void respond(ClientConnection* client, int slot);
+};
+
+
+#endif /* LINKQUALITYCOMMAND_HPP_ */
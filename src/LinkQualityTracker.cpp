@@ -0,0 +1,154 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <string.h>
+
+#include "LinkQualityTracker.hpp"
+
+LinkQualityTracker::LinkQualityTracker() {
+	reset();
+}
+
+void LinkQualityTracker::reset() {
+	for (int slot=0 ; slot<SenderTable::SLOTS ; slot++) {
+		clear(this->statistics[slot]);
+	}
+}
+
+void LinkQualityTracker::clear(LinkStatistics& link) {
+	memset(&link, 0, sizeof(link));
+}
+
+/**
+ * Adds RSSI and LQI of a data frame, with or without CRC error.
+ */
+void LinkQualityTracker::addSignal(LinkStatistics& link, const FrameRecord& record) {
+
+	if ((record.flags & FRAME_FLAG_RSSI_LQI) == 0) {
+		return;
+	}
+
+	int rssi = decodeRssi(record.rssi);
+	bool first = link.frames + link.crcErrors == 0;
+
+	if (first) {
+		link.rssiAverage = rssi * 256;
+		link.rssiMin = rssi;
+		link.rssiMax = rssi;
+	} else {
+		link.rssiAverage += (rssi * 256 - link.rssiAverage) / (1 << RSSI_WEIGHT_SHIFT);
+		if (rssi < link.rssiMin) {
+			link.rssiMin = rssi;
+		}
+		if (rssi > link.rssiMax) {
+			link.rssiMax = rssi;
+		}
+	}
+
+	link.lqi[(record.lqi & 0x7F) / LinkStatistics::LQI_BUCKET_WIDTH]++;
+}
+
+/**
+ * Updates the interval, jitter and lost data frames with the arrival of
+ * a data frame without CRC error.
+ */
+void LinkQualityTracker::addArrival(LinkStatistics& link, uint64_t arrival) {
+
+	if (link.lastArrival == 0 || arrival <= link.lastArrival) {
+		link.lastArrival = arrival;
+		return;
+	}
+
+	uint64_t interval = arrival - link.lastArrival;
+	link.lastArrival = arrival;
+
+	uint64_t pendingCrcErrors = link.pendingCrcErrors;
+	link.pendingCrcErrors = 0;
+
+	if (link.period == 0) {
+		link.period = interval;
+	} else if (4 * interval < 3 * link.period) {
+		// A single short interval is a data frame received late before,
+		// several ones mean the sender transmits more often now
+		link.longIntervals = 0;
+		if (++link.shortIntervals == INTERVAL_CHANGE) {
+			link.shortIntervals = 0;
+			link.period = interval;
+		}
+	} else if (2 * interval > 3 * link.period) {
+		link.shortIntervals = 0;
+		link.lastInterval = 0; // Not a deviation of the interval
+
+		if (++link.longIntervals == INTERVAL_CHANGE) {
+			// The sender transmits less often now
+			link.longIntervals = 0;
+			link.period = interval;
+			return;
+		}
+
+		// Data frames that would have fit into the gap
+		uint64_t missing = (interval + link.period / 2) / link.period - 1;
+		link.lost += missing > pendingCrcErrors ? missing - pendingCrcErrors : 0;
+		return;
+	} else {
+		link.shortIntervals = 0;
+		link.longIntervals = 0;
+		link.period = link.period + (interval >> PERIOD_WEIGHT_SHIFT) - (link.period >> PERIOD_WEIGHT_SHIFT);
+	}
+
+	if (link.lastInterval > 0) {
+		uint64_t deviation = interval > link.lastInterval
+				? interval - link.lastInterval : link.lastInterval - interval;
+		link.jitter = link.jitter + (deviation >> JITTER_WEIGHT_SHIFT) - (link.jitter >> JITTER_WEIGHT_SHIFT);
+	}
+	link.lastInterval = interval;
+}
+
+void LinkQualityTracker::publish(const FrameRecord& record) {
+
+	bool assigned;
+	int slot = this->senders.lookup(record, assigned);
+	if (slot == SenderTable::NO_SLOT) {
+		return;
+	}
+
+	LinkStatistics& link = this->statistics[slot];
+	if (assigned) {
+		clear(link);
+	}
+
+	addSignal(link, record);
+	addArrival(link, record.monotonic);
+	link.frames++;
+}
+
+void LinkQualityTracker::publishCrcError(const FrameRecord& record) {
+
+	int slot = this->senders.find(record);
+	if (slot == SenderTable::NO_SLOT) {
+		return;
+	}
+
+	LinkStatistics& link = this->statistics[slot];
+
+	addSignal(link, record);
+	link.crcErrors++;
+	link.pendingCrcErrors++;
+}
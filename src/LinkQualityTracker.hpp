@@ -0,0 +1,138 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LINKQUALITYTRACKER_HPP_
+#define LINKQUALITYTRACKER_HPP_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "IFrameSink.hpp"
+#include "SenderTable.hpp"
+
+/**
+ * Statistics of the radio link to one sender, see LinkQualityTracker.
+ */
+struct LinkStatistics {
+	/** LQI values per bucket of the distribution */
+	static const int LQI_BUCKET_WIDTH = 16;
+	static const int LQI_BUCKETS = 128 / LQI_BUCKET_WIDTH;
+
+	/** Data frames received without CRC error */
+	uint64_t frames;
+
+	/** Data frames the receiver detected a CRC error in */
+	uint64_t crcErrors;
+
+	/** Data frames not received at all, estimated from the gaps between the others */
+	uint64_t lost;
+
+	/** Moving average of the RSSI, in 1/256 dBm */
+	int32_t rssiAverage;
+	int16_t rssiMin;
+	int16_t rssiMax;
+
+	/** Number of data frames by LQI, lower is better */
+	uint32_t lqi[LQI_BUCKETS];
+
+	/** Average time between two data frames without a gap, taken as the transmit interval (ns) */
+	uint64_t period;
+
+	/** Mean deviation of the time between two data frames from the one before (ns) */
+	uint64_t jitter;
+
+	/** Time the last data frame without CRC error was received (CLOCK_MONOTONIC, ns) */
+	uint64_t lastArrival;
+	uint64_t lastInterval;
+
+	/** CRC errors since then, they are not lost */
+	uint64_t pendingCrcErrors;
+
+	/** Intervals in a row much shorter or longer than the period */
+	uint8_t shortIntervals;
+	uint8_t longIntervals;
+};
+
+/**
+ * Keeps statistics of the radio link to every sender, to find out which
+ * ones are hard to receive, e.g. when deciding where to place repeaters:
+ * RSSI and LQI, the ratio of CRC errors and an estimate of the data frames
+ * lost.
+ *
+ * Senders are told apart by the SenderTable. Data frames with a CRC error
+ * only count for senders received before, as their addresses may be
+ * damaged.
+ *
+ * Lost data frames are estimated for senders transmitting at a regular
+ * interval: The average time between two data frames is taken as the
+ * interval, and every gap of more than 1.5 intervals counts the data
+ * frames that would have fit in, except those received with a CRC error.
+ * Gaps are left out of the average and the jitter. When three times in a
+ * row are much shorter or longer than the interval, the sender is taken
+ * to have changed its interval. So data frames are not counted as lost
+ * if every second one or more is missing.
+ *
+ * Every data frame takes a constant number of steps. Called by the receive
+ * loop, like the commands reading it, so there is no locking.
+ */
+class LinkQualityTracker : public IFrameSink {
+
+public:
+	/** Weight of a new RSSI value in the moving average, as shift */
+	static const int RSSI_WEIGHT_SHIFT = 3;
+
+	/** Weight of a new time between two data frames in the transmit interval, as shift */
+	static const int PERIOD_WEIGHT_SHIFT = 3;
+
+	/** Times in a row between two data frames that change the transmit interval */
+	static const int INTERVAL_CHANGE = 3;
+
+	/** Weight of a new deviation in the jitter, as shift (as in RFC 3550) */
+	static const int JITTER_WEIGHT_SHIFT = 4;
+
+	LinkQualityTracker();
+
+	virtual void publish(const FrameRecord& record);
+	virtual void publishCrcError(const FrameRecord& record);
+
+	SenderTable& getSenders() { return this->senders; };
+
+	/**
+	 * Returns the statistics of a slot of the sender table, or NULL if the slot is unused.
+	 */
+	const LinkStatistics* getStatistics(int slot) {
+		return this->senders.isUsed(slot) ? &this->statistics[slot] : NULL;
+	};
+
+	/**
+	 * Clears the statistics of all senders.
+	 */
+	void reset();
+
+private:
+	SenderTable senders;
+	LinkStatistics statistics[SenderTable::SLOTS];
+
+	static void clear(LinkStatistics& link);
+	static void addSignal(LinkStatistics& link, const FrameRecord& record);
+	static void addArrival(LinkStatistics& link, uint64_t arrival);
+};
+
+#endif /* LINKQUALITYTRACKER_HPP_ */
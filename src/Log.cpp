@@ -0,0 +1,467 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include "DateTime.hpp"
+
+#include "Log.hpp"
+
+/** How long the background thread sleeps when there is nothing to write */
+static const long FLUSH_INTERVAL_NANOS = 5000000;
+
+static const char* LEVEL_NAMES[] = { "debug", "info", "warn", "error" };
+
+int Log::level = LOG_LEVEL_DEBUG;
+FILE* Log::stream = stdout;
+
+volatile bool Log::running = false;
+pthread_t Log::thread;
+pthread_mutex_t Log::mutex = PTHREAD_MUTEX_INITIALIZER;
+
+Log::Buffer* Log::buffers[MAX_THREADS];
+int Log::nbuffers = 0;
+
+uint64_t Log::clockOffset = 0;
+
+__thread Log::Buffer* Log::threadBuffer = NULL;
+
+int Log::parseLevel(const char* name) {
+	for (int i=LOG_LEVEL_DEBUG ; i<=LOG_LEVEL_ERROR ; i++) {
+		if (strcasecmp(name, LEVEL_NAMES[i]) == 0) {
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+void Log::start() {
+	if (Log::running) {
+		return;
+	}
+
+	Log::clockOffset = DateTime::nanos(CLOCK_REALTIME) - DateTime::nanos(CLOCK_MONOTONIC);
+
+	// Messages written before go first
+	fflush(Log::stream);
+
+	Log::running = true;
+	if (pthread_create(&Log::thread, NULL, Log::run, NULL) != 0) {
+		perror("Starting log thread");
+		exit(1);
+	}
+
+	atexit(Log::stop);
+}
+
+void Log::stop() {
+	if (!Log::running) {
+		return;
+	}
+
+	Log::running = false;
+	pthread_join(Log::thread, NULL);
+}
+
+/**
+ * Returns the buffer of the calling thread, or NULL if there are too many
+ * threads.
+ */
+Log::Buffer* Log::getBuffer() {
+
+	if (Log::threadBuffer == NULL) {
+		pthread_mutex_lock(&Log::mutex);
+
+		if (Log::nbuffers < MAX_THREADS) {
+			Log::threadBuffer = (Buffer*) calloc(1, sizeof(Buffer));
+			if (Log::threadBuffer == NULL) {
+				perror("Allocating log buffer");
+				exit(1);
+			}
+
+			Log::buffers[Log::nbuffers] = Log::threadBuffer;
+			__atomic_store_n(&Log::nbuffers, Log::nbuffers + 1, __ATOMIC_RELEASE);
+		}
+
+		pthread_mutex_unlock(&Log::mutex);
+	}
+
+	return Log::threadBuffer;
+}
+
+/**
+ * Skips flags, width and precision of a conversion and counts the length
+ * modifiers. Returns the conversion character.
+ */
+static const char* parseConversion(const char* f, int& longs, bool& wide) {
+
+	longs = 0;
+	wide = false;
+
+	while (*f != '\0' && strchr("-+ #0123456789.", *f) != NULL) {
+		f++;
+	}
+
+	while (*f != '\0' && strchr("hlLqjzt", *f) != NULL) {
+		if (*f == 'l' || *f == 'q') {
+			longs++;
+		} else if (*f != 'h') {
+			wide = true;
+		}
+		f++;
+	}
+
+	return f;
+}
+
+/**
+ * Copies the arguments as the conversions of the format tell.
+ */
+void Log::capture(Entry& entry, const char* format, va_list ap) {
+
+	// Strings may only use the space not needed by the arguments after them
+	int remaining = 0;
+	for (const char* f = format ; *f != '\0' ; f++) {
+		if (*f == '%') {
+			if (f[1] == '%') {
+				f++;
+			} else {
+				remaining++;
+			}
+		}
+	}
+
+	uint8_t* p = entry.data;
+	uint8_t* end = entry.data + sizeof(entry.data);
+
+	for (const char* f = format ; *f != '\0' ; f++) {
+		if (*f != '%') {
+			continue;
+		}
+		if (*++f == '%') {
+			continue;
+		}
+
+		int longs;
+		bool wide;
+		f = parseConversion(f, longs, wide);
+		remaining--;
+
+		if (*f == 's') {
+			const char* s = va_arg(ap, const char*);
+			if (s == NULL) {
+				s = "(null)";
+			}
+
+			if (end - p < 2 + 8 * remaining) {
+				break;
+			}
+
+			size_t len = strlen(s);
+			size_t room = end - p - 2 - 8 * remaining;
+			if (len > room) {
+				len = room;
+			}
+
+			uint16_t n = len;
+			memcpy(p, &n, 2);
+			memcpy(p + 2, s, len);
+			p += 2 + len;
+			continue;
+		}
+
+		if (end - p < 8) {
+			break;
+		}
+
+		switch (*f) {
+		case 'd': case 'i': case 'c': {
+			int64_t value = longs >= 2 ? va_arg(ap, long long) : (longs == 1 || wide) ? va_arg(ap, long) : va_arg(ap, int);
+			memcpy(p, &value, 8);
+			break;
+		}
+		case 'u': case 'x': case 'X': case 'o': {
+			uint64_t value = longs >= 2 ? va_arg(ap, unsigned long long)
+					: (longs == 1 || wide) ? va_arg(ap, unsigned long) : va_arg(ap, unsigned int);
+			memcpy(p, &value, 8);
+			break;
+		}
+		case 'p': {
+			uint64_t value = (uintptr_t) va_arg(ap, void*);
+			memcpy(p, &value, 8);
+			break;
+		}
+		case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A': {
+			double value = wide ? (double) va_arg(ap, long double) : va_arg(ap, double);
+			memcpy(p, &value, 8);
+			break;
+		}
+		default:
+			// Unknown conversion, the arguments after it can't be found
+			entry.len = p - entry.data;
+			return;
+		}
+
+		p += 8;
+	}
+
+	entry.len = p - entry.data;
+}
+
+/**
+ * Writes the local time of the CLOCK_REALTIME timestamp, with a blank
+ * after it.
+ */
+size_t Log::formatTime(uint64_t timestamp, char* out) {
+
+	// Only the background thread formats more than a few messages
+	static __thread time_t cachedSecond = 0;
+	static __thread char cachedPrefix[32];
+
+	time_t second = timestamp / 1000000000ULL;
+	if (second != cachedSecond) {
+		struct tm tm;
+		localtime_r(&second, &tm);
+		strftime(cachedPrefix, sizeof(cachedPrefix), "%Y-%m-%d %H:%M:%S", &tm);
+		cachedSecond = second;
+	}
+
+	return sprintf(out, "%s.%06u ", cachedPrefix, (unsigned int) (timestamp % 1000000000ULL / 1000));
+}
+
+/**
+ * Formats the message like printf would have. Returns the number of
+ * bytes written to out, at most maxBytes - 1.
+ */
+size_t Log::format(const Entry& entry, char* out, size_t maxBytes) {
+
+	size_t n = formatTime(entry.timestamp + Log::clockOffset, out);
+
+	const uint8_t* p = entry.data;
+	const uint8_t* end = entry.data + entry.len;
+
+	const char* f = entry.format;
+	while (*f != '\0' && n < maxBytes - 1) {
+		if (*f != '%') {
+			out[n++] = *f++;
+			continue;
+		}
+		if (f[1] == '%') {
+			out[n++] = '%';
+			f += 2;
+			continue;
+		}
+
+		const char* start = f;
+		int longs;
+		bool wide;
+		f = parseConversion(f + 1, longs, wide);
+		if (*f == '\0') {
+			break;
+		}
+		f++;
+
+		char spec[32];
+		size_t specLength = f - start;
+		if (specLength >= sizeof(spec) || p >= end) {
+			break; // Arguments truncated
+		}
+		memcpy(spec, start, specLength);
+		spec[specLength] = '\0';
+
+		char conversion = f[-1];
+		int rc;
+
+		if (conversion == 's') {
+			uint16_t len;
+			memcpy(&len, p, 2);
+
+			char s[sizeof(entry.data)];
+			memcpy(s, p + 2, len);
+			s[len] = '\0';
+			p += 2 + len;
+
+			rc = snprintf(out + n, maxBytes - n, spec, s);
+		} else {
+			uint64_t value;
+			memcpy(&value, p, 8);
+			p += 8;
+
+			switch (conversion) {
+			case 'd': case 'i': case 'c':
+				rc = longs >= 2 ? snprintf(out + n, maxBytes - n, spec, (long long) value)
+						: (longs == 1 || wide) ? snprintf(out + n, maxBytes - n, spec, (long) value)
+						: snprintf(out + n, maxBytes - n, spec, (int) value);
+				break;
+			case 'u': case 'x': case 'X': case 'o':
+				rc = longs >= 2 ? snprintf(out + n, maxBytes - n, spec, (unsigned long long) value)
+						: (longs == 1 || wide) ? snprintf(out + n, maxBytes - n, spec, (unsigned long) value)
+						: snprintf(out + n, maxBytes - n, spec, (unsigned int) value);
+				break;
+			case 'p':
+				rc = snprintf(out + n, maxBytes - n, spec, (void*) (uintptr_t) value);
+				break;
+			default: {
+				double d;
+				memcpy(&d, &value, 8);
+				rc = wide ? snprintf(out + n, maxBytes - n, spec, (long double) d)
+						: snprintf(out + n, maxBytes - n, spec, d);
+				break;
+			}
+			}
+		}
+
+		if (rc > 0) {
+			n += (size_t) rc < maxBytes - n ? rc : maxBytes - n - 1;
+		}
+	}
+
+	// Truncated messages still end the line
+	if (n > 0 && out[n - 1] != '\n') {
+		if (n == maxBytes - 1) {
+			n--;
+		}
+		out[n++] = '\n';
+	}
+
+	return n;
+}
+
+void Log::write(int level, const char* format, ...) {
+
+	va_list ap;
+	va_start(ap, format);
+
+	if (!Log::running) {
+		Entry entry;
+		entry.timestamp = DateTime::nanos(CLOCK_MONOTONIC);
+		entry.format = format;
+		entry.level = level;
+		capture(entry, format, ap);
+		va_end(ap);
+
+		Log::clockOffset = DateTime::nanos(CLOCK_REALTIME) - entry.timestamp;
+
+		char line[ENTRY_BYTES * 4];
+		size_t n = Log::format(entry, line, sizeof(line));
+		fwrite(line, 1, n, Log::stream);
+		return;
+	}
+
+	Buffer* buffer = getBuffer();
+	if (buffer == NULL) {
+		va_end(ap);
+		return;
+	}
+
+	uint64_t head = buffer->head;
+	if (head - __atomic_load_n(&buffer->tail, __ATOMIC_ACQUIRE) >= (uint64_t) BUFFER_ENTRIES) {
+		__atomic_store_n(&buffer->dropped, buffer->dropped + 1, __ATOMIC_RELAXED);
+		va_end(ap);
+		return;
+	}
+
+	Entry& entry = buffer->entries[head % BUFFER_ENTRIES];
+	entry.timestamp = DateTime::nanos(CLOCK_MONOTONIC);
+	entry.format = format;
+	entry.level = level;
+	capture(entry, format, ap);
+	va_end(ap);
+
+	__atomic_store_n(&buffer->head, head + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Formats the messages waiting, as many as fit into out.
+ * Returns the number of bytes written to out.
+ */
+size_t Log::drain(char* out, size_t maxBytes) {
+
+	size_t n = 0;
+	int count = __atomic_load_n(&Log::nbuffers, __ATOMIC_ACQUIRE);
+
+	for (int i=0 ; i<count ; i++) {
+		Buffer* buffer = Log::buffers[i];
+
+		// Messages are dropped after the ones waiting
+		uint64_t dropped = __atomic_load_n(&buffer->dropped, __ATOMIC_RELAXED);
+
+		uint64_t tail = buffer->tail;
+		uint64_t head = __atomic_load_n(&buffer->head, __ATOMIC_ACQUIRE);
+
+		// A message takes at most 4 times the entry, e.g. %.2X of 1 byte
+		while (tail < head && maxBytes - n > 4 * ENTRY_BYTES) {
+			n += format(buffer->entries[tail % BUFFER_ENTRIES], out + n, 4 * ENTRY_BYTES);
+			tail++;
+		}
+
+		__atomic_store_n(&buffer->tail, tail, __ATOMIC_RELEASE);
+
+		if (tail == head && dropped != buffer->droppedReported && maxBytes - n > ENTRY_BYTES) {
+			n += formatTime(DateTime::nanos(CLOCK_REALTIME), out + n);
+			n += sprintf(out + n, "%llu log messages dropped\n",
+					(unsigned long long) (dropped - buffer->droppedReported));
+			buffer->droppedReported = dropped;
+		}
+	}
+
+	return n;
+}
+
+/**
+ * Background thread: Writes the messages until stopped, then the ones
+ * left.
+ */
+void* Log::run(void* arg) {
+
+	static char out[64 * 1024];
+	int fd = fileno(Log::stream);
+
+	while (true) {
+		bool stopping = !Log::running;
+
+		size_t n;
+		while ((n = drain(out, sizeof(out))) > 0) {
+			size_t written = 0;
+			while (written < n) {
+				ssize_t rc = ::write(fd, out + written, n - written);
+				if (rc < 0 && errno == EINTR) {
+					continue;
+				}
+				if (rc <= 0) {
+					break; // Nowhere to log to
+				}
+				written += rc;
+			}
+		}
+
+		if (stopping) {
+			return NULL;
+		}
+
+		struct timespec ts = { 0, FLUSH_INTERVAL_NANOS };
+		nanosleep(&ts, NULL);
+	}
+}
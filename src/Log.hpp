@@ -0,0 +1,164 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LOG_HPP_
+#define LOG_HPP_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <pthread.h>
+
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO  1
+#define LOG_LEVEL_WARN  2
+#define LOG_LEVEL_ERROR 3
+
+/**
+ * Log messages below this level are removed by the compiler, e.g.
+ * compile with -DLOG_MIN_LEVEL=LOG_LEVEL_INFO to remove the debug messages
+ * of the hot path completely.
+ */
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+#define LOG_AT(level, ...) \
+	do { \
+		if ((level) >= LOG_MIN_LEVEL && (level) >= Log::getLevel()) { \
+			Log::write((level), __VA_ARGS__); \
+		} \
+	} while (0)
+
+#define LOG_DEBUG(...) LOG_AT(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#define LOG_INFO(...)  LOG_AT(LOG_LEVEL_INFO, __VA_ARGS__)
+#define LOG_WARN(...)  LOG_AT(LOG_LEVEL_WARN, __VA_ARGS__)
+#define LOG_ERROR(...) LOG_AT(LOG_LEVEL_ERROR, __VA_ARGS__)
+
+/**
+ * Leveled log written to stdout (or stderr, see setStream()), one line per message with the time in
+ * front of it.
+ *
+ * Logging a message doesn't format it: The time is taken from the
+ * monotonic clock and the arguments are copied as they are into a buffer of
+ * the calling thread, without locks and system calls. A background thread
+ * formats and writes the messages. If a buffer is full, messages are
+ * dropped instead of waiting, and the number of messages dropped is logged
+ * later.
+ *
+ * The format must be a string literal. Arguments are copied as the
+ * conversions in the format tell (strings are copied, truncated if they
+ * are long), so '*' for width or precision is not supported.
+ *
+ * Until start() is called, messages are formatted and written right away.
+ */
+class Log {
+
+public:
+	/** Messages each thread can have waiting to be written */
+	static const int BUFFER_ENTRIES = 1024;
+
+	/** Threads that can log */
+	static const int MAX_THREADS = 16;
+
+	/**
+	 * Messages below this level are dropped at runtime.
+	 */
+	static void setLevel(int level) { Log::level = level; };
+	static int getLevel() { return Log::level; };
+
+	/**
+	 * Writes the messages to stderr instead of stdout, e.g. when stdout
+	 * carries data. Call before start().
+	 */
+	static void setStream(FILE* stream) { Log::stream = stream; };
+
+	/**
+	 * Returns the level with this name (debug, info, warn or error),
+	 * or -1 if there is none.
+	 */
+	static int parseLevel(const char* name);
+
+	/**
+	 * Starts the background thread. The messages waiting are written when
+	 * the process exits.
+	 */
+	static void start();
+
+	/**
+	 * Writes the messages waiting and stops the background thread.
+	 */
+	static void stop();
+
+	static void write(int level, const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+private:
+	static const size_t ENTRY_BYTES = 256;
+
+	struct Entry {
+		/** CLOCK_MONOTONIC, ns */
+		uint64_t timestamp;
+		const char* format;
+		uint16_t len;
+		uint8_t level;
+
+		/** Arguments: 8 bytes per number, strings with 2 bytes of length in front */
+		uint8_t data[ENTRY_BYTES - 24];
+	};
+
+	/**
+	 * Single producer, single consumer ring of the messages of a thread.
+	 */
+	struct Buffer {
+		Entry entries[BUFFER_ENTRIES];
+
+		/** Written by the producer */
+		uint64_t head;
+		uint64_t dropped;
+
+		/** Written by the consumer */
+		uint64_t tail;
+		uint64_t droppedReported;
+	};
+
+	static int level;
+	static FILE* stream;
+
+	static volatile bool running;
+	static pthread_t thread;
+	static pthread_mutex_t mutex;
+
+	static Buffer* buffers[MAX_THREADS];
+	static int nbuffers;
+
+	/** CLOCK_REALTIME - CLOCK_MONOTONIC, to show the time of day */
+	static uint64_t clockOffset;
+
+	static __thread Buffer* threadBuffer;
+
+	static Buffer* getBuffer();
+	static void capture(Entry& entry, const char* format, va_list ap);
+	static size_t format(const Entry& entry, char* out, size_t maxBytes);
+	static size_t formatTime(uint64_t timestamp, char* out);
+	static size_t drain(char* out, size_t maxBytes);
+	static void* run(void* arg);
+};
+
+#endif /* LOG_HPP_ */
@@ -19,7 +19,9 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
+#include <signal.h>
 
 #include "SocketServer.hpp"
 #include "Spi.hpp"
@@ -27,18 +29,310 @@
 #include "Gpio.hpp"
 #include "RFBeeDataFrame.hpp"
 #include "RawDataFrame.hpp"
-#include "DateTime.hpp"
+#include "Log.hpp"
 #include "VariableLengthModeProtocol.hpp"
 #include "FifoOverflowProtocol.hpp"
 #include "Protocol.hpp"
 #include "RadiatorControllerDataFrame.hpp"
+#include "RegConfigurationProfile0_26MHz.hpp"
 #include "RegConfigurationProfile0_27MHz.hpp"
 #include "RegConfigurationRadiatorController.hpp"
+#include "SharedMemoryRing.hpp"
+#include "MulticastPublisher.hpp"
+#include "RadioProfile.hpp"
+#include "CommandDispatcher.hpp"
+#include "OutputFormatCommand.hpp"
+#include "ChannelCommand.hpp"
+#include "RegisterProfileCommand.hpp"
+#include "FilterCommand.hpp"
+#include "TransmitCommand.hpp"
+#include "TransmitQueue.hpp"
+#include "FramePool.hpp"
+#include "OutputFormatRegistry.hpp"
+#include "LegacyOutputFormat.hpp"
+#include "CsvOutputFormat.hpp"
+#include "JsonOutputFormat.hpp"
+#include "CborOutputFormat.hpp"
+#include "DecoderPipeline.hpp"
+#include "DecoderPipelineCommand.hpp"
+#include "LatencyCommand.hpp"
+#include "ReceiveLatency.hpp"
+#include "MetricsServer.hpp"
+#include "RawCapture.hpp"
+#include "CapturingProtocol.hpp"
+#include "Replay.hpp"
+#include "FrameStore.hpp"
+#include "QueryCommand.hpp"
+#include "LatestValueCache.hpp"
+#include "LatestValueCommand.hpp"
+#include "LinkQualityTracker.hpp"
+#include "LinkQualityCommand.hpp"
 
-const int PORT = 50000;
+const int DEFAULT_PORT = 50000;
+const char* DEFAULT_PROFILE = "rfbee";
+const char* DEFAULT_METRICS_ADDRESS = "127.0.0.1";
+
+static void usage(const char* program) {
+	fprintf(stderr, "Usage: %s [-r profile] [-c channel] [-p port] [-s shm-name [-n slots]]\n"
+			"          [-g group:port [-i interface] [-t ttl] [-l linger]]\n"
+			"          [-a address] [-q depth] [-x rate[:burst]] [-d stages] [-L level]\n"
+			"          [-m [address:]port] [-C prefix[:mib[:segments]]] [-S directory[:sync[:mib[:segments]]]]\n"
+			"       %s -R format [-r profile] [-d stages] [-j threads] [-P] [-L level] file.cap ...\n",
+			program, program);
+	fprintf(stderr, "  -r profile     Register configuration and data frame format (default %s):\n", DEFAULT_PROFILE);
+	fprintf(stderr, "                 rfbee, rfbee26, raw or radiator\n");
+	fprintf(stderr, "  -c channel     Channel number (default: as configured by the profile)\n");
+	fprintf(stderr, "  -p port        TCP port to accept connections on (default %d)\n", DEFAULT_PORT);
+	fprintf(stderr, "  -s shm-name    Also publish data frames to a shared memory ring, e.g. /cc1101\n");
+	fprintf(stderr, "  -n slots       Number of records in the shared memory ring (default %u)\n",
+			SharedMemoryRing::DEFAULT_SLOT_COUNT);
+	fprintf(stderr, "  -g group:port  Also publish data frames as UDP datagrams to a multicast group, e.g. 239.255.0.1:50001\n");
+	fprintf(stderr, "  -i interface   Address of the interface to send multicast datagrams on, e.g. 127.0.0.1\n");
+	fprintf(stderr, "  -t ttl         Multicast time to live (default 1)\n");
+	fprintf(stderr, "  -l linger      Milliseconds to collect data frames into one datagram (default 0)\n");
+	fprintf(stderr, "  -a address     Source address of transmitted data frames, hex (default 00)\n");
+	fprintf(stderr, "  -q depth       Number of data frames queued for transmission (default %d)\n",
+			TransmitQueue::DEFAULT_DEPTH);
+	fprintf(stderr, "  -x rate[:burst] Data frames each client may transmit per second (default: no limit)\n");
+	fprintf(stderr, "  -d stages      Decoder pipeline of the radiator profile (default %s)\n",
+			RadiatorControllerDataFrame::DEFAULT_PIPELINE);
+	fprintf(stderr, "  -L level       Log messages of this level and above: debug, info, warn or error (default info)\n");
+	fprintf(stderr, "  -m [address:]port Serve metrics for Prometheus on http://address:port/metrics (default address %s)\n",
+			DEFAULT_METRICS_ADDRESS);
+	fprintf(stderr, "  -C prefix[:mib[:segments]] Capture the bytes received, before decoding, to segment files\n");
+	fprintf(stderr, "                 <prefix>-<time>-<n>.cap of mib MiB (default %u), keeping the newest (default: all)\n",
+			(unsigned int) (RawCapture::DEFAULT_SEGMENT_BYTES >> 20));
+	fprintf(stderr, "  -S directory[:sync[:mib[:segments]]] Keep the data frames in segments of mib MiB (default %u)\n",
+			(unsigned int) (FrameStore::DEFAULT_SEGMENT_BYTES >> 20));
+	fprintf(stderr, "                 in this directory for queries (QU), synced every sync ms (default %d),\n",
+			FrameStore::DEFAULT_SYNC_MILLIS);
+	fprintf(stderr, "                 keeping the newest segments (default: all)\n");
+	fprintf(stderr, "  -R format      Replay captured segment files instead of receiving: Decode them and write\n");
+	fprintf(stderr, "                 the data frames to stdout in this output format, e.g. json. With -r, all\n");
+	fprintf(stderr, "                 are decoded by the data frame of that profile instead of the one captured\n");
+	fprintf(stderr, "  -j threads     Segments replayed at the same time (default: number of CPUs, at most %d)\n",
+			Replay::MAX_THREADS);
+	fprintf(stderr, "  -P             Replay at the pace the data frames were received\n");
+}
 
 int main(int argc, char** argv) {
 
+	const char* profileName = DEFAULT_PROFILE;
+	int channel = -1;
+	int port = DEFAULT_PORT;
+	const char* shmName = NULL;
+	uint32_t shmSlots = SharedMemoryRing::DEFAULT_SLOT_COUNT;
+	char* multicastGroup = NULL;
+	int multicastPort = 0;
+	const char* multicastInterface = NULL;
+	int multicastTtl = 1;
+	int multicastLinger = 0;
+	long srcAddress = 0;
+	int transmitQueueDepth = TransmitQueue::DEFAULT_DEPTH;
+	double transmitRate = 0;
+	double transmitBurst = 0;
+	const char* decoderStages = RadiatorControllerDataFrame::DEFAULT_PIPELINE;
+	int logLevel = LOG_LEVEL_INFO;
+	const char* metricsAddress = DEFAULT_METRICS_ADDRESS;
+	int metricsPort = 0;
+	char* capturePrefix = NULL;
+	long captureMiB = RawCapture::DEFAULT_SEGMENT_BYTES >> 20;
+	int captureSegments = 0;
+	char* storeDirectory = NULL;
+	int storeSyncMillis = FrameStore::DEFAULT_SYNC_MILLIS;
+	long storeMiB = FrameStore::DEFAULT_SEGMENT_BYTES >> 20;
+	int storeSegments = 0;
+	const char* replayFormat = NULL;
+	int replayThreads = sysconf(_SC_NPROCESSORS_ONLN);
+	bool replayPaced = false;
+	bool profileSelected = false;
+	bool logLevelSelected = false;
+
+	int opt;
+	while ((opt = getopt(argc, argv, "r:c:p:s:n:g:i:t:l:a:q:x:d:L:m:C:S:R:j:P")) != -1) {
+		switch (opt) {
+		case 'r':
+			profileName = optarg;
+			profileSelected = true;
+			break;
+		case 'c':
+			channel = atoi(optarg);
+			break;
+		case 'p':
+			port = atoi(optarg);
+			break;
+		case 's':
+			shmName = optarg;
+			break;
+		case 'n':
+			shmSlots = atoi(optarg);
+			break;
+		case 'g': {
+			multicastGroup = optarg;
+			char* colon = strchr(optarg, ':');
+			if (colon != NULL) {
+				*colon = '\0';
+				multicastPort = atoi(colon + 1);
+			}
+			break;
+		}
+		case 'i':
+			multicastInterface = optarg;
+			break;
+		case 't':
+			multicastTtl = atoi(optarg);
+			break;
+		case 'l':
+			multicastLinger = atoi(optarg);
+			break;
+		case 'a':
+			srcAddress = strtol(optarg, NULL, 16);
+			break;
+		case 'q':
+			transmitQueueDepth = atoi(optarg);
+			break;
+		case 'x': {
+			transmitRate = atof(optarg);
+			char* colon = strchr(optarg, ':');
+			transmitBurst = colon != NULL ? atof(colon + 1) : transmitRate;
+			break;
+		}
+		case 'd':
+			decoderStages = optarg;
+			break;
+		case 'L':
+			logLevel = Log::parseLevel(optarg);
+			logLevelSelected = true;
+			break;
+		case 'm': {
+			char* colon = strchr(optarg, ':');
+			if (colon != NULL) {
+				*colon = '\0';
+				metricsAddress = optarg;
+				metricsPort = atoi(colon + 1);
+			} else {
+				metricsPort = atoi(optarg);
+			}
+			break;
+		}
+		case 'C': {
+			capturePrefix = optarg;
+			char* colon = strchr(optarg, ':');
+			if (colon != NULL) {
+				*colon = '\0';
+				captureMiB = atol(colon + 1);
+				colon = strchr(colon + 1, ':');
+				if (colon != NULL) {
+					captureSegments = atoi(colon + 1);
+				}
+			}
+			break;
+		}
+		case 'S': {
+			storeDirectory = optarg;
+			char* colon = strchr(optarg, ':');
+			if (colon != NULL) {
+				*colon = '\0';
+				storeSyncMillis = atoi(colon + 1);
+				colon = strchr(colon + 1, ':');
+				if (colon != NULL) {
+					storeMiB = atol(colon + 1);
+					colon = strchr(colon + 1, ':');
+					if (colon != NULL) {
+						storeSegments = atoi(colon + 1);
+					}
+				}
+			}
+			break;
+		}
+		case 'R':
+			replayFormat = optarg;
+			break;
+		case 'j':
+			replayThreads = atoi(optarg);
+			break;
+		case 'P':
+			replayPaced = true;
+			break;
+		default:
+			usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (port <= 0 || channel > 255 || shmSlots == 0 || multicastLinger < 0
+			|| (multicastGroup != NULL && multicastPort <= 0)
+			|| srcAddress < 0 || srcAddress > 0xFF || transmitQueueDepth <= 0
+			|| transmitRate < 0 || (transmitRate > 0 && transmitBurst < 1) || logLevel < 0
+			|| metricsPort < 0 || metricsPort > 65535
+			|| (capturePrefix != NULL && (captureMiB < 1 || captureMiB > 1024 || captureSegments < 0))
+			|| (storeDirectory != NULL && (storeSyncMillis < 0 || storeMiB < 1 || storeMiB > 1024 || storeSegments < 0))
+			|| (replayFormat != NULL && (optind >= argc || replayThreads < 1))) {
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	// Clients may close the connection at any time. Handle this when
+	// writing to the socket instead of being terminated.
+	signal(SIGPIPE, SIG_IGN);
+
+	// Replaying writes the data frames to stdout. Unless asked for, the
+	// data frames aren't logged one by one.
+	if (replayFormat != NULL) {
+		Log::setStream(stderr);
+		if (!logLevelSelected) {
+			logLevel = LOG_LEVEL_WARN;
+		}
+	}
+
+	// Log messages are written by a background thread from now on
+	Log::setLevel(logLevel);
+	Log::start();
+
+	// kill -USR1 logs the latency histograms of the receive path
+	ReceiveLatency::dumpOnSignal(SIGUSR1);
+
+	// ------------------------------------------------
+	// Output Formats: The first five keep the numbers
+	// clients used before formats had names
+	// ------------------------------------------------
+
+	LegacyOutputFormat payloadFormat(LegacyOutputFormat::STYLE_PAYLOAD);
+	LegacyOutputFormat addressFormat(LegacyOutputFormat::STYLE_ADDRESS);
+	LegacyOutputFormat binaryFormat(LegacyOutputFormat::STYLE_BINARY);
+	LegacyOutputFormat decimalFormat(LegacyOutputFormat::STYLE_DECIMAL);
+	LegacyOutputFormat hexFormat(LegacyOutputFormat::STYLE_HEX);
+	LegacyOutputFormat rawFormat(LegacyOutputFormat::STYLE_RAW);
+	LegacyOutputFormat radiatorFormat(LegacyOutputFormat::STYLE_RADIATOR);
+	CsvOutputFormat csvFormat;
+	JsonOutputFormat jsonFormat;
+	CborOutputFormat cborFormat;
+
+	OutputFormatRegistry formats;
+	formats.add(&payloadFormat);
+	formats.add(&addressFormat);
+	formats.add(&binaryFormat);
+	formats.add(&decimalFormat);
+	formats.add(&hexFormat);
+	formats.add(&rawFormat);
+	formats.add(&radiatorFormat);
+	formats.add(&csvFormat);
+	formats.add(&jsonFormat);
+	formats.add(&cborFormat);
+
+	if (replayFormat != NULL) {
+		int format = formats.find(replayFormat);
+		if (format < 0) {
+			fprintf(stderr, "Unknown output format %s\n", replayFormat);
+			usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+
+		Replay replay(formats.get(format), profileSelected ? profileName : NULL, decoderStages,
+				replayThreads, replayPaced);
+		return replay.run(argv + optind, argc - optind) < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+	}
+
 	// Set up SPI interface
 	Spi spi("/dev/spidev0.0", 8, 5 * 1000 * 1000);
 
@@ -49,43 +343,156 @@ int main(int argc, char** argv) {
 	gpio.exportPin();
 	gpio.setPinDirection(Gpio::DIRECTION_IN);
 
+	// ---------
+	// Protocols
+	// ---------
+
+	VariableLengthModeProtocol variableLengthModeProtocol(&spi);
+	FifoOverflowProtocol fifoOverflowProtocol(&spi);
+
+	Protocol* variableLength = &variableLengthModeProtocol;
+	Protocol* fifoOverflow = &fifoOverflowProtocol;
+
+	// The bytes received are captured before the data frames decode them
+	RawCapture* rawCapture = NULL;
+	if (capturePrefix != NULL) {
+		rawCapture = new RawCapture(capturePrefix, captureMiB << 20, captureSegments);
+		variableLength = new CapturingProtocol(variableLength, rawCapture);
+		fifoOverflow = new CapturingProtocol(fifoOverflow, rawCapture);
+	}
+
+	// ------------------
+	// Data Frame Formats
+	// ------------------
+
+	RFBeeDataFrame rfBeeDataFrame(variableLength);
+	RawDataFrame rawDataFrame(variableLength);
+
+	DecoderPipeline radiatorPipeline;
+	if (radiatorPipeline.configure(decoderStages) < 0) {
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+	RadiatorControllerDataFrame radiatorControllerDataFrame(fifoOverflow, &radiatorPipeline);
+
+	// --------------------------------------------
+	// Profiles: CC1101 Register Configuration plus
+	// the Data Frame Format that fits to it
+	// --------------------------------------------
+
+	RegConfigurationProfile0_27MHz profile0_27MHz;
+	RegConfigurationProfile0_26MHz profile0_26MHz;
+	RegConfigurationRadiatorController radiatorController;
+
+	RadioProfile rfBeeProfile("rfbee", &profile0_27MHz, &rfBeeDataFrame);
+	RadioProfile rfBee26Profile("rfbee26", &profile0_26MHz, &rfBeeDataFrame);
+	RadioProfile rawProfile("raw", &profile0_27MHz, &rawDataFrame);
+	RadioProfile radiatorProfile("radiator", &radiatorController, &radiatorControllerDataFrame);
+
+	// Set up the RF module. The frame store keeps slots while its
+	// background thread writes them.
+	FramePool framePool(FramePool::DEFAULT_SLOT_COUNT + (storeDirectory != NULL ? FrameStore::RING_ENTRIES : 0));
+	Device device(&spi, &gpio, &framePool);
+	device.reset();
+
+	device.addProfile(&rfBeeProfile);
+	device.addProfile(&rfBee26Profile);
+	device.addProfile(&rawProfile);
+	device.addProfile(&radiatorProfile);
+
+	if (device.selectProfile(profileName) < 0) {
+		fprintf(stderr, "Unknown profile %s\n", profileName);
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	if (channel >= 0) {
+		device.setChannel(channel);
+	}
+
+	TransmitQueue transmitQueue(transmitQueueDepth);
+	device.setTransmitQueue(&transmitQueue);
+
+	if (rawCapture != NULL) {
+		rawCapture->start(&device);
+	}
+
 	// --------
-	// Protocol
+	// Commands
 	// --------
 
-	VariableLengthModeProtocol protocol(&spi);
-	//FifoOverflowProtocol protocol(&spi);
+	CommandDispatcher dispatcher;
 
-	// -----------------
-	// Data Frame Format
-	// -----------------
+	OutputFormatCommand outputFormatCommand(&formats);
+	ChannelCommand channelCommand(&device);
+	RegisterProfileCommand registerProfileCommand(&device);
+	FilterCommand filterCommand;
+	TransmitCommand transmitCommand(&device, srcAddress, transmitRate, transmitBurst);
+	DecoderPipelineCommand decoderPipelineCommand(&radiatorPipeline);
+	LatencyCommand latencyCommand;
 
-	RFBeeDataFrame dataFrame(&protocol);
-	//RawDataFrame dataFrame(&protocol);
-	//RadiatorControllerDataFrame dataFrame(&protocol);
+	dispatcher.addCommand(&outputFormatCommand);
+	dispatcher.addCommand(&channelCommand);
+	dispatcher.addCommand(&registerProfileCommand);
+	dispatcher.addCommand(&filterCommand);
+	dispatcher.addCommand(&transmitCommand);
+	dispatcher.addCommand(&decoderPipelineCommand);
+	dispatcher.addCommand(&latencyCommand);
 
-	// Set up the RF module
-	Device device(&spi, &gpio, &dataFrame);
-	device.reset();
+	// -------------
+	// Frame Outputs
+	// -------------
+
+	// Clients can ask for the last data frame of every sender
+	LatestValueCache latestValueCache;
+	device.addSink(&latestValueCache);
+	LatestValueCommand latestValueCommand(&latestValueCache);
+	dispatcher.addCommand(&latestValueCommand);
 
-	// -----------------------------
-	// CC1101 Register Configuration
-	// -----------------------------
+	// Clients can ask how well every sender is received
+	LinkQualityTracker linkQualityTracker;
+	device.addSink(&linkQualityTracker);
+	LinkQualityCommand linkQualityCommand(&linkQualityTracker);
+	dispatcher.addCommand(&linkQualityCommand);
 
-	//device.configureRegisters(new RegConfigurationRadiatorController());
-	device.configureRegisters(new RegConfigurationProfile0_27MHz());
+	SharedMemoryRing* sharedMemoryRing = NULL;
+	if (shmName != NULL) {
+		sharedMemoryRing = new SharedMemoryRing(shmName, shmSlots);
+		sharedMemoryRing->open();
+		device.addSink(sharedMemoryRing);
+	}
+
+	MulticastPublisher* multicastPublisher = NULL;
+	if (multicastGroup != NULL) {
+		multicastPublisher = new MulticastPublisher(multicastGroup, multicastPort, multicastLinger);
+		multicastPublisher->open(multicastInterface, multicastTtl);
+		device.addSink(multicastPublisher);
+	}
 
-	SocketServer serverSocket(&device);
+	// Clients can query the data frames kept
+	FrameStore* frameStore = NULL;
+	if (storeDirectory != NULL) {
+		frameStore = new FrameStore(storeDirectory, storeSyncMillis, storeMiB << 20, storeSegments);
+		frameStore->open();
+		device.addSink(frameStore);
+		dispatcher.addCommand(new QueryCommand(frameStore));
+	}
+
+	SocketServer serverSocket(&device, &dispatcher, &formats);
 
-	serverSocket.open(PORT);
+	serverSocket.open(port);
 
-	while (true)
-	{
-		DateTime::print();
-		printf("Accepting incoming connections on port %d ...\n", PORT);
-		serverSocket.acceptConnection();
+	MetricsServer metricsServer;
+	if (metricsPort > 0) {
+		metricsServer.addSource(&serverSocket);
+		metricsServer.addSource(&radiatorPipeline);
+		metricsServer.open(metricsAddress, metricsPort);
+		serverSocket.setMetricsServer(&metricsServer);
 	}
 
+	LOG_INFO("Accepting incoming connections on port %d ...\n", port);
+	serverSocket.run();
+
 	serverSocket.closeConnection();
 
 	return EXIT_SUCCESS;
@@ -17,99 +17,99 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <iostream>
-#include <fcntl.h>
 #include <stdio.h>
-#include <stdlib.h>
-#include <unistd.h>
 #include <string.h>
-#include <poll.h>
-using namespace std;
 
 #include "Manchester.hpp"
 
 
-// Table for encoding 4-bit data into a 8-bit Manchester encoding.
-static uint8_t manchEncodeTab[16] = {
-		0xAA,  // 0x0 Manchester encoded
-		0xA9,  // 0x1 Manchester encoded
-		0xA6,  // 0x2 Manchester encoded
-		0xA5,  // 0x3 Manchester encoded
-		0x9A,  // 0x4 Manchester encoded
-		0x99,  // 0x5 Manchester encoded
-		0x96,  // 0x6 Manchester encoded
-		0x95,  // 0x7 Manchester encoded
-		0x6A,  // 0x8 Manchester encoded
-		0x69,  // 0x9 Manchester encoded
-		0x66,  // 0xA Manchester encoded
-		0x65,  // 0xB Manchester encoded
-		0x5A,  // 0xC Manchester encoded
-		0x59,  // 0xD Manchester encoded
-		0x56,  // 0xE Manchester encoded
-		0x55}; // 0xF Manchester encoded
-
-// Table for decoding 4-bit Manchester encoded data into 2-bit
-// data. 0xFF indicates invalid Manchester encoding
-static uint8_t manchDecodeTab[16] = {
-		0xFF, //  Manchester encoded 0x0 decoded
-		0xFF, //  Manchester encoded 0x1 decoded
-		0xFF, //  Manchester encoded 0x2 decoded
-		0xFF, //  Manchester encoded 0x3 decoded
-		0xFF, //  Manchester encoded 0x4 decoded
-		0x03, //  Manchester encoded 0x5 decoded
-		0x02, //  Manchester encoded 0x6 decoded
-		0xFF, //  Manchester encoded 0x7 decoded
-		0xFF, //  Manchester encoded 0x8 decoded
-		0x01, //  Manchester encoded 0x9 decoded
-		0x00, //  Manchester encoded 0xA decoded
-		0xFF, //  Manchester encoded 0xB decoded
-		0xFF, //  Manchester encoded 0xC decoded
-		0xFF, //  Manchester encoded 0xD decoded
-		0xFF, //  Manchester encoded 0xE decoded
-		0xFF}; //  Manchester encoded 0xF decoded
-
-
-void Manchester::encodeByte(uint8_t *unencoded, uint8_t *encoded)
+// Table for decoding an encoded byte (4 symbols) into 4 bits of data.
+// High nibble: Invalid Manchester encoding of the symbols, low nibble: Data.
+const uint8_t Manchester::decodeTab[256] = {
+		0xF0, 0xE1, 0xE0, 0xF0, 0xD2, 0xC3, 0xC2, 0xD2, 0xD0, 0xC1, 0xC0, 0xD0, 0xF0, 0xE1, 0xE0, 0xF0,
+		0xB4, 0xA5, 0xA4, 0xB4, 0x96, 0x87, 0x86, 0x96, 0x94, 0x85, 0x84, 0x94, 0xB4, 0xA5, 0xA4, 0xB4,
+		0xB0, 0xA1, 0xA0, 0xB0, 0x92, 0x83, 0x82, 0x92, 0x90, 0x81, 0x80, 0x90, 0xB0, 0xA1, 0xA0, 0xB0,
+		0xF0, 0xE1, 0xE0, 0xF0, 0xD2, 0xC3, 0xC2, 0xD2, 0xD0, 0xC1, 0xC0, 0xD0, 0xF0, 0xE1, 0xE0, 0xF0,
+		0x78, 0x69, 0x68, 0x78, 0x5A, 0x4B, 0x4A, 0x5A, 0x58, 0x49, 0x48, 0x58, 0x78, 0x69, 0x68, 0x78,
+		0x3C, 0x2D, 0x2C, 0x3C, 0x1E, 0x0F, 0x0E, 0x1E, 0x1C, 0x0D, 0x0C, 0x1C, 0x3C, 0x2D, 0x2C, 0x3C,
+		0x38, 0x29, 0x28, 0x38, 0x1A, 0x0B, 0x0A, 0x1A, 0x18, 0x09, 0x08, 0x18, 0x38, 0x29, 0x28, 0x38,
+		0x78, 0x69, 0x68, 0x78, 0x5A, 0x4B, 0x4A, 0x5A, 0x58, 0x49, 0x48, 0x58, 0x78, 0x69, 0x68, 0x78,
+		0x70, 0x61, 0x60, 0x70, 0x52, 0x43, 0x42, 0x52, 0x50, 0x41, 0x40, 0x50, 0x70, 0x61, 0x60, 0x70,
+		0x34, 0x25, 0x24, 0x34, 0x16, 0x07, 0x06, 0x16, 0x14, 0x05, 0x04, 0x14, 0x34, 0x25, 0x24, 0x34,
+		0x30, 0x21, 0x20, 0x30, 0x12, 0x03, 0x02, 0x12, 0x10, 0x01, 0x00, 0x10, 0x30, 0x21, 0x20, 0x30,
+		0x70, 0x61, 0x60, 0x70, 0x52, 0x43, 0x42, 0x52, 0x50, 0x41, 0x40, 0x50, 0x70, 0x61, 0x60, 0x70,
+		0xF0, 0xE1, 0xE0, 0xF0, 0xD2, 0xC3, 0xC2, 0xD2, 0xD0, 0xC1, 0xC0, 0xD0, 0xF0, 0xE1, 0xE0, 0xF0,
+		0xB4, 0xA5, 0xA4, 0xB4, 0x96, 0x87, 0x86, 0x96, 0x94, 0x85, 0x84, 0x94, 0xB4, 0xA5, 0xA4, 0xB4,
+		0xB0, 0xA1, 0xA0, 0xB0, 0x92, 0x83, 0x82, 0x92, 0x90, 0x81, 0x80, 0x90, 0xB0, 0xA1, 0xA0, 0xB0,
+		0xF0, 0xE1, 0xE0, 0xF0, 0xD2, 0xC3, 0xC2, 0xD2, 0xD0, 0xC1, 0xC0, 0xD0, 0xF0, 0xE1, 0xE0, 0xF0
+};
+
+// Table for encoding a byte into 2 bytes (8 symbols)
+const uint16_t Manchester::encodeTab[256] = {
+		0xAAAA, 0xAAA9, 0xAAA6, 0xAAA5, 0xAA9A, 0xAA99, 0xAA96, 0xAA95,
+		0xAA6A, 0xAA69, 0xAA66, 0xAA65, 0xAA5A, 0xAA59, 0xAA56, 0xAA55,
+		0xA9AA, 0xA9A9, 0xA9A6, 0xA9A5, 0xA99A, 0xA999, 0xA996, 0xA995,
+		0xA96A, 0xA969, 0xA966, 0xA965, 0xA95A, 0xA959, 0xA956, 0xA955,
+		0xA6AA, 0xA6A9, 0xA6A6, 0xA6A5, 0xA69A, 0xA699, 0xA696, 0xA695,
+		0xA66A, 0xA669, 0xA666, 0xA665, 0xA65A, 0xA659, 0xA656, 0xA655,
+		0xA5AA, 0xA5A9, 0xA5A6, 0xA5A5, 0xA59A, 0xA599, 0xA596, 0xA595,
+		0xA56A, 0xA569, 0xA566, 0xA565, 0xA55A, 0xA559, 0xA556, 0xA555,
+		0x9AAA, 0x9AA9, 0x9AA6, 0x9AA5, 0x9A9A, 0x9A99, 0x9A96, 0x9A95,
+		0x9A6A, 0x9A69, 0x9A66, 0x9A65, 0x9A5A, 0x9A59, 0x9A56, 0x9A55,
+		0x99AA, 0x99A9, 0x99A6, 0x99A5, 0x999A, 0x9999, 0x9996, 0x9995,
+		0x996A, 0x9969, 0x9966, 0x9965, 0x995A, 0x9959, 0x9956, 0x9955,
+		0x96AA, 0x96A9, 0x96A6, 0x96A5, 0x969A, 0x9699, 0x9696, 0x9695,
+		0x966A, 0x9669, 0x9666, 0x9665, 0x965A, 0x9659, 0x9656, 0x9655,
+		0x95AA, 0x95A9, 0x95A6, 0x95A5, 0x959A, 0x9599, 0x9596, 0x9595,
+		0x956A, 0x9569, 0x9566, 0x9565, 0x955A, 0x9559, 0x9556, 0x9555,
+		0x6AAA, 0x6AA9, 0x6AA6, 0x6AA5, 0x6A9A, 0x6A99, 0x6A96, 0x6A95,
+		0x6A6A, 0x6A69, 0x6A66, 0x6A65, 0x6A5A, 0x6A59, 0x6A56, 0x6A55,
+		0x69AA, 0x69A9, 0x69A6, 0x69A5, 0x699A, 0x6999, 0x6996, 0x6995,
+		0x696A, 0x6969, 0x6966, 0x6965, 0x695A, 0x6959, 0x6956, 0x6955,
+		0x66AA, 0x66A9, 0x66A6, 0x66A5, 0x669A, 0x6699, 0x6696, 0x6695,
+		0x666A, 0x6669, 0x6666, 0x6665, 0x665A, 0x6659, 0x6656, 0x6655,
+		0x65AA, 0x65A9, 0x65A6, 0x65A5, 0x659A, 0x6599, 0x6596, 0x6595,
+		0x656A, 0x6569, 0x6566, 0x6565, 0x655A, 0x6559, 0x6556, 0x6555,
+		0x5AAA, 0x5AA9, 0x5AA6, 0x5AA5, 0x5A9A, 0x5A99, 0x5A96, 0x5A95,
+		0x5A6A, 0x5A69, 0x5A66, 0x5A65, 0x5A5A, 0x5A59, 0x5A56, 0x5A55,
+		0x59AA, 0x59A9, 0x59A6, 0x59A5, 0x599A, 0x5999, 0x5996, 0x5995,
+		0x596A, 0x5969, 0x5966, 0x5965, 0x595A, 0x5959, 0x5956, 0x5955,
+		0x56AA, 0x56A9, 0x56A6, 0x56A5, 0x569A, 0x5699, 0x5696, 0x5695,
+		0x566A, 0x5669, 0x5666, 0x5665, 0x565A, 0x5659, 0x5656, 0x5655,
+		0x55AA, 0x55A9, 0x55A6, 0x55A5, 0x559A, 0x5599, 0x5596, 0x5595,
+		0x556A, 0x5569, 0x5566, 0x5565, 0x555A, 0x5559, 0x5556, 0x5555
+};
+
+
+void Manchester::encodeByte(const uint8_t *unencoded, uint8_t *encoded)
 {
-	uint8_t data0, data1;
+	uint16_t symbols = encodeTab[*unencoded];
 
-	// Shift to get 4-bit data values
-	data1 = (((*unencoded) >> 4) & 0x0F);
-	data0 = ((*unencoded) & 0x0F);
-
-	// Perform Manchester encoding
-	*encoded       = (manchEncodeTab[data1]);
-	*(encoded + 1) = manchEncodeTab[data0];
+	*encoded       = symbols >> 8;
+	*(encoded + 1) = symbols & 0xFF;
 }
 
-uint8_t Manchester::decodeByte(uint8_t *undecoded, uint8_t *decoded)
+uint8_t Manchester::decodeByte(const uint8_t *undecoded, uint8_t *decoded)
 {
-	uint8_t data0, data1, data2, data3;
-
-	// - Shift to get 4 bit data and decode
-	data3 = ((*undecoded >> 4) & 0x0F);
-	data2 = ( *undecoded       & 0x0F);
-	data1 = ((*(undecoded + 1) >> 4) & 0x0F);
-	data0 = ((*(undecoded + 1))      & 0x0F);
+	uint8_t data;
 
 	// Check for invalid Manchester encoding
-	if ( (manchDecodeTab[data3] == 0xFF ) | (manchDecodeTab[data2] == 0xFF ) |
-			(manchDecodeTab[data1] == 0xFF ) | (manchDecodeTab[data0] == 0xFF ) )
-	{
+	if (decodePair(undecoded, &data) != 0) {
 		return(MAN_DECODING_ERROR);
 	}
 
-	// Shift result into a byte
-	*decoded = (manchDecodeTab[data3] << 6) | (manchDecodeTab[data2] << 4) |
-			(manchDecodeTab[data1] << 2) |  manchDecodeTab[data0];
+	*decoded = data;
 
 	return(MAN_DECODING_OK);
 }
 
-uint8_t Manchester::encode(uint8_t *inputBuffer, size_t inputBufferLen, uint8_t *outputBuffer, size_t& outputBufferLen)
+size_t Manchester::encode(const uint8_t *inputBuffer, size_t inputBufferLen, uint8_t *outputBuffer, size_t& outputBufferLen)
 {
-	for (int i=0 ; i<inputBufferLen ; i++) {
-		decodeByte(inputBuffer + i, outputBuffer + (i*2));
+	for (size_t i=0 ; i<inputBufferLen ; i++) {
+		uint16_t symbols = encodeTab[inputBuffer[i]];
+
+		outputBuffer[i*2]     = symbols >> 8;
+		outputBuffer[i*2 + 1] = symbols & 0xFF;
 	}
 
 	outputBufferLen = (inputBufferLen << 1);
@@ -117,16 +117,60 @@ uint8_t Manchester::encode(uint8_t *inputBuffer, size_t inputBufferLen, uint8_t
 	return outputBufferLen;
 }
 
-uint8_t Manchester::decode(uint8_t *inputBuffer, size_t inputBufferLen, uint8_t *outputBuffer, size_t& outputBufferLen)
+int Manchester::decode(const uint8_t *inputBuffer, size_t inputBufferLen, uint8_t *outputBuffer, size_t& outputBufferLen)
 {
-	for (int i=0 ; i<inputBufferLen ; i+=2) {
-		if (MAN_DECODING_ERROR == decodeByte(inputBuffer + i, outputBuffer + (i/2))) {
-			printf("ERROR: Manchester-Decoding the message.\n");
-			return 0;
-		}
+	size_t len = inputBufferLen >> 1;
+	uint8_t errors = 0;
+
+	// Collect the errors instead of checking every byte, errors are rare
+	for (size_t i=0 ; i<len ; i++) {
+		errors |= decodePair(inputBuffer + (i*2), outputBuffer + i);
+	}
+
+	if (errors != 0) {
+		outputBufferLen = 0;
+		return -1;
 	}
 
-	outputBufferLen = (inputBufferLen >> 1);
+	outputBufferLen = len;
 
 	return outputBufferLen;
 }
+
+size_t Manchester::decode(const uint8_t *inputBuffer, size_t inputBufferLen, uint8_t *outputBuffer, size_t& outputBufferLen,
+		uint16_t errorOffsets[], size_t maxErrors)
+{
+	size_t len = inputBufferLen >> 1;
+	size_t nerrors = 0;
+
+	for (size_t i=0 ; i<len ; i++) {
+		uint8_t mask = decodePair(inputBuffer + (i*2), outputBuffer + i);
+
+		while (mask != 0) {
+			int bit = 31 - __builtin_clz(mask);
+			mask &= ~(1 << bit);
+
+			if (nerrors < maxErrors) {
+				errorOffsets[nerrors] = i*8 + 7 - bit;
+			}
+			nerrors++;
+		}
+	}
+
+	outputBufferLen = len;
+
+	return nerrors;
+}
+
+int Manchester::process(DecoderBuffer& buffer, FrameRecord& record)
+{
+	size_t len;
+	if (decode(buffer.data, buffer.len, buffer.data, len) < 0 || len == 0) {
+		// May happen due to transmission errors.
+		return -1;
+	}
+
+	buffer.len = len;
+
+	return 0;
+}
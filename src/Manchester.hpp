@@ -24,13 +24,27 @@
 #define MAN_DECODING_ERROR   1
 
 #include <stdint.h>
+#include <stddef.h>
+
+#include "IDecoderStage.hpp"
 
 /**
  * Encodes or decodes a buffer of bytes following the rules of the Manchester Code.
+ *
+ * Every data bit is sent as a symbol of 2 bits: 0 as 10, 1 as 01. The symbols
+ * 00 and 11 are invalid. Both directions work with a table lookup per byte.
+ *
+ * As decoder stage "manchester", decodes the bytes received in place.
  */
-class Manchester {
+class Manchester : public IDecoderStage {
 
 public:
+	virtual const char* getName() {
+		return "manchester";
+	}
+
+	virtual int process(DecoderBuffer& buffer, FrameRecord& record);
+
 	/**
 	 * Encodes a single byte.
 	 * The caller is responsible to provide a buffer for the manchester-encoded bytes
@@ -39,7 +53,7 @@ public:
 	 * @param unencoded Unencoded byte.
 	 * @param encoded Resulting manchester-encoded byte.
 	 */
-	void encodeByte(uint8_t *unencoded, uint8_t *encoded);
+	void encodeByte(const uint8_t *unencoded, uint8_t *encoded);
 
 	/**
 	 * Decodes a single byte.
@@ -52,7 +66,24 @@ public:
 	 * @return MAN_DECODING_ERROR if decoding fails or MAN_DECODING_OK, if
 	 * 		   decoding was successful.
 	 */
-	uint8_t decodeByte(uint8_t *undecoded, uint8_t *decoded);
+	uint8_t decodeByte(const uint8_t *undecoded, uint8_t *decoded);
+
+	/**
+	 * Decodes the 2 bytes holding one data byte.
+	 *
+	 * @param undecoded Undecoded bytes.
+	 * @param decoded Resulting manchester-decoded byte. Invalid symbols are decoded as 0.
+	 *
+	 * @return Mask of the invalid symbols, bit 7 for the first one. 0 if decoding
+	 *         was successful.
+	 */
+	static inline uint8_t decodePair(const uint8_t *undecoded, uint8_t *decoded) {
+		uint8_t high = decodeTab[undecoded[0]];
+		uint8_t low = decodeTab[undecoded[1]];
+
+		*decoded = (high << 4) | (low & 0x0F);
+		return (high & 0xF0) | (low >> 4);
+	}
 
 	/**
 	 * Encodes a buffer of bytes.
@@ -66,22 +97,48 @@ public:
 	 *
 	 * @return Length of resulting buffer of manchester-encoded bytes.
 	 */
-	uint8_t encode(uint8_t *inputBuffer, size_t inputBufferLen, uint8_t *outputBuffer, size_t& outputBufferLen);
+	size_t encode(const uint8_t *inputBuffer, size_t inputBufferLen, uint8_t *outputBuffer, size_t& outputBufferLen);
 
 	/**
-	 * Decodes a buffer of bytes.
+	 * Decodes a buffer of bytes. A trailing odd byte is ignored.
 	 * The caller is responsible to provide a buffer for the resulting manchester-decoded bytes of
 	 * at least half the size of the buffer of the undecoded bytes.
+	 * The output buffer may be the same as the input buffer.
 	 *
 	 * @param inputBuffer Buffer of undecoded bytes.
 	 * @param inputBufferLen Length of buffer of undecoded bytes.
 	 * @param outputBuffer Resulting buffer of manchester-decoded bytes.
 	 * @param outputBufferLen Length of resulting buffer of manchester-decoded bytes.
 	 *
-	 * @return Length of resulting buffer of manchester-decoded bytes or 0, if decoding failed.
+	 * @return Length of resulting buffer of manchester-decoded bytes, or -1 if there are
+	 *         invalid symbols. outputBufferLen is 0 then.
+	 */
+	int decode(const uint8_t *inputBuffer, size_t inputBufferLen, uint8_t *outputBuffer, size_t& outputBufferLen);
+
+	/**
+	 * Decodes a buffer of bytes like decode(), but doesn't fail on invalid symbols.
+	 * Instead, the positions of the invalid symbols are returned. The position
+	 * of a symbol is the number of the data bit it encodes, counting from
+	 * the most significant bit of the first decoded byte. Invalid symbols are
+	 * decoded as 0.
+	 *
+	 * @param errorOffsets Resulting positions of the invalid symbols.
+	 * @param maxErrors Number of positions errorOffsets has space for.
+	 *
+	 * @return Number of invalid symbols, may be larger than maxErrors.
+	 */
+	size_t decode(const uint8_t *inputBuffer, size_t inputBufferLen, uint8_t *outputBuffer, size_t& outputBufferLen,
+			uint16_t errorOffsets[], size_t maxErrors);
+
+private:
+	/**
+	 * Data bits of an encoded byte in the low nibble, a bit set in the high
+	 * nibble for each invalid symbol.
 	 */
-	uint8_t decode(uint8_t *inputBuffer, size_t inputBufferLen, uint8_t *outputBuffer, size_t& outputBufferLen);
+	static const uint8_t decodeTab[256];
 
+	/** Both encoded bytes of a byte, the first one in the high byte. */
+	static const uint16_t encodeTab[256];
 };
 
 #endif /* MANCHESTER_HPP_ */
@@ -0,0 +1,81 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+
+#include "Metrics.hpp"
+
+struct CounterDescription {
+	const char* name;
+	const char* help;
+};
+
+static const CounterDescription COUNTER_DESCRIPTIONS[Metrics::COUNTERS] = {
+	{ "rfcc1101_frames_received_total", "Data frames received and published." },
+	{ "rfcc1101_payload_bytes_received_total", "Payload bytes of the data frames received." },
+	{ "rfcc1101_crc_errors_total", "Data frames the receiver detected a CRC error in." },
+	{ "rfcc1101_rx_fifo_overflows_total", "RX FIFO overflows, the data frame was lost." },
+	{ "rfcc1101_invalid_length_total", "Data frames with an invalid length byte." },
+	{ "rfcc1101_receive_errors_total", "Data frames that could not be read or decoded, for any reason." },
+	{ "rfcc1101_receive_timeouts_total", "Waits for a data frame that timed out." },
+	{ "rfcc1101_frame_pool_exhausted_total", "Data frames dropped because no frame slot was free." },
+	{ "rfcc1101_client_drops_total", "Data frames not written to a client because it was too slow." },
+	{ "rfcc1101_frames_transmitted_total", "Data frames transmitted." },
+	{ "rfcc1101_transmit_errors_total", "Data frames that could not be transmitted." },
+	{ "rfcc1101_capture_drops_total", "Receive calls not captured because the capture fell behind." },
+	{ "rfcc1101_store_drops_total", "Data frames not stored because the frame store fell behind or failed." },
+};
+
+uint64_t Metrics::counters[Metrics::COUNTERS];
+
+/**
+ * snprintf returns the length it would have written; count only what fits.
+ */
+static size_t clamp(int rc, size_t maxBytes) {
+	if (rc < 0 || maxBytes == 0) {
+		return 0;
+	}
+
+	return (size_t) rc < maxBytes ? rc : maxBytes - 1;
+}
+
+size_t Metrics::formatHeader(char* out, size_t maxBytes, const char* name, const char* type, const char* help) {
+	return clamp(snprintf(out, maxBytes, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type), maxBytes);
+}
+
+size_t Metrics::formatSample(char* out, size_t maxBytes, const char* name, const char* labels, uint64_t value) {
+	if (labels != NULL) {
+		return clamp(snprintf(out, maxBytes, "%s{%s} %llu\n", name, labels, (unsigned long long) value), maxBytes);
+	}
+
+	return clamp(snprintf(out, maxBytes, "%s %llu\n", name, (unsigned long long) value), maxBytes);
+}
+
+size_t Metrics::format(char* out, size_t maxBytes) {
+	size_t len = 0;
+
+	for (int i=0 ; i<COUNTERS ; i++) {
+		const CounterDescription& description = COUNTER_DESCRIPTIONS[i];
+
+		len += formatHeader(out + len, maxBytes - len, description.name, "counter", description.help);
+		len += formatSample(out + len, maxBytes - len, description.name, NULL, Metrics::get(i));
+	}
+
+	return len;
+}
@@ -0,0 +1,83 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef METRICS_HPP_
+#define METRICS_HPP_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Counters of what happened while receiving and transmitting, exposed in
+ * the Prometheus text format by the MetricsServer.
+ *
+ * Counting is a relaxed atomic add, so any thread may count and read.
+ */
+class Metrics {
+
+public:
+	static const int FRAMES_RECEIVED = 0;
+	static const int BYTES_RECEIVED = 1;
+	static const int CRC_ERRORS = 2;
+	static const int FIFO_OVERFLOWS = 3;
+	static const int INVALID_LENGTH = 4;
+	static const int RECEIVE_ERRORS = 5;
+	static const int RECEIVE_TIMEOUTS = 6;
+	static const int FRAME_POOL_EXHAUSTED = 7;
+	static const int CLIENT_DROPS = 8;
+	static const int FRAMES_TRANSMITTED = 9;
+	static const int TRANSMIT_ERRORS = 10;
+	static const int CAPTURE_DROPS = 11;
+	static const int STORE_DROPS = 12;
+	static const int COUNTERS = 13;
+
+	static void increment(int counter) {
+		__atomic_fetch_add(&Metrics::counters[counter], 1, __ATOMIC_RELAXED);
+	};
+
+	static void add(int counter, uint64_t n) {
+		__atomic_fetch_add(&Metrics::counters[counter], n, __ATOMIC_RELAXED);
+	};
+
+	static uint64_t get(int counter) {
+		return __atomic_load_n(&Metrics::counters[counter], __ATOMIC_RELAXED);
+	};
+
+	/**
+	 * Writes all counters. Returns the number of characters written,
+	 * truncated at maxBytes - 1.
+	 */
+	static size_t format(char* out, size_t maxBytes);
+
+	/**
+	 * Writes the "# HELP" and "# TYPE" lines of a metric.
+	 * type is "counter" or "gauge".
+	 */
+	static size_t formatHeader(char* out, size_t maxBytes, const char* name, const char* type, const char* help);
+
+	/**
+	 * Writes a sample of a metric. labels is e.g. "stage=\"crc\"", or NULL.
+	 */
+	static size_t formatSample(char* out, size_t maxBytes, const char* name, const char* labels, uint64_t value);
+
+private:
+	static uint64_t counters[COUNTERS];
+};
+
+#endif /* METRICS_HPP_ */
@@ -0,0 +1,294 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <assert.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "DateTime.hpp"
+#include "Log.hpp"
+#include "Metrics.hpp"
+
+#include "MetricsServer.hpp"
+
+MetricsServer::MetricsServer() {
+	this->sockfd = -1;
+	this->nsources = 0;
+
+	for (int i=0 ; i<MAX_CONNECTIONS ; i++) {
+		this->connections[i].fd = -1;
+	}
+}
+
+MetricsServer::~MetricsServer() {
+	if (this->sockfd >= 0) {
+		this->close();
+	}
+}
+
+void MetricsServer::addSource(IMetricsSource* source) {
+	assert(this->nsources < MAX_SOURCES);
+
+	this->sources[this->nsources++] = source;
+}
+
+void MetricsServer::open(const char* address, int port) {
+
+	struct sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(port);
+	if (inet_aton(address, &addr.sin_addr) == 0) {
+		fprintf(stderr, "Invalid metrics address %s\n", address);
+		exit(1);
+	}
+
+	this->sockfd = socket(AF_INET, SOCK_STREAM, 0);
+	if (this->sockfd < 0) {
+		perror("Opening metrics socket");
+		exit(1);
+	}
+
+	// The server closes the connections, so they are in TIME_WAIT on
+	// this side. A restart of the driver must not wait for them.
+	int reuse = 1;
+	setsockopt(this->sockfd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+	if (bind(this->sockfd, (struct sockaddr*) &addr, sizeof(addr)) < 0) {
+		perror("Binding metrics socket");
+		exit(1);
+	}
+
+	if (listen(this->sockfd, MAX_CONNECTIONS) < 0) {
+		perror("Listening on metrics socket");
+		exit(1);
+	}
+
+	LOG_INFO("Serving metrics on http://%s:%d/metrics\n", address, port);
+}
+
+void MetricsServer::close() {
+	for (int i=0 ; i<MAX_CONNECTIONS ; i++) {
+		if (this->connections[i].fd >= 0) {
+			closeConnection(&this->connections[i]);
+		}
+	}
+
+	::close(this->sockfd);
+	this->sockfd = -1;
+}
+
+int MetricsServer::getPollFds(struct pollfd fds[]) {
+	int nfds = 0;
+
+	fds[nfds].fd = this->sockfd;
+	fds[nfds++].events = POLLIN;
+
+	for (int i=0 ; i<MAX_CONNECTIONS ; i++) {
+		Connection* connection = &this->connections[i];
+		if (connection->fd >= 0) {
+			fds[nfds].fd = connection->fd;
+			fds[nfds++].events = connection->responseLength > 0 ? POLLOUT : POLLIN;
+		}
+	}
+
+	return nfds;
+}
+
+void MetricsServer::handleEvents(struct pollfd fds[], int nfds) {
+
+	for (int i=1 ; i<nfds ; i++) {
+		if (fds[i].revents == 0) {
+			continue;
+		}
+
+		for (int j=0 ; j<MAX_CONNECTIONS ; j++) {
+			Connection* connection = &this->connections[j];
+			if (connection->fd != fds[i].fd) {
+				continue;
+			}
+
+			if (connection->responseLength > 0) {
+				writeResponse(connection);
+			} else {
+				readRequest(connection);
+			}
+			break;
+		}
+	}
+
+	if (nfds > 0 && fds[0].revents > 0) {
+		acceptConnection();
+	}
+}
+
+void MetricsServer::acceptConnection() {
+
+	int fd = accept(this->sockfd, NULL, NULL);
+	if (fd < 0) {
+		// The scraper may have given up already
+		return;
+	}
+
+	int flags = fcntl(fd, F_GETFL, 0);
+	if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+		perror("Setting socket non-blocking");
+		exit(1);
+	}
+
+	// Take a free connection, or the oldest one: A scraper that doesn't
+	// send its request must not lock out the others.
+	Connection* connection = &this->connections[0];
+	for (int i=0 ; i<MAX_CONNECTIONS ; i++) {
+		if (this->connections[i].fd < 0) {
+			connection = &this->connections[i];
+			break;
+		}
+		if (this->connections[i].opened < connection->opened) {
+			connection = &this->connections[i];
+		}
+	}
+
+	if (connection->fd >= 0) {
+		closeConnection(connection);
+	}
+
+	connection->fd = fd;
+	connection->opened = DateTime::nanos(CLOCK_MONOTONIC);
+	connection->requestLength = 0;
+	connection->responseLength = 0;
+	connection->written = 0;
+}
+
+/**
+ * Reads the request up to the empty line ending the header and answers it.
+ */
+void MetricsServer::readRequest(Connection* connection) {
+
+	ssize_t rc = read(connection->fd, connection->request + connection->requestLength,
+			MAX_REQUEST_BYTES - 1 - connection->requestLength);
+	if (rc < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+		return;
+	}
+
+	if (rc <= 0) {
+		closeConnection(connection);
+		return;
+	}
+
+	connection->requestLength += rc;
+	connection->request[connection->requestLength] = '\0';
+
+	if (strstr(connection->request, "\r\n\r\n") == NULL && strstr(connection->request, "\n\n") == NULL) {
+		if (connection->requestLength == MAX_REQUEST_BYTES - 1) {
+			const char* message = "Request too long\n";
+			respond(connection, "400 Bad Request", "text/plain", message, strlen(message));
+		}
+		return;
+	}
+
+	// Request line: GET /metrics HTTP/1.1
+	char method[8];
+	char path[64];
+	if (sscanf(connection->request, "%7s %63s", method, path) != 2) {
+		const char* message = "Bad request\n";
+		respond(connection, "400 Bad Request", "text/plain", message, strlen(message));
+		return;
+	}
+
+	char* query = strchr(path, '?');
+	if (query != NULL) {
+		*query = '\0';
+	}
+
+	if (strcmp(method, "GET") != 0) {
+		const char* message = "Only GET is supported\n";
+		respond(connection, "405 Method Not Allowed", "text/plain", message, strlen(message));
+		return;
+	}
+
+	if (strcmp(path, "/metrics") != 0) {
+		const char* message = "Metrics are at /metrics\n";
+		respond(connection, "404 Not Found", "text/plain", message, strlen(message));
+		return;
+	}
+
+	size_t len = formatMetrics(this->body, sizeof(this->body));
+	respond(connection, "200 OK", "text/plain; version=0.0.4", this->body, len);
+}
+
+size_t MetricsServer::formatMetrics(char* out, size_t maxBytes) {
+
+	size_t len = Metrics::format(out, maxBytes);
+
+	for (int i=0 ; i<this->nsources ; i++) {
+		len += this->sources[i]->formatMetrics(out + len, maxBytes - len);
+	}
+
+	return len;
+}
+
+void MetricsServer::respond(Connection* connection, const char* status, const char* contentType,
+		const char* body, size_t len) {
+
+	assert(len <= MAX_BODY_BYTES);
+
+	int header = snprintf(connection->response, MAX_HEADER_BYTES,
+			"HTTP/1.0 %s\r\nContent-Type: %s\r\nContent-Length: %u\r\nConnection: close\r\n\r\n",
+			status, contentType, (unsigned int) len);
+	assert(header > 0 && (size_t) header < MAX_HEADER_BYTES);
+
+	memcpy(connection->response + header, body, len);
+	connection->responseLength = header + len;
+	connection->written = 0;
+
+	writeResponse(connection);
+}
+
+void MetricsServer::writeResponse(Connection* connection) {
+
+	ssize_t rc = write(connection->fd, connection->response + connection->written,
+			connection->responseLength - connection->written);
+	if (rc < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+		return;
+	}
+
+	if (rc < 0) {
+		closeConnection(connection);
+		return;
+	}
+
+	connection->written += rc;
+	if (connection->written == connection->responseLength) {
+		closeConnection(connection);
+	}
+}
+
+void MetricsServer::closeConnection(Connection* connection) {
+	::close(connection->fd);
+	connection->fd = -1;
+	connection->responseLength = 0;
+}
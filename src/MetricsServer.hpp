@@ -0,0 +1,109 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef METRICSSERVER_HPP_
+#define METRICSSERVER_HPP_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <poll.h>
+
+#include "IMetricsSource.hpp"
+
+/**
+ * Minimal HTTP server answering "GET /metrics" with the Metrics counters
+ * and the metrics of the sources added, in the Prometheus text format.
+ *
+ * It has no thread of its own: The SocketServer polls the descriptors
+ * returned by getPollFds() together with its own and passes the events on
+ * to handleEvents(). The sockets are non-blocking and each connection
+ * is closed after the response, so scrapes never hold up receiving.
+ */
+class MetricsServer {
+
+public:
+	static const int MAX_CONNECTIONS = 4;
+
+	/** Descriptors getPollFds() returns at most */
+	static const int MAX_FDS = 1 + MAX_CONNECTIONS;
+
+	static const int MAX_SOURCES = 8;
+
+	MetricsServer();
+	~MetricsServer();
+
+	void addSource(IMetricsSource* source);
+
+	/**
+	 * Listens on the address, e.g. "127.0.0.1" to be reachable from this
+	 * host only, or "0.0.0.0" for all interfaces.
+	 */
+	void open(const char* address, int port);
+	void close();
+
+	/**
+	 * Fills in the descriptors to poll, returns their number.
+	 */
+	int getPollFds(struct pollfd fds[]);
+
+	/**
+	 * Accepts connections, reads requests and writes responses, as the
+	 * events of the descriptors returned by getPollFds() tell.
+	 */
+	void handleEvents(struct pollfd fds[], int nfds);
+
+private:
+	static const size_t MAX_REQUEST_BYTES = 1024;
+	static const size_t MAX_HEADER_BYTES = 256;
+	static const size_t MAX_BODY_BYTES = 16384;
+
+	struct Connection {
+		/** Socket file descriptor, -1 if unused */
+		int fd;
+
+		/** CLOCK_MONOTONIC, ns. The oldest connection is closed when all are in use. */
+		uint64_t opened;
+
+		char request[MAX_REQUEST_BYTES];
+		size_t requestLength;
+
+		char response[MAX_HEADER_BYTES + MAX_BODY_BYTES];
+		size_t responseLength;
+		size_t written;
+	};
+
+	int sockfd;
+
+	IMetricsSource* sources[MAX_SOURCES];
+	int nsources;
+
+	Connection connections[MAX_CONNECTIONS];
+
+	/** Body of the response, before the header is put in front */
+	char body[MAX_BODY_BYTES];
+
+	void acceptConnection();
+	void readRequest(Connection* connection);
+	void respond(Connection* connection, const char* status, const char* contentType, const char* body, size_t len);
+	void writeResponse(Connection* connection);
+	void closeConnection(Connection* connection);
+	size_t formatMetrics(char* out, size_t maxBytes);
+};
+
+#endif /* METRICSSERVER_HPP_ */
@@ -0,0 +1,220 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <assert.h>
+#include <arpa/inet.h>
+
+#include "DateTime.hpp"
+#include "Log.hpp"
+#include "FrameRecordCodec.hpp"
+
+#include "MulticastPublisher.hpp"
+
+MulticastPublisher::MulticastPublisher(const char* group, int port, int lingerMillis) {
+	this->group = group;
+	this->port = port;
+	this->lingerMillis = lingerMillis;
+	this->sockfd = -1;
+
+	this->datagramSequence = 0;
+	this->ndatagrams = 0;
+	this->pendingSince = 0;
+}
+
+MulticastPublisher::~MulticastPublisher() {
+	if (this->sockfd >= 0) {
+		this->close();
+	}
+}
+
+void MulticastPublisher::open(const char* interfaceAddress, int ttl) {
+
+	memset(&this->groupAddress, 0, sizeof(this->groupAddress));
+	this->groupAddress.sin_family = AF_INET;
+	this->groupAddress.sin_port = htons(this->port);
+	if (inet_aton(this->group, &this->groupAddress.sin_addr) == 0
+			|| !IN_MULTICAST(ntohl(this->groupAddress.sin_addr.s_addr))) {
+		fprintf(stderr, "Invalid multicast group address %s\n", this->group);
+		exit(1);
+	}
+
+	this->sockfd = socket(AF_INET, SOCK_DGRAM, 0);
+	if (this->sockfd < 0) {
+		perror("Opening multicast socket");
+		exit(1);
+	}
+
+	unsigned char multicastTtl = ttl;
+	if (setsockopt(this->sockfd, IPPROTO_IP, IP_MULTICAST_TTL, &multicastTtl, sizeof(multicastTtl)) < 0) {
+		perror("Setting multicast TTL");
+		exit(1);
+	}
+
+	// Deliver to listeners on this host as well
+	unsigned char loop = 1;
+	if (setsockopt(this->sockfd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop)) < 0) {
+		perror("Setting multicast loopback");
+		exit(1);
+	}
+
+	if (interfaceAddress != NULL) {
+		struct in_addr addr;
+		if (inet_aton(interfaceAddress, &addr) == 0) {
+			fprintf(stderr, "Invalid interface address %s\n", interfaceAddress);
+			exit(1);
+		}
+
+		if (setsockopt(this->sockfd, IPPROTO_IP, IP_MULTICAST_IF, &addr, sizeof(addr)) < 0) {
+			perror("Setting multicast interface");
+			exit(1);
+		}
+	}
+
+	LOG_INFO("Publishing data frames to multicast group %s:%d (linger=%d ms)\n",
+			this->group, this->port, this->lingerMillis);
+}
+
+void MulticastPublisher::close() {
+	this->flush();
+
+	if (::close(this->sockfd) < 0) {
+		perror("Closing multicast socket");
+		exit(1);
+	}
+
+	this->sockfd = -1;
+}
+
+/**
+ * Starts a new datagram and writes its header.
+ */
+uint8_t* MulticastPublisher::startDatagram() {
+
+	assert(this->ndatagrams < MAX_DATAGRAMS);
+
+	uint8_t* datagram = this->datagrams[this->ndatagrams];
+	uint32_t sequence = this->datagramSequence++;
+
+	datagram[0] = (MULTICAST_MAGIC >> 24) & 0xFF;
+	datagram[1] = (MULTICAST_MAGIC >> 16) & 0xFF;
+	datagram[2] = (MULTICAST_MAGIC >> 8) & 0xFF;
+	datagram[3] = MULTICAST_MAGIC & 0xFF;
+	datagram[4] = MULTICAST_VERSION;
+	datagram[5] = 0; // Number of records
+	datagram[6] = 0;
+	datagram[7] = 0;
+	datagram[8] = sequence >> 24;
+	datagram[9] = sequence >> 16;
+	datagram[10] = sequence >> 8;
+	datagram[11] = sequence;
+
+	this->datagramLength[this->ndatagrams++] = HEADER_BYTES;
+
+	return datagram;
+}
+
+void MulticastPublisher::publish(const FrameRecord& record) {
+
+	size_t len = FrameRecordCodec::encodedLength(record);
+	assert(HEADER_BYTES + len <= DEFAULT_DATAGRAM_BYTES);
+
+	int current = this->ndatagrams - 1;
+	if (current < 0
+			|| this->datagramLength[current] + len > DEFAULT_DATAGRAM_BYTES
+			|| this->datagrams[current][5] == 0xFF) {
+
+		// Does not fit into the current datagram
+		if (this->ndatagrams == MAX_DATAGRAMS) {
+			flush();
+		}
+
+		startDatagram();
+		current = this->ndatagrams - 1;
+	}
+
+	uint8_t* datagram = this->datagrams[current];
+	this->datagramLength[current] += FrameRecordCodec::encode(record, datagram + this->datagramLength[current]);
+	datagram[5]++;
+
+	if (this->pendingSince == 0) {
+		this->pendingSince = DateTime::nanos(CLOCK_MONOTONIC);
+	}
+
+	if (this->lingerMillis == 0) {
+		flush();
+	}
+}
+
+int MulticastPublisher::flushTimeout() {
+	if (this->ndatagrams == 0) {
+		return -1;
+	}
+
+	uint64_t elapsed = (DateTime::nanos(CLOCK_MONOTONIC) - this->pendingSince) / 1000000;
+	if (elapsed >= (uint64_t) this->lingerMillis) {
+		return 0;
+	}
+
+	return this->lingerMillis - elapsed;
+}
+
+/**
+ * Sends all pending datagrams with a single system call.
+ */
+void MulticastPublisher::flush() {
+
+	if (this->ndatagrams == 0) {
+		return;
+	}
+
+	struct mmsghdr msgs[MAX_DATAGRAMS];
+	struct iovec iov[MAX_DATAGRAMS];
+
+	memset(msgs, 0, sizeof(msgs));
+
+	for (int i=0 ; i<this->ndatagrams ; i++) {
+		iov[i].iov_base = this->datagrams[i];
+		iov[i].iov_len = this->datagramLength[i];
+
+		msgs[i].msg_hdr.msg_name = &this->groupAddress;
+		msgs[i].msg_hdr.msg_namelen = sizeof(this->groupAddress);
+		msgs[i].msg_hdr.msg_iov = &iov[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	int sent = 0;
+	while (sent < this->ndatagrams) {
+		int rc = sendmmsg(this->sockfd, msgs + sent, this->ndatagrams - sent, 0);
+		if (rc < 0) {
+			// Don't stop receiving just because the network is down.
+			// Receivers will notice the gap in the sequence numbers.
+			perror("Sending multicast datagrams");
+			break;
+		}
+
+		sent += rc;
+	}
+
+	this->ndatagrams = 0;
+	this->pendingSince = 0;
+}
@@ -0,0 +1,106 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MULTICASTPUBLISHER_HPP_
+#define MULTICASTPUBLISHER_HPP_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+#include "IFrameSink.hpp"
+
+static const uint32_t MULTICAST_MAGIC = 0x4331314D; // "C11M"
+static const uint8_t MULTICAST_VERSION = 1;
+
+/**
+ * Sends every data frame received once as UDP datagram to a multicast
+ * group, no matter how many listeners there are.
+ *
+ * Datagram format (network byte order):
+ *
+ * Byte 0-3:  Magic "C11M"
+ * Byte 4:    Version
+ * Byte 5:    Number of records in this datagram
+ * Byte 6-7:  Reserved
+ * Byte 8-11: Datagram sequence number
+ * Byte 12 to end: Records, encoded by FrameRecordCodec
+ *
+ * Receivers detect lost frames by gaps in the record sequence numbers.
+ *
+ * If a linger time is configured, small frames are collected into one
+ * datagram up to the maximum datagram size. Several datagrams are sent
+ * with a single system call.
+ */
+class MulticastPublisher : public IFrameSink {
+
+public:
+	static const size_t HEADER_BYTES = 12;
+
+	/** Fits into an Ethernet frame without IP fragmentation */
+	static const size_t DEFAULT_DATAGRAM_BYTES = 1472;
+
+	/**
+	 * @param group Multicast group address, e.g. "239.255.0.1".
+	 * @param port UDP port.
+	 * @param lingerMillis How long to wait for more frames before sending
+	 *        a datagram. 0 sends every frame immediately.
+	 */
+	MulticastPublisher(const char* group, int port, int lingerMillis);
+	virtual ~MulticastPublisher();
+
+	/**
+	 * Creates the socket.
+	 *
+	 * @param interfaceAddress Address of the local interface to send on,
+	 *        e.g. "127.0.0.1" for testing on loopback. NULL for default.
+	 * @param ttl Multicast time to live, 1 keeps datagrams on the local network.
+	 */
+	void open(const char* interfaceAddress, int ttl);
+	void close();
+
+	virtual void publish(const FrameRecord& record);
+	virtual int flushTimeout();
+	virtual void flush();
+
+private:
+	static const int MAX_DATAGRAMS = 16;
+
+	const char* group;
+	int port;
+	int lingerMillis;
+	int sockfd;
+
+	struct sockaddr_in groupAddress;
+
+	uint32_t datagramSequence;
+
+	/** Datagrams waiting to be sent. The last one may still be filled. */
+	uint8_t datagrams[MAX_DATAGRAMS][DEFAULT_DATAGRAM_BYTES];
+	size_t datagramLength[MAX_DATAGRAMS];
+	int ndatagrams;
+
+	/** Time when the first pending record was added (CLOCK_MONOTONIC, ns) */
+	uint64_t pendingSince;
+
+	uint8_t* startDatagram();
+};
+
+#endif /* MULTICASTPUBLISHER_HPP_ */
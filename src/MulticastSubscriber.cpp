@@ -0,0 +1,140 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "FrameRecordCodec.hpp"
+
+#include "MulticastSubscriber.hpp"
+
+MulticastSubscriber::MulticastSubscriber() {
+	this->sockfd = -1;
+	this->nextSequence = 0;
+	this->lost = 0;
+}
+
+MulticastSubscriber::~MulticastSubscriber() {
+	if (this->sockfd >= 0) {
+		this->close();
+	}
+}
+
+int MulticastSubscriber::open(const char* group, int port, const char* interfaceAddress) {
+
+	struct ip_mreq mreq;
+	memset(&mreq, 0, sizeof(mreq));
+
+	if (inet_aton(group, &mreq.imr_multiaddr) == 0) {
+		fprintf(stderr, "Invalid multicast group address %s\n", group);
+		return -1;
+	}
+
+	mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+	if (interfaceAddress != NULL && inet_aton(interfaceAddress, &mreq.imr_interface) == 0) {
+		fprintf(stderr, "Invalid interface address %s\n", interfaceAddress);
+		return -1;
+	}
+
+	this->sockfd = socket(AF_INET, SOCK_DGRAM, 0);
+	if (this->sockfd < 0) {
+		perror("Opening multicast socket");
+		return -1;
+	}
+
+	// Several subscribers on the same host
+	int reuse = 1;
+	setsockopt(this->sockfd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+	struct sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr = mreq.imr_multiaddr;
+	addr.sin_port = htons(port);
+
+	if (bind(this->sockfd, (struct sockaddr*) &addr, sizeof(addr)) < 0) {
+		perror("Binding multicast socket");
+		this->close();
+		return -1;
+	}
+
+	if (setsockopt(this->sockfd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
+		perror("Joining multicast group");
+		this->close();
+		return -1;
+	}
+
+	return 0;
+}
+
+void MulticastSubscriber::close() {
+	::close(this->sockfd);
+	this->sockfd = -1;
+}
+
+int MulticastSubscriber::receive(FrameRecord records[], int maxRecords, int timeoutMillis) {
+
+	struct pollfd pl[1];
+	pl[0].fd = this->sockfd;
+	pl[0].events = POLLIN;
+
+	int rc = poll(pl, 1, timeoutMillis);
+	if (rc <= 0) {
+		return rc;
+	}
+
+	ssize_t len = recv(this->sockfd, this->datagram, sizeof(this->datagram), 0);
+	if (len < (ssize_t) MulticastPublisher::HEADER_BYTES) {
+		return len < 0 ? -1 : 0;
+	}
+
+	uint32_t magic = ((uint32_t) this->datagram[0] << 24) | (this->datagram[1] << 16)
+			| (this->datagram[2] << 8) | this->datagram[3];
+	if (magic != MULTICAST_MAGIC || this->datagram[4] != MULTICAST_VERSION) {
+		return 0; // Not for us
+	}
+
+	int count = this->datagram[5];
+	size_t pos = MulticastPublisher::HEADER_BYTES;
+	int n = 0;
+
+	for (int i=0 ; i<count && n<maxRecords ; i++) {
+		size_t consumed = FrameRecordCodec::decode(this->datagram + pos, len - pos, records[n]);
+		if (consumed == 0) {
+			break; // Truncated datagram
+		}
+		pos += consumed;
+
+		uint32_t sequence = records[n].sequence;
+		if (this->nextSequence != 0 && sequence > this->nextSequence) {
+			this->lost += sequence - this->nextSequence;
+		}
+		this->nextSequence = sequence + 1;
+
+		n++;
+	}
+
+	return n;
+}
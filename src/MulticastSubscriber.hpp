@@ -0,0 +1,82 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MULTICASTSUBSCRIBER_HPP_
+#define MULTICASTSUBSCRIBER_HPP_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "FrameRecord.hpp"
+#include "MulticastPublisher.hpp"
+
+/**
+ * Receives the data frames sent by the MulticastPublisher.
+ *
+ * To use it in your own application, compile MulticastSubscriber.cpp and
+ * FrameRecordCodec.cpp together with your sources.
+ */
+class MulticastSubscriber {
+
+public:
+	MulticastSubscriber();
+	~MulticastSubscriber();
+
+	/**
+	 * Joins the multicast group.
+	 *
+	 * @param interfaceAddress Address of the local interface to receive on,
+	 *        e.g. "127.0.0.1" for testing on loopback. NULL for default.
+	 *
+	 * Returns 0 on success, -1 on error.
+	 */
+	int open(const char* group, int port, const char* interfaceAddress);
+	void close();
+
+	/**
+	 * Receives one datagram and decodes the records it contains.
+	 * Blocks until a datagram arrives or the timeout expires.
+	 *
+	 * Returns the number of records decoded, 0 on timeout and -1 on error.
+	 */
+	int receive(FrameRecord records[], int maxRecords, int timeoutMillis);
+
+	/**
+	 * Number of records missed, calculated from the gaps in the record
+	 * sequence numbers.
+	 */
+	uint64_t getLost() {
+		return this->lost;
+	}
+
+	int getFd() {
+		return this->sockfd;
+	}
+
+private:
+	int sockfd;
+
+	/** Sequence number of the next record expected, 0 before the first one */
+	uint32_t nextSequence;
+	uint64_t lost;
+
+	uint8_t datagram[MulticastPublisher::DEFAULT_DATAGRAM_BYTES];
+};
+
+#endif /* MULTICASTSUBSCRIBER_HPP_ */
@@ -0,0 +1,74 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <assert.h>
+
+#include "OutputBufferPool.hpp"
+
+OutputBufferPool::OutputBufferPool(int nbuffers) {
+	assert(nbuffers > 0);
+
+	this->buffers = new OutputBuffer[nbuffers];
+	this->freeList = NULL;
+
+	for (int i=nbuffers-1 ; i>=0 ; i--) {
+		this->buffers[i].refs = 0;
+		this->buffers[i].next = this->freeList;
+		this->freeList = &this->buffers[i];
+	}
+
+	this->available = nbuffers;
+}
+
+OutputBufferPool::~OutputBufferPool() {
+	delete[] this->buffers;
+}
+
+OutputBuffer* OutputBufferPool::acquire() {
+
+	OutputBuffer* buffer = this->freeList;
+	if (buffer == NULL) {
+		return NULL;
+	}
+
+	this->freeList = buffer->next;
+	this->available--;
+
+	buffer->next = NULL;
+	buffer->len = 0;
+	buffer->refs = 1;
+
+	return buffer;
+}
+
+void OutputBufferPool::retain(OutputBuffer* buffer) {
+	assert(buffer->refs > 0);
+
+	buffer->refs++;
+}
+
+void OutputBufferPool::release(OutputBuffer* buffer) {
+	assert(buffer->refs > 0);
+
+	if (--buffer->refs == 0) {
+		buffer->next = this->freeList;
+		this->freeList = buffer;
+		this->available++;
+	}
+}
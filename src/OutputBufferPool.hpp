@@ -0,0 +1,77 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OUTPUTBUFFERPOOL_HPP_
+#define OUTPUTBUFFERPOOL_HPP_
+
+#include <stddef.h>
+
+/**
+ * Bytes to be written to one or more clients, e.g. a data frame rendered
+ * in an output format. Every client queue holding the buffer owns a
+ * reference; the buffer goes back to the pool when the last client has
+ * written it.
+ */
+struct OutputBuffer {
+	static const size_t MAX_BYTES = 1024;
+
+	char data[MAX_BYTES];
+	size_t len;
+
+	int refs;
+
+	/** Next free buffer while in the pool */
+	OutputBuffer* next;
+};
+
+/**
+ * Preallocated output buffers, so no memory is allocated per data frame.
+ */
+class OutputBufferPool {
+
+public:
+	OutputBufferPool(int nbuffers);
+	~OutputBufferPool();
+
+	/**
+	 * Takes a buffer from the pool, with a single reference.
+	 * Returns NULL if all buffers are in use.
+	 */
+	OutputBuffer* acquire();
+
+	/**
+	 * Adds a reference to a buffer.
+	 */
+	void retain(OutputBuffer* buffer);
+
+	/**
+	 * Drops a reference. Returns the buffer to the pool when it was the
+	 * last one.
+	 */
+	void release(OutputBuffer* buffer);
+
+	int getAvailable() { return this->available; };
+
+private:
+	OutputBuffer* buffers;
+	OutputBuffer* freeList;
+	int available;
+};
+
+#endif /* OUTPUTBUFFERPOOL_HPP_ */
@@ -0,0 +1,99 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "OutputEncoding.hpp"
+
+const char OutputEncoding::HEX_DIGITS[513] =
+	"000102030405060708090A0B0C0D0E0F101112131415161718191A1B1C1D1E1F"
+	"202122232425262728292A2B2C2D2E2F303132333435363738393A3B3C3D3E3F"
+	"404142434445464748494A4B4C4D4E4F505152535455565758595A5B5C5D5E5F"
+	"606162636465666768696A6B6C6D6E6F707172737475767778797A7B7C7D7E7F"
+	"808182838485868788898A8B8C8D8E8F909192939495969798999A9B9C9D9E9F"
+	"A0A1A2A3A4A5A6A7A8A9AAABACADAEAFB0B1B2B3B4B5B6B7B8B9BABBBCBDBEBF"
+	"C0C1C2C3C4C5C6C7C8C9CACBCCCDCECFD0D1D2D3D4D5D6D7D8D9DADBDCDDDEDF"
+	"E0E1E2E3E4E5E6E7E8E9EAEBECEDEEEFF0F1F2F3F4F5F6F7F8F9FAFBFCFDFEFF";
+
+const char OutputEncoding::DECIMAL_DIGITS[201] =
+	"0001020304050607080910111213141516171819"
+	"2021222324252627282930313233343536373839"
+	"4041424344454647484950515253545556575859"
+	"6061626364656667686970717273747576777879"
+	"8081828384858687888990919293949596979899";
+
+char* OutputEncoding::hex(char* out, const uint8_t data[], size_t nbytes) {
+
+	for (size_t i=0 ; i<nbytes ; i++) {
+		const char* digits = HEX_DIGITS + 2 * data[i];
+		out[0] = digits[0];
+		out[1] = digits[1];
+		out += 2;
+	}
+
+	return out;
+}
+
+size_t OutputEncoding::decimalLength(uint64_t value) {
+
+	size_t len = 1;
+	while (value >= 10) {
+		value /= 10;
+		len++;
+	}
+
+	return len;
+}
+
+char* OutputEncoding::decimal(char* out, uint64_t value) {
+
+	// Write the digits backwards, two at a time, then move them in place
+	char tmp[20];
+	char* p = tmp + sizeof(tmp);
+
+	while (value >= 100) {
+		const char* digits = DECIMAL_DIGITS + 2 * (value % 100);
+		value /= 100;
+		*--p = digits[1];
+		*--p = digits[0];
+	}
+
+	if (value >= 10) {
+		const char* digits = DECIMAL_DIGITS + 2 * value;
+		*--p = digits[1];
+		*--p = digits[0];
+	} else {
+		*--p = '0' + value;
+	}
+
+	size_t len = tmp + sizeof(tmp) - p;
+	memcpy(out, p, len);
+
+	return out + len;
+}
+
+char* OutputEncoding::signedDecimal(char* out, int64_t value) {
+
+	if (value < 0) {
+		*out++ = '-';
+		return decimal(out, (uint64_t) 0 - (uint64_t) value);
+	}
+
+	return decimal(out, (uint64_t) value);
+}
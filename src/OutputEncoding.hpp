@@ -0,0 +1,79 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OUTPUTENCODING_HPP_
+#define OUTPUTENCODING_HPP_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Encodes numbers and bytes as text for the output formats.
+ *
+ * The functions write directly into the output buffer and return the
+ * position after the last character written. No terminating '\0' is
+ * written. The caller makes sure the buffer is large enough; the
+ * *Length() functions tell the exact size.
+ *
+ * Hex digits are looked up in a table with the two characters of every
+ * byte value, so a payload is encoded in a single pass.
+ */
+class OutputEncoding {
+
+public:
+	/** Characters needed to encode nbytes bytes in hex */
+	static size_t hexLength(size_t nbytes) { return 2 * nbytes; };
+
+	/** Characters needed to encode a number in decimal */
+	static size_t decimalLength(uint64_t value);
+
+	/**
+	 * Writes a byte as two upper case hex digits.
+	 */
+	static char* hex(char* out, uint8_t value) {
+		const char* digits = HEX_DIGITS + 2 * value;
+		out[0] = digits[0];
+		out[1] = digits[1];
+		return out + 2;
+	}
+
+	/**
+	 * Writes bytes as upper case hex digits, two per byte.
+	 */
+	static char* hex(char* out, const uint8_t data[], size_t nbytes);
+
+	/**
+	 * Writes a number in decimal, without leading zeros.
+	 */
+	static char* decimal(char* out, uint64_t value);
+
+	/**
+	 * Writes a signed number in decimal.
+	 */
+	static char* signedDecimal(char* out, int64_t value);
+
+private:
+	/** "000102...FF": The two hex digits of every byte value */
+	static const char HEX_DIGITS[513];
+
+	/** "000102...99": The two decimal digits of every number below 100 */
+	static const char DECIMAL_DIGITS[201];
+};
+
+#endif /* OUTPUTENCODING_HPP_ */
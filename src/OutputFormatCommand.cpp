@@ -17,8 +17,33 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <strings.h>
+
 #include "OutputFormatCommand.hpp"
 
-int OutputFormatCommand::execute(const char* parameters) {
+int OutputFormatCommand::execute(ClientConnection* client, const char* parameters) {
+
+	if (*parameters == '\0') {
+		client->respond("OF DEFAULT%s\n",
+				client->outputFormat == OutputFormatRegistry::DEFAULT_FORMAT ? " *" : "");
+
+		for (int i=0 ; i<this->registry->getCount() ; i++) {
+			client->respond("OF %d %s%s\n", i, this->registry->get(i)->getName(),
+					client->outputFormat == i ? " *" : "");
+		}
+		return 0;
+	}
+
+	if (strcasecmp(parameters, "DEFAULT") == 0) {
+		client->outputFormat = OutputFormatRegistry::DEFAULT_FORMAT;
+		return 0;
+	}
+
+	int format = this->registry->find(parameters);
+	if (format < 0) {
+		return -1;
+	}
+
+	client->outputFormat = format;
 	return 0;
 }
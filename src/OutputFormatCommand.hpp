@@ -21,15 +21,28 @@
 #define OUTPUTFORMATCOMMAND_HPP_
 
 #include "AbstractCommand.hpp"
+#include "OutputFormatRegistry.hpp"
 
+/**
+ * Selects the format used to write data frames to the client.
+ *
+ * "OF <format>" selects the format by number or name, "OF DEFAULT" the
+ * format preferred by the current data frame format. "OF" lists all
+ * formats, the current one marked by '*'.
+ */
 class OutputFormatCommand : public AbstractCommand {
+	OutputFormatRegistry* registry;
 
 public:
+	OutputFormatCommand(OutputFormatRegistry* registry) {
+		this->registry = registry;
+	}
+
 	const char* getToken() {
 		return "OF";
 	}
 
-	int execute(const char* parameters);
+	int execute(ClientConnection* client, const char* parameters);
 };
 
 
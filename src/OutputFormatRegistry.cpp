@@ -0,0 +1,53 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <strings.h>
+#include <assert.h>
+
+#include "OutputFormatRegistry.hpp"
+
+OutputFormatRegistry::OutputFormatRegistry() {
+	this->nformats = 0;
+}
+
+int OutputFormatRegistry::add(IOutputFormat* format) {
+	assert(this->nformats < MAX_FORMATS);
+	assert(this->find(format->getName()) < 0);
+
+	this->formats[this->nformats] = format;
+	return this->nformats++;
+}
+
+int OutputFormatRegistry::find(const char* name) {
+
+	char* end;
+	long index = strtol(name, &end, 10);
+	if (*name != '\0' && *end == '\0') {
+		return index >= 0 && index < this->nformats ? index : -1;
+	}
+
+	for (int i=0 ; i<this->nformats ; i++) {
+		if (strcasecmp(this->formats[i]->getName(), name) == 0) {
+			return i;
+		}
+	}
+
+	return -1;
+}
@@ -0,0 +1,62 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OUTPUTFORMATREGISTRY_HPP_
+#define OUTPUTFORMATREGISTRY_HPP_
+
+#include "IOutputFormat.hpp"
+
+/**
+ * The output formats clients can select. Output formats are numbered in
+ * the order they are added.
+ */
+class OutputFormatRegistry {
+
+public:
+	static const int MAX_FORMATS = 16;
+
+	/**
+	 * Selects the output format the current data frame format prefers,
+	 * see IDataFrame::getDefaultOutputFormat().
+	 */
+	static const int DEFAULT_FORMAT = -1;
+
+	OutputFormatRegistry();
+
+	/**
+	 * Adds an output format. Returns its number.
+	 */
+	int add(IOutputFormat* format);
+
+	/**
+	 * Returns the number of an output format, given by name or number,
+	 * or -1 if there is no such output format.
+	 */
+	int find(const char* name);
+
+	int getCount() { return this->nformats; };
+	IOutputFormat* get(int index) { return this->formats[index]; };
+
+private:
+	IOutputFormat* formats[MAX_FORMATS];
+	int nformats;
+};
+
+
+#endif /* OUTPUTFORMATREGISTRY_HPP_ */
@@ -0,0 +1,70 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <assert.h>
+
+#include "Log.hpp"
+
+#include "PipelineDataFrame.hpp"
+
+PipelineDataFrame::PipelineDataFrame(Protocol* protocol, DecoderPipeline* pipeline,
+		const char* name, uint8_t frameType, const char* defaultOutputFormat) : IDataFrame(protocol) {
+	this->pipeline = pipeline;
+	this->name = name;
+	this->frameType = frameType;
+	this->defaultOutputFormat = defaultOutputFormat;
+}
+
+int PipelineDataFrame::receive(FrameRecord& record) {
+
+	uint8_t bytes[MAX_RECEIVE_BYTES];
+	size_t nbytes;
+
+	int rc = this->protocol->receive(bytes, nbytes);
+	if (rc < 0) {
+		return -1;
+	}
+	assert(nbytes >= 2 && nbytes <= MAX_RECEIVE_BYTES);
+
+	record.rssi = bytes[nbytes-2];
+	record.lqi = bytes[nbytes-1] & 0x7F; // Strip off the CRC bit
+	record.frameType = this->frameType;
+	record.flags = FRAME_FLAG_RSSI_LQI;
+	record.srcAddress = 0;
+	record.destAddress = 0;
+
+	DecoderBuffer buffer;
+	buffer.data = bytes;
+	buffer.len = nbytes - 2; // Remove RSSI and LQI from buffer
+
+	if (this->pipeline->run(buffer, record) < 0) {
+		return -1;
+	}
+
+	LOG_INFO("%s received (length=%d RSSI=%ddBm LQI=0x%.2X)\n",
+			this->name, record.len, decodeRssi(record.rssi), record.lqi);
+
+	return 0;
+}
+
+int PipelineDataFrame::transmit(const FrameRecord& /* record */) {
+
+	return -1; // Receive-only format
+}
@@ -0,0 +1,83 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PIPELINEDATAFRAME_HPP_
+#define PIPELINEDATAFRAME_HPP_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "IDataFrame.hpp"
+#include "Protocol.hpp"
+#include "DecoderPipeline.hpp"
+
+/**
+ * Data frame whose bytes are decoded by a DecoderPipeline, so a new kind
+ * of device needs a pipeline configuration instead of a new class.
+ *
+ * RSSI and LQI appended by the protocol are taken off before the bytes
+ * are passed to the pipeline. Addresses are not known, unless a stage
+ * fills them in.
+ */
+class PipelineDataFrame : public IDataFrame {
+
+public:
+	/**
+	 * @param name Name printed for every data frame received.
+	 * @param frameType FRAME_TYPE_* of the records.
+	 * @param defaultOutputFormat See getDefaultOutputFormat().
+	 */
+	PipelineDataFrame(Protocol* protocol, DecoderPipeline* pipeline,
+			const char* name, uint8_t frameType, const char* defaultOutputFormat);
+
+	virtual ~PipelineDataFrame() {};
+
+	/**
+	 * Returns 0 if a data frame could be read from the RX FIFO and all
+	 * stages of the pipeline passed it.
+	 * Returns -1 on error.
+	 */
+	virtual int receive(FrameRecord& record);
+
+	/**
+	 * Decoder pipelines only work in one direction, so transmitting is
+	 * not supported.
+	 */
+	virtual int transmit(const FrameRecord& record);
+
+	virtual const char* getDefaultOutputFormat() {
+		return this->defaultOutputFormat;
+	}
+
+	DecoderPipeline* getPipeline() {
+		return this->pipeline;
+	}
+
+private:
+	/** Payload plus RSSI and LQI */
+	static const size_t MAX_RECEIVE_BYTES = FrameRecord::MAX_PAYLOAD_BYTES + 2;
+
+	DecoderPipeline* pipeline;
+	const char* name;
+	uint8_t frameType;
+	const char* defaultOutputFormat;
+};
+
+
+#endif /* PIPELINEDATAFRAME_HPP_ */
@@ -0,0 +1,66 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "Pn9Whitening.hpp"
+
+Pn9Whitening::Pn9Whitening() {
+
+	uint16_t state = 0x1FF;
+
+	for (size_t i=0 ; i<PERIOD + 8 ; i++) {
+		this->sequence[i] = state & 0xFF;
+
+		for (int bit=0 ; bit<8 ; bit++) {
+			uint16_t feedback = (state ^ (state >> 5)) & 0x01;
+			state = (state >> 1) | (feedback << 8);
+		}
+	}
+}
+
+void Pn9Whitening::apply(uint8_t *buffer, size_t len) {
+
+	size_t pos = 0;
+
+	while (len >= 8) {
+		uint64_t data;
+		uint64_t pn9;
+
+		memcpy(&data, buffer, 8);
+		memcpy(&pn9, this->sequence + pos, 8);
+		data ^= pn9;
+		memcpy(buffer, &data, 8);
+
+		buffer += 8;
+		len -= 8;
+		pos = (pos + 8) % PERIOD;
+	}
+
+	for (size_t i=0 ; i<len ; i++) {
+		buffer[i] ^= this->sequence[pos + i];
+	}
+}
+
+int Pn9Whitening::process(DecoderBuffer& buffer, FrameRecord& record) {
+
+	this->apply(buffer.data, buffer.len);
+
+	return 0;
+}
@@ -0,0 +1,66 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PN9WHITENING_HPP_
+#define PN9WHITENING_HPP_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "IDecoderStage.hpp"
+
+/**
+ * Data whitening with the PN9 sequence (x^9 + x^5 + 1, all bits 1 at the
+ * start), like the CC1101 does when PKTCTRL0.WHITE_DATA is set. Whitening
+ * and de-whitening are the same XOR operation.
+ *
+ * The sequence repeats after 511 bytes, so it is calculated once and
+ * applied to 8 bytes at a time.
+ *
+ * As decoder stage "pn9", de-whitens the bytes received in place, for
+ * whitened senders received without the CC1101's packet handling. Place
+ * it before the "crc" stage, the CRC is whitened as well.
+ */
+class Pn9Whitening : public IDecoderStage {
+
+public:
+	/** Length of the PN9 sequence in bytes */
+	static const size_t PERIOD = 511;
+
+	Pn9Whitening();
+
+	virtual const char* getName() {
+		return "pn9";
+	}
+
+	virtual int process(DecoderBuffer& buffer, FrameRecord& record);
+
+	/**
+	 * Whitens or de-whitens a buffer of bytes in place, starting at the
+	 * beginning of the sequence.
+	 */
+	void apply(uint8_t *buffer, size_t len);
+
+private:
+	/** The sequence, plus the start repeated so that words never wrap */
+	uint8_t sequence[PERIOD + 8];
+};
+
+
+#endif /* PN9WHITENING_HPP_ */
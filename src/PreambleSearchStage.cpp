@@ -0,0 +1,163 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <assert.h>
+
+#include "SerialBitstream.hpp"
+
+#include "PreambleSearchStage.hpp"
+
+PreambleSearchStage::PreambleSearchStage(const uint8_t* pattern, size_t len, int maxBitErrors) {
+	assert(len > 0 && len <= MAX_PATTERN_BYTES);
+	assert(maxBitErrors >= 0 && maxBitErrors <= PreambleSearchStage::maxBitErrors(len));
+
+	// The preamble as sent over the air
+	SerialBitstream bitstream;
+	uint8_t encoded[8];
+	size_t encodedLen;
+	bitstream.encode(pattern, len, encoded, encodedLen);
+
+	this->pattern = 0;
+	for (size_t i=0 ; i<encodedLen ; i++) {
+		this->pattern |= (uint64_t) encoded[i] << (56 - 8 * i);
+	}
+
+	this->patternBits = len * 10;
+	this->mask = ~0ULL << (64 - this->patternBits);
+	this->pattern &= this->mask;
+
+	this->maxErrors = maxBitErrors;
+	this->realigned = 0;
+
+	// The anchors are the first 8 bits of each part, parts are at least 8 bits long
+	this->nanchors = maxBitErrors + 1;
+	for (int i=0 ; i<this->nanchors ; i++) {
+		this->anchorOffset[i] = this->patternBits * i / this->nanchors;
+
+		uint8_t anchor = (this->pattern << this->anchorOffset[i]) >> 56;
+
+		for (int byte=0 ; byte<256 ; byte++) {
+			uint8_t high = 0;
+			uint8_t low = 0;
+
+			for (int shift=0 ; shift<8 ; shift++) {
+				// The anchor's first 8-shift bits are the last bits of the first byte
+				if ((byte & (0xFF >> shift)) == (anchor >> shift)) {
+					high |= 1 << shift;
+				}
+
+				// The anchor's last shift bits are the first bits of the next byte
+				if ((byte >> (8 - shift)) == (anchor & ((1 << shift) - 1))) {
+					low |= 1 << shift;
+				}
+			}
+
+			this->anchorHigh[i][byte] = high;
+			this->anchorLow[i][byte] = low;
+		}
+	}
+}
+
+int PreambleSearchStage::search(const uint8_t* bitstream, size_t len) {
+
+	int lastOffset = (int) (len * 8) - this->patternBits;
+	if (lastOffset < 0) {
+		return -1;
+	}
+
+	// Zeros after the end, so whole words can be read anywhere
+	uint8_t padded[FrameRecord::MAX_PAYLOAD_BYTES + 16];
+	assert(len <= (size_t) FrameRecord::MAX_PAYLOAD_BYTES);
+	memcpy(padded, bitstream, len);
+	memset(padded + len, 0, 16);
+
+	int maxAnchorOffset = this->anchorOffset[this->nanchors - 1];
+	int found = -1;
+
+	for (int pos=0 ; pos * 8 <= lastOffset + maxAnchorOffset ; pos++) {
+
+		// Anchors found later may belong to a preamble that starts earlier
+		if (found >= 0 && pos * 8 > found + maxAnchorOffset) {
+			break;
+		}
+
+		for (int i=0 ; i<this->nanchors ; i++) {
+			unsigned int shifts = this->anchorHigh[i][padded[pos]] & this->anchorLow[i][padded[pos + 1]];
+
+			while (shifts != 0) {
+				int offset = pos * 8 + __builtin_ctz(shifts) - this->anchorOffset[i];
+				shifts &= shifts - 1;
+
+				if (offset >= 0 && offset <= lastOffset && (found < 0 || offset < found)
+						&& this->matches(padded, offset)) {
+					found = offset;
+				}
+			}
+		}
+	}
+
+	return found;
+}
+
+int PreambleSearchStage::process(DecoderBuffer& buffer, FrameRecord& record) {
+
+	int offset = this->search(buffer.data, buffer.len);
+	if (offset < 0) {
+		return -1;
+	}
+
+	size_t skip = offset / 8;
+	int shift = offset % 8;
+
+	uint8_t* data = buffer.data;
+	size_t len = buffer.len;
+
+	if (shift == 0) {
+		buffer.data += skip;
+		buffer.len -= skip;
+	} else {
+		// Shift the bitstream in place, each byte is read before it is overwritten
+		size_t newLen = (len * 8 - offset) / 8;
+		for (size_t i=0 ; i<newLen ; i++) {
+			uint8_t next = skip + i + 1 < len ? data[skip + i + 1] : 0;
+			data[i] = (data[skip + i] << shift) | (next >> (8 - shift));
+		}
+		buffer.len = newLen;
+	}
+
+	// Correct bit errors in the preamble
+	bool corrected = false;
+	for (int i=0 ; i * 8 < this->patternBits ; i++) {
+		uint8_t patternByte = this->pattern >> (56 - 8 * i);
+		uint8_t maskByte = this->mask >> (56 - 8 * i);
+		uint8_t byte = (buffer.data[i] & ~maskByte) | patternByte;
+
+		if (byte != buffer.data[i]) {
+			buffer.data[i] = byte;
+			corrected = true;
+		}
+	}
+
+	if (offset > 0 || corrected) {
+		this->realigned++;
+	}
+
+	return 0;
+}
@@ -0,0 +1,131 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PREAMBLESEARCHSTAGE_HPP_
+#define PREAMBLESEARCHSTAGE_HPP_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "IDecoderStage.hpp"
+
+/**
+ * Decoder stage that finds the preamble of a serial bitstream at any bit
+ * offset, e.g. when the CC1101 synchronized one or two bits off, and shifts
+ * the bitstream so that the preamble starts at the first bit. Place it
+ * before the stages decoding the bitstream.
+ *
+ * The preamble is given as decoded bytes and searched for as it is sent:
+ * 10 bits per byte, including start and stop bits. Optionally, some bits
+ * of the preamble may be wrong; they are corrected, so the following
+ * stages see the exact preamble.
+ *
+ * With n bits wrong, at least one of n+1 parts of the preamble is right,
+ * so the search looks for the first 8 bits of each part (the anchors) at
+ * all 8 bit offsets of a byte with two table lookups. Only where an anchor
+ * is found, the whole preamble is compared as 64 bit word.
+ */
+class PreambleSearchStage : public IDecoderStage {
+
+public:
+	/** 6 bytes are 60 bits as sent, the most that fits into a 64 bit word */
+	static const size_t MAX_PATTERN_BYTES = 6;
+
+	/**
+	 * @param pattern Preamble, as decoded bytes.
+	 * @param len Length of the preamble.
+	 * @param maxBitErrors Number of bits of the preamble that may be wrong,
+	 *        at most maxBitErrors(len).
+	 */
+	PreambleSearchStage(const uint8_t* pattern, size_t len, int maxBitErrors);
+
+	/**
+	 * The number of bit errors allowed is limited by the number of anchors
+	 * that fit into the preamble.
+	 */
+	static int maxBitErrors(size_t len) {
+		return len * 10 / 8 - 1;
+	}
+
+	virtual const char* getName() {
+		return "align";
+	}
+
+	/**
+	 * Returns -1 if the preamble is not found.
+	 */
+	virtual int process(DecoderBuffer& buffer, FrameRecord& record);
+
+	/**
+	 * Finds the preamble in the bitstream.
+	 * Returns the bit offset of the first match, -1 if not found.
+	 */
+	int search(const uint8_t* bitstream, size_t len);
+
+	/**
+	 * Number of data frames whose preamble was not at the first bit or had
+	 * bit errors.
+	 */
+	uint64_t getRealigned() {
+		return this->realigned;
+	}
+
+private:
+	static const int MAX_ANCHORS = MAX_PATTERN_BYTES * 10 / 8;
+
+	/** Preamble as sent, left aligned */
+	uint64_t pattern;
+	uint64_t mask;
+	int patternBits;
+	int maxErrors;
+
+	/** Bit offset of each anchor in the preamble */
+	int anchorOffset[MAX_ANCHORS];
+	int nanchors;
+
+	/**
+	 * For a byte of the bitstream, the bit offsets (as bit mask) at which
+	 * the anchor may start: anchorHigh for the byte the anchor starts in,
+	 * anchorLow for the byte after it. The anchor starts where both agree.
+	 */
+	uint8_t anchorHigh[MAX_ANCHORS][256];
+	uint8_t anchorLow[MAX_ANCHORS][256];
+
+	uint64_t realigned;
+
+	/**
+	 * Returns true if the preamble is found at this bit offset.
+	 */
+	inline bool matches(const uint8_t* padded, int offset) {
+		const uint8_t* bytes = padded + offset / 8;
+
+		uint64_t word = 0;
+		for (int i=0 ; i<8 ; i++) {
+			word = (word << 8) | bytes[i];
+		}
+
+		int shift = offset % 8;
+		uint64_t window = (word << shift) | (bytes[8] >> (8 - shift));
+
+		return __builtin_popcountll((window ^ this->pattern) & this->mask) <= this->maxErrors;
+	}
+};
+
+
+#endif /* PREAMBLESEARCHSTAGE_HPP_ */
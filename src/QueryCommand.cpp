@@ -0,0 +1,118 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+
+#include "QueryCommand.hpp"
+
+/**
+ * Parses seconds since the epoch, with up to 9 decimal places, into ns.
+ * Returns a pointer behind the time, or NULL if there is no valid time.
+ */
+static const char* parseTime(const char* s, uint64_t& nanos) {
+
+	if (!isdigit((unsigned char) *s)) {
+		return NULL;
+	}
+
+	uint64_t seconds = 0;
+	int digits = 0;
+	while (isdigit((unsigned char) *s)) {
+		seconds = seconds * 10 + (*s++ - '0');
+		if (++digits > 11) {
+			return NULL;
+		}
+	}
+
+	uint64_t fraction = 0;
+	uint64_t scale = 1000000000ULL;
+	if (*s == '.') {
+		s++;
+		while (isdigit((unsigned char) *s)) {
+			if (scale == 1) {
+				return NULL;
+			}
+			scale /= 10;
+			fraction += (*s++ - '0') * scale;
+		}
+	}
+
+	nanos = seconds * 1000000000ULL + fraction;
+	return s;
+}
+
+int QueryCommand::execute(ClientConnection* client, const char* parameters) {
+
+	FrameStoreQuery& query = client->query;
+
+	if (query.isActive()) {
+		client->respond("QUEND %llu\n", (unsigned long long) query.getCount());
+		query.stop();
+	}
+
+	if (strcasecmp(parameters, "STOP") == 0) {
+		return 0;
+	}
+
+	int source = FrameStoreQuery::ANY_SOURCE;
+	const char* s = parameters;
+	if (*s == '*') {
+		s++;
+	} else {
+		char* end;
+		long address = strtol(s, &end, 16);
+		if (end == s || address < 0 || address > 0xFF) {
+			return -1;
+		}
+		source = address;
+		s = end;
+	}
+
+	if (*s != ' ') {
+		return -1;
+	}
+	while (*s == ' ') {
+		s++;
+	}
+
+	uint64_t from;
+	s = parseTime(s, from);
+	if (s == NULL) {
+		return -1;
+	}
+
+	uint64_t to = UINT64_MAX;
+	while (*s == ' ') {
+		s++;
+	}
+	if (*s != '\0') {
+		s = parseTime(s, to);
+		if (s == NULL || *s != '\0' || to < from) {
+			return -1;
+		}
+	}
+
+	query.start(this->store, source, from, to);
+	return 0;
+}
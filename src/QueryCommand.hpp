@@ -0,0 +1,55 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef QUERYCOMMAND_HPP_
+#define QUERYCOMMAND_HPP_
+
+#include "AbstractCommand.hpp"
+#include "FrameStore.hpp"
+
+/**
+ * Sends the data frames kept by the FrameStore to the client, in the
+ * client's output format.
+ *
+ * "QU <source> <from> [<to>]" with the source address in hex or '*' for
+ * any, and the time range in seconds since the epoch, e.g.
+ * "QU 0A 1792411194.5 1792414794". Without <to>, up to now. The data
+ * frames are streamed by the socket server after the "OK QU" line, as
+ * fast as the client reads them, followed by "QUEND <count>" (or
+ * "QUEND <count> ERROR"). Live data frames keep coming in between.
+ * "QU STOP" ends the query. A new query ends the one running.
+ */
+class QueryCommand : public AbstractCommand {
+	FrameStore* store;
+
+public:
+	QueryCommand(FrameStore* store) {
+		this->store = store;
+	}
+
+	const char* getToken() {
+		return "QU";
+	}
+
+	int execute(ClientConnection* client, const char* parameters);
+};
+
+
+#endif /* QUERYCOMMAND_HPP_ */
@@ -23,38 +23,12 @@
 #include <assert.h>
 
 #include "AddressSpace.hpp"
-#include "DateTime.hpp"
+#include "Log.hpp"
+#include "Metrics.hpp"
 
 #include "RFBeeDataFrame.hpp"
 
-
-static const int DEFAULT_OUTPUT_FORMAT = 4; // I prefer hex output
-
-/**
- * Decodes the RSSI value added by the CC1101 receiver.
- */
-static int RSSIDecode(uint8_t rssiEnc){
-	int rssi;
-
-	if (rssiEnc >= 128) {
-		rssi = (rssiEnc - 256) >> 1;
-	} else {
-		rssi = rssiEnc >> 1;
-	}
-
-	return rssi - 74;
-}
-
 RFBeeDataFrame::RFBeeDataFrame(Protocol* protocol) : IDataFrame(protocol) {
-
-	this->len = 0;
-	this->srcAddress = 0;
-	this->destAddress = 0;
-
-	this->rssi = 0;
-	this->lqi = 0;
-
-	this->outputFormat = DEFAULT_OUTPUT_FORMAT;
 }
 
 /**
@@ -64,10 +38,12 @@ RFBeeDataFrame::RFBeeDataFrame(Protocol* protocol) : IDataFrame(protocol) {
  * valid and not just random garbage. However, this may NOT be sufficient
  * in some cases.
  *
+ * Only frames with a correct CRC are passed on, so the CRC flag is always set.
+ *
  * Returns 0 if a data frame could be read from the RX FIFO.
- * Returns -1 on error.
+ * Returns CRC_ERROR if the CRC was wrong, -1 on other errors.
  */
-int RFBeeDataFrame::receive() {
+int RFBeeDataFrame::receive(FrameRecord& record) {
 
 	uint8_t tmp[MAX_PAYLOAD_BYTES + 4];
 	size_t nbytes;
@@ -76,116 +52,61 @@ int RFBeeDataFrame::receive() {
 
 	if (rc >= 0) {
 		size_t cnt = 0;
-		this->destAddress = tmp[cnt++];
-		this->srcAddress = tmp[cnt++];
+		record.destAddress = tmp[cnt++];
+		record.srcAddress = tmp[cnt++];
 
 		size_t payloadLength = nbytes - 4; // dstAddress, srcAddress, RSSI, LQI
-		memcpy(this->buffer, tmp + cnt, payloadLength);
+		memcpy(record.payload, tmp + cnt, payloadLength);
 		cnt += payloadLength;
-		this->len = payloadLength;
+		record.len = payloadLength;
 
-		this->rssi = tmp[cnt++];
-		this->lqi = tmp[cnt++];
+		record.rssi = tmp[cnt++];
+		uint8_t lqi = tmp[cnt++];
 
-		DateTime::print();
-		printf("RFBeeDataFrame received (length=%d destAddress=0x%.2X srcAddress=0x%.2X RSSI=%ddBm LQI=0x%.2X)\n",
-				nbytes, this->destAddress, this->srcAddress, RSSIDecode(this->rssi), this->lqi);
+		LOG_INFO("RFBeeDataFrame received (length=%d destAddress=0x%.2X srcAddress=0x%.2X RSSI=%ddBm LQI=0x%.2X)\n",
+				(int) nbytes, record.destAddress, record.srcAddress, decodeRssi(record.rssi), lqi);
 
 		assert(nbytes == cnt);
 
+		record.lqi = lqi & 0x7F; // Strip off the CRC bit
+		record.frameType = FRAME_TYPE_RFBEE;
+		record.flags = FRAME_FLAG_ADDRESS | FRAME_FLAG_RSSI_LQI;
+
 		// Checksum OK?
-		if ((this->lqi & 0x80) == 0) {
-			DateTime::print();
-			printf("Receiver detected CRC error.\n");
-			return -1; // CRC error in received data
+		if ((lqi & 0x80) == 0) {
+			Metrics::increment(Metrics::CRC_ERRORS);
+			LOG_WARN("Receiver detected CRC error.\n");
+			return CRC_ERROR; // The link quality statistics still count it
 		}
 
-		this->lqi = this->lqi & 0x7F; // Strip off the CRC bit
+		record.flags |= FRAME_FLAG_CRC_OK;
+
+		return 0;
 	}
 
-	return 0;
+	return -1;
 }
 
 /**
  * Writes the frame into the TX FIFO and makes the CC1101 transmit
  * the data by sending a STX strobe command.
  */
-int RFBeeDataFrame::transmit() {
-
-	return 0;
-}
-
-/**
- * Writes the contents of this data frame to a file descriptor.
- */
-void RFBeeDataFrame::writeToSocket(int fd) {
+int RFBeeDataFrame::transmit(const FrameRecord& record) {
 
-	assert(fd >= 0);
-
-	const size_t MAX_LINE_LENGTH = 768; // Not exact, but should be enough
-	char line[MAX_LINE_LENGTH];
-	char tmp[16];
+	if (record.len > MAX_TRANSMIT_PAYLOAD_BYTES) {
+		return -1;
+	}
 
+	uint8_t tmp[MAX_PAYLOAD_BYTES];
 	size_t cnt = 0;
 
-	switch(this->outputFormat) {
-
-	case 0 :
-		// 0: Payload only
-		write(fd, (void*) this->buffer, (size_t) this->len);
-		break;
-
-	case 1 :
-		// 1: source, dest, payload
-		line[cnt++] = this->srcAddress;
-		line[cnt++] = this->destAddress;
-		memcpy(line + cnt, this->buffer, this->len); cnt += this->len;
-		write(fd, line, cnt);
-
-		assert (cnt < MAX_LINE_LENGTH);
-		break;
-
-	case 2 :
-		// 2: payload len, source, dest, payload, rssi, lqi
-		line[cnt++] = this->len;
-		line[cnt++] = this->srcAddress;
-		line[cnt++] = this->destAddress;
-		memcpy(line + cnt, this->buffer, this->len); cnt += this->len;
-		line[cnt++] = this->rssi;
-		line[cnt++] = this->lqi;
-		write(fd, line, cnt);
-
-		assert (cnt < MAX_LINE_LENGTH);
-		break;
-
-	case 3 :
-		//  3: payload len (DEC), source (DEC), dest (DEC), payload, rssi (DEC), lqi (DEC) NL
-		snprintf(line, 128, "%d,%d,%d,", this->len, this->srcAddress, this->destAddress);
-		cnt = strlen(line);
-		memcpy(line + cnt, this->buffer, this->len); cnt += this->len;
-		line[cnt++] = '\0';
-		snprintf(tmp, 16, ",%d,%d\n", this->rssi, this->lqi);
-		strcat(line, tmp);
-		write(fd, line, strlen(line));
-
-		assert(strlen(line) < MAX_LINE_LENGTH);
-		break;
-
-	case 4:
-		//  payload len (HEX) source (HEX) dest (HEX) payload (HEX) rssi (HEX) lqi (HEX) NL
-		snprintf(line, 128, "%.2X %.2X %.2X ", this->len, this->srcAddress, this->destAddress);
-		for (int i = 0; i<this->len; i++) {
-			snprintf(tmp, 16, "%.2X", this->buffer[i]);
-			strcat(line, tmp);
-		}
-		snprintf(tmp, 16, " %.2X %.2X\n", this->rssi, this->lqi);
-		strcat(line, tmp);
+	tmp[cnt++] = record.destAddress;
+	tmp[cnt++] = record.srcAddress;
+	memcpy(tmp + cnt, record.payload, record.len);
+	cnt += record.len;
 
-		write(fd, line, strlen(line));
+	LOG_INFO("RFBeeDataFrame transmit (length=%d destAddress=0x%.2X srcAddress=0x%.2X)\n",
+			(int) cnt, record.destAddress, record.srcAddress);
 
-		assert(strlen(line) < MAX_LINE_LENGTH);
-		break;
-	}
+	return this->protocol->transmit(tmp, cnt);
 }
-
-
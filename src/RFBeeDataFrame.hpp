@@ -37,31 +37,15 @@
  * Byte n+1: RSSI (Received Signal Strength Indicator)
  * Byte n+2: LQI (Link Quality Indicator)
  *
- * Payload is limited to 255 bytes.
+ * Payload is limited to 255 bytes when receiving. When transmitting, the
+ * length byte counts the addresses as well, so the payload is limited to
+ * 253 bytes.
  */
 class RFBeeDataFrame : public IDataFrame {
 
 public:
 	static const int MAX_PAYLOAD_BYTES = 256;
-
-	uint8_t buffer[MAX_PAYLOAD_BYTES];
-	uint8_t len;
-
-	uint8_t srcAddress;
-	uint8_t destAddress;
-
-	/** Received Signal Strength Indicator */
-	uint8_t rssi;
-
-	/** Format used to write data frame to the socket */
-	int outputFormat;
-
-	/**
-	 * Link Quality Indicator. LQI is best used as a relative measurement
-	 * of the link quality (a low value indicates a better link than what a
-	 * high value does), since the value is dependent on the modulation format.
-	 */
-	uint8_t lqi;
+	static const int MAX_TRANSMIT_PAYLOAD_BYTES = 253;
 
 	RFBeeDataFrame(Protocol* protocol);
 
@@ -77,15 +61,13 @@ public:
 	 * Returns 0 if a data frame could be read from the RX FIFO.
 	 * Returns -1 on error.
 	 */
-	virtual int receive();
-
-	virtual int transmit();
+	virtual int receive(FrameRecord& record);
 
+	virtual int transmit(const FrameRecord& record);
 
-	/**
-	 * Writes the data frame to a file descriptor.
-	 */
-	virtual void writeToSocket(int fd);
+	virtual const char* getDefaultOutputFormat() {
+		return "hex";
+	}
 };
 
 
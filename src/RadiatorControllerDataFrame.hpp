@@ -20,51 +20,26 @@
 #ifndef RADIATORCONTROLLERDATAFRAME_HPP_
 #define RADIATORCONTROLLERDATAFRAME_HPP_
 
-#include <stdint.h>
-#include <stddef.h>
-
-#include "IDataFrame.hpp"
-#include "Protocol.hpp"
+#include "PipelineDataFrame.hpp"
 
 /**
- * Custom data frame that does conversions of the data.
+ * Data frames of HR80 radiator controllers, received in FIFO overflow mode.
  *
+ * The data is sent as serial bitstream including start and stop bits,
+ * starting with the preamble 0x33 0x55 0x53 and terminated by 0x35.
+ * In between is the Manchester encoded message. The preamble is searched
+ * at any bit offset, in case the receiver synchronized a few bits off.
+ * Controllers send every message several times, repeated copies are dropped.
  */
-class RadiatorControllerDataFrame : public IDataFrame {
+class RadiatorControllerDataFrame : public PipelineDataFrame {
 
 public:
-	static const int FIFO_LENGTH = 64;
-
-	uint8_t buffer[FIFO_LENGTH];
-	uint8_t len;
-
-	/** Received Signal Strength Indicator */
-	uint8_t rssi;
-
-	/**
-	 * Link Quality Indicator. LQI is best used as a relative measurement
-	 * of the link quality (a low value indicates a better link than what a
-	 * high value does), since the value is dependent on the modulation format.
-	 */
-	uint8_t lqi;
+	/** Configuration of the pipeline that decodes radiator controller data frames */
+	static const char* DEFAULT_PIPELINE;
 
-	RadiatorControllerDataFrame(Protocol* protocol);
+	RadiatorControllerDataFrame(Protocol* protocol, DecoderPipeline* pipeline);
 
 	virtual ~RadiatorControllerDataFrame() {};
-
-	/**
-	 * Returns 0 if a valid data frame could be read from the RX FIFO
-	 * and decoded successfully.
-	 * Returns -1 on error.
-	 */
-	virtual int receive();
-
-	virtual int transmit();
-
-	/**
-	 * Writes the data frame to a file descriptor.
-	 */
-	virtual void writeToSocket(int fd);
 };
 
 
@@ -0,0 +1,46 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RADIOPROFILE_HPP_
+#define RADIOPROFILE_HPP_
+
+#include "RegConfiguration.hpp"
+#include "IDataFrame.hpp"
+
+/**
+ * A register configuration together with the data frame format (and its
+ * protocol) that fits to it. The device can switch between profiles at
+ * runtime.
+ */
+class RadioProfile {
+
+public:
+	const char* name;
+	RegConfiguration* configuration;
+	IDataFrame* dataFrame;
+
+	RadioProfile(const char* name, RegConfiguration* configuration, IDataFrame* dataFrame) {
+		this->name = name;
+		this->configuration = configuration;
+		this->dataFrame = dataFrame;
+	}
+};
+
+
+#endif /* RADIOPROFILE_HPP_ */
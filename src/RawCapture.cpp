@@ -0,0 +1,290 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <assert.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/mman.h>
+
+#include "DateTime.hpp"
+#include "Log.hpp"
+#include "Metrics.hpp"
+
+#include "RawCapture.hpp"
+
+RawCapture::RawCapture(const char* prefix, size_t segmentBytes, int maxSegments) {
+	assert(segmentBytes >= sizeof(CaptureSegmentHeader) + captureRecordSize(CAPTURE_MAX_DATA_BYTES));
+
+	this->prefix = prefix;
+	this->segmentBytes = segmentBytes;
+	this->maxSegments = maxSegments;
+
+	this->device = NULL;
+
+	this->head = 0;
+	this->tail = 0;
+	this->sequence = 0;
+
+	this->running = false;
+
+	this->segment = NULL;
+	this->segmentNumber = 0;
+	this->started = 0;
+}
+
+RawCapture::~RawCapture() {
+	if (this->running) {
+		this->stop();
+	}
+}
+
+void RawCapture::start(Device* device) {
+	this->device = device;
+	this->started = DateTime::nanos(CLOCK_REALTIME);
+
+	if (openSegment() < 0) {
+		exit(1);
+	}
+
+	this->running = true;
+	if (pthread_create(&this->thread, NULL, RawCapture::run, this) != 0) {
+		perror("Starting capture thread");
+		exit(1);
+	}
+}
+
+void RawCapture::stop() {
+	this->running = false;
+	pthread_join(this->thread, NULL);
+
+	drain();
+	if (this->segment != NULL) {
+		closeSegment();
+	}
+}
+
+void RawCapture::formatName(uint32_t number, char* name, size_t maxBytes) {
+	time_t seconds = this->started / 1000000000ULL;
+	struct tm tm;
+	localtime_r(&seconds, &tm);
+
+	char startTime[32];
+	strftime(startTime, sizeof(startTime), "%Y%m%d-%H%M%S", &tm);
+
+	snprintf(name, maxBytes, "%s-%s-%04u.cap", this->prefix, startTime, number);
+}
+
+/**
+ * Creates and maps the next segment file, and removes the oldest one
+ * if there are too many.
+ * Returns 0 on success, -1 on error.
+ */
+int RawCapture::openSegment() {
+
+	char name[256];
+	formatName(this->segmentNumber, name, sizeof(name));
+
+	int fd = ::open(name, O_CREAT | O_TRUNC | O_RDWR, 0644);
+	if (fd < 0) {
+		LOG_ERROR("Creating capture segment %s: %s\n", name, strerror(errno));
+		return -1;
+	}
+
+	// Allocate the blocks now, so writing a record never waits for the
+	// file system to find space
+	int rc = posix_fallocate(fd, 0, this->segmentBytes);
+	if (rc != 0) {
+		LOG_ERROR("Allocating capture segment %s: %s\n", name, strerror(rc));
+		::close(fd);
+		return -1;
+	}
+
+	void* addr = mmap(NULL, this->segmentBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (addr == MAP_FAILED) {
+		LOG_ERROR("Mapping capture segment %s: %s\n", name, strerror(errno));
+		::close(fd);
+		return -1;
+	}
+
+	// The mapping stays valid after closing the file descriptor.
+	::close(fd);
+
+	CaptureSegmentHeader* header = (CaptureSegmentHeader*) addr;
+	memset(header, 0, sizeof(CaptureSegmentHeader));
+	header->version = CAPTURE_VERSION;
+	header->headerSize = sizeof(CaptureSegmentHeader);
+	header->segment = this->segmentNumber;
+	header->size = this->segmentBytes;
+	header->used = sizeof(CaptureSegmentHeader);
+	header->started = this->started;
+
+	int nprofiles = this->device->getProfileCount();
+	for (int i=0 ; i<nprofiles && i<CAPTURE_MAX_PROFILES ; i++) {
+		strncpy(header->profiles[i], this->device->getProfile(i)->name, CAPTURE_PROFILE_NAME_BYTES - 1);
+		header->profileCount++;
+	}
+
+	__atomic_store_n(&header->magic, CAPTURE_MAGIC, __ATOMIC_RELEASE);
+
+	this->segment = header;
+
+	LOG_INFO("Capturing to %s (size=%u)\n", name, (unsigned int) this->segmentBytes);
+
+	if (this->maxSegments > 0 && this->segmentNumber >= (uint32_t) this->maxSegments) {
+		formatName(this->segmentNumber - this->maxSegments, name, sizeof(name));
+		if (unlink(name) < 0) {
+			LOG_WARN("Removing capture segment %s: %s\n", name, strerror(errno));
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Unmaps the segment and gives back the space not used.
+ */
+void RawCapture::closeSegment() {
+
+	size_t used = this->segment->used;
+	this->segment->size = used;
+
+	if (munmap(this->segment, this->segmentBytes) < 0) {
+		perror("Unmapping capture segment");
+		exit(1);
+	}
+
+	char name[256];
+	formatName(this->segmentNumber, name, sizeof(name));
+	if (truncate(name, used) < 0) {
+		LOG_WARN("Truncating capture segment %s: %s\n", name, strerror(errno));
+	}
+
+	this->segment = NULL;
+	this->segmentNumber++;
+}
+
+/**
+ * Copies the bytes into the ring. No system calls, no locks.
+ */
+void RawCapture::capture(const uint8_t* bytes, size_t nbytes) {
+
+	uint32_t sequence = this->sequence++;
+
+	uint64_t head = this->head;
+	if (head - __atomic_load_n(&this->tail, __ATOMIC_ACQUIRE) >= (uint64_t) RING_ENTRIES) {
+		Metrics::increment(Metrics::CAPTURE_DROPS);
+		return;
+	}
+
+	Entry& entry = this->ring[head % RING_ENTRIES];
+	CaptureRecordHeader& header = entry.header;
+
+	size_t len = nbytes >= 2 ? nbytes - 2 : 0;
+	if (len > CAPTURE_MAX_DATA_BYTES) {
+		len = CAPTURE_MAX_DATA_BYTES;
+	}
+
+	header.recordSize = captureRecordSize(len);
+	header.len = len;
+	header.rssi = nbytes >= 2 ? bytes[nbytes - 2] : 0;
+	header.lqi = nbytes >= 2 ? bytes[nbytes - 1] : 0;
+	header.reserved = 0;
+	header.sequence = sequence;
+	header.reserved2 = 0;
+	header.timestamp = DateTime::nanos(CLOCK_REALTIME);
+	header.monotonic = DateTime::nanos(CLOCK_MONOTONIC);
+
+	header.profile = 0;
+	RadioProfile* profile = this->device->getCurrentProfile();
+	for (int i=0 ; i<this->device->getProfileCount() ; i++) {
+		if (this->device->getProfile(i) == profile) {
+			header.profile = i;
+			break;
+		}
+	}
+
+	memcpy(entry.data, bytes, len);
+
+	__atomic_store_n(&this->head, head + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Appends the record to the segment, starting the next segment if it
+ * doesn't fit.
+ */
+void RawCapture::write(const Entry& entry) {
+
+	if (this->segment != NULL && this->segment->used + entry.header.recordSize > this->segmentBytes) {
+		closeSegment();
+		if (openSegment() < 0) {
+			LOG_ERROR("Capture stopped\n");
+		}
+	}
+
+	if (this->segment == NULL) {
+		Metrics::increment(Metrics::CAPTURE_DROPS);
+		return;
+	}
+
+	size_t used = this->segment->used;
+
+	uint8_t* record = (uint8_t*) this->segment + used;
+	memcpy(record, &entry.header, sizeof(CaptureRecordHeader));
+	memcpy(record + sizeof(CaptureRecordHeader), entry.data, entry.header.len);
+
+	// Readers of the file see the record once it is complete
+	__atomic_store_n(&this->segment->used, used + entry.header.recordSize, __ATOMIC_RELEASE);
+}
+
+/**
+ * Writes the records waiting. Returns true if there were any.
+ */
+bool RawCapture::drain() {
+
+	uint64_t head = __atomic_load_n(&this->head, __ATOMIC_ACQUIRE);
+	uint64_t tail = this->tail;
+	if (tail == head) {
+		return false;
+	}
+
+	while (tail < head) {
+		write(this->ring[tail % RING_ENTRIES]);
+		tail++;
+		__atomic_store_n(&this->tail, tail, __ATOMIC_RELEASE);
+	}
+
+	return true;
+}
+
+void* RawCapture::run(void* arg) {
+	RawCapture* capture = (RawCapture*) arg;
+
+	while (capture->running) {
+		if (!capture->drain()) {
+			usleep(5000);
+		}
+	}
+
+	return NULL;
+}
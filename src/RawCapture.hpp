@@ -0,0 +1,111 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RAWCAPTURE_HPP_
+#define RAWCAPTURE_HPP_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+
+#include "CaptureFileLayout.hpp"
+#include "Device.hpp"
+
+/**
+ * Records the bytes of every receive call of a protocol, before they are
+ * decoded, into segment files (see CaptureFileLayout.hpp), so decode
+ * failures seen in the field can be reproduced later. The protocols are
+ * wrapped by a CapturingProtocol.
+ *
+ * The receiving thread only copies the bytes into a ring; a background
+ * thread writes them into the segment file, which is preallocated and
+ * memory mapped. When a segment is full, the next one is started; only
+ * the newest maxSegments are kept.
+ *
+ * If the ring is full, records are dropped instead of waiting (see the
+ * sequence numbers and Metrics::CAPTURE_DROPS).
+ */
+class RawCapture {
+
+public:
+	static const int RING_ENTRIES = 1024;
+
+	static const size_t DEFAULT_SEGMENT_BYTES = 16 * 1024 * 1024;
+
+	/**
+	 * @param prefix Path and start of the file names, e.g. "/var/log/cc1101".
+	 *        Segments are named <prefix>-<start time>-<number>.cap.
+	 * @param segmentBytes Size of a segment file.
+	 * @param maxSegments Number of segment files kept, 0 for all.
+	 */
+	RawCapture(const char* prefix, size_t segmentBytes, int maxSegments);
+	~RawCapture();
+
+	/**
+	 * Creates the first segment and starts the background thread.
+	 * The profile names of the device are written into each segment.
+	 */
+	void start(Device* device);
+
+	/**
+	 * Writes the records waiting and closes the segment.
+	 */
+	void stop();
+
+	/**
+	 * Called by the receiving thread with the bytes a protocol returned,
+	 * RSSI and LQI last.
+	 */
+	void capture(const uint8_t* bytes, size_t nbytes);
+
+private:
+	struct Entry {
+		CaptureRecordHeader header;
+		uint8_t data[CAPTURE_MAX_DATA_BYTES];
+	};
+
+	const char* prefix;
+	size_t segmentBytes;
+	int maxSegments;
+
+	Device* device;
+
+	/** Single producer, single consumer ring */
+	Entry ring[RING_ENTRIES];
+	uint64_t head;
+	uint64_t tail;
+	uint32_t sequence;
+
+	volatile bool running;
+	pthread_t thread;
+
+	/** Segment being written, mapped */
+	CaptureSegmentHeader* segment;
+	uint32_t segmentNumber;
+	uint64_t started;
+
+	int openSegment();
+	void closeSegment();
+	void formatName(uint32_t number, char* name, size_t maxBytes);
+	void write(const Entry& entry);
+	bool drain();
+	static void* run(void* arg);
+};
+
+#endif /* RAWCAPTURE_HPP_ */
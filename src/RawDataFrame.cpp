@@ -23,19 +23,18 @@
 #include <assert.h>
 
 #include "AddressSpace.hpp"
-#include "DateTime.hpp"
+#include "Log.hpp"
 
 #include "RawDataFrame.hpp"
 
 RawDataFrame::RawDataFrame(Protocol* protocol) : IDataFrame(protocol) {
-	this->len = 0;
 }
 
 /**
  * Returns 0 if a data frame could be read from the RX FIFO.
  * Returns -1 on error.
  */
-int RawDataFrame::receive() {
+int RawDataFrame::receive(FrameRecord& record) {
 
 	uint8_t tmp[MAX_PAYLOAD_BYTES + 4];
 	size_t nbytes;
@@ -43,49 +42,36 @@ int RawDataFrame::receive() {
 	int rc = this->protocol->receive(tmp, nbytes);
 	if (rc >= 0) {
 		size_t payloadLength = nbytes - 2; // - 2 for RSSI, LQI
-		memcpy(this->buffer, tmp, payloadLength);
-		this->len = payloadLength;
+		memcpy(record.payload, tmp, payloadLength);
+		record.len = payloadLength;
 
-		DateTime::print();
-		printf("RawDataFrame received (length=%d)\n", nbytes);
-	}
+		record.rssi = tmp[nbytes-2];
+		record.lqi = tmp[nbytes-1] & 0x7F; // Strip off the CRC bit
 
-	return 0;
-}
+		record.frameType = FRAME_TYPE_RAW;
+		record.flags = FRAME_FLAG_RSSI_LQI;
+		record.srcAddress = 0;
+		record.destAddress = 0;
 
-/**
- * Writes the frame into the TX FIFO and makes the CC1101 transmit
- * the data by sending a STX strobe command.
- */
-int RawDataFrame::transmit() {
+		LOG_INFO("RawDataFrame received (length=%d)\n", (int) nbytes);
+
+		return 0;
+	}
 
-	return 0;
+	return -1;
 }
 
 /**
- * Writes the contents of this data frame to a file descriptor.
+ * Writes the frame into the TX FIFO and makes the CC1101 transmit
+ * the data by sending a STX strobe command. Addresses are ignored.
  */
-void RawDataFrame::writeToSocket(int fd) {
-
-	assert(fd >= 0);
-
-	const size_t MAX_LINE_LENGTH = 768; // Not exact, but should be enough
-	char line[MAX_LINE_LENGTH];
-	char tmp[16];
+int RawDataFrame::transmit(const FrameRecord& record) {
 
-	line[0] = '\0';
-
-	//  payload (HEX) NL
-	for (size_t i = 0; i<this->len; i++) {
-		snprintf(tmp, 16, "%.2X", this->buffer[i]);
-		strcat(line, tmp);
+	if (record.len == 0 || record.len > MAX_TRANSMIT_PAYLOAD_BYTES) {
+		return -1;
 	}
-	snprintf(tmp, 16, "\n");
-	strcat(line, tmp);
 
-	write(fd, line, strlen(line));
+	LOG_INFO("RawDataFrame transmit (length=%d)\n", record.len);
 
-	assert(strlen(line) < MAX_LINE_LENGTH);
+	return this->protocol->transmit(record.payload, record.len);
 }
-
-
@@ -35,9 +35,7 @@ class RawDataFrame : public IDataFrame {
 
 public:
 	static const int MAX_PAYLOAD_BYTES = 256;
-
-	uint8_t buffer[MAX_PAYLOAD_BYTES];
-	uint8_t len;
+	static const int MAX_TRANSMIT_PAYLOAD_BYTES = 255;
 
 	RawDataFrame(Protocol* protocol);
 
@@ -47,14 +45,13 @@ public:
 	 * Returns 0 if a data frame could be read from the RX FIFO.
 	 * Returns -1 on error.
 	 */
-	virtual int receive();
+	virtual int receive(FrameRecord& record);
 
-	virtual int transmit();
+	virtual int transmit(const FrameRecord& record);
 
-	/**
-	 * Writes the data frame to a file descriptor.
-	 */
-	virtual void writeToSocket(int fd);
+	virtual const char* getDefaultOutputFormat() {
+		return "raw";
+	}
 };
 
 
@@ -0,0 +1,110 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+
+#include "DateTime.hpp"
+#include "Log.hpp"
+
+#include "ReceiveLatency.hpp"
+
+static const char* STAGE_NAMES[] = { "wakeup", "drain", "decode", "write", "total" };
+
+LatencyHistogram ReceiveLatency::histograms[ReceiveLatency::STAGES];
+
+int ReceiveLatency::lastPoint = -1;
+uint64_t ReceiveLatency::lastNanos = 0;
+uint64_t ReceiveLatency::edgeNanos = 0;
+
+volatile sig_atomic_t ReceiveLatency::dumpRequested = 0;
+
+void ReceiveLatency::mark(int point) {
+	uint64_t now = DateTime::nanos(CLOCK_MONOTONIC);
+
+	if (point == LATENCY_EDGE) {
+		ReceiveLatency::edgeNanos = now;
+	} else if (point == ReceiveLatency::lastPoint + 1) {
+		// Stage n lies between point n and n + 1
+		ReceiveLatency::histograms[point - 1].record(now - ReceiveLatency::lastNanos);
+
+		if (point == LATENCY_WRITTEN) {
+			ReceiveLatency::histograms[STAGE_TOTAL].record(now - ReceiveLatency::edgeNanos);
+		}
+	} else {
+		// A point was skipped, e.g. the data frame was dropped before
+		// and this is the next one. Wait for the next edge.
+		point = -1;
+	}
+
+	ReceiveLatency::lastPoint = point;
+	ReceiveLatency::lastNanos = now;
+}
+
+const char* ReceiveLatency::getStageName(int stage) {
+	return STAGE_NAMES[stage];
+}
+
+LatencyHistogram& ReceiveLatency::getHistogram(int stage) {
+	return ReceiveLatency::histograms[stage];
+}
+
+void ReceiveLatency::reset() {
+	for (int i=0 ; i<STAGES ; i++) {
+		ReceiveLatency::histograms[i].reset();
+	}
+}
+
+void ReceiveLatency::dump() {
+	for (int i=0 ; i<STAGES ; i++) {
+		LatencyHistogram& histogram = ReceiveLatency::histograms[i];
+
+		LOG_INFO("Latency %s count=%llu min=%llu p50=%llu p90=%llu p99=%llu p999=%llu max=%llu ns\n",
+				STAGE_NAMES[i],
+				(unsigned long long) histogram.getCount(),
+				(unsigned long long) histogram.getMin(),
+				(unsigned long long) histogram.getPercentile(50.0),
+				(unsigned long long) histogram.getPercentile(90.0),
+				(unsigned long long) histogram.getPercentile(99.0),
+				(unsigned long long) histogram.getPercentile(99.9),
+				(unsigned long long) histogram.getMax());
+	}
+}
+
+void ReceiveLatency::handleSignal(int signum) {
+	ReceiveLatency::dumpRequested = 1;
+}
+
+void ReceiveLatency::dumpOnSignal(int signum) {
+	struct sigaction action;
+	memset(&action, 0, sizeof(action));
+	action.sa_handler = ReceiveLatency::handleSignal;
+	sigemptyset(&action.sa_mask);
+
+	// Restart system calls like read() and write(); poll() is interrupted
+	// anyway, so the receiving thread wakes up to dump.
+	action.sa_flags = SA_RESTART;
+
+	if (sigaction(signum, &action, NULL) < 0) {
+		perror("Installing signal handler");
+		exit(1);
+	}
+}
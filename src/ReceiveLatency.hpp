@@ -0,0 +1,100 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RECEIVELATENCY_HPP_
+#define RECEIVELATENCY_HPP_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <signal.h>
+
+#include "LatencyHistogram.hpp"
+
+/** Points of the receive path a data frame passes, in this order */
+#define LATENCY_EDGE      0 // Woken up by the GDO2 pin
+#define LATENCY_FIFO_READ 1 // First byte read from the RX FIFO
+#define LATENCY_DRAINED   2 // Last byte read from the RX FIFO
+#define LATENCY_DECODED   3 // Data frame decoded
+#define LATENCY_WRITTEN   4 // Written to the clients
+
+/**
+ * Measures where the time goes between the GDO2 pin waking up the driver
+ * and the data frame being written to the sockets.
+ *
+ * The receive path calls mark() at each point. The time between two
+ * consecutive points goes into the histogram of the stage in between, the
+ * time from LATENCY_EDGE to LATENCY_WRITTEN into the "total" histogram.
+ * Data frames that are dropped on the way don't reach the later stages.
+ *
+ * A mark is a read of the monotonic clock and an increment, so this is
+ * always on. Marks are made by the receiving thread only.
+ */
+class ReceiveLatency {
+
+public:
+	static const int STAGE_WAKEUP = 0; // Edge to first FIFO read
+	static const int STAGE_DRAIN = 1;  // Reading the RX FIFO
+	static const int STAGE_DECODE = 2; // Decoding the data frame
+	static const int STAGE_WRITE = 3;  // Publishing to the sinks and writing to the sockets
+	static const int STAGE_TOTAL = 4;
+	static const int STAGES = 5;
+
+	static void mark(int point);
+
+	static const char* getStageName(int stage);
+	static LatencyHistogram& getHistogram(int stage);
+
+	static void reset();
+
+	/**
+	 * Logs one line per stage: count, min, p50, p90, p99, p99.9 and max in ns.
+	 */
+	static void dump();
+
+	/**
+	 * Dumps the histograms to the log when the process receives this
+	 * signal, e.g. SIGUSR1. The signal handler only sets a flag, the
+	 * histograms are logged by dumpIfRequested().
+	 */
+	static void dumpOnSignal(int signum);
+
+	/**
+	 * Called by the receiving thread when it was woken up.
+	 */
+	static void dumpIfRequested() {
+		if (ReceiveLatency::dumpRequested) {
+			ReceiveLatency::dumpRequested = 0;
+			ReceiveLatency::dump();
+		}
+	};
+
+private:
+	static LatencyHistogram histograms[STAGES];
+
+	/** Last point passed and when (CLOCK_MONOTONIC, ns) */
+	static int lastPoint;
+	static uint64_t lastNanos;
+	static uint64_t edgeNanos;
+
+	static volatile sig_atomic_t dumpRequested;
+
+	static void handleSignal(int signum);
+};
+
+#endif /* RECEIVELATENCY_HPP_ */
@@ -0,0 +1,49 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REGISTERPROFILECOMMAND_HPP_
+#define REGISTERPROFILECOMMAND_HPP_
+
+#include "AbstractCommand.hpp"
+#include "Device.hpp"
+
+/**
+ * Switches to another register configuration and data frame format
+ * without restarting the driver.
+ *
+ * "RP <name>" selects the profile, "RP" lists all profiles. The current
+ * profile is marked with a '*'. Affects all clients.
+ */
+class RegisterProfileCommand : public AbstractCommand {
+	Device* device;
+
+public:
+	RegisterProfileCommand(Device* device) {
+		this->device = device;
+	}
+
+	const char* getToken() {
+		return "RP";
+	}
+
+	int execute(ClientConnection* client, const char* parameters);
+};
+
+
+#endif /* REGISTERPROFILECOMMAND_HPP_ */
@@ -0,0 +1,359 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+
+#include "DateTime.hpp"
+#include "Log.hpp"
+#include "ReplayProtocol.hpp"
+#include "RFBeeDataFrame.hpp"
+#include "RawDataFrame.hpp"
+#include "RadiatorControllerDataFrame.hpp"
+#include "DecoderPipeline.hpp"
+
+#include "Replay.hpp"
+
+Replay::Replay(IOutputFormat* format, const char* profile, const char* pipeline, int threads, bool paced) {
+	this->format = format;
+	this->profile = profile;
+	this->pipeline = pipeline;
+	this->threads = threads;
+	this->paced = paced;
+
+	this->segments = NULL;
+	this->nsegments = 0;
+	this->next = 0;
+	this->written = 0;
+
+	pthread_mutex_init(&this->mutex, NULL);
+	pthread_cond_init(&this->decodedCondition, NULL);
+	pthread_cond_init(&this->writtenCondition, NULL);
+
+	this->firstCaptured = 0;
+	this->firstReplayed = 0;
+}
+
+Replay::~Replay() {
+	delete[] this->segments;
+
+	pthread_cond_destroy(&this->writtenCondition);
+	pthread_cond_destroy(&this->decodedCondition);
+	pthread_mutex_destroy(&this->mutex);
+}
+
+/**
+ * Returns the DATA_FRAME_* the driver uses for a profile, or -1 if there
+ * is no such profile.
+ */
+int Replay::findDataFrame(const char* profile) {
+
+	if (strcmp(profile, "rfbee") == 0 || strcmp(profile, "rfbee26") == 0) {
+		return DATA_FRAME_RFBEE;
+	} else if (strcmp(profile, "raw") == 0) {
+		return DATA_FRAME_RAW;
+	} else if (strcmp(profile, "radiator") == 0) {
+		return DATA_FRAME_RADIATOR;
+	}
+
+	return -1;
+}
+
+int Replay::run(char* const files[], int nfiles) {
+
+	if (this->profile != NULL && findDataFrame(this->profile) < 0) {
+		LOG_ERROR("Unknown profile %s\n", this->profile);
+		return -1;
+	}
+
+	DecoderPipeline pipeline;
+	if (pipeline.configure(this->pipeline) < 0) {
+		return -1;
+	}
+
+	this->segments = new Segment[nfiles];
+	this->nsegments = nfiles;
+	for (int i=0 ; i<nfiles ; i++) {
+		Segment& segment = this->segments[i];
+		memset(&segment, 0, sizeof(Segment));
+		segment.name = files[i];
+	}
+
+	// Pacing needs the records in order
+	if (this->paced || this->threads < 1) {
+		this->threads = 1;
+	}
+	if (this->threads > nfiles) {
+		this->threads = nfiles;
+	}
+	if (this->threads > MAX_THREADS) {
+		this->threads = MAX_THREADS;
+	}
+	int nthreads = this->threads;
+
+	uint64_t started = DateTime::nanos(CLOCK_MONOTONIC);
+
+	pthread_t workers[MAX_THREADS];
+	for (int i=0 ; i<nthreads ; i++) {
+		if (pthread_create(&workers[i], NULL, Replay::worker, this) != 0) {
+			perror("Starting replay thread");
+			exit(1);
+		}
+	}
+
+	// Write the segments in order, as they are decoded
+	uint64_t records = 0;
+	uint64_t decoded = 0;
+	uint64_t lost = 0;
+	int failed = 0;
+
+	for (int i=0 ; i<nfiles ; i++) {
+		Segment& segment = this->segments[i];
+
+		pthread_mutex_lock(&this->mutex);
+		while (!segment.done) {
+			pthread_cond_wait(&this->decodedCondition, &this->mutex);
+		}
+		pthread_mutex_unlock(&this->mutex);
+
+		writeOutput(segment);
+		free(segment.output);
+		segment.output = NULL;
+
+		records += segment.records;
+		decoded += segment.decoded;
+		lost += segment.lost;
+		if (segment.failed) {
+			failed++;
+		}
+
+		pthread_mutex_lock(&this->mutex);
+		this->written = i + 1;
+		pthread_cond_broadcast(&this->writtenCondition);
+		pthread_mutex_unlock(&this->mutex);
+	}
+
+	for (int i=0 ; i<nthreads ; i++) {
+		pthread_join(workers[i], NULL);
+	}
+
+	uint64_t elapsed = DateTime::nanos(CLOCK_MONOTONIC) - started;
+
+	fprintf(stderr, "Replayed %d segments with %d threads in %.3f s: %llu records (%.0f/s), "
+			"%llu decoded, %llu not decoded, %llu lost while capturing\n",
+			nfiles - failed, nthreads, elapsed / 1e9, (unsigned long long) records,
+			elapsed > 0 ? records * 1e9 / elapsed : 0.0, (unsigned long long) decoded,
+			(unsigned long long) (records - decoded), (unsigned long long) lost);
+
+	if (failed > 0) {
+		LOG_ERROR("%d segments could not be read completely\n", failed);
+		return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * Decodes the records of a segment into its output.
+ */
+void Replay::decode(Segment& segment) {
+
+	CaptureReader reader;
+	if (reader.open(segment.name) < 0) {
+		segment.failed = true;
+		return;
+	}
+
+	// Fresh data frames for each segment, as stages may keep state
+	// (e.g. the duplicate filter)
+	ReplayProtocol protocol;
+	DecoderPipeline pipeline;
+	pipeline.configure(this->pipeline);
+
+	RFBeeDataFrame rfBeeDataFrame(&protocol);
+	RawDataFrame rawDataFrame(&protocol);
+	RadiatorControllerDataFrame radiatorControllerDataFrame(&protocol, &pipeline);
+
+	IDataFrame* kinds[DATA_FRAMES];
+	kinds[DATA_FRAME_RFBEE] = &rfBeeDataFrame;
+	kinds[DATA_FRAME_RAW] = &rawDataFrame;
+	kinds[DATA_FRAME_RADIATOR] = &radiatorControllerDataFrame;
+
+	// Records of profiles the driver doesn't know any more are not decoded
+	IDataFrame* dataFrames[CAPTURE_MAX_PROFILES];
+	for (int i=0 ; i<CAPTURE_MAX_PROFILES ; i++) {
+		const char* name = this->profile != NULL ? this->profile : reader.getProfileName(i);
+		int kind = name != NULL ? findDataFrame(name) : -1;
+		dataFrames[i] = kind >= 0 ? kinds[kind] : NULL;
+	}
+
+	FrameRecord record;
+	char line[IOutputFormat::MAX_LINE_BYTES];
+	bool first = true;
+	uint32_t nextSequence = 0;
+
+	const CaptureRecordHeader* captured;
+	while ((captured = reader.next()) != NULL) {
+		segment.records++;
+
+		if (!first && captured->sequence != nextSequence) {
+			segment.lost += captured->sequence - nextSequence;
+		}
+		nextSequence = captured->sequence + 1;
+		first = false;
+
+		if (this->paced) {
+			pace(captured);
+		}
+
+		IDataFrame* dataFrame = captured->profile < CAPTURE_MAX_PROFILES ? dataFrames[captured->profile] : NULL;
+		if (dataFrame == NULL) {
+			continue;
+		}
+
+		// The decoder stages see the capture times, as they saw the live ones
+		record.sequence = captured->sequence;
+		record.timestamp = captured->timestamp;
+		record.monotonic = captured->monotonic;
+
+		protocol.setRecord(captured);
+		if (dataFrame->receive(record) < 0) {
+			continue;
+		}
+
+		segment.decoded++;
+
+		size_t len = this->format->format(record, line, sizeof(line));
+		append(segment, line, len);
+
+		if (this->paced) {
+			writeOutput(segment);
+		}
+	}
+
+	if (reader.isCorrupt()) {
+		LOG_ERROR("%s: Invalid record after %llu records\n", segment.name,
+				(unsigned long long) segment.records);
+		segment.failed = true;
+	}
+}
+
+/**
+ * Waits until the time passed since the first record is the time that
+ * passed when it was captured.
+ */
+void Replay::pace(const CaptureRecordHeader* record) {
+
+	if (this->firstReplayed == 0) {
+		this->firstCaptured = record->monotonic;
+		this->firstReplayed = DateTime::nanos(CLOCK_MONOTONIC);
+		return;
+	}
+
+	if (record->monotonic <= this->firstCaptured) {
+		return;
+	}
+
+	uint64_t due = this->firstReplayed + (record->monotonic - this->firstCaptured);
+
+	struct timespec ts;
+	ts.tv_sec = due / 1000000000ULL;
+	ts.tv_nsec = due % 1000000000ULL;
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+	}
+}
+
+void Replay::append(Segment& segment, const char* data, size_t len) {
+
+	if (segment.len + len > segment.capacity) {
+		size_t capacity = segment.capacity > 0 ? segment.capacity * 2 : 64 * 1024;
+		while (capacity < segment.len + len) {
+			capacity *= 2;
+		}
+
+		segment.output = (char*) realloc(segment.output, capacity);
+		if (segment.output == NULL) {
+			perror("Allocating replay output");
+			exit(1);
+		}
+		segment.capacity = capacity;
+	}
+
+	memcpy(segment.output + segment.len, data, len);
+	segment.len += len;
+}
+
+void Replay::writeOutput(Segment& segment) {
+
+	size_t written = 0;
+	while (written < segment.len) {
+		ssize_t rc = ::write(1, segment.output + written, segment.len - written);
+		if (rc < 0 && errno == EINTR) {
+			continue;
+		}
+		if (rc < 0 && errno == EPIPE) {
+			exit(1); // The reader went away, e.g. head
+		}
+		if (rc <= 0) {
+			perror("Writing replay output");
+			exit(1);
+		}
+		written += rc;
+	}
+
+	segment.len = 0;
+}
+
+/**
+ * Replay thread: Decodes the next segment, but not too far ahead of the
+ * segments written.
+ */
+void* Replay::worker(void* arg) {
+	Replay* replay = (Replay*) arg;
+
+	while (true) {
+		pthread_mutex_lock(&replay->mutex);
+
+		int index = replay->next;
+		if (index >= replay->nsegments) {
+			pthread_mutex_unlock(&replay->mutex);
+			return NULL;
+		}
+		replay->next++;
+
+		while (index >= replay->written + SEGMENTS_AHEAD * replay->threads) {
+			pthread_cond_wait(&replay->writtenCondition, &replay->mutex);
+		}
+
+		pthread_mutex_unlock(&replay->mutex);
+
+		Segment& segment = replay->segments[index];
+		replay->decode(segment);
+
+		pthread_mutex_lock(&replay->mutex);
+		segment.done = true;
+		pthread_cond_broadcast(&replay->decodedCondition);
+		pthread_mutex_unlock(&replay->mutex);
+	}
+}
@@ -0,0 +1,131 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef REPLAY_HPP_
+#define REPLAY_HPP_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+
+#include "IDataFrame.hpp"
+#include "IOutputFormat.hpp"
+#include "CaptureReader.hpp"
+
+/**
+ * Decodes segment files written by RawCapture with the data frames of the
+ * driver and writes the records to stdout in an output format, without
+ * the RF module. After fixing a decoder, the captures can be decoded
+ * again; and decoders can be measured with the data received in the field.
+ *
+ * As fast as possible, segments are decoded by several threads. Each
+ * segment is decoded by its own data frames and decoder pipeline, so the
+ * output is the same no matter how many threads there are, and it is
+ * written in the order the segments were given. Optionally, records are
+ * written at the pace they were received instead.
+ *
+ * Records keep the sequence number and timestamps of the capture. Records
+ * that don't decode are counted, as data frames not passed on by the
+ * driver.
+ */
+class Replay {
+
+public:
+	static const int MAX_THREADS = 8;
+
+	/**
+	 * @param format Output format the records are written in.
+	 * @param profile Decodes every record with the data frame of this
+	 *        profile instead of the one active when it was captured, or NULL.
+	 * @param pipeline Configuration of the radiator decoder pipeline,
+	 *        see DecoderPipeline::configure().
+	 * @param threads Segments decoded at the same time.
+	 * @param paced Writes the records at the pace they were received.
+	 */
+	Replay(IOutputFormat* format, const char* profile, const char* pipeline, int threads, bool paced);
+	~Replay();
+
+	/**
+	 * Replays the segment files in this order and writes a summary to
+	 * stderr.
+	 *
+	 * Returns 0 on success, -1 if the profile or pipeline is not valid or
+	 * a segment could not be read completely.
+	 */
+	int run(char* const files[], int nfiles);
+
+private:
+	/** Decoded segments waiting to be written, per thread */
+	static const int SEGMENTS_AHEAD = 2;
+
+	struct Segment {
+		const char* name;
+
+		/** Rendered records not written yet */
+		char* output;
+		size_t len;
+		size_t capacity;
+
+		uint64_t records;
+		uint64_t decoded;
+		uint64_t lost;
+		bool failed;
+
+		bool done;
+	};
+
+	IOutputFormat* format;
+	const char* profile;
+	const char* pipeline;
+	int threads;
+	bool paced;
+
+	Segment* segments;
+	int nsegments;
+
+	/** Next segment to decode, and number of segments written */
+	int next;
+	int written;
+
+	pthread_mutex_t mutex;
+	pthread_cond_t decodedCondition;
+	pthread_cond_t writtenCondition;
+
+	/** Pacing: Time of the first record, captured and replayed (CLOCK_MONOTONIC, ns) */
+	uint64_t firstCaptured;
+	uint64_t firstReplayed;
+
+	/** Data frames of the driver, see Main */
+	static const int DATA_FRAME_RFBEE = 0;
+	static const int DATA_FRAME_RAW = 1;
+	static const int DATA_FRAME_RADIATOR = 2;
+	static const int DATA_FRAMES = 3;
+
+	static int findDataFrame(const char* profile);
+
+	void decode(Segment& segment);
+	void pace(const CaptureRecordHeader* record);
+	void append(Segment& segment, const char* data, size_t len);
+	void writeOutput(Segment& segment);
+
+	static void* worker(void* arg);
+};
+
+#endif /* REPLAY_HPP_ */
@@ -0,0 +1,66 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef REPLAYPROTOCOL_HPP_
+#define REPLAYPROTOCOL_HPP_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "Protocol.hpp"
+#include "CaptureFileLayout.hpp"
+
+/**
+ * Protocol that receives the bytes of a captured record instead of
+ * reading the RX FIFO, so data frames decode captures exactly as they
+ * decoded the bytes received. There is no SPI or GPIO involved.
+ */
+class ReplayProtocol : public Protocol {
+
+public:
+	ReplayProtocol();
+
+	/**
+	 * Sets the record the next receive() returns. The record must stay
+	 * valid until then.
+	 */
+	void setRecord(const CaptureRecordHeader* record) {
+		this->record = record;
+	}
+
+	/**
+	 * Copies the bytes of the record, with RSSI and LQI appended as the
+	 * CC1101 does. The record is returned only once.
+	 *
+	 * Returns 0 on success, -1 if there is no record.
+	 */
+	virtual int receive(uint8_t buffer[], size_t& nbytes);
+
+	/**
+	 * There is no radio to transmit with, so this always fails.
+	 */
+	virtual int transmit(const uint8_t buffer[], size_t nbytes);
+
+private:
+	const CaptureRecordHeader* record;
+};
+
+
+#endif /* REPLAYPROTOCOL_HPP_ */
@@ -0,0 +1,154 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Log.hpp"
+
+#include "SenderTable.hpp"
+
+SenderTable::SenderTable() {
+	memset(this->keys, 0, sizeof(this->keys));
+	memset(this->used, 0, sizeof(this->used));
+	this->evicted = 0;
+}
+
+/**
+ * Fibonacci hashing, the upper bits of the product are well mixed.
+ */
+int SenderTable::hash(uint32_t deviceId) {
+	return (deviceId * 2654435761U) >> 24;
+}
+
+/**
+ * Returns false if the data frame has no device address.
+ */
+bool SenderTable::getDeviceId(const FrameRecord& record, uint32_t& deviceId) {
+
+	if (record.frameType != FRAME_TYPE_RADIATORCONTROLLER
+			|| record.len < DEVICE_ID_OFFSET + DEVICE_ID_BYTES) {
+		return false;
+	}
+
+	const uint8_t* id = record.payload + DEVICE_ID_OFFSET;
+	deviceId = (id[0] << 16) | (id[1] << 8) | id[2];
+	return true;
+}
+
+int SenderTable::lookup(const FrameRecord& record, bool& assigned) {
+
+	assigned = false;
+
+	if ((record.flags & FRAME_FLAG_ADDRESS) != 0) {
+		int slot = record.srcAddress;
+		if (!this->used[slot]) {
+			this->used[slot] = true;
+			assigned = true;
+		}
+		return slot;
+	}
+
+	uint32_t deviceId;
+	if (!getDeviceId(record, deviceId)) {
+		return NO_SLOT;
+	}
+
+	int home = hash(deviceId);
+	for (int i=0 ; i<ADDRESSES ; i++) {
+		int n = (home + i) % ADDRESSES;
+		if (!this->used[ADDRESSES + n]) {
+			this->used[ADDRESSES + n] = true;
+			this->keys[n] = deviceId;
+			assigned = true;
+			return ADDRESSES + n;
+		}
+		if (this->keys[n] == deviceId) {
+			return ADDRESSES + n;
+		}
+	}
+
+	// More devices than slots, the one in the home slot is forgotten
+	if (this->evicted++ == 0) {
+		LOG_WARN("More than %d radiator devices, statistics are forgotten\n", ADDRESSES);
+	}
+	this->keys[home] = deviceId;
+	assigned = true;
+	return ADDRESSES + home;
+}
+
+int SenderTable::find(const FrameRecord& record) {
+
+	if ((record.flags & FRAME_FLAG_ADDRESS) != 0) {
+		return this->used[record.srcAddress] ? (int) record.srcAddress : NO_SLOT;
+	}
+
+	uint32_t deviceId;
+	if (!getDeviceId(record, deviceId)) {
+		return NO_SLOT;
+	}
+
+	return findDevice(deviceId);
+}
+
+int SenderTable::findDevice(uint32_t deviceId) {
+
+	int home = hash(deviceId);
+	for (int i=0 ; i<ADDRESSES ; i++) {
+		int n = (home + i) % ADDRESSES;
+		if (!this->used[ADDRESSES + n]) {
+			return NO_SLOT;
+		}
+		if (this->keys[n] == deviceId) {
+			return ADDRESSES + n;
+		}
+	}
+
+	return NO_SLOT;
+}
+
+int SenderTable::findName(const char* name) {
+
+	char* end;
+	unsigned long address = strtoul(name, &end, 16);
+	if (*end != '\0' || *name == '-' || *name == '+' || *name == ' ') {
+		return NO_SLOT;
+	}
+
+	size_t digits = end - name;
+	if (digits >= 1 && digits <= 2) {
+		return this->used[address] ? (int) address : NO_SLOT;
+	}
+
+	if (digits == 2 * DEVICE_ID_BYTES) {
+		return findDevice(address);
+	}
+
+	return NO_SLOT;
+}
+
+void SenderTable::formatName(int slot, char name[NAME_LENGTH]) {
+	if (slot < ADDRESSES) {
+		snprintf(name, NAME_LENGTH, "%02X", slot);
+	} else {
+		snprintf(name, NAME_LENGTH, "%06X", this->keys[slot - ADDRESSES]);
+	}
+}
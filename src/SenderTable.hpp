@@ -0,0 +1,102 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef SENDERTABLE_HPP_
+#define SENDERTABLE_HPP_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "FrameRecord.hpp"
+
+/**
+ * Assigns a slot to every sender of data frames, so statistics can be
+ * kept per sender in plain arrays.
+ *
+ * Data frames with addresses get the slot of their source address.
+ * Radiator controller data frames have no address field; they are told
+ * apart by the address of the sending device in the message, placed in
+ * the upper half of the slots by a hash with linear probing. Other data
+ * frames, e.g. raw ones, have no sender.
+ */
+class SenderTable {
+
+public:
+	/** Slots for source addresses, then the same number for devices */
+	static const int ADDRESSES = 256;
+	static const int SLOTS = 2 * ADDRESSES;
+
+	static const int NO_SLOT = -1;
+
+	/** HR80 messages start with a header byte, followed by the 3 byte address of the sender */
+	static const int DEVICE_ID_OFFSET = 1;
+	static const int DEVICE_ID_BYTES = 3;
+
+	/** Characters of the name of a slot, see formatName() */
+	static const size_t NAME_LENGTH = 2 * DEVICE_ID_BYTES + 1;
+
+	SenderTable();
+
+	/**
+	 * Returns the slot of the sender of a data frame, or NO_SLOT if it
+	 * has none. assigned is set if the slot was given to this sender just
+	 * now, i.e. whatever is kept in the slot belongs to another sender.
+	 * With more devices than slots, the slot of another device is reused.
+	 */
+	int lookup(const FrameRecord& record, bool& assigned);
+
+	/**
+	 * Returns the slot of the sender of a data frame, or NO_SLOT if it has
+	 * none or nothing was received from it before. No slot is assigned.
+	 */
+	int find(const FrameRecord& record);
+
+	/**
+	 * Returns the slot of a sender named as by formatName(), i.e. a source
+	 * address with 2 hex digits or a device address with 6, or NO_SLOT if
+	 * nothing was received from it.
+	 */
+	int findName(const char* name);
+
+	/**
+	 * Returns true if a sender has the slot.
+	 */
+	bool isUsed(int slot) { return this->used[slot]; };
+
+	/**
+	 * Writes the address of the sender in the slot in hex: 2 digits for a
+	 * source address, 6 for a device address.
+	 */
+	void formatName(int slot, char name[NAME_LENGTH]);
+
+private:
+	/** Device addresses of the upper half */
+	uint32_t keys[ADDRESSES];
+	bool used[SLOTS];
+
+	/** Devices that had to take the slot of another one */
+	uint64_t evicted;
+
+	static int hash(uint32_t deviceId);
+	static bool getDeviceId(const FrameRecord& record, uint32_t& deviceId);
+	int findDevice(uint32_t deviceId);
+};
+
+#endif /* SENDERTABLE_HPP_ */
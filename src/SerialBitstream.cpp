@@ -29,52 +29,71 @@ using namespace std;
 #include "SerialBitstream.hpp"
 
 
+// Table for reversing the bit order of a byte
+const uint8_t SerialBitstream::reverseTab[256] = {
+		0x00, 0x80, 0x40, 0xC0, 0x20, 0xA0, 0x60, 0xE0, 0x10, 0x90, 0x50, 0xD0, 0x30, 0xB0, 0x70, 0xF0,
+		0x08, 0x88, 0x48, 0xC8, 0x28, 0xA8, 0x68, 0xE8, 0x18, 0x98, 0x58, 0xD8, 0x38, 0xB8, 0x78, 0xF8,
+		0x04, 0x84, 0x44, 0xC4, 0x24, 0xA4, 0x64, 0xE4, 0x14, 0x94, 0x54, 0xD4, 0x34, 0xB4, 0x74, 0xF4,
+		0x0C, 0x8C, 0x4C, 0xCC, 0x2C, 0xAC, 0x6C, 0xEC, 0x1C, 0x9C, 0x5C, 0xDC, 0x3C, 0xBC, 0x7C, 0xFC,
+		0x02, 0x82, 0x42, 0xC2, 0x22, 0xA2, 0x62, 0xE2, 0x12, 0x92, 0x52, 0xD2, 0x32, 0xB2, 0x72, 0xF2,
+		0x0A, 0x8A, 0x4A, 0xCA, 0x2A, 0xAA, 0x6A, 0xEA, 0x1A, 0x9A, 0x5A, 0xDA, 0x3A, 0xBA, 0x7A, 0xFA,
+		0x06, 0x86, 0x46, 0xC6, 0x26, 0xA6, 0x66, 0xE6, 0x16, 0x96, 0x56, 0xD6, 0x36, 0xB6, 0x76, 0xF6,
+		0x0E, 0x8E, 0x4E, 0xCE, 0x2E, 0xAE, 0x6E, 0xEE, 0x1E, 0x9E, 0x5E, 0xDE, 0x3E, 0xBE, 0x7E, 0xFE,
+		0x01, 0x81, 0x41, 0xC1, 0x21, 0xA1, 0x61, 0xE1, 0x11, 0x91, 0x51, 0xD1, 0x31, 0xB1, 0x71, 0xF1,
+		0x09, 0x89, 0x49, 0xC9, 0x29, 0xA9, 0x69, 0xE9, 0x19, 0x99, 0x59, 0xD9, 0x39, 0xB9, 0x79, 0xF9,
+		0x05, 0x85, 0x45, 0xC5, 0x25, 0xA5, 0x65, 0xE5, 0x15, 0x95, 0x55, 0xD5, 0x35, 0xB5, 0x75, 0xF5,
+		0x0D, 0x8D, 0x4D, 0xCD, 0x2D, 0xAD, 0x6D, 0xED, 0x1D, 0x9D, 0x5D, 0xDD, 0x3D, 0xBD, 0x7D, 0xFD,
+		0x03, 0x83, 0x43, 0xC3, 0x23, 0xA3, 0x63, 0xE3, 0x13, 0x93, 0x53, 0xD3, 0x33, 0xB3, 0x73, 0xF3,
+		0x0B, 0x8B, 0x4B, 0xCB, 0x2B, 0xAB, 0x6B, 0xEB, 0x1B, 0x9B, 0x5B, 0xDB, 0x3B, 0xBB, 0x7B, 0xFB,
+		0x07, 0x87, 0x47, 0xC7, 0x27, 0xA7, 0x67, 0xE7, 0x17, 0x97, 0x57, 0xD7, 0x37, 0xB7, 0x77, 0xF7,
+		0x0F, 0x8F, 0x4F, 0xCF, 0x2F, 0xAF, 0x6F, 0xEF, 0x1F, 0x9F, 0x5F, 0xDF, 0x3F, 0xBF, 0x7F, 0xFF
+};
+
 SerialBitstream::SerialBitstream() {
 }
 
-
-void SerialBitstream::decode(uint8_t *inputBuffer, size_t inputBufferLen, uint8_t *outputBuffer, size_t& outputBufferLen) {
+int SerialBitstream::decode(const uint8_t *inputBuffer, size_t inputBufferLen, uint8_t *outputBuffer, size_t& outputBufferLen) {
 
 	// Remove the start- and stop-bits in the bitstream
 	// #0123456 7##01234 567##012 34567##0 1234567# (# -> Start/Stop bit)
 	// is decoded to:
 	// 76543210 76543210 76543210 76543210
+	//
+	// 5 bytes hold exactly 4 characters, so the bitstream is decoded in
+	// blocks of 5 bytes. A block is read completely before the decoded
+	// bytes are written, so decoding in place is possible.
 
-	int src_bytepos;
-	int src_bitpos;
+	size_t nchars = inputBufferLen * 8 / 10;
+	size_t nblocks = nchars / 4;
 
-	int dest_bytepos;
-	int dest_bitpos;
+	int errors = 0;
 
-	int j = 0;
-	for (int i=0 ; i < (inputBufferLen * 8) ; i++) {
+	for (size_t i=0 ; i<nblocks ; i++) {
+		errors += decodeBlock(inputBuffer + i * 5, 5, outputBuffer + i * 4, 4);
+	}
 
-		if (i % 10 == 0) {
-			// Start bit. Ignore.
-		}
-		else if ((i - 9) % 10 == 0) {
-			// Stop bit. Ignore.
-		}
-		else {
-			src_bytepos = i / 8;
-			src_bitpos = i % 8;
-
-			dest_bytepos = j / 8;
-			dest_bitpos = j % 8;
-
-			uint8_t mask = 1 << (7 - src_bitpos);
-			if ((inputBuffer[src_bytepos] & mask) > 0) {
-				outputBuffer[dest_bytepos] |= 1 << dest_bitpos;
-			}
-			else {
-				outputBuffer[dest_bytepos] &= ~(1 << dest_bitpos);
-			}
-
-			j++;
-		}
+	// Characters in the last, incomplete block. Bits after the last
+	// complete character are ignored.
+	size_t remaining = nchars - nblocks * 4;
+	if (remaining > 0) {
+		errors += decodeBlock(inputBuffer + nblocks * 5, inputBufferLen - nblocks * 5,
+				outputBuffer + nblocks * 4, remaining);
 	}
 
-	outputBufferLen = (j / 8) + 1;
+	outputBufferLen = nchars;
+
+	return errors;
+}
+
+int SerialBitstream::process(DecoderBuffer& buffer, FrameRecord& record) {
+
+	// Framing errors are expected after the end of the data frame, as the
+	// whole RX FIFO is decoded. Later stages check what they need.
+	size_t len;
+	decode(buffer.data, buffer.len, buffer.data, len);
+	buffer.len = len;
+
+	return 0;
 }
 
 /**
@@ -86,66 +105,33 @@ void SerialBitstream::decode(uint8_t *inputBuffer, size_t inputBufferLen, uint8_
  * @param outputBuffer Points to the encoded data.
  * @param outputBufferLen Number of bytes of encoded data.
  */
-void SerialBitstream::encode(uint8_t *inputBuffer, size_t inputBufferLen, uint8_t *outputBuffer, size_t& outputBufferLen) {
+void SerialBitstream::encode(const uint8_t *inputBuffer, size_t inputBufferLen, uint8_t *outputBuffer, size_t& outputBufferLen) {
 
 	// Adds a start and stop bit and reverses the bit order.
 	// 76543210 76543210 76543210 76543210
 	// is encoded to:
 	// #0123456 7##01234 567##012 34567##0 1234567# (# -> Start/Stop bit)
 
-	//bitstream.show(inputBuffer, inputBufferLen);
-
-	int bytepos;
-	int bitpos;
-
-	int j = 0;
-	for (int i=0 ; i < (inputBufferLen * 8) ; i++) {
-
-		if (j % 10 == 0) {
-			// Insert start bit (0)
-			bytepos = j / 8;
-			bitpos = j % 8;
+	uint32_t bits = 0; // Bits not written yet, the oldest one is the most significant
+	int nbits = 0;
+	size_t j = 0;
 
-			outputBuffer[bytepos] &= ~(1 << (7 - bitpos));
-			j++;
-		}
-
-		bytepos = i / 8;
-		bitpos = i % 8;
-
-		uint8_t mask = 1 << bitpos;
-		if ((inputBuffer[bytepos] & mask) > 0) {
-
-			bytepos = j / 8;
-			bitpos = 7 - (j % 8);
-
-			outputBuffer[bytepos] |= 1 << bitpos;
-
-		} else {
-
-			bytepos = j / 8;
-			bitpos = 7 - (j % 8);
+	for (size_t i=0 ; i<inputBufferLen ; i++) {
+		bits = (bits << 10) | (reverseTab[inputBuffer[i]] << 1) | 0x001;
+		nbits += 10;
 
-			outputBuffer[bytepos] &= ~(1 << bitpos);
-		}
-
-		j++;
-
-		if ((j - 9) % 10 == 0) {
-			// Insert stop bit (1)
-			bytepos = j / 8;
-			bitpos = j % 8;
-
-			outputBuffer[bytepos] |= 1 << (7 - bitpos);
-			j++;
+		while (nbits >= 8) {
+			nbits -= 8;
+			outputBuffer[j++] = bits >> nbits;
 		}
 	}
 
+	if (nbits > 0) {
+		// Fill up the last byte with stop bits, the line is idle now
+		outputBuffer[j++] = (bits << (8 - nbits)) | ((1 << (8 - nbits)) - 1);
+	}
 
-	outputBufferLen = (j / 8) + 1;
-
-	//bitstream.show(outputBuffer, *outputBufferLen);
-
+	outputBufferLen = j;
 }
 
 void SerialBitstream::show(uint8_t* buffer, size_t len)
@@ -24,42 +24,97 @@
 //#define DEBUG_SHOW_BINARY
 
 #include <stdint.h>
+#include <stddef.h>
+
+#include "IDecoderStage.hpp"
 
 /**
  * Assumes that the output of a serial communication stream/line, including start- and stop-bits
  * is send over the air. The order of the bits in the bytes has also to be reversed as the data
  * is mapped to a buffer of bytes.
+ *
+ * As decoder stage "bitstream", decodes the bytes received in place.
  */
-class SerialBitstream {
+class SerialBitstream : public IDecoderStage {
 
 public:
 	SerialBitstream();
 
+	virtual const char* getName() {
+		return "bitstream";
+	}
+
+	virtual int process(DecoderBuffer& buffer, FrameRecord& record);
+
 	/**
 	 * From a serial bitstream, removes the start- and stop-bits from the bit stream and reverses
 	 * the bit order. The result is a buffer of bytes.
+	 * Every 10 bits of input are a character, bits after the last complete character are ignored.
 	 * The caller is responsible to provide a buffer for the resulting decoded bytes
-	 * that is big enough (at least 4/5 as big as the input buffer)
+	 * that is big enough (at least 4/5 as big as the input buffer).
+	 * The output buffer may be the same as the input buffer.
 	 *
 	 * @param inputBuffer Buffer of undecoded bytes.
 	 * @param inputBufferLen Length of the buffer of undecoded bytes.
 	 * @param outputBuffer Resulting buffer of decoded bytes.
 	 * @param outputBufferLen Length of the resulting buffer of decoded bytes.
+	 *
+	 * @return Number of characters with framing error, i.e. start bit not 0 or stop bit not 1.
 	 */
-	void decode(uint8_t *inputBuffer, size_t inputBufferLen, uint8_t *outputBuffer, size_t& outputBufferLen);
+	int decode(const uint8_t *inputBuffer, size_t inputBufferLen, uint8_t *outputBuffer, size_t& outputBufferLen);
 
 	/**
 	 * From a buffer of bytes, reverses the bit order of the input buffer and adds a start bit
 	 * before and a stop bit after each byte. The result is a serial bitstream.
+	 * The last byte is filled up with 1 bits.
 	 * The caller is responsible to provide a buffer for the resulting encoded bytes
-	 * that is big enough (at least 5/4 as big as the input buffer).
+	 * that is big enough (at least 5/4 as big as the input buffer, rounded up).
 	 *
 	 * @param inputBuffer Buffer of unencoded bytes.
 	 * @param inputBufferLen Length of the buffer of unencoded bytes.
 	 * @param outputBuffer Resulting buffer of encoded bytes.
 	 * @param outputBufferLen Length of resulting buffer of encoded bytes.
 	 */
-	void encode(uint8_t *inputBuffer, size_t inputBufferLen, uint8_t *outputBuffer, size_t& outputBufferLen);
+	void encode(const uint8_t *inputBuffer, size_t inputBufferLen, uint8_t *outputBuffer, size_t& outputBufferLen);
+
+	/**
+	 * Decodes up to 4 characters from a block of up to 5 bytes. For decoders
+	 * that process the characters as they are decoded.
+	 *
+	 * @param block Bytes of the bitstream, the first byte starts with a start bit.
+	 * @param nbytes Number of bytes in the block, at most 5.
+	 * @param outputBuffer Resulting decoded bytes.
+	 * @param nchars Number of characters to decode, at most 4 and fitting into nbytes.
+	 *
+	 * @return Number of characters with framing error.
+	 */
+	static inline int decodeBlock(const uint8_t *block, size_t nbytes, uint8_t *outputBuffer, size_t nchars) {
+
+		// The first bit received is bit 39
+		uint64_t bits = 0;
+		if (nbytes == 5) {
+			bits = ((uint64_t) block[0] << 32) | ((uint32_t) block[1] << 24)
+					| ((uint32_t) block[2] << 16) | ((uint32_t) block[3] << 8) | block[4];
+		} else {
+			for (size_t i=0 ; i<nbytes ; i++) {
+				bits |= (uint64_t) block[i] << (32 - 8 * i);
+			}
+		}
+
+		int errors = 0;
+		for (size_t k=0 ; k<nchars ; k++) {
+			// Start bit, 8 data bits (least significant bit first), stop bit
+			unsigned int character = (bits >> (30 - 10 * k)) & 0x3FF;
+
+			outputBuffer[k] = reverseTab[(character >> 1) & 0xFF];
+
+			if ((character & 0x201) != 0x001) {
+				errors++;
+			}
+		}
+
+		return errors;
+	}
 
 	/**
 	 * Prints the specified buffer.
@@ -68,6 +123,10 @@ public:
 	 * @param len Length of this buffer.
 	 */
 	void show(uint8_t* buffer, size_t len);
+
+private:
+	/** Table for reversing the bit order of a byte */
+	static const uint8_t reverseTab[256];
 };
 
 #endif /* SERIAL_BITSTREAM_H_ */
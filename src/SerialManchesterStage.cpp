@@ -0,0 +1,158 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include "Log.hpp"
+
+#include "SerialManchesterStage.hpp"
+
+SerialManchesterStage::SerialManchesterStage(const uint8_t* sync, size_t syncLen, uint8_t marker, bool verify) {
+	assert(syncLen > 0 && syncLen <= SyncStage::MAX_PATTERN_BYTES);
+
+	memcpy(this->sync, sync, syncLen);
+	this->syncLen = syncLen;
+	this->marker = marker;
+	this->mismatches = 0;
+
+	this->nreference = 0;
+	if (verify) {
+		this->reference[this->nreference++] = new SerialBitstream();
+		this->reference[this->nreference++] = new SyncStage(sync, syncLen);
+		this->reference[this->nreference++] = new EndMarkerStage(marker);
+		this->reference[this->nreference++] = new Manchester();
+	}
+}
+
+SerialManchesterStage::~SerialManchesterStage() {
+	for (int i=0 ; i<this->nreference ; i++) {
+		delete this->reference[i];
+	}
+}
+
+/**
+ * Decodes the bitstream into payload. Returns 0 on success, -1 if the data
+ * frame is rejected.
+ */
+int SerialManchesterStage::decode(const DecoderBuffer& buffer, uint8_t* payload, size_t& len) {
+
+	size_t nchars = buffer.len * 8 / 10;
+
+	uint8_t header[SyncStage::MAX_PATTERN_BYTES];
+	uint8_t pair[2];
+	size_t count = 0; // Characters between preamble and end marker
+	uint8_t errors = 0;
+
+	for (size_t k=0 ; k<nchars ; k+=4) {
+		uint8_t chars[4];
+		size_t n = nchars - k < 4 ? nchars - k : 4;
+		size_t offset = k / 4 * 5;
+
+		SerialBitstream::decodeBlock(buffer.data + offset, buffer.len - offset < 5 ? buffer.len - offset : 5, chars, n);
+
+		for (size_t i=0 ; i<n ; i++) {
+			size_t index = k + i;
+
+			if (index < this->syncLen) {
+				header[index] = chars[i];
+
+				if (index == this->syncLen - 1 && memcmp(header, this->sync, this->syncLen) != 0) {
+					SyncStage::logUnknownHeader(header, this->syncLen);
+					return -1;
+				}
+				continue;
+			}
+
+			if (chars[i] == this->marker) {
+				// A trailing odd character is ignored, like Manchester::decode() does
+				len = count / 2;
+				return len > 0 && errors == 0 ? 0 : -1;
+			}
+
+			pair[count & 1] = chars[i];
+			if (count & 1) {
+				errors |= Manchester::decodePair(pair, payload + count / 2);
+			}
+			count++;
+		}
+	}
+
+	if (nchars < this->syncLen) {
+		SyncStage::logUnknownHeader(header, nchars);
+		return -1;
+	}
+
+	LOG_WARN("ERROR: Cannot find message end marker.\n");
+	return -1;
+}
+
+int SerialManchesterStage::process(DecoderBuffer& buffer, FrameRecord& record) {
+
+	// At most 4 characters per 5 bytes, half of them decoded
+	assert(buffer.len * 2 / 5 <= (size_t) FrameRecord::MAX_PAYLOAD_BYTES);
+
+	size_t len = 0;
+	int rc = this->decode(buffer, record.payload, len);
+
+	if (this->nreference > 0) {
+		this->verify(buffer, record, rc, len);
+	}
+
+	if (rc < 0) {
+		return -1;
+	}
+
+	// The result is in its final place already
+	buffer.data = record.payload;
+	buffer.len = len;
+
+	return 0;
+}
+
+/**
+ * Runs the separate stages on a copy of the bitstream and compares the
+ * result. Returns 0 if the results are the same.
+ */
+int SerialManchesterStage::verify(const DecoderBuffer& buffer, FrameRecord& record, int rc, size_t len) {
+
+	uint8_t copy[FrameRecord::MAX_PAYLOAD_BYTES + 2];
+	assert(buffer.len <= sizeof(copy));
+	memcpy(copy, buffer.data, buffer.len);
+
+	DecoderBuffer referenceBuffer;
+	referenceBuffer.data = copy;
+	referenceBuffer.len = buffer.len;
+
+	int referenceRc = 0;
+	for (int i=0 ; i<this->nreference && referenceRc == 0 ; i++) {
+		referenceRc = this->reference[i]->process(referenceBuffer, record);
+	}
+
+	if (referenceRc != rc || (rc == 0 && (referenceBuffer.len != len
+			|| memcmp(referenceBuffer.data, record.payload, len) != 0))) {
+		this->mismatches++;
+		LOG_ERROR("ERROR: Fused decoder differs from separate stages (rc=%d/%d length=%d/%d mismatches=%llu)\n",
+				rc, referenceRc, (int) len, (int) referenceBuffer.len, (unsigned long long) this->mismatches);
+		return -1;
+	}
+
+	return 0;
+}
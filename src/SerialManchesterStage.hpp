@@ -0,0 +1,84 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SERIALMANCHESTERSTAGE_HPP_
+#define SERIALMANCHESTERSTAGE_HPP_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "IDecoderStage.hpp"
+#include "SerialBitstream.hpp"
+#include "SyncStage.hpp"
+#include "EndMarkerStage.hpp"
+#include "Manchester.hpp"
+
+/**
+ * Decoder stage doing the work of the stages "bitstream", "sync", "end" and
+ * "manchester" in a single pass: Each character is taken from the serial
+ * bitstream, compared to the preamble or end marker and Manchester decoded
+ * straight into the payload of the record. Nothing after the end marker is
+ * decoded.
+ *
+ * Passes and rejects exactly the same data frames as the separate stages.
+ * In verify mode, the separate stages run as well and differences are
+ * reported, e.g. to check a change against data frames of a real device.
+ */
+class SerialManchesterStage : public IDecoderStage {
+
+public:
+	/**
+	 * @param sync Preamble, see SyncStage.
+	 * @param syncLen Length of the preamble.
+	 * @param marker End marker, see EndMarkerStage.
+	 * @param verify Also run the separate stages and compare the results.
+	 */
+	SerialManchesterStage(const uint8_t* sync, size_t syncLen, uint8_t marker, bool verify);
+	virtual ~SerialManchesterStage();
+
+	virtual const char* getName() {
+		return "fused";
+	}
+
+	virtual int process(DecoderBuffer& buffer, FrameRecord& record);
+
+	/**
+	 * Number of data frames the separate stages decoded differently, in verify mode.
+	 */
+	uint64_t getMismatches() {
+		return this->mismatches;
+	}
+
+private:
+	uint8_t sync[SyncStage::MAX_PATTERN_BYTES];
+	size_t syncLen;
+	uint8_t marker;
+
+	uint64_t mismatches;
+
+	/** Separate stages, only in verify mode */
+	IDecoderStage* reference[4];
+	int nreference;
+
+	int decode(const DecoderBuffer& buffer, uint8_t* payload, size_t& len);
+	int verify(const DecoderBuffer& buffer, FrameRecord& record, int rc, size_t len);
+};
+
+
+#endif /* SERIALMANCHESTERSTAGE_HPP_ */
@@ -0,0 +1,189 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <assert.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "Log.hpp"
+
+#include "SharedMemoryRing.hpp"
+
+SharedMemoryRing::SharedMemoryRing(const char* name, uint32_t slotCount) {
+	assert(slotCount > 0);
+
+	this->name = name;
+	this->slotCount = slotCount;
+
+	this->header = NULL;
+	this->slots = NULL;
+	this->size = 0;
+}
+
+SharedMemoryRing::~SharedMemoryRing() {
+	if (this->header != NULL) {
+		this->close();
+	}
+}
+
+/**
+ * Maps the shared memory object. Exits on error.
+ */
+static void* mapObject(int fd, size_t size) {
+	void* addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (addr == MAP_FAILED) {
+		perror("Mapping shared memory");
+		exit(1);
+	}
+
+	return addr;
+}
+
+/**
+ * Returns true if an existing shared memory object of the given size is a
+ * ring buffer with the layout and number of slots of this one.
+ */
+bool SharedMemoryRing::isCompatible(const SharedMemoryRingHeader* header, size_t size) {
+	return size == this->size
+			&& __atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) == SHM_RING_MAGIC
+			&& header->version == SHM_RING_VERSION
+			&& header->headerSize == sizeof(SharedMemoryRingHeader)
+			&& header->slotCount == this->slotCount
+			&& header->slotSize == sizeof(SharedMemoryRingSlot);
+}
+
+void SharedMemoryRing::open() {
+
+	int fd = shm_open(this->name, O_CREAT | O_RDWR, 0644);
+	if (fd < 0) {
+		perror("Opening shared memory");
+		exit(1);
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) < 0) {
+		perror("Opening shared memory");
+		exit(1);
+	}
+
+	this->size = sharedMemoryRingSize(this->slotCount);
+
+	if (st.st_size > 0) {
+		// Left by a previous run, readers may still have it mapped. It is
+		// never resized under them, that would make them fault.
+		SharedMemoryRingHeader* existing = (SharedMemoryRingHeader*) mapObject(fd, st.st_size);
+
+		if (isCompatible(existing, st.st_size)) {
+			::close(fd);
+			this->header = existing;
+			this->slots = sharedMemoryRingSlots(this->header);
+
+			LOG_INFO("Publishing data frames to shared memory %s (slots=%u size=%u), continuing at record %llu\n",
+					this->name, this->slotCount, (unsigned int) this->size,
+					(unsigned long long) this->header->writeSequence);
+			return;
+		}
+
+		// Replaced by a new object. Attached readers see the magic number
+		// cleared and open the name again.
+		__atomic_store_n(&existing->magic, 0, __ATOMIC_RELEASE);
+		__atomic_add_fetch(&existing->futex, 1, __ATOMIC_SEQ_CST);
+		futexWake(&existing->futex);
+		munmap(existing, st.st_size);
+
+		::close(fd);
+		shm_unlink(this->name);
+
+		fd = shm_open(this->name, O_CREAT | O_EXCL | O_RDWR, 0644);
+		if (fd < 0) {
+			perror("Opening shared memory");
+			exit(1);
+		}
+	}
+
+	if (ftruncate(fd, this->size) < 0) {
+		perror("Resizing shared memory");
+		exit(1);
+	}
+
+	void* addr = mapObject(fd, this->size);
+
+	// The mapping stays valid after closing the file descriptor.
+	::close(fd);
+
+	this->header = (SharedMemoryRingHeader*) addr;
+	memset(addr, 0, this->size);
+
+	this->header->version = SHM_RING_VERSION;
+	this->header->headerSize = sizeof(SharedMemoryRingHeader);
+	this->header->slotCount = this->slotCount;
+	this->header->slotSize = sizeof(SharedMemoryRingSlot);
+	this->slots = sharedMemoryRingSlots(this->header);
+
+	__atomic_store_n(&this->header->magic, SHM_RING_MAGIC, __ATOMIC_RELEASE);
+
+	LOG_INFO("Publishing data frames to shared memory %s (slots=%u size=%u)\n",
+			this->name, this->slotCount, (unsigned int) this->size);
+}
+
+void SharedMemoryRing::close() {
+	if (munmap(this->header, this->size) < 0) {
+		perror("Unmapping shared memory");
+		exit(1);
+	}
+
+	// The name is kept, a restarted driver continues with the readers attached.
+
+	this->header = NULL;
+	this->slots = NULL;
+}
+
+/**
+ * Copies the record into the next slot of the ring buffer and wakes up
+ * readers waiting for new records. The system call to wake up readers
+ * is only done if there is actually a reader waiting.
+ */
+void SharedMemoryRing::publish(const FrameRecord& record) {
+
+	assert(this->header != NULL);
+
+	uint64_t n = this->header->writeSequence;
+	SharedMemoryRingSlot* slot = &this->slots[n % this->slotCount];
+
+	// Mark the slot as "being written"
+	__atomic_store_n(&slot->sequence, 2 * n + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	// Only copy the valid part of the payload
+	memcpy(&slot->record, &record, offsetof(FrameRecord, payload) + record.len);
+
+	// Mark the slot as "complete"
+	__atomic_store_n(&slot->sequence, 2 * n + 2, __ATOMIC_RELEASE);
+	__atomic_store_n(&this->header->writeSequence, n + 1, __ATOMIC_RELEASE);
+
+	__atomic_add_fetch(&this->header->futex, 1, __ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&this->header->waiters, __ATOMIC_SEQ_CST) > 0) {
+		futexWake(&this->header->futex);
+	}
+}
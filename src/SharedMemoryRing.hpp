@@ -0,0 +1,77 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SHAREDMEMORYRING_HPP_
+#define SHAREDMEMORYRING_HPP_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "IFrameSink.hpp"
+#include "SharedMemoryRingLayout.hpp"
+
+/**
+ * Publishes every data frame received into a POSIX shared memory ring
+ * buffer, so that local consumers can read the frames without going
+ * through a TCP socket.
+ *
+ * There is a single writer (the driver) and any number of readers.
+ * Readers use the SharedMemoryRingReader class.
+ *
+ * The shared memory object outlives the driver, so a restarted driver
+ * continues publishing to the readers still attached.
+ */
+class SharedMemoryRing : public IFrameSink {
+
+public:
+	static const uint32_t DEFAULT_SLOT_COUNT = 256;
+
+	/**
+	 * @param name Name of the shared memory object, e.g. "/cc1101".
+	 * @param slotCount Number of records kept in the ring buffer.
+	 */
+	SharedMemoryRing(const char* name, uint32_t slotCount);
+	virtual ~SharedMemoryRing();
+
+	/**
+	 * Creates the shared memory object and maps it. An existing one with
+	 * the same layout and number of slots is continued; any other one is
+	 * replaced, as it can't be resized while readers have it mapped.
+	 */
+	void open();
+
+	/**
+	 * Unmaps the shared memory object. It is not removed.
+	 */
+	void close();
+
+	virtual void publish(const FrameRecord& record);
+
+private:
+	const char* name;
+	uint32_t slotCount;
+
+	SharedMemoryRingHeader* header;
+	SharedMemoryRingSlot* slots;
+	size_t size;
+
+	bool isCompatible(const SharedMemoryRingHeader* header, size_t size);
+};
+
+#endif /* SHAREDMEMORYRING_HPP_ */
@@ -0,0 +1,98 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SHAREDMEMORYRINGLAYOUT_HPP_
+#define SHAREDMEMORYRINGLAYOUT_HPP_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include "FrameRecord.hpp"
+
+/**
+ * Memory layout of the shared memory ring buffer, shared between the
+ * driver (single writer) and any number of local readers.
+ *
+ * The shared memory object starts with a header, followed by slotCount
+ * slots. Record n (counting from 0) is stored in slot n % slotCount.
+ *
+ * Each slot is protected by its own sequence number (seqlock):
+ * While the writer copies record n into the slot, the sequence number is
+ * 2 * n + 1 (odd). When the record is complete, it is 2 * n + 2 (even).
+ * A reader copies the record and then checks that the sequence number did
+ * not change in the meantime. If it did, the writer has overtaken the reader.
+ */
+
+static const uint32_t SHM_RING_MAGIC = 0x52313143; // "C11R"
+static const uint16_t SHM_RING_VERSION = 1;
+
+struct SharedMemoryRingHeader {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t headerSize;
+	uint32_t slotCount;
+	uint32_t slotSize;
+
+	/** Number of records published so far. */
+	uint64_t writeSequence;
+
+	/**
+	 * Futex word. Incremented by the writer on every record published.
+	 * Readers wait on it if there is nothing to read.
+	 */
+	uint32_t futex;
+
+	/** Number of readers currently waiting on the futex word. */
+	uint32_t waiters;
+} __attribute__((aligned(64)));
+
+struct SharedMemoryRingSlot {
+	uint64_t sequence;
+	FrameRecord record;
+} __attribute__((aligned(64)));
+
+/**
+ * Returns the size of the shared memory object for the given number of slots.
+ */
+static inline size_t sharedMemoryRingSize(uint32_t slotCount) {
+	return sizeof(SharedMemoryRingHeader) + slotCount * sizeof(SharedMemoryRingSlot);
+}
+
+static inline SharedMemoryRingSlot* sharedMemoryRingSlots(SharedMemoryRingHeader* header) {
+	return (SharedMemoryRingSlot*) ((uint8_t*) header + header->headerSize);
+}
+
+/**
+ * Futex operations on a futex word in shared memory.
+ * The non-private variants are used, as writer and readers are
+ * different processes.
+ */
+static inline int futexWait(uint32_t* word, uint32_t expected, const struct timespec* timeout) {
+	return syscall(SYS_futex, word, FUTEX_WAIT, expected, timeout, NULL, 0);
+}
+
+static inline int futexWake(uint32_t* word) {
+	return syscall(SYS_futex, word, FUTEX_WAKE, INT32_MAX, NULL, NULL, 0);
+}
+
+#endif /* SHAREDMEMORYRINGLAYOUT_HPP_ */
@@ -0,0 +1,216 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "SharedMemoryRingReader.hpp"
+
+SharedMemoryRingReader::SharedMemoryRingReader() {
+	this->header = NULL;
+	this->slots = NULL;
+	this->size = 0;
+	this->next = 0;
+	this->peeked = 0;
+	this->lost = 0;
+}
+
+SharedMemoryRingReader::~SharedMemoryRingReader() {
+	if (this->header != NULL) {
+		this->close();
+	}
+}
+
+int SharedMemoryRingReader::open(const char* name) {
+
+	// Read/write, as readers need to register as waiters on the futex word.
+	int fd = shm_open(name, O_RDWR, 0);
+	if (fd < 0) {
+		perror("Opening shared memory");
+		return -1;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) < 0 || (size_t) st.st_size < sizeof(SharedMemoryRingHeader)) {
+		fprintf(stderr, "Shared memory %s is not a ring buffer.\n", name);
+		::close(fd);
+		return -1;
+	}
+
+	void* addr = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (addr == MAP_FAILED) {
+		perror("Mapping shared memory");
+		return -1;
+	}
+
+	SharedMemoryRingHeader* hdr = (SharedMemoryRingHeader*) addr;
+	if (__atomic_load_n(&hdr->magic, __ATOMIC_ACQUIRE) != SHM_RING_MAGIC
+			|| hdr->version != SHM_RING_VERSION
+			|| hdr->slotSize != sizeof(SharedMemoryRingSlot)
+			|| sharedMemoryRingSize(hdr->slotCount) > (size_t) st.st_size) {
+		fprintf(stderr, "Shared memory %s: Unsupported ring buffer layout.\n", name);
+		munmap(addr, st.st_size);
+		return -1;
+	}
+
+	this->header = hdr;
+	this->slots = sharedMemoryRingSlots(hdr);
+	this->size = st.st_size;
+	this->next = __atomic_load_n(&hdr->writeSequence, __ATOMIC_ACQUIRE);
+	this->lost = 0;
+
+	return 0;
+}
+
+void SharedMemoryRingReader::close() {
+	munmap(this->header, this->size);
+
+	this->header = NULL;
+	this->slots = NULL;
+}
+
+/**
+ * Returns true if the driver replaced the shared memory object by a new one.
+ */
+bool SharedMemoryRingReader::isReplaced() {
+	return __atomic_load_n(&this->header->magic, __ATOMIC_ACQUIRE) != SHM_RING_MAGIC;
+}
+
+/**
+ * Returns the slot of the next record to read, or NULL if there is none.
+ * Skips records that were already overwritten by the writer.
+ */
+SharedMemoryRingSlot* SharedMemoryRingReader::nextSlot() {
+
+	const uint32_t slotCount = this->header->slotCount;
+
+	while (true) {
+		if (isReplaced()) {
+			return NULL;
+		}
+
+		uint64_t w = __atomic_load_n(&this->header->writeSequence, __ATOMIC_ACQUIRE);
+
+		if (this->next > w) {
+			// Writer was restarted.
+			this->next = w;
+		}
+
+		if (this->next == w) {
+			return NULL; // Nothing new
+		}
+
+		if (w - this->next >= slotCount) {
+			// Reader too slow. The oldest record may just be overwritten.
+			uint64_t oldest = w - slotCount + 1;
+			this->lost += oldest - this->next;
+			this->next = oldest;
+		}
+
+		SharedMemoryRingSlot* slot = &this->slots[this->next % slotCount];
+
+		uint64_t s = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+		if (s == 2 * this->next + 2) {
+			this->peeked = s;
+			return slot;
+		}
+
+		// Overwritten in the meantime. Try again with an updated write sequence.
+	}
+}
+
+int SharedMemoryRingReader::read(FrameRecord& record) {
+
+	while (true) {
+		SharedMemoryRingSlot* slot = nextSlot();
+		if (slot == NULL) {
+			return isReplaced() ? -1 : 0;
+		}
+
+		memcpy(&record, &slot->record, offsetof(FrameRecord, payload));
+		size_t len = record.len;
+		if (len > FrameRecord::MAX_PAYLOAD_BYTES) {
+			len = FrameRecord::MAX_PAYLOAD_BYTES;
+		}
+		memcpy(record.payload, slot->record.payload, len);
+
+		if (consume()) {
+			return 1;
+		}
+	}
+}
+
+const FrameRecord* SharedMemoryRingReader::peek() {
+
+	SharedMemoryRingSlot* slot = nextSlot();
+	if (slot == NULL) {
+		return NULL;
+	}
+
+	return &slot->record;
+}
+
+bool SharedMemoryRingReader::consume() {
+
+	SharedMemoryRingSlot* slot = &this->slots[this->next % this->header->slotCount];
+
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	uint64_t s = __atomic_load_n(&slot->sequence, __ATOMIC_RELAXED);
+
+	this->next++;
+
+	if (s != this->peeked) {
+		this->lost++;
+		return false;
+	}
+
+	return true;
+}
+
+int SharedMemoryRingReader::wait(int timeoutMillis) {
+
+	uint32_t futex = __atomic_load_n(&this->header->futex, __ATOMIC_SEQ_CST);
+	if (isReplaced()) {
+		return -1;
+	}
+
+	if (this->next != __atomic_load_n(&this->header->writeSequence, __ATOMIC_ACQUIRE)) {
+		return 1;
+	}
+
+	struct timespec ts;
+	ts.tv_sec = timeoutMillis / 1000;
+	ts.tv_nsec = (timeoutMillis % 1000) * 1000000L;
+
+	__atomic_add_fetch(&this->header->waiters, 1, __ATOMIC_SEQ_CST);
+	futexWait(&this->header->futex, futex, timeoutMillis < 0 ? NULL : &ts);
+	__atomic_sub_fetch(&this->header->waiters, 1, __ATOMIC_SEQ_CST);
+
+	if (isReplaced()) {
+		return -1;
+	}
+
+	return this->next != __atomic_load_n(&this->header->writeSequence, __ATOMIC_ACQUIRE) ? 1 : 0;
+}
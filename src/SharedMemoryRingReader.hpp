@@ -0,0 +1,117 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SHAREDMEMORYRINGREADER_HPP_
+#define SHAREDMEMORYRINGREADER_HPP_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "FrameRecord.hpp"
+#include "SharedMemoryRingLayout.hpp"
+
+/**
+ * Reads the data frames published by the driver into a shared memory
+ * ring buffer (see SharedMemoryRing).
+ *
+ * To use it in your own application, compile SharedMemoryRingReader.cpp
+ * together with your sources. Reading records does not require any system
+ * call; only waiting for new records does.
+ *
+ * Each reader has its own read position. If a reader is too slow, the
+ * writer overwrites records that have not been read yet. These records
+ * are skipped and counted as lost.
+ *
+ * The reader stays attached when the driver is restarted. Only if the
+ * driver replaced the ring buffer, e.g. to change the number of slots,
+ * read() and wait() return -1; close() and open() it again.
+ */
+class SharedMemoryRingReader {
+
+public:
+	SharedMemoryRingReader();
+	~SharedMemoryRingReader();
+
+	/**
+	 * Maps the shared memory object created by the driver.
+	 * Reading starts with the next record published.
+	 *
+	 * Returns 0 on success, -1 if the shared memory object does not exist
+	 * or is not a valid ring buffer.
+	 */
+	int open(const char* name);
+
+	void close();
+
+	/**
+	 * Copies the next record into the provided record.
+	 *
+	 * Returns 1 if a record was read, 0 if there is no new record and -1
+	 * if the ring buffer was replaced.
+	 */
+	int read(FrameRecord& record);
+
+	/**
+	 * Zero-copy access to the next record. Returns NULL if there is no
+	 * new record or the ring buffer was replaced. The record lives in shared memory and may be overwritten
+	 * by the writer at any time, so the caller has to call consume() after
+	 * evaluating it.
+	 */
+	const FrameRecord* peek();
+
+	/**
+	 * Advances to the next record after peek().
+	 * Returns true if the record was not modified while it was evaluated,
+	 * false if it was overwritten and the results must be discarded.
+	 */
+	bool consume();
+
+	/**
+	 * Waits until there is a new record to read.
+	 *
+	 * Returns 1 if there is a new record, 0 on timeout and -1 if the ring
+	 * buffer was replaced. A negative timeout waits forever.
+	 */
+	int wait(int timeoutMillis);
+
+	/**
+	 * Number of records skipped because the reader was too slow.
+	 */
+	uint64_t getLost() {
+		return this->lost;
+	}
+
+private:
+	SharedMemoryRingHeader* header;
+	SharedMemoryRingSlot* slots;
+	size_t size;
+
+	/** Sequence number of the next record to read */
+	uint64_t next;
+
+	/** Slot sequence number seen by peek() */
+	uint64_t peeked;
+
+	uint64_t lost;
+
+	SharedMemoryRingSlot* nextSlot();
+	bool isReplaced();
+};
+
+#endif /* SHAREDMEMORYRINGREADER_HPP_ */
@@ -0,0 +1,98 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <poll.h>
+
+#include "DateTime.hpp"
+
+#include "SimulatedGpio.hpp"
+
+SimulatedGpio::SimulatedGpio(SimulatedRadio* radio) {
+	this->radio = radio;
+}
+
+void SimulatedGpio::getPinValue(void* value, size_t nbytes) {
+	if (nbytes > 0) {
+		*(char*) value = this->radio->nanosUntilPin() == 0 ? '1' : '0';
+	}
+}
+
+/**
+ * Method returns
+ *  0 if nothing happened within the specified timeout, or a signal
+ *    interrupted the wait.
+ *  1 if the pin was raised, maybe together with events on the other
+ *    file descriptors.
+ * -1 if there was only an event on one of the other file descriptors.
+ */
+int SimulatedGpio::waitForPinValueChange(int timeout_millis, struct pollfd otherFds[], int nOtherFds) {
+
+	uint64_t deadline = DateTime::nanos(CLOCK_MONOTONIC) + timeout_millis * 1000000ULL;
+
+	for (int i=0 ; i<nOtherFds ; i++) {
+		otherFds[i].revents = 0;
+	}
+
+	while (true) {
+		int64_t untilPin = this->radio->nanosUntilPin();
+		if (untilPin == 0) {
+			return 1;
+		}
+
+		uint64_t now = DateTime::nanos(CLOCK_MONOTONIC);
+		if (timeout_millis >= 0 && now >= deadline) {
+			return 0;
+		}
+
+		// Wait for the pin or the timeout, whichever comes first
+		int64_t wait = untilPin;
+		if (timeout_millis >= 0 && (wait < 0 || (uint64_t) wait > deadline - now)) {
+			wait = deadline - now;
+		}
+
+		struct timespec ts;
+		ts.tv_sec = wait / 1000000000LL;
+		ts.tv_nsec = wait % 1000000000LL;
+
+		int rc = ppoll(otherFds, nOtherFds, wait >= 0 ? &ts : NULL, NULL);
+		if (rc < 0) {
+			if (errno == EINTR) {
+				return 0;
+			}
+
+			perror("poll");
+			exit(1);
+		}
+
+		if (rc > 0) {
+			// Data ready to read from a socket or socket was closed.
+			return this->radio->nanosUntilPin() == 0 ? 1 : -1;
+		}
+	}
+}
+
+/**
+ * Returns 0 on timeout, 1 when the pin was raised.
+ */
+int SimulatedGpio::waitForPinValueChange(int timeout_millis, const char* edge) {
+	return waitForPinValueChange(timeout_millis, NULL, 0);
+}
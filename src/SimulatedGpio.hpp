@@ -0,0 +1,52 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SIMULATEDGPIO_HPP_
+#define SIMULATEDGPIO_HPP_
+
+#include "Gpio.hpp"
+#include "SimulatedRadio.hpp"
+
+/**
+ * The GDO2 pin of a SimulatedRadio. Doesn't touch the GPIO pins of the
+ * host.
+ */
+class SimulatedGpio : public Gpio {
+
+public:
+	SimulatedGpio(SimulatedRadio* radio);
+
+	virtual void exportPin() {};
+	virtual void unexportPin() {};
+	virtual void setPinDirection(const char* direction) {};
+	virtual void setPinEdge(const char* edge) {};
+	virtual void getPinValue(void* value, size_t nbytes);
+
+	/**
+	 * Waits until the radio raises the pin, like Gpio does, but with
+	 * nanosecond resolution.
+	 */
+	virtual int waitForPinValueChange(int timeout_millis, struct pollfd otherFds[], int nOtherFds);
+	virtual int waitForPinValueChange(int timeout_millis, const char* edge);
+
+private:
+	SimulatedRadio* radio;
+};
+
+#endif /* SIMULATEDGPIO_HPP_ */
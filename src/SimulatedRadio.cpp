@@ -0,0 +1,338 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "AddressSpace.hpp"
+#include "DateTime.hpp"
+
+#include "SimulatedRadio.hpp"
+
+SimulatedRadio::SimulatedRadio(uint32_t baud, SimulatedRadioStatistics* statistics) {
+	this->statistics = statistics;
+	memset(this->statistics, 0, sizeof(*this->statistics));
+
+	memset(this->registers, 0, sizeof(this->registers));
+	this->registers[ADDR_FIFOTHR] = 0x07; // Reset value
+	this->state = STATE_IDLE;
+
+	this->nanosPerByte = 8 * 1000000000ULL / baud;
+
+	this->rate = 1;
+	this->minPayload = MIN_PAYLOAD_BYTES;
+	this->maxPayload = MIN_PAYLOAD_BYTES;
+	this->burst = 1;
+	this->pauseMillis = 0;
+	this->seed = 1;
+
+	this->endNanos = 0;
+	this->nextStart = 0;
+	this->nextPayload = MIN_PAYLOAD_BYTES;
+	this->nextInBurst = 0;
+
+	this->receiving = false;
+	this->frameLength = 0;
+	this->frameStart = 0;
+	this->readPos = 0;
+}
+
+SimulatedRadio::~SimulatedRadio() {
+}
+
+void SimulatedRadio::setTraffic(double rate, size_t minPayload, size_t maxPayload, int burst, int pauseMillis) {
+	this->rate = rate;
+	this->minPayload = minPayload;
+	this->maxPayload = maxPayload;
+	this->burst = burst;
+	this->pauseMillis = pauseMillis;
+}
+
+void SimulatedRadio::start(uint64_t startNanos, uint64_t endNanos) {
+	this->endNanos = endNanos;
+	this->nextStart = startNanos;
+	this->nextPayload = this->minPayload + rand_r(&this->seed) % (this->maxPayload - this->minPayload + 1);
+	this->nextInBurst = 0;
+}
+
+size_t SimulatedRadio::threshold() {
+	return 4 * ((this->registers[ADDR_FIFOTHR] & 0x0F) + 1);
+}
+
+/**
+ * Number of bytes of the current data frame that arrived in the RX FIFO
+ * until now, including the ones read already.
+ */
+size_t SimulatedRadio::arrived(uint64_t now) {
+	if (now < this->frameStart) {
+		return 0;
+	}
+
+	uint64_t n = (now - this->frameStart) / this->nanosPerByte;
+	return n < this->frameLength ? n : this->frameLength;
+}
+
+/**
+ * Sends everything due until now and updates the state of the RX FIFO.
+ */
+void SimulatedRadio::advance(uint64_t now) {
+
+	while (this->nextStart != 0 && this->nextStart <= now) {
+		// The data frame received before is complete by then
+		advance(this->nextStart - 1);
+		send(this->nextStart);
+	}
+
+	if (this->receiving && this->state == STATE_RX) {
+		size_t n = arrived(now);
+		if (n - this->readPos > FIFO_LENGTH) {
+			this->statistics->overflows++;
+			this->state = STATE_RX_OVERFLOW;
+		} else if (n == this->frameLength) {
+			// End of data frame, leave RX as configured by RXOFF_MODE
+			this->state = STATE_IDLE;
+		}
+	}
+}
+
+/**
+ * Sends the next data frame and schedules the one after it.
+ */
+void SimulatedRadio::send(uint64_t now) {
+
+	uint32_t number = this->statistics->injected++;
+	size_t payload = this->nextPayload;
+
+	if (this->state != STATE_RX || this->receiving) {
+		this->statistics->missed++;
+	} else {
+		this->frameStart = now + OVERHEAD_BYTES * this->nanosPerByte;
+		this->frameLength = payload + 5;
+		this->readPos = 0;
+		this->receiving = true;
+
+		uint64_t airEnd = this->frameStart + this->frameLength * this->nanosPerByte;
+
+		uint8_t* p = this->frame;
+		*p++ = payload + 2;
+		*p++ = 0x01; // Destination address
+		*p++ = 0x0A; // Source address
+
+		for (int i=3 ; i>=0 ; i--) {
+			*p++ = number >> (8 * i);
+		}
+		for (int i=7 ; i>=0 ; i--) {
+			*p++ = airEnd >> (8 * i);
+		}
+		for (size_t i=MIN_PAYLOAD_BYTES ; i<payload ; i++) {
+			*p++ = i;
+		}
+
+		*p++ = 0xE4; // RSSI
+		*p++ = 0x80 | 0x2D; // LQI with CRC OK
+	}
+
+	uint64_t airTime = (OVERHEAD_BYTES + payload + 5) * this->nanosPerByte;
+	uint64_t period = 1e9 / this->rate;
+	uint64_t next = now + (period > airTime ? period : airTime);
+
+	if (++this->nextInBurst >= this->burst) {
+		this->nextInBurst = 0;
+		next += this->pauseMillis * 1000000ULL;
+	}
+
+	this->nextStart = next < this->endNanos ? next : 0;
+	this->nextPayload = this->minPayload + rand_r(&this->seed) % (this->maxPayload - this->minPayload + 1);
+}
+
+uint8_t SimulatedRadio::rxBytes(uint64_t now) {
+	uint8_t overflow = this->state == STATE_RX_OVERFLOW ? 0x80 : 0x00;
+
+	if (!this->receiving) {
+		return overflow;
+	}
+
+	size_t n = arrived(now) - this->readPos;
+	return overflow | (n < 0x7F ? n : 0x7F);
+}
+
+uint8_t SimulatedRadio::readFifo(uint64_t now) {
+
+	// Reading the empty RX FIFO returns garbage
+	if (!this->receiving || this->readPos >= arrived(now)) {
+		return 0;
+	}
+
+	uint8_t value = this->frame[this->readPos++];
+
+	if (this->readPos == this->frameLength) {
+		if (this->state != STATE_RX_OVERFLOW) {
+			this->statistics->delivered++;
+		}
+		this->receiving = false;
+	}
+
+	return value;
+}
+
+/**
+ * Chip status byte: CHIP_RDYn low and the state.
+ */
+uint8_t SimulatedRadio::status() {
+	return this->state;
+}
+
+int64_t SimulatedRadio::nanosUntilPin() {
+
+	uint64_t now = DateTime::nanos(CLOCK_MONOTONIC);
+	advance(now);
+
+	if (this->receiving) {
+		if (this->state == STATE_RX_OVERFLOW) {
+			return 0; // The RX FIFO stays full
+		}
+
+		size_t target = this->readPos + threshold();
+		if (target > this->frameLength) {
+			target = this->frameLength;
+		}
+
+		uint64_t at = this->frameStart + target * this->nanosPerByte;
+		return at > now ? at - now : 0;
+	}
+
+	if (this->state == STATE_RX && this->nextStart != 0) {
+		size_t target = threshold();
+		if (target > this->nextPayload + 5) {
+			target = this->nextPayload + 5;
+		}
+
+		return this->nextStart + (OVERHEAD_BYTES + target) * this->nanosPerByte - now;
+	}
+
+	return -1;
+}
+
+uint8_t SimulatedRadio::readSingleByte(const uint8_t address, uint8_t& value) {
+
+	uint64_t now = DateTime::nanos(CLOCK_MONOTONIC);
+	advance(now);
+
+	if (address == ADDR_RXTX_FIFO) {
+		value = readFifo(now);
+	} else if (address == ADDR_RX_BYTES) {
+		value = rxBytes(now);
+	} else if (address < REGISTER_COUNT) {
+		value = this->registers[address];
+	} else {
+		value = 0;
+	}
+
+	return status();
+}
+
+uint8_t SimulatedRadio::readBurst(const uint8_t address, uint8_t buffer[], const size_t nbytes) {
+
+	uint64_t now = DateTime::nanos(CLOCK_MONOTONIC);
+	advance(now);
+
+	if (address == ADDR_RXTX_FIFO) {
+		for (size_t i=0 ; i<nbytes ; i++) {
+			buffer[i] = readFifo(now);
+		}
+	} else if (address == ADDR_RX_BYTES) {
+		buffer[0] = rxBytes(now);
+	} else if (address == ADDR_TX_BYTES) {
+		buffer[0] = 0; // Transmitted immediately
+	} else {
+		for (size_t i=0 ; i<nbytes ; i++) {
+			buffer[i] = address + i < REGISTER_COUNT ? this->registers[address + i] : 0;
+		}
+	}
+
+	return status();
+}
+
+uint8_t SimulatedRadio::readStrobe(const uint8_t address) {
+
+	uint64_t now = DateTime::nanos(CLOCK_MONOTONIC);
+	advance(now);
+
+	switch (address) {
+	case STROBE_SRES:
+		memset(this->registers, 0, sizeof(this->registers));
+		this->registers[ADDR_FIFOTHR] = 0x07;
+		this->state = STATE_IDLE;
+		this->receiving = false;
+		break;
+
+	case STROBE_SRX:
+		if (this->state == STATE_IDLE) {
+			this->state = STATE_RX;
+		}
+		break;
+
+	case STROBE_SIDLE:
+		// Stops receiving the data frame in the middle
+		if (this->receiving && this->state == STATE_RX) {
+			this->statistics->flushed++;
+			this->receiving = false;
+		}
+		if (this->state != STATE_RX_OVERFLOW) {
+			this->state = STATE_IDLE;
+		}
+		break;
+
+	case STROBE_SFRX:
+		if (this->receiving && this->state != STATE_RX_OVERFLOW) {
+			this->statistics->flushed++;
+		}
+		this->receiving = false;
+		if (this->state == STATE_RX_OVERFLOW) {
+			this->state = STATE_IDLE;
+		}
+		break;
+
+	default:
+		// STX: Data frames are transmitted immediately
+		break;
+	}
+
+	return status();
+}
+
+uint8_t SimulatedRadio::writeSingleByte(const uint8_t address, const uint8_t value) {
+
+	if (address < REGISTER_COUNT) {
+		this->registers[address] = value;
+	}
+
+	return status();
+}
+
+uint8_t SimulatedRadio::writeBurst(const uint8_t address, const uint8_t buffer[], const size_t nbytes) {
+
+	// Writes to the TX FIFO are dropped
+	for (size_t i=0 ; i<nbytes && address + i < REGISTER_COUNT ; i++) {
+		this->registers[address + i] = buffer[i];
+	}
+
+	return status();
+}
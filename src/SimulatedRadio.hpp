@@ -0,0 +1,164 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SIMULATEDRADIO_HPP_
+#define SIMULATEDRADIO_HPP_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "Spi.hpp"
+
+/**
+ * What happened to the data frames sent to the simulated radio. Kept apart
+ * from the radio, so it can be placed in memory shared with the process
+ * that evaluates a load test.
+ */
+struct SimulatedRadioStatistics {
+	/** Data frames sent on air */
+	uint64_t injected;
+
+	/** Data frames lost because the radio was not in RX state */
+	uint64_t missed;
+
+	/** Data frames lost because the RX FIFO overflowed */
+	uint64_t overflows;
+
+	/** Data frames flushed from the RX FIFO before they were read completely */
+	uint64_t flushed;
+
+	/** Data frames read completely from the RX FIFO */
+	uint64_t delivered;
+};
+
+/**
+ * Replaces the CC1101 for load tests: Sends data frames in variable length
+ * mode (as used by the rfbee profile) at a configurable rate, with random
+ * payload sizes and in bursts.
+ *
+ * The bytes of a data frame arrive in the RX FIFO at the data rate, in real
+ * time. If the driver doesn't read them fast enough, the RX FIFO overflows.
+ * After a data frame is received, the radio leaves RX state, and data frames
+ * sent before the driver strobes SRX again are missed.
+ *
+ * Payload byte 0-3 is the number of the data frame, byte 4-11 the time
+ * (CLOCK_MONOTONIC, ns) its last byte arrived, both in network byte order.
+ * Receivers calculate the latency from it.
+ *
+ * Use it together with SimulatedGpio, which waits for the GDO2 pin.
+ */
+class SimulatedRadio : public Spi {
+
+public:
+	/** Number of the data frame and time of its last byte */
+	static const size_t MIN_PAYLOAD_BYTES = 12;
+
+	/** Length byte of the variable length mode counts addresses and payload */
+	static const size_t MAX_PAYLOAD_BYTES = 253;
+
+	/**
+	 * @param baud Data rate in bits per second.
+	 * @param statistics Counters updated by the radio.
+	 */
+	SimulatedRadio(uint32_t baud, SimulatedRadioStatistics* statistics);
+	virtual ~SimulatedRadio();
+
+	/**
+	 * Sets the traffic sent: Bursts of data frames at a rate, with a pause
+	 * between the bursts. Data frames are sent back to back if the rate is
+	 * higher than the data rate allows.
+	 *
+	 * @param rate Data frames per second within a burst.
+	 * @param minPayload Smallest payload size.
+	 * @param maxPayload Largest payload size, sizes are evenly distributed.
+	 * @param burst Number of data frames per burst.
+	 * @param pauseMillis Pause after each burst.
+	 */
+	void setTraffic(double rate, size_t minPayload, size_t maxPayload, int burst, int pauseMillis);
+
+	/**
+	 * Sends data frames from start to end (CLOCK_MONOTONIC, ns).
+	 */
+	void start(uint64_t startNanos, uint64_t endNanos);
+
+	/**
+	 * Returns the time until the GDO2 pin is raised (RX FIFO filled at or
+	 * above the threshold, or end of data frame), 0 if it is raised, or -1
+	 * if it won't be raised without the driver doing something.
+	 */
+	int64_t nanosUntilPin();
+
+	virtual uint8_t readSingleByte(const uint8_t address, uint8_t& value);
+	virtual uint8_t readBurst(const uint8_t address, uint8_t buffer[], const size_t nbytes);
+	virtual uint8_t readStrobe(const uint8_t address);
+
+	virtual uint8_t writeSingleByte(const uint8_t address, const uint8_t value);
+	virtual uint8_t writeBurst(const uint8_t address, const uint8_t buffer[], const size_t nbytes);
+
+private:
+	static const int FIFO_LENGTH = 64;
+	static const int REGISTER_COUNT = 0x2F;
+
+	/** Preamble and sync word sent before each data frame */
+	static const int OVERHEAD_BYTES = 8;
+
+	/** Chip states in the status byte */
+	static const uint8_t STATE_IDLE = 0x00;
+	static const uint8_t STATE_RX = 0x10;
+	static const uint8_t STATE_RX_OVERFLOW = 0x60;
+
+	SimulatedRadioStatistics* statistics;
+
+	uint8_t registers[REGISTER_COUNT];
+	uint8_t state;
+
+	/** Time to send one byte */
+	uint64_t nanosPerByte;
+
+	double rate;
+	size_t minPayload;
+	size_t maxPayload;
+	int burst;
+	int pauseMillis;
+	unsigned int seed;
+
+	uint64_t endNanos;
+
+	/** Next data frame sent on air */
+	uint64_t nextStart;
+	size_t nextPayload;
+	int nextInBurst;
+
+	/** Data frame in the RX FIFO: Length byte, addresses, payload, RSSI, LQI */
+	bool receiving;
+	uint8_t frame[MAX_PAYLOAD_BYTES + 5];
+	size_t frameLength;
+	uint64_t frameStart;
+	size_t readPos;
+
+	void advance(uint64_t now);
+	void send(uint64_t now);
+	size_t arrived(uint64_t now);
+	uint8_t rxBytes(uint64_t now);
+	uint8_t readFifo(uint64_t now);
+	uint8_t status();
+	size_t threshold();
+};
+
+#endif /* SIMULATEDRADIO_HPP_ */
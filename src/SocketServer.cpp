@@ -26,14 +26,25 @@
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <assert.h>
 
 #include "SocketServer.hpp"
-#include "RFBeeDataFrame.hpp"
-#include "DateTime.hpp"
+#include "Log.hpp"
+#include "Metrics.hpp"
+#include "ReceiveLatency.hpp"
+
+SocketServer::SocketServer(Device* device, CommandDispatcher* dispatcher, OutputFormatRegistry* formats)
+	: pool(MAX_CLIENTS * ClientConnection::OUTPUT_QUEUE_LENGTH + OutputFormatRegistry::MAX_FORMATS) {
+	assert(OutputBuffer::MAX_BYTES >= IOutputFormat::MAX_LINE_BYTES);
 
-SocketServer::SocketServer(Device* device) {
 	this->device = device;
+	this->dispatcher = dispatcher;
+	this->formats = formats;
 	this->sockfd = -1;
+	this->metricsServer = NULL;
 }
 
 /**
@@ -60,13 +71,231 @@ void SocketServer::open(int portno)
 		exit(1);
 	}
 
-	// Allowing a queue of up to 1 pending connection.
-	if (listen(this->sockfd, 1) < 0 ) {
+	// Allowing a queue of up to MAX_CLIENTS pending connections.
+	if (listen(this->sockfd, MAX_CLIENTS) < 0 ) {
 		perror("Setup server socket connection queue");
 		exit(1);
 	}; 
 }
 
+void SocketServer::setMetricsServer(MetricsServer* metricsServer)
+{
+	this->metricsServer = metricsServer;
+}
+
+/**
+ * Receives data frames and serves the connected clients.
+ * The RF module keeps receiving, even if no client is connected,
+ * so that the frame sinks get all data frames.
+ */
+void SocketServer::run()
+{
+	struct pollfd fds[1 + MAX_CLIENTS + MetricsServer::MAX_FDS];
+	int index[1 + MAX_CLIENTS];
+
+	for (;;) {
+		int nfds = 0;
+
+		fds[nfds].fd = this->sockfd;
+		fds[nfds].events = POLLIN;
+		index[nfds++] = -1;
+
+		for (int i=0 ; i<MAX_CLIENTS ; i++) {
+			if (this->clients[i].fd >= 0) {
+				fds[nfds].fd = this->clients[i].fd;
+				fds[nfds].events = POLLIN | POLLERR;
+				// A query being streamed continues when the socket takes more
+				if (this->clients[i].hasOutput() || canStream(&this->clients[i])) {
+					fds[nfds].events |= POLLOUT;
+				}
+				index[nfds++] = i;
+			}
+		}
+
+		// The descriptors of the metrics server follow those of the clients
+		int nclientFds = nfds;
+		if (this->metricsServer != NULL) {
+			nfds += this->metricsServer->getPollFds(fds + nfds);
+		}
+
+		// Data frames still queued for transmission don't wait for events
+		int timeoutMillis = device->hasQueuedTransmits() ? 0 : RECEIVE_TIMEOUT_MILLIS;
+
+		// We do a blocking read (waiting for incoming RF data), but this method
+		// also returns if there is an event on one of the sockets.
+		int rc = device->blockingRead(fds, nfds, timeoutMillis);
+		if (rc > 0) {
+			writeToClients(device->getFrame());
+			ReceiveLatency::mark(LATENCY_WRITTEN);
+
+		} else if (rc == 0 && timeoutMillis == RECEIVE_TIMEOUT_MILLIS) {
+			for (int i=0 ; i<MAX_CLIENTS ; i++) {
+				if (this->clients[i].fd >= 0) {
+					this->clients[i].respond("Timeout\n");
+				}
+			}
+		}
+
+		// Socket events may come together with a data frame. Clients
+		// closed while writing it are skipped.
+		// POLLOUT is handled by writeOutput() below
+		if (rc != 0) {
+			for (int i=1 ; i<nclientFds ; i++) {
+				if ((fds[i].revents & ~POLLOUT) > 0 && this->clients[index[i]].fd == fds[i].fd) {
+					readFromClient(index[i]);
+				}
+			}
+
+			if (this->metricsServer != NULL) {
+				this->metricsServer->handleEvents(fds + nclientFds, nfds - nclientFds);
+			}
+
+			if (fds[0].revents > 0) {
+				acceptConnection();
+			}
+		}
+
+		// Commands may have queued data frames
+		device->transmitQueued(this);
+
+		streamQueries();
+		writeOutput();
+	}
+}
+
+/**
+ * Writes the data frame to the clients, using the output format selected
+ * by each client. The data frame is rendered once per output format and
+ * the buffer is shared by the clients.
+ */
+void SocketServer::writeToClients(const FrameDescriptor& frame)
+{
+	const FrameRecord& record = device->getFramePool()->get(frame.slot);
+
+	OutputBuffer* rendered[OutputFormatRegistry::MAX_FORMATS];
+	for (int i=0 ; i<OutputFormatRegistry::MAX_FORMATS ; i++) {
+		rendered[i] = NULL;
+	}
+
+	int defaultFormat = this->formats->find(device->dataFrame->getDefaultOutputFormat());
+	assert(defaultFormat >= 0);
+
+	for (int i=0 ; i<MAX_CLIENTS ; i++) {
+		ClientConnection* client = &this->clients[i];
+		if (client->fd < 0 || !client->accepts(frame)) {
+			continue;
+		}
+
+		int outputFormat = client->outputFormat;
+		if (outputFormat == OutputFormatRegistry::DEFAULT_FORMAT) {
+			outputFormat = defaultFormat;
+		}
+		if (rendered[outputFormat] == NULL) {
+			OutputBuffer* buffer = this->pool.acquire();
+			if (buffer == NULL) {
+				LOG_WARN("No output buffer left. Dropping data frame (fd=%d)\n", client->fd);
+				Metrics::increment(Metrics::CLIENT_DROPS);
+				client->dropped++;
+				continue;
+			}
+
+			buffer->len = this->formats->get(outputFormat)->format(record, buffer->data, OutputBuffer::MAX_BYTES);
+			rendered[outputFormat] = buffer;
+		}
+
+		if (!client->send(rendered[outputFormat])) {
+			if (client->hasFailed()) {
+				closeClient(i);
+				continue;
+			}
+
+			Metrics::increment(Metrics::CLIENT_DROPS);
+			LOG_WARN("Client too slow. Dropping data frame (fd=%d dropped=%llu)\n",
+					client->fd, (unsigned long long) client->dropped);
+		}
+	}
+
+	// Clients that queued the buffers hold their own references
+	for (int i=0 ; i<OutputFormatRegistry::MAX_FORMATS ; i++) {
+		if (rendered[i] != NULL) {
+			this->pool.release(rendered[i]);
+		}
+	}
+}
+
+/**
+ * Returns true if the client's query can queue more stored data frames.
+ */
+bool SocketServer::canStream(ClientConnection* client)
+{
+	return client->query.isActive() && client->getQueued() < QUERY_QUEUE_LIMIT
+			&& this->pool.getAvailable() > 0;
+}
+
+/**
+ * Queues the next stored data frames of the clients' queries.
+ */
+void SocketServer::streamQueries()
+{
+	int defaultFormat = this->formats->find(device->dataFrame->getDefaultOutputFormat());
+	assert(defaultFormat >= 0);
+
+	for (int i=0 ; i<MAX_CLIENTS ; i++) {
+		ClientConnection* client = &this->clients[i];
+		if (client->fd >= 0 && canStream(client)) {
+			streamQuery(client, defaultFormat);
+		}
+	}
+}
+
+void SocketServer::streamQuery(ClientConnection* client, int defaultFormat)
+{
+	int outputFormat = client->outputFormat;
+	if (outputFormat == OutputFormatRegistry::DEFAULT_FORMAT) {
+		outputFormat = defaultFormat;
+	}
+	IOutputFormat* format = this->formats->get(outputFormat);
+
+	client->query.beginBatch();
+
+	FrameRecord record;
+	for (int n=0 ; n<QUERY_BATCH && canStream(client) ; n++) {
+		OutputBuffer* buffer = this->pool.acquire();
+
+		int rc = client->query.next(record);
+		if (rc == FrameStoreQuery::BATCH_DONE) {
+			this->pool.release(buffer);
+			return; // Go on with the next loop
+		}
+
+		if (rc <= 0) {
+			this->pool.release(buffer);
+			client->respond("QUEND %llu%s\n", (unsigned long long) client->query.getCount(),
+					rc < 0 ? " ERROR" : "");
+			client->query.stop();
+			return;
+		}
+
+		buffer->len = format->format(record, buffer->data, OutputBuffer::MAX_BYTES);
+		client->send(buffer);
+		this->pool.release(buffer);
+	}
+}
+
+/**
+ * Writes the queued output to the clients and closes the connections
+ * that failed.
+ */
+void SocketServer::writeOutput()
+{
+	for (int i=0 ; i<MAX_CLIENTS ; i++) {
+		ClientConnection* client = &this->clients[i];
+		if (client->fd >= 0 && client->writeOutput() < 0) {
+			closeClient(i);
+		}
+	}
+}
+
 void SocketServer::acceptConnection()
 {
 	int newsockfd;
@@ -81,34 +310,120 @@ void SocketServer::acceptConnection()
 		exit(1);
 	}
 
-	DateTime::print();
-	printf("Incoming connection from %s\n", inet_ntoa(cli_addr.sin_addr));
-
-	for (;;) {
+	for (int i=0 ; i<MAX_CLIENTS ; i++) {
+		if (this->clients[i].fd < 0) {
+			// Slow clients must not block the others
+			int flags = fcntl(newsockfd, F_GETFL, 0);
+			if (flags < 0 || fcntl(newsockfd, F_SETFL, flags | O_NONBLOCK) < 0) {
+				perror("Setting socket non-blocking");
+				exit(1);
+			}
 
-		// We do a blocking read (waiting for incoming RF data), but this method
-		// also returns if there is incoming data from the socket.
-		int rc = device->blockingRead(newsockfd, 60000);
-		if (rc > 0) {
-			// Write the data frame to the socket, using
-			// the selected output format.
-			device->dataFrame->writeToSocket(newsockfd);
+			this->clients[i].open(newsockfd, OutputFormatRegistry::DEFAULT_FORMAT, &this->pool);
 
-		} else if (rc == 0) {
-			const char* TIMEOUT = "Timeout\n";
-			write(newsockfd, TIMEOUT, strlen(TIMEOUT));
-		} else {
-			// Something wrong with socket FD
-			break; // Leave the loop
+			LOG_INFO("Incoming connection from %s\n", inet_ntoa(cli_addr.sin_addr));
+			return;
 		}
 	}
 
+	LOG_WARN("Rejecting connection from %s: Too many clients.\n", inet_ntoa(cli_addr.sin_addr));
+
 	if (close(newsockfd) < 0) {
 		perror("Closing new socket");
 		exit(1);
 	}
 }
 
+/**
+ * Reads the data sent by a client and executes the complete command lines.
+ */
+void SocketServer::readFromClient(int index)
+{
+	ClientConnection* client = &this->clients[index];
+	char buf[256];
+
+	int rc = read(client->fd, buf, sizeof(buf));
+	if (rc < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+		return;
+	}
+
+	if (rc <= 0) {
+		// Client closed the connection or something wrong with socket FD
+		closeClient(index);
+		return;
+	}
+
+	const char* data = buf;
+	size_t nbytes = rc;
+	while (nbytes > 0) {
+		char* line = client->readLine(data, nbytes);
+		if (line != NULL) {
+			this->dispatcher->dispatch(client, line);
+		}
+	}
+}
+
+void SocketServer::closeClient(int index)
+{
+	LOG_INFO("Closing connection (fd=%d)\n", this->clients[index].fd);
+
+	if (close(this->clients[index].fd) < 0) {
+		perror("Closing new socket");
+		exit(1);
+	}
+
+	// Nobody left to acknowledge the queued data frames
+	this->device->cancelTransmits(&this->clients[index]);
+
+	this->clients[index].close();
+}
+
+void SocketServer::transmitted(const TransmitRequest& request, int rc)
+{
+	ClientConnection* client = (ClientConnection*) request.owner;
+
+	client->respond("TXACK %u %s\n", request.id, rc == 0 ? "OK" : "ERROR");
+}
+
+size_t SocketServer::formatMetrics(char* out, size_t maxBytes)
+{
+	int nclients = 0;
+	int queued = 0;
+	for (int i=0 ; i<MAX_CLIENTS ; i++) {
+		if (this->clients[i].fd >= 0) {
+			nclients++;
+			queued += this->clients[i].getQueued();
+		}
+	}
+
+	FramePool* framePool = this->device->getFramePool();
+	TransmitQueue* transmitQueue = this->device->getTransmitQueue();
+
+	size_t len = 0;
+
+	len += Metrics::formatHeader(out + len, maxBytes - len, "rfcc1101_clients", "gauge",
+			"Clients connected to the socket server.");
+	len += Metrics::formatSample(out + len, maxBytes - len, "rfcc1101_clients", NULL, nclients);
+
+	len += Metrics::formatHeader(out + len, maxBytes - len, "rfcc1101_client_output_queued", "gauge",
+			"Buffers queued for all clients, not written to the sockets yet.");
+	len += Metrics::formatSample(out + len, maxBytes - len, "rfcc1101_client_output_queued", NULL, queued);
+
+	len += Metrics::formatHeader(out + len, maxBytes - len, "rfcc1101_frame_slots_available", "gauge",
+			"Free slots of the frame pool.");
+	len += Metrics::formatSample(out + len, maxBytes - len, "rfcc1101_frame_slots_available", NULL,
+			framePool->getAvailable());
+
+	if (transmitQueue != NULL) {
+		len += Metrics::formatHeader(out + len, maxBytes - len, "rfcc1101_transmit_queued", "gauge",
+				"Data frames waiting to be transmitted.");
+		len += Metrics::formatSample(out + len, maxBytes - len, "rfcc1101_transmit_queued", NULL,
+				transmitQueue->size());
+	}
+
+	return len;
+}
+
 /**
  * Close the server socket
  */
@@ -21,19 +21,88 @@
 #define SOCKETSERVER_HPP_
 
 #include "Device.hpp"
+#include "ClientConnection.hpp"
+#include "CommandDispatcher.hpp"
+#include "OutputBufferPool.hpp"
+#include "OutputFormatRegistry.hpp"
+#include "MetricsServer.hpp"
+#include "IMetricsSource.hpp"
 
-class SocketServer
+/**
+ * Accepts connections from several clients at the same time and writes
+ * every data frame received to all of them.
+ * Each data frame is rendered only once per output format, no matter how
+ * many clients selected the format.
+ * Clients may send command lines to change settings (see CommandDispatcher).
+ * Data frames queued by clients are transmitted between receiving.
+ * A MetricsServer, if set, is served by the same loop.
+ *
+ * Results of queries (see QueryCommand) are streamed between receiving as
+ * well: A few records and file reads at a time, and only while the
+ * client's output queue is less than half full, so the client's live
+ * data frames and responses still fit.
+ */
+class SocketServer : public ITransmitListener, public IMetricsSource
 {
+	static const int MAX_CLIENTS = 8;
+
+	/** Clients get "Timeout" if nothing was received for this long */
+	static const int RECEIVE_TIMEOUT_MILLIS = 60000;
+
+	/** Stored data frames queued per client and loop at most */
+	static const int QUERY_QUEUE_LIMIT = ClientConnection::OUTPUT_QUEUE_LENGTH / 2;
+	static const int QUERY_BATCH = 64;
+
 	Device* device; // RF module
+	CommandDispatcher* dispatcher;
+	OutputFormatRegistry* formats;
 
 	int sockfd;
 
+	ClientConnection clients[MAX_CLIENTS];
+
+	/** Rendered data frames and responses waiting to be written */
+	OutputBufferPool pool;
+
+	MetricsServer* metricsServer;
+
+	void acceptConnection();
+	void writeToClients(const FrameDescriptor& frame);
+	void writeOutput();
+	bool canStream(ClientConnection* client);
+	void streamQueries();
+	void streamQuery(ClientConnection* client, int defaultFormat);
+	void readFromClient(int index);
+	void closeClient(int index);
+
 public:
-	SocketServer(Device* device);
+	SocketServer(Device* device, CommandDispatcher* dispatcher, OutputFormatRegistry* formats);
 
 	void open(int portno);
-	void acceptConnection();
+
+	/**
+	 * Serves the metrics from the receive loop as well.
+	 */
+	void setMetricsServer(MetricsServer* metricsServer);
+
+	/**
+	 * Receives data frames and serves the connected clients.
+	 * Never returns.
+	 */
+	void run();
+
 	void closeConnection();
+
+	/**
+	 * Sends the acknowledgement of a transmitted data frame to the client
+	 * that queued it.
+	 */
+	virtual void transmitted(const TransmitRequest& request, int rc);
+
+	/**
+	 * Connected clients and the depths of the queues.
+	 */
+	virtual size_t formatMetrics(char* out, size_t maxBytes);
 };
 
 #endif /* SOCKETSERVER_HPP_ */
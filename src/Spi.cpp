@@ -27,7 +27,7 @@
 #include <unistd.h>
 #include <assert.h>
 
-#include "DateTime.hpp"
+#include "Log.hpp"
 
 #include "Spi.hpp"
 
@@ -43,6 +43,12 @@ Spi::Spi(const char* device, uint8_t bits, uint32_t speed) {
 	}
 }
 
+Spi::Spi() {
+	this->bits = 0;
+	this->speed = 0;
+	this->fd_spi = -1;
+}
+
 Spi::~Spi() {
 	if (this->fd_spi >= 0) {
 		close(this->fd_spi);
@@ -72,8 +78,7 @@ uint8_t Spi::readSingleByte(const uint8_t address, uint8_t& value) {
 
 	value = rx[1];
 
-	DateTime::print();
-	printf("read single byte address=0x%.2X status=0x%.2X value=0x%.2X\n", address, rx[0], value);
+	LOG_DEBUG("read single byte address=0x%.2X status=0x%.2X value=0x%.2X\n", address, rx[0], value);
 
 	// CHIP_RDYn (Bit 7)
 	// Stays high until power and crystal have stabilized.
@@ -110,15 +115,7 @@ uint8_t Spi::readBurst(const uint8_t address, uint8_t buffer[], const size_t nby
 
 	memcpy(buffer, rx+1, nbytes);
 
-	/*
-	DateTime::print();
-	printf("read burst       address=0x%.2X status=0x%.2X value=", address, rx[0]);
-
-	for (int i=0 ; i<nbytes ; i++) {
-		printf("0x%.2X ", buffer[i]);
-	}
-	printf("\n");
-	*/
+	LOG_DEBUG("read burst       address=0x%.2X status=0x%.2X nbytes=%d\n", address, rx[0], (int) nbytes);
 
 	// CHIP_RDYn (Bit 7)
 	// Stays high until power and crystal have stabilized.
@@ -148,10 +145,7 @@ uint8_t Spi::readStrobe(const uint8_t address)
 		abort();
 	}
 
-	/*
-	DateTime::print();
-	printf("read strobe      address=0x%.2X status=0x%.2X\n", address, rx[0]);
-	*/
+	LOG_DEBUG("read strobe      address=0x%.2X status=0x%.2X\n", address, rx[0]);
 
 	return rx[0];
 }
@@ -23,6 +23,12 @@
 #include <stdint.h>
 #include <stddef.h>
 
+/**
+ * Access to the CC1101 registers and FIFOs through the Linux spidev driver.
+ *
+ * The methods are virtual so benchmarks and simulations can replace the
+ * RF module by a subclass.
+ */
 class Spi {
 private:
 	uint8_t bits;
@@ -30,16 +36,22 @@ private:
 
 	int fd_spi;
 
+protected:
+	/**
+	 * For subclasses that don't use a SPI device.
+	 */
+	Spi();
+
 public:
 	Spi(const char* device, uint8_t bits, uint32_t speed);
-	~Spi();
+	virtual ~Spi();
 
-	uint8_t readSingleByte(const uint8_t address, uint8_t& value);
-	uint8_t readBurst(const uint8_t address, uint8_t buffer[], const size_t nbytes);
-	uint8_t readStrobe(const uint8_t address);
+	virtual uint8_t readSingleByte(const uint8_t address, uint8_t& value);
+	virtual uint8_t readBurst(const uint8_t address, uint8_t buffer[], const size_t nbytes);
+	virtual uint8_t readStrobe(const uint8_t address);
 
-	uint8_t writeSingleByte(const uint8_t address, const uint8_t value);
-	uint8_t writeBurst(const uint8_t address, const uint8_t buffer[], const size_t nbytes);
+	virtual uint8_t writeSingleByte(const uint8_t address, const uint8_t value);
+	virtual uint8_t writeBurst(const uint8_t address, const uint8_t buffer[], const size_t nbytes);
 };
 
 
@@ -0,0 +1,59 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include "Log.hpp"
+
+#include "SyncStage.hpp"
+
+SyncStage::SyncStage(const uint8_t* pattern, size_t len) {
+	assert(len > 0 && len <= MAX_PATTERN_BYTES);
+
+	memcpy(this->pattern, pattern, len);
+	this->len = len;
+}
+
+int SyncStage::process(DecoderBuffer& buffer, FrameRecord& record) {
+
+	if (buffer.len < this->len || memcmp(buffer.data, this->pattern, this->len) != 0) {
+		logUnknownHeader(buffer.data, buffer.len < this->len ? buffer.len : this->len);
+		return -1;
+	}
+
+	buffer.data += this->len;
+	buffer.len -= this->len;
+
+	return 0;
+}
+
+void SyncStage::logUnknownHeader(const uint8_t* header, size_t len) {
+
+	char hex[MAX_PATTERN_BYTES * 5 + 1];
+	char* p = hex;
+	*p = '\0';
+
+	for (size_t i=0 ; i<len && i<MAX_PATTERN_BYTES ; i++) {
+		p += sprintf(p, " 0x%.2X", header[i]);
+	}
+
+	LOG_WARN("Unknown message header:%s\n", hex);
+}
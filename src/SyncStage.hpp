@@ -0,0 +1,57 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SYNCSTAGE_HPP_
+#define SYNCSTAGE_HPP_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "IDecoderStage.hpp"
+
+/**
+ * Decoder stage that only passes on data frames starting with a fixed
+ * preamble, e.g. 0x33 0x55 0x53 for HR80 radiator controllers.
+ * The preamble is stripped off.
+ */
+class SyncStage : public IDecoderStage {
+
+public:
+	static const size_t MAX_PATTERN_BYTES = 8;
+
+	SyncStage(const uint8_t* pattern, size_t len);
+
+	virtual const char* getName() {
+		return "sync";
+	}
+
+	virtual int process(DecoderBuffer& buffer, FrameRecord& record);
+
+	/**
+	 * Logs the preamble of a data frame that doesn't match.
+	 */
+	static void logUnknownHeader(const uint8_t* header, size_t len);
+
+private:
+	uint8_t pattern[MAX_PATTERN_BYTES];
+	size_t len;
+};
+
+
+#endif /* SYNCSTAGE_HPP_ */
@@ -0,0 +1,50 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TokenBucket.hpp"
+
+TokenBucket::TokenBucket() {
+	this->reset();
+}
+
+void TokenBucket::reset() {
+	this->tokens = 0;
+	this->refillTime = 0;
+}
+
+bool TokenBucket::take(double rate, double burst, uint64_t now) {
+
+	if (this->refillTime == 0) {
+		this->tokens = burst;
+	} else {
+		this->tokens += (now - this->refillTime) * rate / 1e9;
+		if (this->tokens > burst) {
+			this->tokens = burst;
+		}
+	}
+
+	this->refillTime = now;
+
+	if (this->tokens < 1.0) {
+		return false;
+	}
+
+	this->tokens -= 1.0;
+	return true;
+}
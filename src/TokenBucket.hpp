@@ -0,0 +1,58 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TOKENBUCKET_HPP_
+#define TOKENBUCKET_HPP_
+
+#include <stdint.h>
+
+/**
+ * Limits the rate of events: Every event takes a token from the bucket,
+ * tokens are refilled at a constant rate up to the size of the bucket.
+ * This allows short bursts while limiting the average rate.
+ */
+class TokenBucket {
+
+public:
+	TokenBucket();
+
+	/**
+	 * Fills the bucket completely.
+	 */
+	void reset();
+
+	/**
+	 * Takes a token if there is one.
+	 *
+	 * @param rate Tokens added per second.
+	 * @param burst Maximum number of tokens in the bucket.
+	 * @param now Current time (CLOCK_MONOTONIC, ns).
+	 *
+	 * Returns true if a token was taken, false if the rate is exceeded.
+	 */
+	bool take(double rate, double burst, uint64_t now);
+
+private:
+	double tokens;
+
+	/** Time when tokens were added last, 0 if the bucket is full */
+	uint64_t refillTime;
+};
+
+#endif /* TOKENBUCKET_HPP_ */
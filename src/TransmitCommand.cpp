@@ -0,0 +1,107 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "DateTime.hpp"
+#include "Log.hpp"
+
+#include "TransmitCommand.hpp"
+
+static int hexDigit(char c) {
+	if (c >= '0' && c <= '9') {
+		return c - '0';
+	}
+
+	c = toupper((unsigned char) c);
+	if (c >= 'A' && c <= 'F') {
+		return c - 'A' + 10;
+	}
+
+	return -1;
+}
+
+/**
+ * Decodes the payload given as hex string.
+ * Returns the number of bytes, or -1 if the string is invalid.
+ */
+static int parsePayload(const char* s, uint8_t payload[], size_t maxBytes) {
+
+	size_t len = strlen(s);
+	if (len == 0 || len % 2 != 0 || len / 2 > maxBytes) {
+		return -1;
+	}
+
+	for (size_t i=0 ; i<len ; i+=2) {
+		int hi = hexDigit(s[i]);
+		int lo = hexDigit(s[i + 1]);
+		if (hi < 0 || lo < 0) {
+			return -1;
+		}
+
+		payload[i / 2] = (hi << 4) | lo;
+	}
+
+	return len / 2;
+}
+
+int TransmitCommand::execute(ClientConnection* client, const char* parameters) {
+
+	char* end;
+	long destAddress = strtol(parameters, &end, 16);
+	if (end == parameters || *end != ' ' || destAddress < 0 || destAddress > 0xFF) {
+		return -1;
+	}
+
+	const char* payload = end;
+	while (*payload == ' ') {
+		payload++;
+	}
+
+	uint8_t buffer[FrameRecord::MAX_PAYLOAD_BYTES];
+	int len = parsePayload(payload, buffer, sizeof(buffer));
+	if (len < 0) {
+		return -1;
+	}
+
+	if (this->rate > 0 && !client->transmitLimit.take(this->rate, this->burst, DateTime::nanos(CLOCK_MONOTONIC))) {
+		LOG_WARN("Client exceeds transmit rate limit (fd=%d)\n", client->fd);
+		return -1;
+	}
+
+	TransmitRequest* request = this->device->queueTransmit(client);
+	if (request == NULL) {
+		LOG_WARN("Transmit queue full (fd=%d)\n", client->fd);
+		return -1;
+	}
+
+	FrameRecord& record = request->record;
+	memset(&record, 0, sizeof(record));
+	record.flags = FRAME_FLAG_ADDRESS;
+	record.srcAddress = this->srcAddress;
+	record.destAddress = destAddress;
+	record.len = len;
+	memcpy(record.payload, buffer, len);
+
+	client->respond("TX %u\n", request->id);
+	return 0;
+}
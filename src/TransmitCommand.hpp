@@ -0,0 +1,71 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRANSMITCOMMAND_HPP_
+#define TRANSMITCOMMAND_HPP_
+
+#include <stdint.h>
+
+#include "AbstractCommand.hpp"
+#include "Device.hpp"
+
+/**
+ * Queues a data frame to be transmitted by the RF module.
+ *
+ * "TX <destination> <payload>" with the destination address and the
+ * payload in hex, e.g. "TX 0A 48656C6C6F". The command returns "TX <id>"
+ * right away, so clients may send the next data frame without waiting.
+ * After the data frame was transmitted, the client gets
+ * "TXACK <id> OK" or "TXACK <id> ERROR".
+ *
+ * The command fails if the transmit queue is full or the client exceeds
+ * its rate limit.
+ */
+class TransmitCommand : public AbstractCommand {
+	Device* device;
+
+	uint8_t srcAddress;
+
+	/** Data frames per second per client, 0 for no limit */
+	double rate;
+	double burst;
+
+public:
+	/**
+	 * @param srcAddress Source address put into the data frames.
+	 * @param rate Data frames each client may transmit per second on
+	 *        average, 0 for no limit.
+	 * @param burst Data frames each client may transmit at once.
+	 */
+	TransmitCommand(Device* device, uint8_t srcAddress, double rate, double burst) {
+		this->device = device;
+		this->srcAddress = srcAddress;
+		this->rate = rate;
+		this->burst = burst;
+	}
+
+	const char* getToken() {
+		return "TX";
+	}
+
+	int execute(ClientConnection* client, const char* parameters);
+};
+
+
+#endif /* TRANSMITCOMMAND_HPP_ */
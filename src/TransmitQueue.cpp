@@ -0,0 +1,84 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <assert.h>
+
+#include "TransmitQueue.hpp"
+
+TransmitQueue::TransmitQueue(int depth) {
+	assert(depth > 0);
+
+	this->requests = new TransmitRequest[depth];
+	this->depth = depth;
+	this->head = 0;
+	this->count = 0;
+	this->nextId = 1;
+}
+
+TransmitQueue::~TransmitQueue() {
+	delete[] this->requests;
+}
+
+TransmitRequest* TransmitQueue::push(const void* owner) {
+
+	if (this->count == this->depth) {
+		return NULL;
+	}
+
+	TransmitRequest* request = &this->requests[(this->head + this->count) % this->depth];
+	this->count++;
+
+	request->id = this->nextId++;
+	request->owner = owner;
+
+	return request;
+}
+
+TransmitRequest* TransmitQueue::front() {
+
+	if (this->count == 0) {
+		return NULL;
+	}
+
+	return &this->requests[this->head];
+}
+
+void TransmitQueue::pop() {
+	assert(this->count > 0);
+
+	this->head = (this->head + 1) % this->depth;
+	this->count--;
+}
+
+void TransmitQueue::remove(const void* owner) {
+
+	// Move the remaining requests together, keeping their order
+	int kept = 0;
+	for (int i=0 ; i<this->count ; i++) {
+		TransmitRequest* request = &this->requests[(this->head + i) % this->depth];
+		if (request->owner != owner) {
+			if (kept != i) {
+				this->requests[(this->head + kept) % this->depth] = *request;
+			}
+			kept++;
+		}
+	}
+
+	this->count = kept;
+}
@@ -0,0 +1,99 @@
+/*
+ * rfcc1101 - SPI Protocol Driver for TI CC1101 RF communication module.
+ *
+ * Copyright (C) 2013 Wolfgang Klenk <wolfgang.klenk@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRANSMITQUEUE_HPP_
+#define TRANSMITQUEUE_HPP_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "FrameRecord.hpp"
+
+/**
+ * A data frame waiting to be transmitted.
+ */
+struct TransmitRequest {
+	/** Identifies the request in the acknowledgement sent to the client */
+	uint32_t id;
+
+	/** Whoever queued the request, gets the acknowledgement */
+	const void* owner;
+
+	/** Addresses and payload to transmit */
+	FrameRecord record;
+};
+
+/**
+ * Receives the result of a transmitted data frame.
+ */
+class ITransmitListener {
+
+public:
+	virtual ~ITransmitListener() {};
+
+	/**
+	 * Called after the data frame was transmitted.
+	 * rc is 0 on success, -1 on error.
+	 */
+	virtual void transmitted(const TransmitRequest& request, int rc) = 0;
+};
+
+/**
+ * First in first out queue of data frames to be transmitted.
+ * The depth is fixed when the queue is created.
+ */
+class TransmitQueue {
+
+public:
+	static const int DEFAULT_DEPTH = 16;
+
+	TransmitQueue(int depth);
+	~TransmitQueue();
+
+	/**
+	 * Appends a request and assigns its id.
+	 * Returns the request to fill in, or NULL if the queue is full.
+	 */
+	TransmitRequest* push(const void* owner);
+
+	/**
+	 * Returns the oldest request, or NULL if the queue is empty.
+	 */
+	TransmitRequest* front();
+	void pop();
+
+	/**
+	 * Removes all requests of an owner, e.g. if the client closed
+	 * the connection.
+	 */
+	void remove(const void* owner);
+
+	int size() { return this->count; };
+	int getDepth() { return this->depth; };
+
+private:
+	TransmitRequest* requests;
+	int depth;
+	int head;
+	int count;
+
+	uint32_t nextId;
+};
+
+#endif /* TRANSMITQUEUE_HPP_ */
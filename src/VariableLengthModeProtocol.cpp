@@ -24,6 +24,9 @@
 
 #include "AddressSpace.hpp"
 #include "DateTime.hpp"
+#include "Log.hpp"
+#include "Metrics.hpp"
+#include "ReceiveLatency.hpp"
 
 #include "VariableLengthModeProtocol.hpp"
 
@@ -42,8 +45,8 @@ VariableLengthModeProtocol::VariableLengthModeProtocol(Spi* spi) {
  * least 255 + 2 = 257 bytes.
  *
  * The code is kind of time critical: Don't add statements that cause
- * additional I/O operations (e.g. debug printf statements). Doing so may
- * lead to RX FIFO overflow.
+ * additional I/O operations (e.g. printf statements, use the Log instead).
+ * Doing so may lead to RX FIFO overflow.
  */
 int VariableLengthModeProtocol::receive(uint8_t buffer[], size_t& nbytes) {
 
@@ -56,40 +59,45 @@ int VariableLengthModeProtocol::receive(uint8_t buffer[], size_t& nbytes) {
 	// Read the variable length byte from the RX FIFO
 	uint8_t variableLength;
 	uint8_t chipStatus = this->spi->readSingleByte(ADDR_RXTX_FIFO, variableLength);
+	ReceiveLatency::mark(LATENCY_FIFO_READ);
+
 	if (variableLength == 0) {
-		DateTime::print();
-		printf("RX FIFO received invalid variable length byte = 0x00.\n");
+		Metrics::increment(Metrics::INVALID_LENGTH);
+		LOG_WARN("RX FIFO received invalid variable length byte = 0x00.\n");
 
 		this->spi->readStrobe(STROBE_SFRX); // Flush the RX FIFO
 		return -1;
 	}
 
 	if ((chipStatus & 0x70) == 0x60) {
-		DateTime::print();
-		printf("RX FIFO Overflow when reading first byte. Flushing RX Buffer.\n");
+		Metrics::increment(Metrics::FIFO_OVERFLOWS);
+		LOG_WARN("RX FIFO Overflow when reading first byte. Flushing RX Buffer.\n");
 
 		this->spi->readStrobe(STROBE_SFRX); // Flush the RX FIFO
 		return -1;
 	}
 
 	// The CC1101 receiver adds 2 bytes at the end of the message:
-	// RSSI and LQI.
-	variableLength += 2;
+	// RSSI and LQI. Up to 257 bytes, so don't count in uint8_t.
+	size_t frameLength = variableLength + 2;
 
 	uint8_t rxBytes;
-	uint8_t currentLength = 0;
+	size_t currentLength = 0;
 	do {
 		// Check how many bytes we can read from the RX FIFO
 		this->spi->readBurst(ADDR_RX_BYTES, &rxBytes, 1);
 
-		t_rxbytes[cnt++] = rxBytes; // Debug
+		// Debug. Frames longer than the FIFO take more polls than fit.
+		if (cnt < FIFO_LENGTH) {
+			t_rxbytes[cnt++] = rxBytes;
+		}
 
 		if ((rxBytes & 0x80) > 0) {
-			DateTime::print();
-			printf("RX FIFO Overflow. Flushing RX Buffer. (rxbytes=0x%.2X)\n", rxBytes);
+			Metrics::increment(Metrics::FIFO_OVERFLOWS);
+			LOG_WARN("RX FIFO Overflow. Flushing RX Buffer. (rxbytes=0x%.2X)\n", rxBytes);
 
 			for (int i=0 ; i<cnt ; i++) {
-				printf("i=%d rxbytes=0x%.2X (0x%.2X) %d (%d)\n", i, t_rxbytes[i],  t_rxbytes[i] & 0x7F, t_rxbytes[i], t_rxbytes[i] & 0x7F);
+				LOG_DEBUG("i=%d rxbytes=0x%.2X (0x%.2X) %d (%d)\n", i, t_rxbytes[i],  t_rxbytes[i] & 0x7F, t_rxbytes[i], t_rxbytes[i] & 0x7F);
 			}
 
 			this->spi->readStrobe(STROBE_SFRX); // Flush the RX FIFO
@@ -108,7 +116,7 @@ int VariableLengthModeProtocol::receive(uint8_t buffer[], size_t& nbytes) {
 
 		// In case this is the remaining part of the message, read all
 		// bytes from the RX FIFO. If not, keep a byte in the RX FIFO.
-		if ((currentLength + rxBytes) >= variableLength) {
+		if ((currentLength + rxBytes) >= frameLength) {
 			this->spi->readBurst(ADDR_RXTX_FIFO, fifo, rxBytes);
 			memcpy(buffer + currentLength, fifo, rxBytes);
 			currentLength += rxBytes;
@@ -120,15 +128,15 @@ int VariableLengthModeProtocol::receive(uint8_t buffer[], size_t& nbytes) {
 
 			usleep(2000); // Allow some time to fill the RX FIFO
 		}
-	} while (currentLength < variableLength);
+	} while (currentLength < frameLength);
 
 	nbytes = currentLength;
+	ReceiveLatency::mark(LATENCY_DRAINED);
 
-	DateTime::print();
-	printf("Received message (variableLength=%d currentLength=%d)\n", variableLength, currentLength);
+	LOG_DEBUG("Received message (variableLength=%d currentLength=%d)\n", variableLength, (int) currentLength);
 
 	for (int i=0 ; i<cnt ; i++) {
-		printf("i=%d rxbytes=0x%.2X (0x%.2X) %d (%d)\n", i, t_rxbytes[i],  t_rxbytes[i] & 0x7F, t_rxbytes[i], t_rxbytes[i] & 0x7F);
+		LOG_DEBUG("i=%d rxbytes=0x%.2X (0x%.2X) %d (%d)\n", i, t_rxbytes[i],  t_rxbytes[i] & 0x7F, t_rxbytes[i], t_rxbytes[i] & 0x7F);
 	}
 
 	return 0;
@@ -138,101 +146,79 @@ int VariableLengthModeProtocol::receive(uint8_t buffer[], size_t& nbytes) {
  * Transmit the frame.
  * We use the "variable packet length mode", so the first byte specifies the
  * payload length. The payload length is limited to 255 bytes.
+ *
+ * The TX FIFO is refilled while transmitting, and the method returns
+ * after the last byte was sent.
+ *
+ * Returns 0 if the frame was transmitted, -1 on error.
  */
 int VariableLengthModeProtocol::transmit(const uint8_t buffer[], size_t nbytes) {
 
-	/*
 	assert(nbytes > 0);
 	assert(nbytes <= 255);
 
-	uint8_t status;
-
-	// Make sure the TX FIFO is empty
-	while (true) {
-		this->spi->readBurst(ADDR_TX_BYTES, &status, 1);
-
-		if ((status & 0x80) > 0) {
-			DateTime::print();
-			printf("TX FIFO underflow. Flushing TX FIFO.\n");
-
-			this->spi->readStrobe(STROBE_SFTX);
-
-			sleep(100);
-		} else {
-			// When we are here, the TX FIFO should be empty.
-			// If not, then we have an issue in the code.
-			assert(status == 0);
-			break;
-		}
-	}
-
-	// Write the "length" byte
-	this->spi->writeSingleByte(ADDR_RXTX_FIFO, nbytes);
-
-	// Write the first 63 bytes
-	int currentPos = 0;
-	size_t currentBytes = 63;
-	if (nbytes < currentBytes) {
-		currentBytes = nbytes;
-	}
+	uint64_t deadline = DateTime::nanos(CLOCK_MONOTONIC) + TX_TIMEOUT_MILLIS * 1000000ULL;
 
-	DateTime::print();
-	printf("currentPos=%d currentBytes=%d\n", currentPos, currentBytes);
+	// The TX FIFO must only be flushed in IDLE state.
+	// Starting from IDLE state also means that the frame is sent
+	// without waiting for a clear channel (TX-if-CCA only applies
+	// when STX is strobed in RX state).
+	this->spi->readStrobe(STROBE_SIDLE);
+	this->spi->readStrobe(STROBE_SFTX);
 
-	this->spi->writeBurst(ADDR_RXTX_FIFO, buffer + currentPos, currentBytes);
-	currentPos += currentBytes;
+	// Write the "length" byte and as many bytes as fit into the TX FIFO
+	size_t currentPos = nbytes < FIFO_LENGTH - 1 ? nbytes : FIFO_LENGTH - 1;
+	fifo[0] = nbytes;
+	memcpy(fifo + 1, buffer, currentPos);
+	this->spi->writeBurst(ADDR_RXTX_FIFO, fifo, currentPos + 1);
 
 	// Start transmission
 	this->spi->readStrobe(STROBE_STX);
 
-	// When the STX or SFSTXON command strobe is given while CC1101 is in the
-	// RX state, the TX or FSTXON state is only entered if the clear channel
-	// requirements are fulfilled. Otherwise, the chip will remain in RX.
-	// If the channel the becomes available, the radio will not enter TX
-	// or FSTXON state before a new strobe command is sent on the SPI interface.
-	// This feature is called TX-if-CCA.
-
-	// For this reason, we actually need to check if transmission actually
-	// started
 	while (true) {
-		status = this->spi->readStrobe(STROBE_SNOP);
-		if((status & 0x70) == 0x20) {
-			break;
-		}
-
-		DateTime::print();
-		printf("Current state: 0x%.2X - Waiting for TX.\n", status);
-		sleep(100);
-	}
+		// The chip status byte returned with TX_BYTES tells the state
+		uint8_t txBytes;
+		uint8_t status = this->spi->readBurst(ADDR_TX_BYTES, &txBytes, 1);
+		uint8_t state = status & 0x70;
 
+		if ((txBytes & 0x80) > 0 || state == 0x70) {
+			LOG_WARN("TX FIFO underflow. Flushing TX FIFO. (currentPos=%d nbytes=%d)\n", (int) currentPos, (int) nbytes);
 
-	while (true) {
-		this->spi->readBurst(ADDR_TX_BYTES, &status, 1);
-
-		assert ((status & 0x80) == 0); // Check for TX FIFO Underflow
+			this->spi->readStrobe(STROBE_SFTX);
+			return -1;
+		}
 
-		// Some space left in TX FIFO?
-		if (status < 64) {
-			currentBytes = 64 - status;
+		txBytes &= 0x7F;
 
-			if ((nbytes - currentPos) < currentBytes) {
-				currentBytes = nbytes - currentPos;
-			}
+		if (currentPos < nbytes) {
+			// Refill the TX FIFO, values above the FIFO length are "buggy"
+			if (txBytes < FIFO_LENGTH) {
+				size_t currentBytes = FIFO_LENGTH - txBytes;
+				if (currentBytes > nbytes - currentPos) {
+					currentBytes = nbytes - currentPos;
+				}
 
-			if (currentBytes == 0) {
-				break;
+				this->spi->writeBurst(ADDR_RXTX_FIFO, buffer + currentPos, currentBytes);
+				currentPos += currentBytes;
 			}
+		} else if (txBytes == 0 && state != 0x20 && state != 0x40 && state != 0x50) {
+			// Everything sent and no longer in TX, CALIBRATE or SETTLING
+			// state: The chip entered the state configured by TXOFF_MODE.
+			break;
+		}
 
-			DateTime::print();
-			printf("status=%d currentPos=%d currentBytes=%d\n", status, currentPos, currentBytes);
+		if (DateTime::nanos(CLOCK_MONOTONIC) >= deadline) {
+			LOG_WARN("Timeout transmitting frame (state=0x%.2X txBytes=%d). Flushing TX FIFO.\n", state, txBytes);
 
-			this->spi->writeBurst(ADDR_RXTX_FIFO, buffer + currentPos, currentBytes);
-			currentPos += currentBytes;
+			this->spi->readStrobe(STROBE_SIDLE);
+			this->spi->readStrobe(STROBE_SFTX);
+			return -1;
 		}
+
+		usleep(TX_POLL_MICROS); // Allow some time to send the TX FIFO
 	}
 
-	*/
+	LOG_INFO("Transmitted message (length=%d)\n", (int) nbytes);
 
 	return 0;
 }
-
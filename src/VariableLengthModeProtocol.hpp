@@ -34,6 +34,15 @@ class VariableLengthModeProtocol : public Protocol {
 public:
 	static const int FIFO_LENGTH = 64;
 
+	/** Longest time to transmit a frame, also at low data rates */
+	static const int TX_TIMEOUT_MILLIS = 3000;
+
+	/**
+	 * Time between checks of the TX FIFO while transmitting. Short enough
+	 * that a full FIFO doesn't run empty in between at 500 kBaud.
+	 */
+	static const int TX_POLL_MICROS = 500;
+
 	VariableLengthModeProtocol(Spi* spi);
 
 	/**